@@ -0,0 +1,101 @@
+#include "ecs/transform_kernels.hpp"
+#include "core/simd.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Raw;
+
+// times TransformKernels::ComposeTRS against composing every entity's matrix with glm, best pass of several
+namespace
+{
+    constexpr u32 ENTITY_COUNT = 100000;
+    constexpr u32 PASS_COUNT = 50;
+
+    template<typename Fn>
+    f64 BestPassMs(Fn&& fn)
+    {
+        f64 best = 1e30;
+        for(u32 pass = 0; pass < PASS_COUNT; pass++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            const auto end = std::chrono::steady_clock::now();
+            const f64 ms = std::chrono::duration<f64, std::milli>(end - start).count();
+            if(ms < best) best = ms;
+        }
+        return best;
+    }
+
+    f32 MaxDifference(const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b)
+    {
+        f32 result = 0.f;
+        for(u32 i = 0; i < (u32)a.size(); i++)
+        {
+            for(u32 c = 0; c < 4; c++)
+            {
+                for(u32 r = 0; r < 4; r++) result = std::max(result, std::fabs(a[i][c][r] - b[i][c][r]));
+            }
+        }
+        return result;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<f32> positions(-100.f, 100.f);
+    std::uniform_real_distribution<f32> angles(-3.14159265f, 3.14159265f);
+    std::uniform_real_distribution<f32> scales(0.25f, 4.f);
+
+    // the same transforms as one array per channel and as one struct per entity
+    std::vector<f32> position[3], rotation[3], scale[3];
+    std::vector<glm::vec3> entityPosition(ENTITY_COUNT), entityRotation(ENTITY_COUNT), entityScale(ENTITY_COUNT);
+    for(u32 c = 0; c < 3; c++)
+    {
+        position[c].resize(ENTITY_COUNT);
+        rotation[c].resize(ENTITY_COUNT);
+        scale[c].resize(ENTITY_COUNT);
+    }
+    for(u32 i = 0; i < ENTITY_COUNT; i++)
+    {
+        for(u32 c = 0; c < 3; c++)
+        {
+            position[c][i] = entityPosition[i][c] = positions(rng);
+            rotation[c][i] = entityRotation[i][c] = angles(rng);
+            scale[c][i] = entityScale[i][c] = scales(rng);
+        }
+    }
+
+    const TRSStreams streams = {
+        { position[0].data(), position[1].data(), position[2].data() },
+        { rotation[0].data(), rotation[1].data(), rotation[2].data() },
+        { scale[0].data(), scale[1].data(), scale[2].data() },
+    };
+
+    std::vector<glm::mat4> glmMatrices(ENTITY_COUNT), scalarMatrices(ENTITY_COUNT), dispatchedMatrices(ENTITY_COUNT);
+
+    const f64 glmMs = BestPassMs([&]()
+        {
+            for(u32 i = 0; i < ENTITY_COUNT; i++)
+            {
+                glmMatrices[i] = glm::translate(glm::mat4(1.f), entityPosition[i]) *
+                    glm::mat4_cast(glm::quat(entityRotation[i])) *
+                    glm::scale(glm::mat4(1.f), entityScale[i]);
+            }
+        }
+    );
+    const f64 scalarMs = BestPassMs([&]() { TransformKernels::ComposeTRSScalar(streams, 0, ENTITY_COUNT, scalarMatrices.data()); });
+    const f64 dispatchedMs = BestPassMs([&]() { TransformKernels::ComposeTRS(streams, 0, ENTITY_COUNT, dispatchedMatrices.data()); });
+
+    printf("%u entities, best of %u passes\n", ENTITY_COUNT, PASS_COUNT);
+    printf("glm per entity:      %8.3f ms\n", glmMs);
+    printf("ComposeTRSScalar:    %8.3f ms  (%.2fx glm, max diff %.2e)\n", scalarMs, glmMs / scalarMs, MaxDifference(glmMatrices, scalarMatrices));
+    printf("ComposeTRS (%s): %8.3f ms  (%.2fx glm, max diff %.2e)\n", SIMD::SupportsAVX2() ? "avx2  " : "scalar", dispatchedMs, glmMs / dispatchedMs, MaxDifference(glmMatrices, dispatchedMatrices));
+
+    return 0;
+}
@@ -169,9 +169,9 @@ namespace Raw::rstd
             RAW_DEALLOCATE(m_Data);
         }
 
-        for(u32 i = 0; i < (capacity - m_Capacity) * sizeof(T); i += sizeof(T))
+        for(u32 i = curSize; i < capacity; i++)
         {
-            *(data + (curSize + i)) = T();
+            data[i] = T();
         }
         // memset(data + curSize, 0, (capacity - m_Capacity) * sizeof(T));
 
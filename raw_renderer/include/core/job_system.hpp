@@ -18,6 +18,10 @@ namespace Raw::JobSystem
     // Add a job to exectue asynchronously. Any idle thread will execute this job. 
     void Execute(const std::function<void()>& job);
 
+    // Add a job that IsBusy and Wait ignore, for long running work that must not stall the frame's jobs.
+    // The job has to signal its own completion, and should not occupy every worker at once.
+    void ExecuteBackground(const std::function<void()>& job);
+
     /**
      * Divide a job into multiple jobs and execute in parallel.
      * @param jobCount : how many jobs to generate for this task.
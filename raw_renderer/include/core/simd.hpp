@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/defines.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_AMD64)
+    #define RAW_ARCH_X86
+    #include <immintrin.h>
+#endif
+
+#if defined(__AVX__)
+    #define RAW_SIMD_AVX
+    #define RAW_SIMD_SSE
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #define RAW_SIMD_SSE
+#endif
+
+// functions compiled for AVX2 regardless of the global target, only call them after checking SupportsAVX2()
+#if defined(RAW_ARCH_X86)
+    #if defined(_MSC_VER)
+        #define RAW_TARGET_AVX2
+    #else
+        #define RAW_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace Raw::SIMD
+{
+    bool SupportsAVX2();
+
+#if defined(RAW_ARCH_X86)
+    // rows r0..r7 become columns, row i of the result holds lane i of every input
+    RAW_TARGET_AVX2 RAW_INLINE void Transpose8(__m256* rows)
+    {
+        const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+        const __m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+        const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+        const __m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+        const __m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+        const __m256 t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+        const __m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+        const __m256 t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+
+        const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+        rows[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+        rows[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+        rows[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+        rows[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+        rows[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+        rows[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+        rows[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+        rows[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+    }
+#endif
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "core/asserts.hpp"
+#include <vector>
+
+namespace Raw
+{
+    struct ChangeRange
+    {
+        u32 first{ 0 };
+        u32 count{ 0 };
+    };
+
+    // per element version stamps, an element changed since frame N if its stamp is greater than N
+    class ChangeTracker
+    {
+    public:
+        RAW_INLINE void Resize(u32 count, u64 frame = 0)
+        {
+            m_Versions.resize(count, frame);
+            if(frame > m_LastChange) m_LastChange = frame;
+        }
+
+        RAW_INLINE void Clear()
+        {
+            m_Versions.clear();
+            m_LastChange = 0;
+        }
+
+        RAW_INLINE void Push(u64 frame)
+        {
+            m_Versions.push_back(frame);
+            if(frame > m_LastChange) m_LastChange = frame;
+        }
+
+        // mirrors a swap-with-last removal in the tracked array
+        RAW_INLINE void RemoveSwap(u32 index)
+        {
+            RAW_ASSERT(index < m_Versions.size());
+            m_Versions[index] = m_Versions.back();
+            m_Versions.pop_back();
+        }
+
+        RAW_INLINE void MarkChanged(u32 index, u64 frame)
+        {
+            RAW_ASSERT(index < m_Versions.size());
+            m_Versions[index] = frame;
+            if(frame > m_LastChange) m_LastChange = frame;
+        }
+
+        RAW_INLINE void MarkAllChanged(u64 frame)
+        {
+            for(u64& version : m_Versions) version = frame;
+            if(frame > m_LastChange) m_LastChange = frame;
+        }
+
+        RAW_INLINE bool HasChangedSince(u64 frame) const { return m_LastChange > frame; }
+        RAW_INLINE bool IsChangedSince(u32 index, u64 frame) const { return m_Versions[index] > frame; }
+        RAW_INLINE u64 GetVersion(u32 index) const { return m_Versions[index]; }
+        RAW_INLINE u32 GetCount() const { return (u32)m_Versions.size(); }
+
+        void GetChangedSince(u64 frame, std::vector<u32>& outIndices) const
+        {
+            outIndices.clear();
+            if(!HasChangedSince(frame)) return;
+
+            for(u32 i = 0; i < (u32)m_Versions.size(); i++)
+            {
+                if(m_Versions[i] > frame) outIndices.push_back(i);
+            }
+        }
+
+        // changed elements merged into contiguous ranges, ready to be used as copy regions
+        void GetChangedRangesSince(u64 frame, std::vector<ChangeRange>& outRanges) const
+        {
+            outRanges.clear();
+            if(!HasChangedSince(frame)) return;
+
+            for(u32 i = 0; i < (u32)m_Versions.size(); i++)
+            {
+                if(m_Versions[i] <= frame) continue;
+
+                if(!outRanges.empty() && outRanges.back().first + outRanges.back().count == i)
+                {
+                    outRanges.back().count++;
+                }
+                else
+                {
+                    outRanges.push_back({ i, 1 });
+                }
+            }
+        }
+
+    private:
+        std::vector<u64> m_Versions;
+        u64 m_LastChange{ 0 };
+
+    };
+}
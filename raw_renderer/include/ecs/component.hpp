@@ -4,13 +4,23 @@
 
 namespace Raw
 {
-#define MAX_ENTITIES 1 << 16
+#define ENTITY_INDEX_BITS 16
+#define ENTITY_GENERATION_BITS 16
+#define MAX_ENTITIES 1 << ENTITY_INDEX_BITS
 #define INVALID_ENTITY_ID 0
 
+    // low bits index the entity slot, high bits hold the generation of that slot
     using Entity = u32;
 
+    constexpr u32 ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+    constexpr u32 ENTITY_GENERATION_MASK = (1u << ENTITY_GENERATION_BITS) - 1;
+
+    RAW_INLINE constexpr u32 GetEntityIndex(Entity e) { return e & ENTITY_INDEX_MASK; }
+    RAW_INLINE constexpr u32 GetEntityGeneration(Entity e) { return (e >> ENTITY_INDEX_BITS) & ENTITY_GENERATION_MASK; }
+    RAW_INLINE constexpr Entity MakeEntity(u32 index, u32 generation) { return (generation << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK); }
+
     struct IComponent
     {
         virtual ~IComponent() {}
     };
-}
\ No newline at end of file
+}
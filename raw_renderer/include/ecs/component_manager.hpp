@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ecs/component.hpp"
+#include "ecs/change_tracker.hpp"
 #include "core/asserts.hpp"
 #include "containers/vector.hpp"
 // temporary
@@ -16,6 +17,11 @@ namespace Raw
         virtual void Remove(Entity e) = 0;
         virtual bool Contains(Entity e) const = 0;
         virtual u32 GetCount() const = 0;
+
+        virtual void RemoveBatch(const Entity* entities, u32 count)
+        {
+            for(u32 i = 0; i < count; i++) Remove(entities[i]);
+        }
     };
 
     template <typename T>
@@ -39,6 +45,34 @@ namespace Raw
             return nullptr;
         }
 
+        // same as GetComponent but stamps the component as changed in the current frame
+        RAW_INLINE T* GetComponentMutable(Entity e)
+        {
+            auto it = m_LookUp.find(e);
+            if(it == m_LookUp.end()) return nullptr;
+
+            m_Changes.MarkChanged(it->second, m_CurrentFrame);
+            return &m_Components[it->second];
+        }
+
+        RAW_INLINE void MarkChanged(Entity e)
+        {
+            auto it = m_LookUp.find(e);
+            if(it != m_LookUp.end()) m_Changes.MarkChanged(it->second, m_CurrentFrame);
+        }
+
+        // components touched after 'frame', returned as indices into the dense component array
+        RAW_INLINE void GetChangedSince(u64 frame, std::vector<u32>& outIndices) const { m_Changes.GetChangedSince(frame, outIndices); }
+        RAW_INLINE bool HasChangedSince(u64 frame) const { return m_Changes.HasChangedSince(frame); }
+        RAW_INLINE bool IsChangedSince(Entity e, u64 frame) const
+        {
+            auto it = m_LookUp.find(e);
+            return it != m_LookUp.end() && m_Changes.IsChangedSince(it->second, frame);
+        }
+
+        RAW_INLINE void SetCurrentFrame(u64 frame) { m_CurrentFrame = frame; }
+        RAW_INLINE u64 GetCurrentFrame() const { return m_CurrentFrame; }
+
         RAW_INLINE virtual u32 GetCount() const override { return m_Components.size(); }
         RAW_INLINE Entity GetEntity(u32 index) const { return m_Entities[index]; }
 
@@ -49,6 +83,8 @@ namespace Raw
         rstd::vector<T> m_Components;
         rstd::vector<Entity> m_Entities;
         std::unordered_map<Entity, u32> m_LookUp;
+        ChangeTracker m_Changes;
+        u64 m_CurrentFrame{ 1 };
 
     };
 
@@ -65,6 +101,7 @@ namespace Raw
         m_Components.shutdown();
         m_Entities.shutdown();
         m_LookUp.clear();
+        m_Changes.Clear();
     }
 
     template <typename T>
@@ -84,6 +121,7 @@ namespace Raw
         m_LookUp[e] = m_Components.size();
         m_Components.push_back(T());
         m_Entities.push_back(e);
+        m_Changes.Push(m_CurrentFrame);
 
         return m_Components.back();
     }
@@ -102,6 +140,10 @@ namespace Raw
 
             m_Components.pop_back();
             m_Entities.pop_back();
+            m_Changes.RemoveSwap(index);
+            m_LookUp[lastEntity] = index;
+            // the swapped in component now lives at a new dense index
+            if(index < m_Components.size()) m_Changes.MarkChanged(index, m_CurrentFrame);
             m_LookUp.erase(e);
         }
     }
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ecs/component.hpp"
+#include <vector>
+
+namespace Raw
+{
+    class IComponentManager;
+
+    class EntityManager
+    {
+    public:
+        EntityManager() {}
+        ~EntityManager() {}
+
+        DISABLE_COPY(EntityManager);
+
+        void Init();
+        void Shutdown();
+
+        Entity Create();
+        // destruction is deferred until Flush so components are removed in one pass per manager
+        void Destroy(Entity e);
+        void Destroy(const Entity* entities, u32 count);
+        void Flush();
+
+        bool IsAlive(Entity e) const;
+        void RegisterComponentManager(IComponentManager* manager);
+
+        RAW_INLINE u32 GetAliveCount() const { return m_AliveCount; }
+
+    private:
+        // generation per slot, a slot's generation is bumped when it's freed so stale handles stop matching
+        std::vector<u16> m_Generations;
+        std::vector<u32> m_FreeIndices;
+        std::vector<Entity> m_PendingDestroy;
+        std::vector<IComponentManager*> m_ComponentManagers;
+        u32 m_AliveCount{ 0 };
+
+    };
+}
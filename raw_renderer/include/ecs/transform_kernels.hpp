@@ -0,0 +1,24 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include <glm/glm.hpp>
+
+namespace Raw
+{
+    // structure of arrays view over translation, euler rotation (radians) and scale
+    struct TRSStreams
+    {
+        const f32* position[3];
+        const f32* rotation[3];
+        const f32* scale[3];
+    };
+
+    namespace TransformKernels
+    {
+        // T * R * S, matching glm::translate(position) * glm::mat4_cast(glm::quat(rotation)) * glm::scale(scale)
+        void ComposeTRSScalar(const TRSStreams& streams, u32 first, u32 count, glm::mat4* outMatrices);
+        void ComposeTRSAVX2(const TRSStreams& streams, u32 first, u32 count, glm::mat4* outMatrices);
+        // picks the widest kernel supported by the running cpu
+        void ComposeTRS(const TRSStreams& streams, u32 first, u32 count, glm::mat4* outMatrices);
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ecs/component_manager.hpp"
+#include "ecs/core_components.hpp"
+#include "ecs/transform_kernels.hpp"
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+namespace Raw
+{
+    // SoA storage mode for TransformComponent, keeps every channel in its own array so
+    // world matrices for large entity counts can be composed 8 at a time
+    class TransformStorage : public IComponentManager
+    {
+    public:
+        virtual void Init() override;
+        virtual void Shutdown() override;
+
+        virtual bool Contains(Entity e) const override;
+        virtual void Remove(Entity e) override;
+        void Add(Entity e, const TransformComponent& transform = TransformComponent());
+
+        void Set(Entity e, const TransformComponent& transform);
+        TransformComponent Get(Entity e) const;
+
+        // outMatrices must hold GetCount() matrices, ordered like the storage
+        void ComputeMatrices(glm::mat4* outMatrices) const;
+        // only recomposes transforms modified after 'frame', other entries of outMatrices are left untouched
+        u32 ComputeChangedMatrices(u64 frame, glm::mat4* outMatrices);
+
+        RAW_INLINE void SetCurrentFrame(u64 frame) { m_CurrentFrame = frame; }
+        RAW_INLINE bool HasChangedSince(u64 frame) const { return m_Changes.HasChangedSince(frame); }
+        RAW_INLINE void GetChangedSince(u64 frame, std::vector<u32>& outIndices) const { m_Changes.GetChangedSince(frame, outIndices); }
+
+        RAW_INLINE virtual u32 GetCount() const override { return (u32)m_Entities.size(); }
+        RAW_INLINE Entity GetEntity(u32 index) const { return m_Entities[index]; }
+        RAW_INLINE TRSStreams GetStreams() const
+        {
+            return {
+                { m_Position[0].data(), m_Position[1].data(), m_Position[2].data() },
+                { m_Rotation[0].data(), m_Rotation[1].data(), m_Rotation[2].data() },
+                { m_Scale[0].data(), m_Scale[1].data(), m_Scale[2].data() },
+            };
+        }
+
+    private:
+        void Write(u32 index, const TransformComponent& transform);
+
+    private:
+        std::vector<f32> m_Position[3];
+        std::vector<f32> m_Rotation[3];
+        std::vector<f32> m_Scale[3];
+        std::vector<Entity> m_Entities;
+        std::unordered_map<Entity, u32> m_LookUp;
+        ChangeTracker m_Changes;
+        std::vector<ChangeRange> m_ChangeRanges;
+        u64 m_CurrentFrame{ 1 };
+
+    };
+}
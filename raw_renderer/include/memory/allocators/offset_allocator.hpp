@@ -0,0 +1,78 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include <vector>
+
+namespace Raw
+{
+    constexpr u32 INVALID_OFFSET_NODE = U32_MAX;
+
+    struct OffsetAllocation
+    {
+        u32 offset{ 0 };
+        u32 size{ 0 };
+        // INVALID_OFFSET_NODE for empty allocations, which have nothing to free
+        u32 node{ INVALID_OFFSET_NODE };
+
+        RAW_INLINE bool IsValid() const { return node != INVALID_OFFSET_NODE; }
+    };
+
+    // hands out ranges of a heap that lives somewhere else, such as a gpu buffer, so the bookkeeping is kept out of band.
+    // free ranges are binned TLSF style by their top bit and the three bits below it, both allocating and freeing are O(1)
+    // and neighbouring free ranges are merged on free
+    class OffsetAllocator
+    {
+    public:
+        OffsetAllocator() {}
+        ~OffsetAllocator() {}
+
+        DISABLE_COPY(OffsetAllocator);
+
+        // size is in whatever unit the caller allocates in, vertices, indices, bytes
+        void Init(u32 size);
+        void Shutdown();
+
+        // false when no free range is large enough, an allocation of 0 succeeds without taking one
+        bool Allocate(u32 size, OffsetAllocation& outAllocation);
+        void Free(const OffsetAllocation& allocation);
+
+        RAW_INLINE u32 GetSize() const { return m_Size; }
+        RAW_INLINE u32 GetFreeSize() const { return m_FreeSize; }
+        u32 GetLargestFreeRange() const;
+
+    private:
+        struct Node
+        {
+            u32 offset{ 0 };
+            u32 size{ 0 };
+            // free list of the node's bin
+            u32 binPrev{ INVALID_OFFSET_NODE };
+            u32 binNext{ INVALID_OFFSET_NODE };
+            // the nodes covering the ranges right before and after this one
+            u32 neighbourPrev{ INVALID_OFFSET_NODE };
+            u32 neighbourNext{ INVALID_OFFSET_NODE };
+            bool used{ false };
+        };
+
+        static constexpr u32 k_SubBinCount = 8;
+        static constexpr u32 k_BinGroupCount = 32;
+        static constexpr u32 k_BinCount = k_SubBinCount * k_BinGroupCount;
+
+        u32 InsertFreeNode(u32 offset, u32 size, u32 neighbourPrev, u32 neighbourNext);
+        void LinkIntoBin(u32 node);
+        void UnlinkFromBin(u32 node);
+        u32 NewNode();
+        void ReleaseNode(u32 node);
+
+    private:
+        std::vector<Node> m_Nodes;
+        std::vector<u32> m_UnusedNodes;
+        u32 m_BinHeads[k_BinCount];
+        // bit g is set when any bin of group g has a free range, bit s of m_UsedSubBins[g] when bin g * 8 + s does
+        u32 m_UsedGroups{ 0 };
+        u8 m_UsedSubBins[k_BinGroupCount];
+        u32 m_Size{ 0 };
+        u32 m_FreeSize{ 0 };
+
+    };
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/defines.hpp"
+
+namespace Raw
+{
+    // read only mapping of a whole file, pages are faulted in on first access instead of being read up front
+    class MappedFile
+    {
+    public:
+        MappedFile() {}
+        ~MappedFile() { Close(); }
+
+        DISABLE_COPY(MappedFile);
+
+        bool Open(cstring filepath);
+        void Close();
+
+        RAW_INLINE bool IsOpen() const { return m_Data != nullptr; }
+        RAW_INLINE const u8* GetData() const { return m_Data; }
+        RAW_INLINE u64 GetSize() const { return m_Size; }
+
+    private:
+        const u8* m_Data{ nullptr };
+        u64 m_Size{ 0 };
+#if defined(RAW_PLATFORM_WINDOWS)
+        void* m_File{ nullptr };
+        void* m_Mapping{ nullptr };
+#else
+        i32 m_File{ -1 };
+#endif
+
+    };
+}
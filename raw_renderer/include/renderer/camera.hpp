@@ -30,6 +30,8 @@ namespace Raw::GFX
         }
         RAW_INLINE glm::mat4 GetProjectionMatrix() const { return m_Proj; }
         RAW_INLINE glm::vec3 GetPosition() const { return m_Position; }
+        RAW_INLINE f32 GetNearPlane() const { return m_zNear; }
+        RAW_INLINE f32 GetFarPlane() const { return m_zFar; }
 
         RAW_INLINE void SetPositon(const glm::vec3& pos) { m_Position = pos; }
         RAW_INLINE void SetUpVector(const glm::vec3& up)
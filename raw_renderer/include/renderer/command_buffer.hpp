@@ -19,6 +19,9 @@ namespace Raw::GFX
         virtual void Clear(const glm::vec4& rgba) = 0;
         virtual void ClearDepthStencil(const glm::vec2& ds) = 0;
         virtual void CopyImage(const TextureHandle& src, const TextureHandle& dst) = 0;
+        virtual void UpdateBuffer(const BufferHandle& buffer, u64 offset, u64 size, const void* data) = 0;
+        virtual void CopyBuffer(const BufferHandle& src, const BufferHandle& dst, u64 srcOffset, u64 dstOffset, u64 size) = 0;
+        virtual void FillBuffer(const BufferHandle& buffer, u64 offset, u64 size, u32 value) = 0;
         virtual void Dispatch(const ComputePipelineHandle& handle, u32 groupX, u32 groupY, u32 groupZ) = 0;
         virtual void TransitionImage(const TextureHandle& handle, ETextureLayout newLayout) = 0;
         virtual void AddMemoryBarrier(EAccessFlags srcAccess, EAccessFlags dstAccess, EPipelineStageFlags srcPipeline, EPipelineStageFlags dstPipeline) = 0;
@@ -30,12 +33,27 @@ namespace Raw::GFX
         virtual void Draw(u32 vertexCount, u32 instanceCount, u32 firstVertex, u32 firstInstance) = 0;
         virtual void DrawIndexed(u32 indexCount, u32 instanceCount, u32 firstIndex, i32 vertexOffset, u32 firstInstance) = 0;
         virtual void DrawIndexedIndirect(const BufferHandle& indirectBuffer, u64 offset, u32 drawCount) = 0;
+        // draws the u32 at countOffset in countBuffer of the commands, at most maxDrawCount
+        virtual void DrawIndexedIndirectCount(const BufferHandle& indirectBuffer, u64 offset, const BufferHandle& countBuffer, u64 countOffset, u32 maxDrawCount) = 0;
+        virtual void DrawMeshTasks(u32 groupX, u32 groupY, u32 groupZ) = 0;
         virtual void BindVertexBuffer(const BufferHandle& vertexBuffer) = 0;
         virtual void BindDrawData(const BufferHandle& meshDrawBuffer) = 0;
-        virtual void BindIndexBuffer(const BufferHandle& indexBuffer) = 0;
+        virtual void BindInstanceData(const BufferHandle& visibleInstancesBuffer) = 0;
+        virtual void BindMeshBoundsData(const BufferHandle& meshBoundsBuffer) = 0;
+        // which of GlobalSceneData's cascade projections the shadow pass draws with, pushed after the mesh bounds
+        virtual void BindShadowCascadeData(u32 cascadeIndex) = 0;
+        virtual void BindIndexBuffer(const BufferHandle& indexBuffer, u64 offset = 0, EIndexType type = EIndexType::UINT32) = 0;
         virtual void BindFullScreenData(const FullScreenData& data) = 0;
         virtual void BindAOData(const AOData& data) = 0;
-        virtual void BindCullData(const BufferHandle& indirectDrawData, const BufferHandle& meshBoundsData, const BufferHandle& culledIndirectDrawData, u32 drawCount) = 0;
+        virtual void BindCullData(const BufferHandle& indirectDrawData, const BufferHandle& meshBoundsData, const BufferHandle& instanceBoundsData, const BufferHandle& meshDrawData, const BufferHandle& culledIndirectDrawData, const BufferHandle& visibleInstancesData, u32 instanceCount, u32 cullView = CAMERA_CULL_VIEW, u32 instanceFilter = CULL_ALL_INSTANCES) = 0;
+        virtual void BindMeshletData(const BufferHandle& meshletData, const BufferHandle& meshletVertexData, const BufferHandle& meshletTriangleData, const BufferHandle& meshletTaskData, u32 taskCount, const BufferHandle& instanceVisibilityData, ECullPhase cullPhase = ALL_INSTANCES_PHASE) = 0;
+        virtual void BindMeshletCullData(const MeshletCullData& data) = 0;
+        virtual void BindDrawCompactionData(const DrawCompactionData& data) = 0;
+        virtual void BindDepthPyramidData(const DepthPyramidBuildData& data) = 0;
+        virtual void BindOcclusionCullData(const OcclusionCullData& data) = 0;
+        // the light culling compute pass, and the lighting pass reading its clusters after the full screen data
+        virtual void BindLightCullData(const LightClusterData& data) = 0;
+        virtual void BindLightClusterData(const LightClusterData& data) = 0;
         
         ECommandBufferState GetState() const { return m_State->load(); }
         EQueueType GetQueueType() const { return m_QueueType; }
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "renderer/renderer_data.hpp"
+#include <vector>
+
+namespace Raw::GFX
+{
+    // what an instance list is culled against, the main camera or any other view such as a shadow caster's
+    struct CullView
+    {
+        Frustum frustum;
+        glm::vec3 cameraPosition{ 0.f };
+        // projection[1][1], turns world space lod errors into a fraction of the screen height
+        f32 projectionScale{ 1.f };
+        // CULL_STATIC_INSTANCES or CULL_DYNAMIC_INSTANCES keep only instances of that kind, blended sorting ignores it
+        u32 instanceFilter{ CULL_ALL_INSTANCES };
+    };
+
+    RAW_INLINE CullView MakeCullView(const GlobalSceneData& sceneData)
+    {
+        CullView view;
+        view.frustum = sceneData.cameraFrustum;
+        view.cameraPosition = glm::vec3(sceneData.viewInv[3]);
+        view.projectionScale = sceneData.projection[1][1];
+        return view;
+    }
+
+    namespace CullingKernels
+    {
+        // bit (i % 8) of outMasks[i / 8] is set when instance i's world bounds are at least partially inside the frustum,
+        // for instances [first, first + count). first has to be a multiple of 8 so every mask byte belongs to one call
+        void CullBoundsScalar(const InstanceBoundsData* bounds, u32 first, u32 count, const Frustum& frustum, u8* outMasks);
+        void CullBoundsAVX2(const InstanceBoundsData* bounds, u32 first, u32 count, const Frustum& frustum, u8* outMasks);
+        // picks the widest kernel supported by the running cpu
+        void CullBounds(const InstanceBoundsData* bounds, u32 first, u32 count, const Frustum& frustum, u8* outMasks);
+    }
+
+    // level of detail of one instance, matches SelectLod in common.glsl
+    u32 SelectLod(const MeshBoundsData& bounds, const glm::mat4& transform, const CullView& view);
+
+    // frustum culls every instance of a scene on the job system and compacts the survivors into indirect commands.
+    // commands only exist for levels with visible instances, each one draws a contiguous range of the instance list.
+    // blended instances are left out of Cull and sorted back to front on their own
+    class CPUCuller
+    {
+    public:
+        CPUCuller() {}
+        ~CPUCuller() {}
+
+        DISABLE_COPY(CPUCuller);
+
+        // outCommands needs room for drawCount * MAX_LOD_COUNT commands and outInstances for instanceCount indices.
+        // the stream ranges of outList are filled in, its buffers are left to the caller
+        void Cull(const SceneData& scene, const CullView& view, IndirectDraw* outCommands, u32* outInstances, CulledDrawList& outList);
+
+        // frustum culls the blended instances and sorts the survivors farthest first, returns how many survived
+        u32 SortBlended(const SceneData& scene, const CullView& view);
+        // one command per sorted instance, outCommands and outInstances need room for GetBlendedInstanceCount() entries.
+        // fills in the blended runs of outList
+        void WriteBlended(const SceneData& scene, IndirectDraw* outCommands, u32* outInstances, CulledDrawList& outList) const;
+
+        RAW_INLINE u32 GetVisibleInstanceCount() const { return m_VisibleInstanceCount; }
+        // blended instances in the scene of the last SortBlended, culled or not
+        RAW_INLINE u32 GetBlendedInstanceCount() const { return m_BlendedInstanceCount; }
+
+    private:
+        struct BlendedInstance
+        {
+            u32 instance{ 0 };
+            u32 lod{ 0 };
+            f32 distance{ 0.f };
+        };
+
+    private:
+        std::vector<u8> m_Masks;
+        // selected level per instance, CULLED_LOD when outside the view
+        std::vector<u8> m_Lods;
+        std::vector<u32> m_CommandCursors;
+        std::vector<i32> m_VertexOffsets;
+        std::vector<BlendedInstance> m_Blended;
+        u32 m_VisibleInstanceCount{ 0 };
+        u32 m_BlendedInstanceCount{ 0 };
+
+    };
+}
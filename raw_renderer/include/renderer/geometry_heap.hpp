@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "renderer/gfxdevice.hpp"
+#include "renderer/renderer_data.hpp"
+#include "memory/allocators/offset_allocator.hpp"
+#include <vector>
+
+namespace Raw::GFX
+{
+    // large device local buffers that every asset is sub-allocated from, so every loaded asset binds the same buffers.
+    // the vertex, index and meshlet heaps hold an asset's geometry for as long as it's loaded, the draw and bounds heaps
+    // hold a scene's draw list, which is rebuilt from its assets whenever one is added or removed.
+    // the index buffer holds a 16 bit region followed by a 32 bit one starting at GetWideIndexOffset()
+    class GeometryHeap
+    {
+    public:
+        // draw and bounds ranges are handed out in blocks of this many bytes, so every range starts aligned for any use
+        static constexpr u64 k_BlockSize = 256;
+
+        static GeometryHeap* Instance();
+
+        void Init(IGFXDevice* device);
+        void Shutdown(IGFXDevice* device);
+        // ranges are only reused once no frame in flight can still read them, called once per frame after BeginFrame
+        void BeginFrame();
+
+        // uploads an asset's vertices and its mixed index block, whose 32 bit indices start wideIndexOffset bytes in.
+        // false when either heap has no range large enough, nothing is allocated then
+        bool Add(IGFXDevice* device, const SceneVertex* vertices, u32 vertexCount, const u8* indices, u64 wideIndexOffset, u64 indexSize, GeometryAllocation& outAllocation);
+        // uploads the meshlets of an asset whose vertices are already in outAllocation, their vertex and triangle offsets
+        // and vertices are moved onto the allocation's ranges on the way. false when a heap is full, nothing is allocated then
+        bool AddMeshlets(IGFXDevice* device, const MeshletData* meshlets, u32 meshletCount, const u32* vertices, u32 vertexCount,
+            const u32* triangles, u32 triangleCount, GeometryAllocation& outAllocation);
+        void Remove(const GeometryAllocation& allocation);
+
+        // size bytes of each heap rounded up to whole blocks, false when either heap has no range large enough
+        bool AddDrawList(u64 drawSize, u64 boundsSize, DrawListAllocation& outAllocation);
+        void Remove(const DrawListAllocation& allocation);
+
+        RAW_INLINE const BufferHandle& GetVertexBuffer() const { return m_VertexBuffer; }
+        RAW_INLINE const BufferHandle& GetIndexBuffer() const { return m_IndexBuffer; }
+        RAW_INLINE const BufferHandle& GetMeshletBuffer() const { return m_MeshletBuffer; }
+        RAW_INLINE const BufferHandle& GetMeshletVertexBuffer() const { return m_MeshletVertexBuffer; }
+        RAW_INLINE const BufferHandle& GetMeshletTriangleBuffer() const { return m_MeshletTriangleBuffer; }
+        RAW_INLINE const BufferHandle& GetDrawBuffer() const { return m_DrawBuffer; }
+        RAW_INLINE const BufferHandle& GetBoundsBuffer() const { return m_BoundsBuffer; }
+        RAW_INLINE u64 GetWideIndexOffset() const { return (u64)m_ShortIndices.GetSize() * sizeof(u16); }
+
+    private:
+        struct PendingRemoval
+        {
+            OffsetAllocator* allocator{ nullptr };
+            OffsetAllocation allocation;
+            u64 frame{ 0 };
+        };
+
+        void Defer(OffsetAllocator& allocator, const OffsetAllocation& allocation);
+
+    private:
+        OffsetAllocator m_Vertices;
+        OffsetAllocator m_ShortIndices;
+        OffsetAllocator m_WideIndices;
+        OffsetAllocator m_Meshlets;
+        OffsetAllocator m_MeshletVertices;
+        OffsetAllocator m_MeshletTriangles;
+        OffsetAllocator m_Draws;
+        OffsetAllocator m_Bounds;
+        BufferHandle m_VertexBuffer;
+        BufferHandle m_IndexBuffer;
+        BufferHandle m_MeshletBuffer;
+        BufferHandle m_MeshletVertexBuffer;
+        BufferHandle m_MeshletTriangleBuffer;
+        BufferHandle m_DrawBuffer;
+        BufferHandle m_BoundsBuffer;
+        std::vector<PendingRemoval> m_PendingRemovals;
+        u64 m_Frame{ 0 };
+        bool m_Initialized{ false };
+
+    };
+}
@@ -44,12 +44,26 @@ namespace Raw::GFX
         virtual void BeginFrame() = 0;
         virtual void EndFrame() = 0;
         virtual u32 GetMaximumPushConstantSize() = 0;
+        virtual u32 GetCurrentFrameIndex() = 0;
+        // VK_EXT_mesh_shader task and mesh stages
+        virtual bool SupportsMeshShaders() = 0;
+        // vkCmdDrawIndexedIndirectCount plus the subgroup ballots draw compaction packs commands with
+        virtual bool SupportsDrawIndirectCount() = 0;
+        // software implementations such as lavapipe, where work is cheaper on the host than in a dispatch
+        virtual bool IsCPUDevice() = 0;
 
         virtual ICommandBuffer* GetCommandBuffer(bool begin = false) = 0;
         virtual ICommandBuffer* GetSecondaryCommandBuffer() = 0;
         virtual void MapBuffer(const BufferHandle& handle, void* data, u64 dataSize) = 0;
         virtual void UnmapBuffer(const BufferHandle& handle, EBufferMapType type = EBufferMapType::BINDLESS) = 0;
         virtual void WriteBuffer(const BufferHandle& handle, EBufferMapType type = EBufferMapType::BINDLESS) = 0;
+        // writes the buffer into the descriptor sets of every frame in flight once, for buffers that stay bound and are only updated in place
+        virtual void WriteBufferAllFrames(const BufferHandle& handle, EBufferMapType type = EBufferMapType::BINDLESS) = 0;
+        // persistent mapping of host visible buffers, nullptr for device local memory
+        virtual void* GetMappedData(const BufferHandle& handle) = 0;
+        // copies data into [offset, offset + size) of a device local buffer through a staging buffer and waits for it,
+        // ranges of the buffer in use by frames in flight may be read meanwhile
+        virtual void UploadBufferData(const BufferHandle& handle, u64 offset, const void* data, u64 size) = 0;
         virtual void MapTexture(const TextureHandle& handle, bool isBindless = true) = 0;
         virtual TextureHandle& GetDrawImageHandle() = 0;
         virtual TextureHandle& GetDepthBufferHandle() = 0;
@@ -58,8 +72,13 @@ namespace Raw::GFX
 
         [[nodiscard]] virtual TextureHandle CreateTexture(const TextureDesc& desc, bool isDepth = false) = 0;
         [[nodiscard]] virtual TextureHandle CreateTexture(const TextureDesc& desc, void* initialData) = 0;
+        // creates and fills count rgba8 textures sharing one staging buffer and a single submission
+        virtual void CreateTextures(const TextureDesc* descs, void* const* initialData, u32 count, TextureHandle* outHandles) = 0;
         [[nodiscard]] virtual BufferHandle CreateBuffer(const BufferDesc& desc) = 0;
         [[nodiscard]] virtual BufferHandle CreateBuffer(const BufferDesc& desc, void* initialData) = 0;
+        // a handle to [offset, offset + size) of buffer, used like any other buffer. destroying it leaves buffer alive,
+        // it has to be destroyed before buffer is
+        [[nodiscard]] virtual BufferHandle CreateBufferRange(const BufferHandle& buffer, u64 offset, u64 size) = 0;
         [[nodiscard]] virtual SamplerHandle CreateSampler(const SamplerDesc& desc) = 0;
         [[nodiscard]] virtual ComputePipelineHandle CreateComputePipeline(const ComputePipelineDesc& desc) = 0;
         [[nodiscard]] virtual GraphicsPipelineHandle CreateGraphicsPipeline(const GraphicsPipelineDesc& desc) = 0;
@@ -129,6 +129,7 @@ namespace Raw::GFX
         D32_SFLOAT,
         D24_UNORM_S8_UINT,
         D32_SFLOAT_S8_UINT,
+        R32G32_SFLOAT,
     };
 
     enum class EMemoryType : u8
@@ -151,6 +152,12 @@ namespace Raw::GFX
         INDIRECT = 1 << 7,
     };
 
+    enum class EIndexType : u8
+    {
+        UINT16,
+        UINT32,
+    };
+
     enum class EDepthWriteMask : u8
     {
         ZERO,
@@ -195,6 +202,7 @@ namespace Raw::GFX
         GEOM_STAGE                            = 1 << 4,
         TESS_EVAL_STAGE                       = 1 << 5,
         TESS_CONTROL_STAGE                    = 1 << 6,
+        TASK_STAGE                            = 1 << 7,
     };
 
     enum class EBlendState : u8
@@ -264,7 +272,7 @@ namespace Raw::GFX
         A = 1 << 3,
     };
 
-    enum EAccessFlags : u8
+    enum EAccessFlags : u16
     {
         COLOR_ATTACHMENT_READ_BIT               = 1 << 0,
         COLOR_ATTACHMENT_WRITE_BIT              = 1 << 1,
@@ -272,6 +280,11 @@ namespace Raw::GFX
         DEPTH_STENCIL_ATTACHMENT_WRITE_BIT      = 1 << 3,
         SHADER_WRITE_BIT                        = 1 << 4,
         SHADER_READ_BIT                         = 1 << 5,
+        TRANSFER_READ_BIT                       = 1 << 6,
+        TRANSFER_WRITE_BIT                      = 1 << 7,
+        UNIFORM_READ_BIT                        = 1 << 8,
+        INDIRECT_COMMAND_READ_BIT               = 1 << 9,
+        INDEX_READ_BIT                          = 1 << 10,
     };
 
     enum EPipelineStageFlags
@@ -287,8 +300,15 @@ namespace Raw::GFX
         LATE_FRAGMENT_TESTS_BIT                 = 1 << 8,
         COLOR_ATTACHMENT_OUTPUT_BIT             = 1 << 9,
         NONE                                    = 1 << 10,
+        TRANSFER_BIT                            = 1 << 11,
+        DRAW_INDIRECT_BIT                       = 1 << 12,
+        TASK_SHADER_BIT                         = 1 << 13,
+        MESH_SHADER_BIT                         = 1 << 14,
     };
 
+    // barriers can wait on or block several stages at once
+    RAW_INLINE EPipelineStageFlags operator|(EPipelineStageFlags a, EPipelineStageFlags b) { return (EPipelineStageFlags)((u32)a | (u32)b); }
+
     enum class ERenderingOp : u8
     {
         CLEAR,
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "renderer/render_passes/render_pass.hpp"
+#include "events/core_events.hpp"
+#include "events/event_handler.hpp"
+
+namespace Raw::GFX
+{
+    // conservative min and max depth pyramid of the depth buffer, one single level storage image per mip
+    class DepthPyramidPass : public IRenderPass
+    {
+    public:
+        DepthPyramidPass() {}
+        ~DepthPyramidPass() {}
+
+        virtual void Init(IGFXDevice* device) override;
+        virtual void Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene) override;
+        virtual void ExecuteAsync(IGFXDevice* device, SceneData* scene) override;
+        void Shutdown(IGFXDevice* device);
+
+        const DepthPyramidData& GetPyramidData() const { return m_Pyramid; }
+
+        GPUTechnique technique;
+        ComputePipelineDesc techniqueDesc;
+
+    private:
+        void RecordPyramid(IGFXDevice* device, ICommandBuffer* cmd);
+        // sized to the depth buffer rounded down to a power of two, so every level halves the last exactly
+        void CreateMips(IGFXDevice* device, u32 depthWidth, u32 depthHeight);
+        void DestroyMips(IGFXDevice* device);
+        bool OnWindowResize(const WindowResizeEvent& e);
+        EventHandler<WindowResizeEvent> m_ResizeHandler;
+
+    private:
+        TextureHandle m_Mips[MAX_DEPTH_PYRAMID_MIPS];
+        DepthPyramidData m_Pyramid;
+        // finished workgroups of the current build, the last one reduces the levels past its tile
+        BufferHandle m_CounterBuffer;
+    };
+}
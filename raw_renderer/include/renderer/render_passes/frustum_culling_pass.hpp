@@ -1,6 +1,7 @@
 #pragma once
 
 #include "renderer/render_passes/render_pass.hpp"
+#include "renderer/cpu_culling.hpp"
 #include "events/core_events.hpp"
 #include "events/event_handler.hpp"
 
@@ -15,8 +16,86 @@ namespace Raw::GFX
         virtual void Init(IGFXDevice* device) override;
         virtual void Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene) override;
         virtual void ExecuteAsync(IGFXDevice* device, SceneData* scene) override;
+        // second phase of occlusion culling, once the depth pyramid of the early draws is built
+        void ExecuteLate(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene);
+        void Shutdown(IGFXDevice* device);
 
         GPUTechnique technique;
         ComputePipelineDesc techniqueDesc;
+        GPUTechnique meshletTechnique;
+        ComputePipelineDesc meshletTechniqueDesc;
+        // only created when the device can draw with a gpu count
+        GPUTechnique compactionTechnique;
+        ComputePipelineDesc compactionTechniqueDesc;
+        GPUTechnique occlusionTechnique;
+        ComputePipelineDesc occlusionTechniqueDesc;
+        // set every frame by the renderer, the cpu path culls against it instead of dispatching the compute shader
+        CullView cullView;
+        // shadow casters are culled per cascade against its light frustum, dynamic ones every frame and static ones only
+        // when the cascade's cache is rebuilt. lods still follow the camera
+        CullView cascadeViews[SHADOW_CASCADE_COUNT];
+        bool useCPUCulling{ false };
+        // meshlet geometry is drawn in two phases, what was visible last frame and then what the pyramid says was missed
+        bool useOcclusionCulling{ false };
+        DepthPyramidData depthPyramid;
+
+    private:
+        // what one view is culled into on the gpu, the compacted buffers are only valid when the device can draw with a count
+        struct DeviceDrawBuffers
+        {
+            BufferHandle indirectBuffer;
+            BufferHandle instanceBuffer;
+            BufferHandle compactedIndirectBuffer;
+            BufferHandle drawCountBuffer;
+        };
+
+    private:
+        // per instance culling, visible instances are appended to their indirect draw's range in the visible instance list
+        void RecordCulling(ICommandBuffer* cmd, SceneData* scene, const DeviceDrawBuffers& buffers, u32 view, u32 instanceFilter, CulledDrawList& outList);
+        // packs the commands culling left with instances to the front of their stream range and counts them
+        void RecordCompaction(ICommandBuffer* cmd, SceneData* scene, const DeviceDrawBuffers& buffers, CulledDrawList& outList);
+        // the camera first, then the casters of every cascade
+        void RecordViews(ICommandBuffer* cmd, SceneData* scene);
+        // without mesh shaders the geometry pass draws meshlets that survived this from a compacted index buffer
+        void RecordMeshletCulling(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene, ECullPhase phase);
+        // tests every instance against the depth pyramid and rewrites its visibility flags
+        void RecordOcclusionCulling(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene);
+        // culls on the job system straight into host visible buffers of the current frame, nothing is recorded
+        void CullOnCPU(IGFXDevice* device, SceneData* scene);
+        // blended instances are always culled and sorted back to front on the cpu, whichever backend culls the rest
+        void SortBlended(IGFXDevice* device, SceneData* scene);
+
+    private:
+        // host visible commands and instance lists, one set per frame in flight
+        struct HostDrawBuffers
+        {
+            BufferHandle indirectBuffers[MAX_SWAPCHAIN_IMAGES];
+            BufferHandle instanceBuffers[MAX_SWAPCHAIN_IMAGES];
+            u32 commandCapacity{ 0 };
+            u32 instanceCapacity{ 0 };
+        };
+
+        void ReserveHostBuffers(IGFXDevice* device, HostDrawBuffers& buffers, u32 commandCount, u32 instanceCount);
+        void DestroyHostBuffers(IGFXDevice* device, HostDrawBuffers& buffers);
+        void ReserveCompactionBuffers(IGFXDevice* device, u32 commandCount);
+        void ReserveCascadeBuffers(IGFXDevice* device, u32 commandCount, u32 instanceCount);
+        void DestroyCascadeBuffers(IGFXDevice* device);
+        void CreateDeviceBuffers(IGFXDevice* device, DeviceDrawBuffers& buffers, u32 commandCount, u32 instanceCount);
+        void DestroyDeviceBuffers(IGFXDevice* device, DeviceDrawBuffers& buffers);
+
+    private:
+        CPUCuller m_CPUCuller;
+        HostDrawBuffers m_CPUBuffers;
+        HostDrawBuffers m_BlendedBuffers;
+        HostDrawBuffers m_CPUCascadeBuffers[SHADOW_CASCADE_COUNT];
+        HostDrawBuffers m_CPUCascadeStaticBuffers[SHADOW_CASCADE_COUNT];
+        // device local, only written and read on the gpu so one set serves every frame in flight
+        BufferHandle m_CompactedIndirectBuffer;
+        BufferHandle m_DrawCountBuffer;
+        u32 m_CompactedCapacity{ 0 };
+        DeviceDrawBuffers m_CascadeBuffers[SHADOW_CASCADE_COUNT];
+        DeviceDrawBuffers m_CascadeStaticBuffers[SHADOW_CASCADE_COUNT];
+        u32 m_CascadeCommandCapacity{ 0 };
+        u32 m_CascadeInstanceCapacity{ 0 };
     };
 }
\ No newline at end of file
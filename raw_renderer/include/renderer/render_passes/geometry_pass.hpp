@@ -22,9 +22,14 @@ namespace Raw::GFX
         virtual void Init(IGFXDevice* device) override;
         virtual void Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene) override;
         virtual void ExecuteAsync(IGFXDevice* device, SceneData* scene) override;
+        // draws the meshlets occlusion culling found were missed, over what Execute already wrote
+        void ExecuteLate(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene);
 
         GPUTechnique technique;
         GraphicsPipelineDesc techiqueDesc;
+        // opaque geometry split into meshlets, task and mesh shaders or the compute culled index buffer fallback
+        GPUTechnique meshletTechnique;
+        GraphicsPipelineDesc meshletTechniqueDesc;
 
         TextureHandle diffuse;
         TextureHandle normals;
@@ -40,7 +45,11 @@ namespace Raw::GFX
         TextureDesc viewspacePositionDesc;
         TextureDesc lightClipSpacePositionDesc;
 
+        // Execute only draws instances that were visible last frame, ExecuteLate the rest
+        bool useOcclusionCulling{ false };
+
     private:
+        void RecordGeometry(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene, ECullPhase phase);
         bool OnWindowResize(const WindowResizeEvent& e);
         EventHandler<WindowResizeEvent> m_ResizeHandler;
 
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "renderer/render_passes/render_pass.hpp"
+
+namespace Raw::GFX
+{
+    // bins the scene's point lights into the view space cluster grid, the lighting pass only shades a pixel
+    // with the lights of its cluster
+    class LightCullingPass : public IRenderPass
+    {
+    public:
+        LightCullingPass() {}
+        ~LightCullingPass() {}
+
+        virtual void Init(IGFXDevice* device) override;
+        virtual void Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene) override;
+        virtual void ExecuteAsync(IGFXDevice* device, SceneData* scene) override;
+        void Shutdown(IGFXDevice* device);
+
+        // the scene's lights and the clusters they were binned into by the last Execute
+        const LightClusterData& GetClusterData() const { return m_ClusterData; }
+
+        GPUTechnique technique;
+        ComputePipelineDesc techniqueDesc;
+
+    private:
+        void RecordCulling(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene);
+
+    private:
+        LightClusterData m_ClusterData;
+        // light count per cluster and MAX_LIGHTS_PER_CLUSTER light indices per cluster, rewritten every frame
+        BufferHandle m_ClusterLightCountBuffer;
+        BufferHandle m_ClusterLightIndexBuffer;
+    };
+}
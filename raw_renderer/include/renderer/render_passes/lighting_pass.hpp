@@ -25,6 +25,8 @@ namespace Raw::GFX
 
         TextureHandle illuminatedTexture;
         TextureDesc illuminatedDesc;
+        // point lights binned by the light culling pass, set before every Execute
+        LightClusterData clusterData;
 
     private:
         bool OnWindowResize(const WindowResizeEvent& e);
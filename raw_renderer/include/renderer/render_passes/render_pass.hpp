@@ -15,4 +15,74 @@ namespace Raw::GFX
         virtual void Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene) = 0;
         virtual void ExecuteAsync(IGFXDevice* device, SceneData* scene) = 0;
     };
+
+    // draws one stream's range of each index width, each with its own index buffer binding
+    RAW_INLINE void DrawStreamIndexedIndirect(ICommandBuffer* cmd, SceneData* scene, const BufferHandle& indirectBuffer, const DrawStream& stream)
+    {
+        if(stream.shortRange.count > 0)
+        {
+            cmd->BindIndexBuffer(scene->indexBuffer, 0, EIndexType::UINT16);
+            cmd->DrawIndexedIndirect(indirectBuffer, stream.shortRange.first * sizeof(IndirectDraw), stream.shortRange.count);
+        }
+        if(stream.wideRange.count > 0)
+        {
+            cmd->BindIndexBuffer(scene->indexBuffer, scene->wideIndexOffset, EIndexType::UINT32);
+            cmd->DrawIndexedIndirect(indirectBuffer, stream.wideRange.first * sizeof(IndirectDraw), stream.wideRange.count);
+        }
+    }
+
+    // draws a stream straight from the scene's unculled indirect draws
+    RAW_INLINE void DrawSceneIndexedIndirect(ICommandBuffer* cmd, SceneData* scene, const BufferHandle& indirectBuffer, EDrawStream stream)
+    {
+        DrawStreamIndexedIndirect(cmd, scene, indirectBuffer, scene->streams[stream]);
+    }
+
+    // draws whatever culling left of a stream in a culled list, with its instance list bound for the vertex stage
+    RAW_INLINE void DrawListCulled(ICommandBuffer* cmd, SceneData* scene, const CulledDrawList& draws, EDrawStream stream)
+    {
+        const DrawStream& commands = draws.streams[stream];
+        if(commands.shortRange.count + commands.wideRange.count == 0) return;
+
+        cmd->BindInstanceData(draws.instanceBuffer);
+        if(!draws.drawCountBuffer.IsValid())
+        {
+            DrawStreamIndexedIndirect(cmd, scene, draws.indirectBuffer, commands);
+            return;
+        }
+
+        // compacted ranges hold their visible commands up front, the gpu count says how many
+        if(commands.shortRange.count > 0)
+        {
+            cmd->BindIndexBuffer(scene->indexBuffer, 0, EIndexType::UINT16);
+            cmd->DrawIndexedIndirectCount(draws.indirectBuffer, commands.shortRange.first * sizeof(IndirectDraw),
+                draws.drawCountBuffer, GetDrawCountOffset(stream, false), commands.shortRange.count);
+        }
+        if(commands.wideRange.count > 0)
+        {
+            cmd->BindIndexBuffer(scene->indexBuffer, scene->wideIndexOffset, EIndexType::UINT32);
+            cmd->DrawIndexedIndirectCount(draws.indirectBuffer, commands.wideRange.first * sizeof(IndirectDraw),
+                draws.drawCountBuffer, GetDrawCountOffset(stream, true), commands.wideRange.count);
+        }
+    }
+
+    // draws what camera culling left of a stream in scene->culledDraws
+    RAW_INLINE void DrawSceneCulled(ICommandBuffer* cmd, SceneData* scene, EDrawStream stream)
+    {
+        DrawListCulled(cmd, scene, scene->culledDraws, stream);
+    }
+
+    // blended instances back to front, the index buffer is rebound between runs of different width
+    RAW_INLINE void DrawSceneBlended(ICommandBuffer* cmd, SceneData* scene)
+    {
+        const CulledDrawList& draws = scene->culledDraws;
+        if(draws.blendedRuns.empty()) return;
+
+        cmd->BindInstanceData(draws.blendedInstanceBuffer);
+        for(const BlendedDrawRun& run : draws.blendedRuns)
+        {
+            if(run.shortIndices)    cmd->BindIndexBuffer(scene->indexBuffer, 0, EIndexType::UINT16);
+            else                    cmd->BindIndexBuffer(scene->indexBuffer, scene->wideIndexOffset, EIndexType::UINT32);
+            cmd->DrawIndexedIndirect(draws.blendedIndirectBuffer, run.commands.first * sizeof(IndirectDraw), run.commands.count);
+        }
+    }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 namespace Raw::GFX
 {
+    // the first cascade's map, the rest are only reachable through GlobalSceneData::cascadeShadowMaps
     #define DIR_SHADOW_MAP "directional_shadow_map"
 
     class ShadowPass : public IRenderPass
@@ -15,12 +16,38 @@ namespace Raw::GFX
         virtual void Init(IGFXDevice* device) override;
         virtual void Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene) override;
         virtual void ExecuteAsync(IGFXDevice* device, SceneData* scene) override;
+        // picks the cascades whose static casters are redrawn this frame into scene->cascadeRebuildMask,
+        // has to run before culling so only those cascades cull their static casters
+        void UpdateCache(const GlobalSceneData& sceneData, SceneData* scene);
 
-        GPUTechnique technique;
+        // pipelines are created against their depth attachment, so every cascade has its own
+        GPUTechnique techniques[SHADOW_CASCADE_COUNT];
+        GPUTechnique staticTechniques[SHADOW_CASCADE_COUNT];
+        GPUTechnique maskedTechniques[SHADOW_CASCADE_COUNT];
+        GPUTechnique staticMaskedTechniques[SHADOW_CASCADE_COUNT];
         GraphicsPipelineDesc techiqueDesc;
+        GraphicsPipelineDesc maskedTechniqueDesc;
 
-        TextureHandle shadowMap;
+        // what gets sampled, the cached static depth with the dynamic casters drawn over it
+        TextureHandle shadowMaps[SHADOW_CASCADE_COUNT];
+        // static casters only, redrawn when the light, the cascade's projection or a static instance changes
+        TextureHandle staticShadowMaps[SHADOW_CASCADE_COUNT];
         TextureDesc shadowMapDesc;
 
+    private:
+        void RecordCascades(ICommandBuffer* cmd, SceneData* scene);
+        // opaque casters through pipeline, then masked ones through maskedPipeline
+        void DrawCasters(ICommandBuffer* cmd, SceneData* scene, const GraphicsPipelineHandle& pipeline, const GraphicsPipelineHandle& maskedPipeline, 
+            ERenderingOp depthOp, u32 cascade, const CulledDrawList& draws);
+
+    private:
+        const SceneData* m_CachedScene{ nullptr };
+        u64 m_CachedStaticVersion{ 0 };
+        glm::vec4 m_CachedLightDir{ 0.f };
+        glm::mat4 m_CachedViewProj[SHADOW_CASCADE_COUNT];
+        bool m_CacheValid[SHADOW_CASCADE_COUNT]{};
+        // set while a cascade's map holds dynamic casters, it's restored from the cache once they're gone
+        bool m_HasDynamic[SHADOW_CASCADE_COUNT]{};
+
     };
-}
\ No newline at end of file
+}
@@ -17,6 +17,12 @@ namespace Raw::GFX
         bool enableAO{ true };
         bool enableSSR{ true };
         bool enableFXAA{ false };
+        // frustum culling on the job system instead of a compute dispatch, the default on software rasterizers
+        bool enableCPUCulling{ false };
+        // meshlet geometry tested against a depth pyramid of what was visible last frame
+        bool enableOcclusionCulling{ true };
+        // view distance the shadow cascades are split over, clamped to the camera's far plane
+        f32 shadowDistance{ 60.f };
     };
 
     class Renderer
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "renderer/gpu_resources.hpp"
+#include "memory/allocators/offset_allocator.hpp"
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -8,11 +9,39 @@
 
 namespace Raw::GFX
 {
+    // size of each cascade's shadow map
     #define SHADOW_MAP_SIZE 2048
+    // slices of the camera frustum the directional light's shadows are split into, nearest first
+    #define SHADOW_CASCADE_COUNT 4
+    // frustum culling views, the camera first and then one per shadow cascade
+    #define CAMERA_CULL_VIEW 0
+    // which instances a frustum culling view keeps, cascades cull their static and dynamic casters separately
+    #define CULL_ALL_INSTANCES 0
+    #define CULL_STATIC_INSTANCES 1
+    #define CULL_DYNAMIC_INSTANCES 2
     #define AMBIENT_OCCLUSION_TEX "aoTexture"
     #define REFLECTION_TEX "refTexture"
     #define ANTI_ALIASING_TEX "aaTex"
-    #define MAX_LIGHT_COUNT 64
+    // capacity of a scene's point light buffer, a scene starts out with DEFAULT_LIGHT_COUNT of them
+    #define MAX_LIGHT_COUNT 4096
+    #define DEFAULT_LIGHT_COUNT 64
+    // view space grid point lights are binned into, screen tiles split into exponential depth slices
+    #define LIGHT_CLUSTER_X 16
+    #define LIGHT_CLUSTER_Y 9
+    #define LIGHT_CLUSTER_Z 24
+    #define LIGHT_CLUSTER_COUNT (LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z)
+    // index slots each cluster has, lights past this are dropped from it
+    #define MAX_LIGHTS_PER_CLUSTER 128
+    // source mesh plus up to three simplified levels
+    #define MAX_LOD_COUNT 4
+    #define MAX_MESHLET_VERTICES 64
+    #define MAX_MESHLET_TRIANGLES 124
+    // meshlets culled by one task shader or meshlet culling workgroup, one per invocation
+    #define MESHLET_TASK_SIZE 32
+    // task and meshlet culling dispatches are 2D past this, the smallest maxTaskWorkGroupCount[0] the spec allows
+    #define MAX_MESHLET_TASK_GROUPS_X 65535u
+    // levels of a depth pyramid up to 4096 texels across, depth buffers up to 8k wide
+    #define MAX_DEPTH_PYRAMID_MIPS 13
 
     struct PointLight
     {
@@ -53,9 +82,17 @@ namespace Raw::GFX
         glm::vec4 lightDir{ -0.5f, -1.f, 0.f, 0.f };
         f32 lightIntensity{ 1.f };
         u32 shadowMapIndex{ U32_MAX };
-        f32 padding0[2];
+        // camera clip planes, the light clusters' depth slices are spread between them
+        f32 zNear{ 0.1f };
+        f32 zFar{ 100.f };
         Frustum cameraFrustum;
-        glm::mat4 padding1[3];
+        // light space projection of each cascade, fitted to a slice of the camera frustum
+        glm::mat4 cascadeViewProj[SHADOW_CASCADE_COUNT];
+        // view space distance each cascade ends at
+        glm::vec4 cascadeSplits{ 0.f };
+        u32 cascadeShadowMaps[SHADOW_CASCADE_COUNT]{ U32_MAX, U32_MAX, U32_MAX, U32_MAX };
+        Frustum cascadeFrustums[SHADOW_CASCADE_COUNT];
+        glm::vec4 padding1[2];
     };
 
     // 16 byte aligned
@@ -68,6 +105,24 @@ namespace Raw::GFX
         glm::vec4 tangent;
     };
 
+    // 20 bytes, decoded by DecodeVertex in common.glsl
+    // position is unorm16 within the mesh bounds, positionZW's high half holds the tangent handedness,
+    // normal and tangent are octahedral snorm16 pairs and the uvs are half floats
+    struct CompactVertexData
+    {
+        u32 positionXY;
+        u32 positionZW;
+        u32 normal;
+        u32 tangent;
+        u32 texCoord;
+    };
+
+#if defined(RAW_COMPACT_VERTICES)
+    typedef CompactVertexData SceneVertex;
+#else
+    typedef VertexData SceneVertex;
+#endif
+
     struct GPUTechnique
     {
         GraphicsPipelineHandle gfxPipeline;
@@ -110,12 +165,91 @@ namespace Raw::GFX
         i32 metallicRoughness{ -1 };
     };
 
+    // which instances a meshlet pass draws under two phase occlusion culling. the values double as the instance
+    // visibility flag a phase tests, set by the occlusion test of the previous frame or this one
+    enum ECullPhase : u32
+    {
+        ALL_INSTANCES_PHASE = 0,
+        // visible last frame, drawn before the depth pyramid is built
+        EARLY_CULL_PHASE = 1,
+        // passed the occlusion test but weren't visible last frame
+        LATE_CULL_PHASE = 2,
+    };
+
+    // min and max depth of 2x2 texels of the level below, one single level rg32 texture per level.
+    // the first level is the depth buffer's size rounded down to a power of two
+    struct DepthPyramidData
+    {
+        u32 mips[MAX_DEPTH_PYRAMID_MIPS]{};
+        u32 mipCount{ 0 };
+        u32 width{ 0 };
+        u32 height{ 0 };
+    };
+
+    struct DepthPyramidBuildData
+    {
+        DepthPyramidData pyramid;
+        u32 depthBuffer{ 0 };
+        u32 depthWidth{ 0 };
+        u32 depthHeight{ 0 };
+        u32 workGroupCount{ 0 };
+        // counts finished workgroups, the last one reduces the remaining levels and resets it
+        BufferHandle counterBuffer;
+    };
+
+    // instances are tested against the depth pyramid of this frame's early draws
+    struct OcclusionCullData
+    {
+        BufferHandle instanceBoundsBuffer;
+        BufferHandle instanceVisibilityBuffer;
+        u32 instanceCount{ 0 };
+        DepthPyramidData pyramid;
+    };
+
+    // point lights binned into the cluster grid, each cluster has MAX_LIGHTS_PER_CLUSTER index slots
+    struct LightClusterData
+    {
+        BufferHandle pointLightBuffer;
+        BufferHandle clusterLightCountBuffer;
+        BufferHandle clusterLightIndexBuffer;
+        u32 pointLightCount{ 0 };
+    };
+
+    // scene buffers read and written by the compute meshlet culling fallback
+    struct MeshletCullData
+    {
+        BufferHandle meshDrawBuffer;
+        BufferHandle meshBoundsBuffer;
+        BufferHandle meshletBuffer;
+        BufferHandle meshletTrianglesBuffer;
+        BufferHandle meshletTasksBuffer;
+        BufferHandle visibleMeshletsBuffer;
+        BufferHandle meshletIndexBuffer;
+        BufferHandle meshletDrawBuffer;
+        BufferHandle instanceVisibilityBuffer;
+        u32 taskCount{ 0 };
+        ECullPhase cullPhase{ ALL_INSTANCES_PHASE };
+    };
+
+    // glTF alpha modes, each drawn by its own passes. blended stays last so it's drawn over the rest in forward passes
+    enum EDrawStream : u32
+    {
+        OPAQUE_STREAM = 0,
+        MASKED_STREAM,
+        BLENDED_STREAM,
+        DRAW_STREAM_COUNT
+    };
+
+    // one per instance, instances of the same mesh are contiguous and start at their indirect draw's firstInstance
     struct MeshDrawData
     {
         glm::mat4 transform;
         u32 materialIndex;
+        // set for BLENDED_STREAM instances, which are sorted and drawn on their own
         u32 isTransparent;
-        u32 padding[2];
+        u32 drawIndex;
+        // set once the instance has moved, its shadow is drawn every frame instead of cached with the static casters
+        u32 isDynamic;
     };
 
     struct MeshData
@@ -129,38 +263,201 @@ namespace Raw::GFX
         u32 baseInstance{ 0 };
     };
 
+    // index and meshlet ranges of one level of detail, firstIndex counts in the draw's index width like IndirectDraw::firstIndex
+    struct MeshLodData
+    {
+        u32 firstIndex{ 0 };
+        u32 indexCount{ 0 };
+        u32 firstMeshlet{ 0 };
+        u32 meshletCount{ 0 };
+    };
+
     struct MeshBoundsData
     {
         glm::vec3 boundsMin{ glm::vec3(0) };
-        u32 padding0{ 0 };
+        u32 lodCount{ 1 };
         glm::vec3 boundsMax{ glm::vec3(0) };
-        u32 padding1{ 0 };
+        u32 padding{ 0 };
+        // mesh space distance each level moved the surface by, culling picks the coarsest one that stays under a pixel or so
+        f32 lodErrors[MAX_LOD_COUNT]{};
+        MeshLodData lods[MAX_LOD_COUNT];
     };
 
+    // world space bounds of one instance, derived from its transform and its draw's mesh space bounds
+    struct InstanceBoundsData
+    {
+        glm::vec3 boundsMin{ glm::vec3(0) };
+        f32 padding0{ 0.f };
+        glm::vec3 boundsMax{ glm::vec3(0) };
+        f32 padding1{ 0.f };
+    };
+
+    // a cluster of one indirect draw's triangles, culled on its own against the frustum and its normal cone
+    struct MeshletData
+    {
+        // bounding sphere in mesh space
+        glm::vec3 center{ 0.0f };
+        f32 radius{ 0.0f };
+        // every triangle is backfacing when seen from inside the cone, a cutoff above 1 disables the test
+        glm::vec3 coneApex{ 0.0f };
+        f32 coneCutoff{ 2.0f };
+        glm::vec3 coneAxis{ 0.0f };
+        // scene wide vertex indices start at vertexOffset in the meshlet vertex list,
+        // triangles start at triangleOffset in the triangle list as three u8 meshlet local indices packed in a u32
+        u32 vertexOffset{ 0 };
+        u32 triangleOffset{ 0 };
+        u32 vertexCount{ 0 };
+        u32 triangleCount{ 0 };
+        u32 padding{ 0 };
+    };
+
+    // up to MESHLET_TASK_SIZE meshlets of one instance, starting meshletOffset meshlets into whichever level of detail is selected.
+    // tasks cover the source mesh, coarser levels have fewer meshlets and leave the tail of the tasks empty
+    struct MeshletTask
+    {
+        u32 instanceIndex{ 0 };
+        u32 meshletOffset{ 0 };
+    };
+
+    struct DrawRange
+    {
+        u32 first{ 0 };
+        u32 count{ 0 };
+    };
+
+    // the draws or commands of one EDrawStream, split by index width
+    struct DrawStream
+    {
+        DrawRange shortRange;
+        DrawRange wideRange;
+    };
+
+    // consecutive blended commands sharing an index width
+    struct BlendedDrawRun
+    {
+        DrawRange commands;
+        bool shortIndices{ true };
+    };
+
+    // buffers read and written by the draw compaction pass, which packs the commands culling left with instances to the
+    // front of each stream range and counts them so the draws only cover those
+    struct DrawCompactionData
+    {
+        BufferHandle commandBuffer;
+        BufferHandle compactedCommandBuffer;
+        BufferHandle drawCountBuffer;
+        u32 commandCount{ 0 };
+        DrawStream streams[DRAW_STREAM_COUNT];
+    };
+
+    // a range's u32 in the draw count buffer, one per stream and index width
+    RAW_INLINE u64 GetDrawCountOffset(EDrawStream stream, bool wideIndices)
+    {
+        return ((u64)stream * 2 + (wideIndices ? 1 : 0)) * sizeof(u32);
+    }
+
+    // what the instance passes draw this frame, filled in by whichever culling backend ran.
+    // streams index indirectBuffer, except the blended one which is sorted back to front every frame into
+    // blendedIndirectBuffer, one command per instance
+    struct CulledDrawList
+    {
+        BufferHandle indirectBuffer;
+        BufferHandle instanceBuffer;
+        DrawStream streams[DRAW_STREAM_COUNT];
+        // set when the gpu compacted indirectBuffer, each range then draws only as many commands as its count says
+        BufferHandle drawCountBuffer;
+        BufferHandle blendedIndirectBuffer;
+        BufferHandle blendedInstanceBuffer;
+        std::vector<BlendedDrawRun> blendedRuns;
+    };
+
+    // an asset's ranges of the shared geometry heaps, in vertices, 16 and 32 bit indices, meshlets and meshlet vertices and triangles
+    struct GeometryAllocation
+    {
+        OffsetAllocation vertices;
+        OffsetAllocation shortIndices;
+        OffsetAllocation wideIndices;
+        OffsetAllocation meshlets;
+        OffsetAllocation meshletVertices;
+        OffsetAllocation meshletTriangles;
+    };
+
+    // a draw list's ranges of the shared draw and bounds heaps, in GeometryHeap::k_BlockSize blocks
+    struct DrawListAllocation
+    {
+        OffsetAllocation draws;
+        OffsetAllocation bounds;
+    };
+
+    // either one loaded asset or the scene composed from them. an asset only fills in its cpu side data and its geometry,
+    // the composed scene's draw list is what the passes draw
     struct SceneData
     {
+        // the geometry heap's buffers, shared by every loaded asset
         BufferHandle vertexBuffer;
         BufferHandle indexBuffer;
+        BufferHandle meshletBuffer;
+        BufferHandle meshletVerticesBuffer;
+        BufferHandle meshletTrianglesBuffer;
+        // ranges of the geometry heap's draw and bounds buffers, rebuilt with the draw list
         BufferHandle indirectBuffer;
         BufferHandle culledIndirectBuffer;
         BufferHandle meshDrawsBuffer;
         BufferHandle meshBoundsBuffer;
-        u64 vertexBufferId;
-        u64 indexBufferId;
-        u64 indirectBufferId;
-        u64 culledIndirectBufferId;
-        u64 meshDrawsBufferId;
-        u64 meshBoundsBufferId;
+        BufferHandle instanceBoundsBuffer;
+        BufferHandle visibleInstancesBuffer;
+        BufferHandle meshletTasksBuffer;
+        // compute meshlet culling output when mesh shaders aren't available
+        BufferHandle visibleMeshletsBuffer;
+        BufferHandle meshletIndexBuffer;
+        BufferHandle meshletDrawBuffer;
+        // ECullPhase flags per instance, kept across frames by occlusion culling
+        BufferHandle instanceVisibilityBuffer;
+        DrawListAllocation drawListAllocation;
 
+        // drawCount indirect draws, one per unique mesh primitive, expanded into instanceCount instances
         u32 drawCount{ 0 };
+        u32 instanceCount{ 0 };
+        // draws [0, shortIndexDrawCount) use 16 bit indices, the rest use 32 bit indices starting wideIndexOffset bytes in.
+        // while loading the offset is into the asset's own index block, once its geometry is uploaded it's into the index heap
+        u32 shortIndexDrawCount{ 0 };
+        u64 wideIndexOffset{ 0 };
+        // within either width draws are ordered by stream, then by material
+        DrawStream streams[DRAW_STREAM_COUNT];
+        // vertex offsets, first indices and first meshlets of the draws, instances and levels of detail already point into these ranges
+        GeometryAllocation geometryAllocation;
+        // opaque and masked instances split into tasks of up to MESHLET_TASK_SIZE meshlets, 0 when the scene has no meshlets
+        u32 meshletTaskCount{ 0 };
+        CulledDrawList culledDraws;
+        // dynamic shadow casters of each cascade, culled against the cascade's light frustum every frame.
+        // only the opaque and masked streams are filled in
+        CulledDrawList cascadeDraws[SHADOW_CASCADE_COUNT];
+        // static casters of each cascade, only culled on frames its bit in cascadeRebuildMask is set
+        CulledDrawList cascadeStaticDraws[SHADOW_CASCADE_COUNT];
+        // cascades whose cached static shadow map is redrawn this frame, set by the shadow pass before culling
+        u32 cascadeRebuildMask{ 0 };
+        u32 dynamicInstanceCount{ 0 };
+        // bumped whenever a static instance changes, cached static shadows are stale once it moves past them
+        u64 staticCasterVersion{ 0 };
+        // the scene's point lights, room for MAX_LIGHT_COUNT of which the first pointLightCount are live
+        BufferHandle pointLightBuffer;
+        u32 pointLightCount{ 0 };
+        // meshes and draws are per instance, bounds are per indirect draw and in mesh space
         std::vector<MeshData> meshes;
         std::vector<MeshBoundsData> meshBoundsData;
         std::vector<MeshDrawData> draws;
+        // the unculled commands, kept so the draw list can be rebuilt when assets come and go
+        std::vector<IndirectDraw> indirectDraws;
+        // per instance like draws, recomputed whenever a draw's transform changes
+        std::vector<InstanceBoundsData> instanceBounds;
+        // (glTF mesh << 32 | primitive) -> indirect draw, filled by the glTF loader for each asset
         std::unordered_map<u64, u32> meshLookup;
         std::vector<u32> images;
         std::vector<u64> imageIds;
         std::vector<u32> textures;
         std::vector<PBRMaterialData> materials;
         std::vector<glm::mat4> transforms;
+        std::vector<glm::mat4> localTransforms;
+        std::vector<u32> transformParents;
     };
 }
\ No newline at end of file
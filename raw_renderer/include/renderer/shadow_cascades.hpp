@@ -0,0 +1,28 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "renderer/renderer_data.hpp"
+
+namespace Raw::GFX
+{
+    // what the directional light's cascades are fitted to, the camera is read from the scene data's view and projection
+    struct CascadeFitDesc
+    {
+        f32 zNear{ 0.1f };
+        // shadows end here even when the camera sees further, so their cost follows the view distance
+        f32 shadowDistance{ 100.f };
+        // 0 splits the distance evenly, 1 logarithmically
+        f32 splitLambda{ 0.75f };
+        // world bounds of every caster, the light frustums reach back to them so casters outside a slice still cast
+        glm::vec3 sceneMin{ 0.f };
+        glm::vec3 sceneMax{ 0.f };
+    };
+
+    // planes of a projection whose depth range is 0 to 1, normalized so distances are in world units
+    Frustum MakeFrustum(const glm::mat4& viewProj);
+
+    // fills in the cascade projections, splits and frustums of sceneData from its camera and light direction.
+    // every cascade is a bounding sphere of its slice, so its size doesn't change as the camera turns, and its
+    // origin moves in whole shadow map texels, so edges don't shimmer as the camera moves
+    void FitShadowCascades(const CascadeFitDesc& desc, GlobalSceneData& sceneData);
+}
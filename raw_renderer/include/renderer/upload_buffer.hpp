@@ -0,0 +1,39 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "renderer/gfxdevice.hpp"
+#include "renderer/gpu_resources.hpp"
+
+namespace Raw::GFX
+{
+    class ICommandBuffer;
+
+    // host visible staging ring, one region per frame in flight so a region is only reused once its frame's fence has signaled
+    class UploadBuffer
+    {
+    public:
+        UploadBuffer() {}
+        ~UploadBuffer() {}
+
+        DISABLE_COPY(UploadBuffer);
+
+        void Init(IGFXDevice* device, u64 sizePerFrame);
+        void Shutdown(IGFXDevice* device);
+
+        // must be called after the device has waited on the frame's fence
+        void BeginFrame(u32 frameIndex);
+        // copies data into the current frame's region and records a copy into dst, returns false if the region is full
+        bool Stage(ICommandBuffer* cmd, const BufferHandle& dst, u64 dstOffset, const void* data, u64 size);
+
+        RAW_INLINE bool IsValid() const { return m_MappedData != nullptr; }
+        RAW_INLINE u64 GetBytesStaged() const { return m_Offset - m_RegionStart; }
+
+    private:
+        BufferHandle m_Buffer;
+        u8* m_MappedData{ nullptr };
+        u64 m_SizePerFrame{ 0 };
+        u64 m_RegionStart{ 0 };
+        u64 m_Offset{ 0 };
+
+    };
+}
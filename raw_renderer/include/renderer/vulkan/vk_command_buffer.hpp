@@ -21,6 +21,9 @@ namespace Raw::GFX
         virtual void Clear(const glm::vec4& rgba) override;
         virtual void ClearDepthStencil(const glm::vec2& ds) override;
         virtual void CopyImage(const TextureHandle& src, const TextureHandle& dst) override;
+        virtual void UpdateBuffer(const BufferHandle& buffer, u64 offset, u64 size, const void* data) override;
+        virtual void CopyBuffer(const BufferHandle& src, const BufferHandle& dst, u64 srcOffset, u64 dstOffset, u64 size) override;
+        virtual void FillBuffer(const BufferHandle& buffer, u64 offset, u64 size, u32 value) override;
         virtual void Dispatch(const ComputePipelineHandle& handle, u32 groupX, u32 groupY, u32 groupZ) override;
         virtual void TransitionImage(const TextureHandle& handle, ETextureLayout newLayout) override;
         virtual void AddMemoryBarrier(EAccessFlags srcAccess, EAccessFlags dstAccess, EPipelineStageFlags srcPipeline, EPipelineStageFlags dstPipeline) override;
@@ -32,18 +35,34 @@ namespace Raw::GFX
         virtual void Draw(u32 vertexCount, u32 instanceCount, u32 firstVertex, u32 firstInstance) override;
         virtual void DrawIndexed(u32 indexCount, u32 instanceCount, u32 firstIndex, i32 vertexOffset, u32 firstInstance) override;
         virtual void DrawIndexedIndirect(const BufferHandle& indirectBuffer, u64 offset, u32 drawCount) override;
+        virtual void DrawIndexedIndirectCount(const BufferHandle& indirectBuffer, u64 offset, const BufferHandle& countBuffer, u64 countOffset, u32 maxDrawCount) override;
+        virtual void DrawMeshTasks(u32 groupX, u32 groupY, u32 groupZ) override;
         virtual void BindVertexBuffer(const BufferHandle& vertexBuffer) override;
         virtual void BindDrawData(const BufferHandle& meshDrawBuffer) override;
-        virtual void BindIndexBuffer(const BufferHandle& indexBuffer) override;
+        virtual void BindInstanceData(const BufferHandle& visibleInstancesBuffer) override;
+        virtual void BindMeshBoundsData(const BufferHandle& meshBoundsBuffer) override;
+        virtual void BindShadowCascadeData(u32 cascadeIndex) override;
+        virtual void BindIndexBuffer(const BufferHandle& indexBuffer, u64 offset = 0, EIndexType type = EIndexType::UINT32) override;
         virtual void BindFullScreenData(const FullScreenData& data) override;
         virtual void BindAOData(const AOData& data) override;
-        virtual void BindCullData(const BufferHandle& indirectDrawData, const BufferHandle& meshBoundsData, const BufferHandle& culledIndirectDrawData, u32 drawCount) override;
+        virtual void BindCullData(const BufferHandle& indirectDrawData, const BufferHandle& meshBoundsData, const BufferHandle& instanceBoundsData, const BufferHandle& meshDrawData, const BufferHandle& culledIndirectDrawData, const BufferHandle& visibleInstancesData, u32 instanceCount, u32 cullView = CAMERA_CULL_VIEW, u32 instanceFilter = CULL_ALL_INSTANCES) override;
+        virtual void BindMeshletData(const BufferHandle& meshletData, const BufferHandle& meshletVertexData, const BufferHandle& meshletTriangleData, const BufferHandle& meshletTaskData, u32 taskCount, const BufferHandle& instanceVisibilityData, ECullPhase cullPhase = ALL_INSTANCES_PHASE) override;
+        virtual void BindMeshletCullData(const MeshletCullData& data) override;
+        virtual void BindDrawCompactionData(const DrawCompactionData& data) override;
+        virtual void BindDepthPyramidData(const DepthPyramidBuildData& data) override;
+        virtual void BindOcclusionCullData(const OcclusionCullData& data) override;
+        virtual void BindLightCullData(const LightClusterData& data) override;
+        virtual void BindLightClusterData(const LightClusterData& data) override;
 
         
         VkCommandBuffer vulkanCmdBuffer{ VK_NULL_HANDLE };
         VulkanPipeline* activeGraphicsPipeline{ nullptr };
         VulkanPipeline* activeComputePipeline{ nullptr };
         VkRenderingInfo curRenderingInfo{};
+
+    private:
+        // the light culling and lighting passes read the same block, each at their own layout, stages and offset
+        void PushLightClusterData(VkPipelineLayout layout, VkShaderStageFlags stages, u32 offset, const LightClusterData& data);
         
     }; 
 }
\ No newline at end of file
@@ -80,6 +80,10 @@ namespace Raw::GFX
         virtual void BeginFrame() override;
         virtual void EndFrame() override;
         virtual u32 GetMaximumPushConstantSize() override { return 128; }
+        virtual u32 GetCurrentFrameIndex() override { return m_CurFrame; }
+        virtual bool SupportsMeshShaders() override { return m_MeshShadersSupported; }
+        virtual bool SupportsDrawIndirectCount() override { return m_DrawIndirectCountSupported; }
+        virtual bool IsCPUDevice() override { return m_GPUProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU; }
 
         RAW_INLINE VkDevice GetDevice() { return m_LogicalDevice; }
         RAW_INLINE VmaAllocator GetAllocator() { return m_VmaAllocator; }
@@ -93,6 +97,9 @@ namespace Raw::GFX
         virtual void MapBuffer(const BufferHandle& handle, void* data, u64 dataSize) override;
         virtual void UnmapBuffer(const BufferHandle& handle, EBufferMapType type = EBufferMapType::BINDLESS) override;
         virtual void WriteBuffer(const BufferHandle& handle, EBufferMapType type = EBufferMapType::BINDLESS) override;
+        virtual void WriteBufferAllFrames(const BufferHandle& handle, EBufferMapType type = EBufferMapType::BINDLESS) override;
+        virtual void* GetMappedData(const BufferHandle& handle) override;
+        virtual void UploadBufferData(const BufferHandle& handle, u64 offset, const void* data, u64 size) override;
         virtual void MapTexture(const TextureHandle& handle, bool isBindless = true) override;
         virtual TextureHandle& GetDrawImageHandle() override;
         virtual TextureHandle& GetDepthBufferHandle() override;
@@ -102,8 +109,10 @@ namespace Raw::GFX
         // resource creation
         [[nodiscard]] virtual TextureHandle CreateTexture(const TextureDesc& desc, bool isDepth = false) override;
         [[nodiscard]] virtual TextureHandle CreateTexture(const TextureDesc& desc, void* initialData) override;
+        virtual void CreateTextures(const TextureDesc* descs, void* const* initialData, u32 count, TextureHandle* outHandles) override;
         [[nodiscard]] virtual BufferHandle CreateBuffer(const BufferDesc& desc) override;
         [[nodsicard]] virtual BufferHandle CreateBuffer(const BufferDesc& desc, void* initialData) override;
+        [[nodiscard]] virtual BufferHandle CreateBufferRange(const BufferHandle& buffer, u64 offset, u64 size) override;
         [[nodiscard]] virtual SamplerHandle CreateSampler(const SamplerDesc& desc) override;
         [[nodiscard]] virtual ComputePipelineHandle CreateComputePipeline(const ComputePipelineDesc& desc) override;
         [[nodiscard]] virtual GraphicsPipelineHandle CreateGraphicsPipeline(const GraphicsPipelineDesc& desc) override;
@@ -132,6 +141,8 @@ namespace Raw::GFX
         VulkanTexture* GetTexture(const TextureHandle& handle);
         VulkanBuffer* GetBuffer(const BufferHandle& handle);
         VkSampler* GetSampler(const SamplerHandle& handle);
+        // queues the descriptor write of a buffer into the given frame's set updates
+        void QueueBufferWrite(VulkanBuffer* buffer, EBufferMapType type, u32 frame);
         VulkanPipeline* GetComputePipeline(const ComputePipelineHandle& handle);
         VulkanPipeline* GetGraphicsPipeline(const GraphicsPipelineHandle& handle);
 
@@ -188,6 +199,9 @@ namespace Raw::GFX
         VmaAllocator m_VmaAllocator{ VK_NULL_HANDLE };
 
         bool m_DebugUtilsPresent{ false };
+        bool m_MeshShadersSupported{ false };
+        bool m_DrawIndirectCountSupported{ false };
+        PFN_vkCmdDrawMeshTasksEXT m_CmdDrawMeshTasks{ nullptr };
         bool m_WindowMinimized{ false };
         bool m_WindowResized{ false };
 
@@ -30,10 +30,14 @@ namespace Raw::GFX
         VmaAllocationInfo allocInfo{};
         VkDeviceAddress bufferAddress{};
         VkBufferUsageFlags usageFlags{};
+        // set when the buffer is a range of another one, commands then address buffer starting offset bytes in.
+        // ranges alias their parent's memory and have no allocation of their own
+        VkDeviceSize offset{ 0 };
+        VkDeviceSize range{ VK_WHOLE_SIZE };
 
         void Destroy()
         {
-            vmaDestroyBuffer(VulkanGFXDevice::Get()->GetAllocator(), buffer, allocation);
+            if(allocation != VK_NULL_HANDLE) vmaDestroyBuffer(VulkanGFXDevice::Get()->GetAllocator(), buffer, allocation);
             allocInfo = {};
         }
     };
@@ -48,6 +52,10 @@ namespace Raw::GFX
         u32 numImageAttachments{ 0 };
         TextureHandle* depthAttachment{ nullptr };
         cstring pipelineName{ nullptr };
+        // push constants have to be written for every stage the range was declared with
+        VkShaderStageFlags pushConstantStages{ 0 };
+        // sets bound from set 0 on, the scene data alone or every global set
+        u32 numDescriptorSets{ 0 };
 
         void Destroy()
         {
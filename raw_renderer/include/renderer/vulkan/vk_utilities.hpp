@@ -8,11 +8,14 @@ namespace Raw::GFX::vkUtils
 {
 	void TransitionImage(VkCommandBuffer cmd, VkImage image, VkImageLayout curLayout, VkImageLayout newLayout, bool isDepth, u32 mipLevel = 1, u32 srcQueue = 0, u32 dstQueue = 0);
 	void CopyImageToImage(VkCommandBuffer cmd, VkImage src, VkImage dst, VkExtent2D srcSize, VkExtent2D dstSize);
+	// texel for texel between images of the same size and format, unlike a blit it works for depth
+	void CopyImageExact(VkCommandBuffer cmd, VkImage src, VkImage dst, VkExtent2D size, VkImageAspectFlags aspect);
 	void GenerateMipMaps(VkCommandBuffer cmd, VkImage image, VkExtent2D imageSize);
 	void AddMemoryBarrier(VkCommandBuffer cmd, VkAccessFlagBits src, VkAccessFlagBits dst, VkPipelineStageFlags srcP, VkPipelineStageFlags dstP);
 
 	VkAccessFlagBits ToVkAccessFlags(EAccessFlags flag);
-	VkPipelineStageFlags ToVkPipelineStageFlags(EPipelineStageFlags flag);
+	VkPipelineStageFlags ToVkPipelineStage(EPipelineStageFlags flag);
+	VkPipelineStageFlags ToVkPipelineStageFlags(EPipelineStageFlags flags);
 
 	VkImageType ToVkImageType(ETextureType type);
 	VkImageViewType ToVkImageViewType(ETextureType type);
@@ -31,7 +34,10 @@ namespace Raw::GFX::vkUtils
 	VkCullModeFlagBits ToVkCullMode(ECullMode mode);
 	VkDescriptorType ToVkDescriptorType(EDescriptorType type);
 	VkShaderStageFlagBits ToVkShaderStage(EShaderStage stage);
+	// every EShaderStage bit set in stages
+	VkShaderStageFlags ToVkShaderStageFlags(u8 stages);
 	VkPolygonMode ToVkPolygonMode(EFillMode fillMode);
 	VkImageLayout ToVkImageLayout(ETextureLayout layout);
 	VkAttachmentLoadOp ToVkRenderingOp(ERenderingOp op);
+	VkIndexType ToVkIndexType(EIndexType type);
 }
\ No newline at end of file
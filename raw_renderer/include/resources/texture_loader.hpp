@@ -34,6 +34,8 @@ namespace Raw
         virtual void Remove(u64 hashedName) override;
         virtual Resource* CreateFromFile(cstring name, cstring filename) override;
         Resource* CreateFromData(cstring name, const GFX::TextureDesc& desc, void* data);
+        // uploads every texture not already loaded in a single submission, outResources[i] matches names[i]
+        void CreateFromDataBatch(const cstring* names, const GFX::TextureDesc* descs, void* const* data, u32 count, Resource** outResources);
         Resource* CreateFromHandle(cstring name, const GFX::TextureHandle& texture);
         
     private:
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "utility/image.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Raw
+{
+    // an image whose decode is deferred, either a file on disk or encoded bytes owned by the streamer
+    struct StreamedImageSource
+    {
+        std::string name;
+        std::string path;
+        std::vector<u8> encoded;
+    };
+
+    // decodes a scene's images on background jobs and uploads the finished ones a few at a time,
+    // so the scene can be drawn with placeholder textures while its images arrive
+    class TextureStreamer
+    {
+    public:
+        TextureStreamer() {}
+        ~TextureStreamer() { Cancel(); }
+
+        DISABLE_COPY(TextureStreamer);
+
+        // stands in for the bindless index of an image that hasn't been uploaded yet
+        static constexpr u32 k_PendingImage = U32_MAX;
+
+        // drops anything still streaming, every entry of images is set to k_PendingImage until its image arrives
+        void Begin(std::vector<StreamedImageSource>&& sources, std::vector<u32>& images);
+        // starts more decodes and uploads decoded images until uploadBudget bytes of texels were uploaded, at least one image per call.
+        // images and imageIds are patched like UploadImages does, outUpdated receives the index of every image that changed
+        void Update(u64 uploadBudget, std::vector<u32>& images, std::vector<u64>& imageIds, std::vector<u32>& outUpdated);
+        // waits for the decodes in flight and throws away everything that wasn't uploaded
+        void Cancel();
+
+        RAW_INLINE bool IsDone() const { return m_Remaining == 0; }
+        RAW_INLINE u32 GetRemainingCount() const { return m_Remaining; }
+
+    private:
+        struct StreamedImage
+        {
+            StreamedImageSource source;
+            Utils::DecodedImage decoded;
+            std::atomic<u8> state{ 0 };
+        };
+
+        std::vector<StreamedImage> m_Images;
+        // images are decoded in order, everything before m_FirstPending has been uploaded
+        u32 m_NextDecode{ 0 };
+        u32 m_FirstPending{ 0 };
+        u32 m_Remaining{ 0 };
+        std::atomic<u32> m_InFlight{ 0 };
+        std::atomic<bool> m_Cancelled{ false };
+        i64 m_StartTime{ 0 };
+
+    };
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "renderer/renderer_data.hpp"
+#include "ecs/change_tracker.hpp"
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Raw
+{
+    constexpr u32 BVH_WIDTH = 4;
+    constexpr u32 INVALID_BVH_NODE = U32_MAX;
+
+    struct AABB
+    {
+        glm::vec3 min{ std::numeric_limits<f32>::max() };
+        glm::vec3 max{ std::numeric_limits<f32>::lowest() };
+
+        RAW_INLINE void Grow(const AABB& other) { min = glm::min(min, other.min); max = glm::max(max, other.max); }
+        RAW_INLINE void Grow(const glm::vec3& point) { min = glm::min(min, point); max = glm::max(max, point); }
+        RAW_INLINE bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+        RAW_INLINE glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+        RAW_INLINE f32 GetHalfArea() const
+        {
+            if(!IsValid()) return 0.f;
+            const glm::vec3 extent = max - min;
+            return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+        }
+    };
+
+    struct BVHRayHit
+    {
+        u32 instance{ U32_MAX };
+        f32 distance{ std::numeric_limits<f32>::max() };
+    };
+
+    // four children per node with their bounds stored component by component, so a query tests all of them at once.
+    // a slot with a count is a leaf over m_Primitives[child, child + count), an empty slot has inverted bounds that nothing hits
+    struct alignas(16) BVHNode
+    {
+        f32 minX[BVH_WIDTH];
+        f32 minY[BVH_WIDTH];
+        f32 minZ[BVH_WIDTH];
+        f32 maxX[BVH_WIDTH];
+        f32 maxY[BVH_WIDTH];
+        f32 maxZ[BVH_WIDTH];
+        u32 children[BVH_WIDTH];
+        u32 counts[BVH_WIDTH];
+    };
+
+    // bounding volume hierarchy over the world space bounds of every draw instance, built with a binned SAH.
+    // moving instances are handled by refitting, the topology is only rebuilt by Build
+    class BVH
+    {
+    public:
+        BVH() {}
+        ~BVH() {}
+
+        DISABLE_COPY(BVH);
+
+        // both read sceneData.instanceBounds, which has to be up to date with the draws
+        void Build(const GFX::SceneData& sceneData);
+        // takes the new bounds of the instances in changedDraws and refits every node to them
+        void Refit(const GFX::SceneData& sceneData, const std::vector<ChangeRange>& changedDraws);
+        void Clear();
+
+        // instances whose bounds are at least partially inside the frustum, appended to outInstances
+        void QueryFrustum(const GFX::Frustum& frustum, std::vector<u32>& outInstances) const;
+        // instances whose bounds overlap bounds, appended to outInstances
+        void QueryOverlap(const AABB& bounds, std::vector<u32>& outInstances) const;
+        // closest instance whose bounds the ray enters before maxDistance, dir doesn't have to be normalized
+        bool Raycast(const glm::vec3& origin, const glm::vec3& dir, BVHRayHit& outHit, f32 maxDistance = std::numeric_limits<f32>::max()) const;
+        // bounds of every instance, invalid when the hierarchy is empty
+        AABB GetBounds() const;
+
+        RAW_INLINE bool IsEmpty() const { return m_Nodes.empty(); }
+        RAW_INLINE u32 GetNodeCount() const { return (u32)m_Nodes.size(); }
+        RAW_INLINE const AABB& GetInstanceBounds(u32 instance) const { return m_InstanceBounds[instance]; }
+
+    private:
+        // splits m_Primitives[first, first + count) into up to four children, returns the new node's index
+        u32 BuildNode(u32 first, u32 count);
+        // partitions the range at the cheapest binned SAH split, returns the first primitive of the right side
+        u32 SplitRange(u32 first, u32 count);
+        f32 GetRangeHalfArea(u32 first, u32 count) const;
+        void RefitNodes();
+
+    private:
+        std::vector<BVHNode> m_Nodes;
+        // instance indices, reordered so every leaf covers a contiguous range
+        std::vector<u32> m_Primitives;
+        std::vector<AABB> m_InstanceBounds;
+        std::vector<glm::vec3> m_Centers;
+
+    };
+}
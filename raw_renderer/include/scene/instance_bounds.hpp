@@ -0,0 +1,23 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "renderer/renderer_data.hpp"
+
+namespace Raw
+{
+    namespace BoundsKernels
+    {
+        // world space bounds of draws [first, first + count), their draw's mesh space bounds moved by the instance transform.
+        // the box is kept as center and extents, the extents go through the absolute of the transform (Arvo)
+        void TransformBoundsScalar(const GFX::MeshDrawData* draws, const GFX::MeshBoundsData* meshBounds, u32 first, u32 count, GFX::InstanceBoundsData* outBounds);
+        void TransformBoundsAVX2(const GFX::MeshDrawData* draws, const GFX::MeshBoundsData* meshBounds, u32 first, u32 count, GFX::InstanceBoundsData* outBounds);
+        // picks the widest kernel supported by the running cpu
+        void TransformBounds(const GFX::MeshDrawData* draws, const GFX::MeshBoundsData* meshBounds, u32 first, u32 count, GFX::InstanceBoundsData* outBounds);
+    }
+
+    // recomputes sceneData.instanceBounds[first, first + count) from the current draw transforms
+    RAW_INLINE void UpdateInstanceBounds(GFX::SceneData& sceneData, u32 first, u32 count)
+    {
+        BoundsKernels::TransformBounds(sceneData.draws.data(), sceneData.meshBoundsData.data(), first, count, sceneData.instanceBounds.data());
+    }
+}
@@ -3,13 +3,23 @@
 #include "core/defines.hpp"
 #include "renderer/renderer_data.hpp"
 #include "renderer/gfxdevice.hpp"
+#include "renderer/upload_buffer.hpp"
+#include "resources/texture_streamer.hpp"
 #include "scene/scene_graph.hpp"
+#include "scene/bvh.hpp"
+#include "ecs/change_tracker.hpp"
 #include "memory/smart_pointers.hpp"
 #include "containers/vector.hpp"
 #include <string>
+#include <vector>
 
 namespace Raw
 {
+    namespace GFX
+    {
+        class ICommandBuffer;
+    }
+
     class Scene
     {
     public:
@@ -18,19 +28,95 @@ namespace Raw
         Scene() {}
         ~Scene() {}
 
-        void Init(std::string& filePath, GFX::IGFXDevice* device);
+        // a streamed load returns as soon as the geometry is on the gpu, images are decoded in the background
+        // and patched into the materials by Update a few at a time. false when the asset couldn't be loaded, the scene is empty then
+        bool Init(std::string& filePath, GFX::IGFXDevice* device, bool streamTextures = false);
         void Shutdown();
+        // loads a glTF next to what the scene already holds, its draws are merged into the scene's draw list so every asset
+        // is culled and drawn by the same indirect draws. only one asset streams its textures at a time, one added while
+        // another is streaming loads its textures up front. called between frames, returns the id RemoveAsset takes
+        // or U32_MAX when the asset couldn't be loaded or doesn't fit in the geometry heap
+        u32 AddAsset(const std::string& filePath, bool streamTextures = false);
+        // frames in flight keep drawing the old draw list, the asset's geometry is freed once they're done with it
+        bool RemoveAsset(u32 assetId);
         void Update(GFX::IGFXDevice* device);
+        // records copies of everything modified since the last upload, must be called after the device began the frame
+        void UploadDirtyData(GFX::IGFXDevice* device, GFX::ICommandBuffer* cmd);
+
+        void SetLocalTransform(u32 node, const glm::mat4& transform) { m_SceneGraph.SetLocalTransform(node, transform); }
+        void MarkMaterialChanged(u32 materialIndex) { if(materialIndex < m_MaterialChanges.GetCount()) m_MaterialChanges.MarkChanged(materialIndex, m_FrameIndex); }
+        void MarkDrawChanged(u32 drawIndex) { if(drawIndex < m_DrawChanges.GetCount()) m_DrawChanges.MarkChanged(drawIndex, m_FrameIndex); }
+        void MarkLightChanged(u32 lightIndex) { if(lightIndex < m_LightChanges.GetCount()) m_LightChanges.MarkChanged(lightIndex, m_FrameIndex); }
+        // uploaded with the next dirty data, returns U32_MAX once the scene holds MAX_LIGHT_COUNT lights
+        u32 AddPointLight(const GFX::PointLight& light);
+        // dynamic instances cast shadows every frame instead of from the cached static maps. draws start out static
+        // and become dynamic when they first move, this declares movers up front or returns a draw to the cache
+        void SetDrawDynamic(u32 drawIndex, bool dynamic);
+        SceneGraph& GetSceneGraph() { return m_SceneGraph; }
+        // world space bounds of every instance, refit with the draws that changed as they're uploaded
+        const BVH& GetBVH() const { return m_BVH; }
 
         GFX::SceneData* GetSceneData() const { return m_SceneData.get(); }
         GFX::PointLight* GetPointLights() const { return m_PointLights.data(); }
+        u32 GetPointLightCount() const { return m_PointLights.size(); }
         GFX::BufferHandle GetSceneMaterials() const { return m_MaterialDataBuffer; }
 
     private:
-        std::string m_Filepath{ "" };
+        // where an asset landed in the composed scene, its transforms, materials, textures and images are consecutive
+        struct AssetPlacement
+        {
+            u32 firstTransform{ 0 };
+            u32 firstMaterial{ 0 };
+            u32 firstTexture{ 0 };
+            u32 firstImage{ 0 };
+            // composed instance of each of the asset's instances
+            std::vector<u32> instances;
+        };
+
+        // one loaded glTF, draws and bounds already point into its geometry heap ranges
+        struct SceneAsset
+        {
+            u32 id{ 0 };
+            std::string filePath;
+            rstd::unique_ptr<GFX::SceneData> data{ nullptr };
+            AssetPlacement placement;
+        };
+
+        // rebuilds the draw list from every asset, the current one is kept when the new one doesn't fit in the geometry heap
+        bool Compose();
+        // copies moved nodes and instances and edited materials back into the assets, so they survive the next Compose
+        void GatherAssetState();
+        void ReleaseAsset(SceneAsset& asset);
+        // stages every range in m_ChangeRanges, element i of src is copied to dst at i * stride.
+        // the copies wait for readStages of frames still in flight to finish reading dst
+        void StageRanges(GFX::ICommandBuffer* cmd, const GFX::BufferHandle& dst, const u8* src, u64 stride, GFX::EPipelineStageFlags readStages);
+        void MarkMaterialsUsingImages(const std::vector<u32>& images);
+
+    private:
+        std::vector<SceneAsset> m_Assets;
+        u32 m_NextAssetId{ 0 };
+        u32 m_StreamingAsset{ U32_MAX };
+        // the draw list every pass draws, composed from m_Assets
         rstd::unique_ptr<GFX::SceneData> m_SceneData{ nullptr };
         GFX::BufferHandle m_MaterialDataBuffer;
         rstd::vector<GFX::PointLight> m_PointLights;
         GFX::BufferHandle m_PointLightBuffer;
+        SceneGraph m_SceneGraph;
+        BVH m_BVH;
+
+        GFX::UploadBuffer m_UploadBuffer;
+        ChangeTracker m_DrawChanges;
+        ChangeTracker m_MaterialChanges;
+        ChangeTracker m_LightChanges;
+        std::vector<ChangeRange> m_ChangeRanges;
+        std::vector<GFX::PBRMaterialData> m_ResolvedMaterials;
+        TextureStreamer m_TextureStreamer;
+        std::vector<u32> m_StreamedImages;
+        std::vector<bool> m_ImageFlags;
+        GFX::TextureHandle m_ErrorTexture;
+        GFX::TextureHandle m_DefaultTexture;
+        GFX::TextureHandle m_DefaultEmissive;
+        u64 m_FrameIndex{ 1 };
+        u64 m_LastUploadFrame{ 0 };
     };
 }
\ No newline at end of file
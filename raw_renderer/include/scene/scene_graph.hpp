@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include "renderer/renderer_data.hpp"
+#include "ecs/change_tracker.hpp"
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Raw
+{
+    constexpr u32 INVALID_NODE = U32_MAX;
+
+    // flattened transform hierarchy, nodes are stored level by level so every parent
+    // is located before its children and all nodes of a level can be updated together
+    class SceneGraph
+    {
+    public:
+        SceneGraph() {}
+        ~SceneGraph() {}
+
+        DISABLE_COPY(SceneGraph);
+
+        void Build(const GFX::SceneData& sceneData);
+        void Clear();
+
+        // propagates dirty flags down the hierarchy, recomputes world matrices of dirty nodes
+        // and writes them into the draws referencing them, modified draws are stamped with frame.
+        // static draws that move are made dynamic
+        void Update(GFX::SceneData& sceneData, ChangeTracker& drawChanges, u64 frame);
+
+        void SetLocalTransform(u32 node, const glm::mat4& local);
+
+        RAW_INLINE u32 GetNodeCount() const { return (u32)m_Parents.size(); }
+        RAW_INLINE u32 GetNode(u32 transformIndex) const { return m_TransformToNode[transformIndex]; }
+        RAW_INLINE u32 GetParent(u32 node) const { return m_Parents[node]; }
+        RAW_INLINE const glm::mat4& GetLocalTransform(u32 node) const { return m_LocalTransforms[node]; }
+        RAW_INLINE const glm::mat4& GetWorldTransform(u32 node) const { return m_WorldTransforms[node]; }
+
+    private:
+        std::vector<glm::mat4> m_LocalTransforms;
+        std::vector<glm::mat4> m_WorldTransforms;
+        std::vector<u32> m_Parents;
+        std::vector<u32> m_NodeToTransform;
+        std::vector<u32> m_TransformToNode;
+        std::vector<u8> m_Dirty;
+        // first node of each depth level, last entry is the node count
+        std::vector<u32> m_LevelOffsets;
+        // draws are grouped by node, m_NodeDraws[m_NodeDrawOffsets[n]..m_NodeDrawOffsets[n+1]] belong to node n
+        std::vector<u32> m_NodeDrawOffsets;
+        std::vector<u32> m_NodeDraws;
+
+        std::vector<u32> m_DirtyNodes;
+        bool m_AnyDirty{ false };
+    };
+}
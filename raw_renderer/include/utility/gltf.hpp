@@ -3,7 +3,45 @@
 #include "renderer/renderer_data.hpp"
 #include <string>
 
+namespace Raw
+{
+   class TextureStreamer;
+}
+
 namespace Raw::Utils
 {
-   void LoadGLTF(std::string filepath, GFX::SceneData& outSceneData);
+   // cpu side geometry that SceneData doesn't keep once it's on the gpu
+   struct SceneGeometry
+   {
+      const GFX::SceneVertex* vertices{ nullptr };
+      u64 vertexCount{ 0 };
+      // mixed 16 and 32 bit indices
+      const u8* indices{ nullptr };
+      u64 indexSize{ 0 };
+      // 32 bit indices start this many bytes into indices
+      u64 wideIndexOffset{ 0 };
+      const GFX::IndirectDraw* indirectDraws{ nullptr };
+      u64 indirectDrawCount{ 0 };
+      // see MeshletData, vertices are scene wide vertex indices and triangles three packed u8 meshlet local indices
+      const GFX::MeshletData* meshlets{ nullptr };
+      u64 meshletCount{ 0 };
+      const u32* meshletVertices{ nullptr };
+      u64 meshletVertexCount{ 0 };
+      const u32* meshletTriangles{ nullptr };
+      u64 meshletTriangleCount{ 0 };
+   };
+
+   // uploads an asset's vertices, indices and meshlets into the geometry heap and moves its draws, instances and levels
+   // of detail onto the ranges it got, outScene must already hold its draws and bounds. false when the heap is full
+   bool UploadSceneGeometry(const std::string& name, const SceneGeometry& geometry, GFX::SceneData& outScene);
+   // allocates the indirect, draw, bounds, culling and meshlet task buffers of a draw list from the geometry heap's draw
+   // and bounds heaps and fills them, outScene must hold its indirect draws, instances and bounds. false when the heap is full
+   bool CreateSceneBuffers(GFX::SceneData& outScene);
+   // frees what CreateSceneBuffers allocated once no frame in flight reads it anymore
+   void DestroySceneBuffers(GFX::SceneData& scene);
+   bool IsBinaryGLTF(const std::string& filepath);
+   // .glb files are memory mapped and their accessors read in place, .gltf goes through tinygltf's file loading.
+   // with a streamer the images are handed to it instead of being decoded and uploaded before returning.
+   // false when the file can't be parsed or its geometry doesn't fit in the geometry heap
+   bool LoadGLTF(std::string filepath, GFX::SceneData& outSceneData, TextureStreamer* streamer = nullptr);
 }
\ No newline at end of file
@@ -9,4 +9,9 @@ namespace Raw::Utils
     {
         return wyhash(value, strlen(value), seed, _wyp);
     }
+
+    RAW_INLINE u64 HashBytes(const void* data, u64 size, u64 seed = 0)
+    {
+        return wyhash(data, size, seed, _wyp);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include <string>
+#include <vector>
+
+namespace Raw::Utils
+{
+    struct DecodedImage
+    {
+        u8* pixels{ nullptr };
+        u32 width{ 0 };
+        u32 height{ 0 };
+        bool fromStb{ false };
+    };
+
+    // tightly packed rgb8 to rgba8 with opaque alpha, rgb and rgba must not overlap
+    void ExpandRGBToRGBA(const u8* rgb, u8* rgba, u64 pixelCount);
+
+    // decodes a png/jpg/... into rgba8, safe to call from job system workers
+    bool DecodeImage(const u8* encoded, u64 size, cstring name, DecodedImage& outImage);
+    void FreeDecodedImage(DecodedImage& image);
+
+    // uploads decoded images in batches, images[i] receives the bindless index of decodedImages[i] or the
+    // error texture if it failed to decode, decoded pixels are freed afterwards
+    void UploadImages(const std::vector<std::string>& names, std::vector<DecodedImage>& decodedImages, std::vector<u32>& images, std::vector<u64>& imageIds);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/defines.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Raw::Utils
+{
+    constexpr u32 VERTEX_CACHE_SIZE = 16;
+
+    struct VertexCacheStats
+    {
+        // average cache miss ratio, transformed vertices per triangle
+        f32 acmr{ 0.0f };
+        // average transform to vertex ratio, 1.0 means every vertex is transformed exactly once
+        f32 atvr{ 0.0f };
+    };
+
+    struct Meshlet
+    {
+        u32 vertexOffset{ 0 };
+        u32 triangleOffset{ 0 };
+        u32 vertexCount{ 0 };
+        u32 triangleCount{ 0 };
+    };
+
+    struct MeshletBounds
+    {
+        glm::vec3 center{ 0.0f };
+        f32 radius{ 0.0f };
+        // a viewer inside the cone sees every triangle from behind, a cutoff above 1 means no such cone exists
+        glm::vec3 coneApex{ 0.0f };
+        glm::vec3 coneAxis{ 0.0f };
+        f32 coneCutoff{ 2.0f };
+    };
+
+    // simulates a FIFO post transform cache over a triangle list
+    VertexCacheStats AnalyzeVertexCache(const u32* indices, u64 indexCount, u32 vertexCount, u32 cacheSize = VERTEX_CACHE_SIZE);
+
+    // reorders triangles for the post transform cache with Tipsify (Sander et al. 2007),
+    // if positions are given the fans Tipsify emits between dead ends are sorted so outward facing clusters are drawn first
+    void OptimizeVertexCache(u32* indices, u64 indexCount, u32 vertexCount, const glm::vec3* positions = nullptr, u32 cacheSize = VERTEX_CACHE_SIZE);
+
+    // renumbers vertices in order of first use so vertex fetch walks memory linearly,
+    // outRemap[old] holds the new location of every vertex, unreferenced vertices are moved to the end
+    void OptimizeVertexFetch(u32* indices, u64 indexCount, u32 vertexCount, u32* outRemap);
+
+    // splits a triangle list into meshlets in index order, so it should run after OptimizeVertexCache,
+    // outVertices receives each meshlet's vertex indices and outTriangles three u8 meshlet local indices per triangle packed in a u32
+    void BuildMeshlets(const u32* indices, u64 indexCount, u32 vertexCount, u32 maxVertices, u32 maxTriangles, 
+        std::vector<Meshlet>& outMeshlets, std::vector<u32>& outVertices, std::vector<u32>& outTriangles);
+
+    MeshletBounds ComputeMeshletBounds(const Meshlet& meshlet, const u32* meshletVertices, const u32* meshletTriangles, const glm::vec3* positions);
+
+    // quadric error edge collapse (Garland and Heckbert 1997) onto existing vertices, so the result indexes the same vertex buffer.
+    // stops at targetIndexCount or once the next collapse would move the surface further than maxError,
+    // open edges and attribute seams are kept in place. returns the new index count and the largest error introduced
+    u64 SimplifyMesh(const u32* indices, u64 indexCount, u32 vertexCount, const glm::vec3* positions, u64 targetIndexCount, f32 maxError, 
+        u32* outIndices, f32& outError);
+}
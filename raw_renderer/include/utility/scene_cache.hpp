@@ -0,0 +1,42 @@
+#pragma once
+
+#include "renderer/renderer_data.hpp"
+#include "utility/gltf.hpp"
+#include <string>
+#include <vector>
+
+namespace Raw::Utils
+{
+    // image referenced by a baked scene, either a file on disk or encoded bytes stored inside the cache
+    struct SceneCacheImage
+    {
+        std::string name;
+        std::string path;
+        const u8* encoded{ nullptr };
+        u64 encodedSize{ 0 };
+    };
+
+    // <source>.rawscene, written next to the source model
+    std::string GetSceneCachePath(const std::string& sourcePath);
+
+    enum class ESceneCacheResult
+    {
+        // no cache, or one built from other contents of the source or its dependencies
+        MISS,
+        LOADED,
+        // the cache was read but its geometry doesn't fit in the geometry heap
+        FAILED
+    };
+
+    // loads the baked scene if it exists and was built from the current contents of the source and its dependencies,
+    // blobs are uploaded straight from the file mapping. with a streamer the images are left to it, see LoadGLTF
+    ESceneCacheResult LoadSceneCache(const std::string& sourcePath, GFX::SceneData& outScene, TextureStreamer* streamer = nullptr);
+
+    // dependencies are additional files (external glTF buffers) whose contents invalidate the cache
+    bool WriteSceneCache(
+        const std::string& sourcePath, 
+        const std::vector<std::string>& dependencies, 
+        const GFX::SceneData& scene, 
+        const SceneGeometry& geometry, 
+        const std::vector<SceneCacheImage>& images);
+}
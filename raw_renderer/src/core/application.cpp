@@ -10,6 +10,7 @@
 #include "resources/resource_manager.hpp"
 #include "resources/texture_loader.hpp"
 #include "resources/buffer_loader.hpp"
+#include "renderer/geometry_heap.hpp"
 #include "scene/scene.hpp"
 #include "renderer/renderer.hpp"
 #include "core/keycodes.hpp"
@@ -83,6 +84,8 @@ namespace Raw
         activeRenderPath->Init();
         
         GFX::IGFXDevice* device = (GFX::IGFXDevice*)ServiceLocator::Get()->GetService(GFX::IGFXDevice::k_ServiceName);
+        GFX::GeometryHeap::Instance()->Init(device);
+
         void* sceneData = RAW_ALLOCATE(sizeof(Scene), alignof(Scene));
         activeScene = new (sceneData) Scene();
 
@@ -95,7 +98,16 @@ namespace Raw
         if(it == jsonData.end()) RAW_ASSERT_MSG(false, "Failed to parse model.json!");
         std::string modelRelPath = jsonData.value("file", "");
         std::string sceneModel = RAW_RESOURCES_DIR + modelRelPath.c_str();
-        activeScene->Init(sceneModel, device);
+        // "streaming" draws the scene as soon as its geometry is loaded and lets the textures arrive afterwards
+        const bool streamTextures = jsonData.value("streaming", false);
+        if(!activeScene->Init(sceneModel, device, streamTextures)) RAW_ERROR("Failed to load '%s', the scene is empty!", sceneModel.c_str());
+
+        // "assets" are loaded next to "file" and drawn with it, their textures are loaded up front
+        for(const std::string& assetRelPath : jsonData.value("assets", std::vector<std::string>()))
+        {
+            std::string assetModel = RAW_RESOURCES_DIR + assetRelPath.c_str();
+            activeScene->AddAsset(assetModel);
+        }
 
         glm::vec3 pos(0.0f, 0.0f, 0.f);
         glm::vec3 target(0.0f,0.0f, -1.f);
@@ -140,6 +152,7 @@ namespace Raw
     {
         activeRenderPath->Shutdown();
         activeScene->Shutdown();
+        GFX::GeometryHeap::Instance()->Shutdown((GFX::IGFXDevice*)ServiceLocator::Get()->GetService(GFX::IGFXDevice::k_ServiceName));
 
         RAW_DEALLOCATE(activeRenderPath);
         RAW_DEALLOCATE(activeScene);
@@ -9,8 +9,15 @@
 
 namespace Raw::JobSystem
 {
+    struct Job
+    {
+        std::function<void()> task;
+        // untracked jobs don't advance finishedLabel, curLabel never counted them
+        bool tracked{ true };
+    };
+
     u32 numThreads = 0;
-    ThreadSafeRingBuffer<std::function<void()>, 256> jobPool;
+    ThreadSafeRingBuffer<Job, 256> jobPool;
     std::condition_variable wakeCondition;
     std::mutex wakeMutex;
     u64 curLabel = 0; // tarackes the state of execution of the main thread
@@ -28,15 +35,15 @@ namespace Raw::JobSystem
         {
             std::thread worker([]
                 {
-                    std::function<void()> job; // the current job for the thread, starts out empty
+                    Job job; // the current job for the thread, starts out empty
 
                     // this is the infinite loop that a worker thread will execute
                     while(true)
                     {
                         if(jobPool.Pop(job)) // try to grab a job from the job pool
                         {
-                            job(); // execute job
-                            finishedLabel.fetch_add(1); // update worker label state
+                            job.task(); // execute job
+                            if(job.tracked) finishedLabel.fetch_add(1); // update worker label state
                         }
                         else
                         {
@@ -66,11 +73,19 @@ namespace Raw::JobSystem
         curLabel += 1;
 
         // type to push the new job util it is pushed successfully
-        while(!jobPool.Push(job)) { Poll(); }
+        while(!jobPool.Push({ job, true })) { Poll(); }
 
         wakeCondition.notify_one(); // wake one thread
     }
 
+    void ExecuteBackground(const std::function<void()>& job)
+    {
+        // the main thread label is left alone so Wait doesn't include this job
+        while(!jobPool.Push({ job, false })) { Poll(); }
+
+        wakeCondition.notify_one();
+    }
+
     bool IsBusy()
     {
         // whenever the main thread label is not reached by the workers, it indicates that some worker is still alive
@@ -113,7 +128,7 @@ namespace Raw::JobSystem
             };
 
             // try to push a new job until it is pushed successfully
-            while(!jobPool.Push(jobGroup)) { Poll(); }
+            while(!jobPool.Push({ jobGroup, true })) { Poll(); }
 
             wakeCondition.notify_one();
         }
@@ -0,0 +1,43 @@
+#include "core/simd.hpp"
+
+#if defined(RAW_ARCH_X86) && defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace Raw::SIMD
+{
+    namespace
+    {
+        bool QueryAVX2()
+        {
+#if defined(RAW_ARCH_X86)
+    #if defined(_MSC_VER)
+            i32 info[4];
+            __cpuid(info, 0);
+            if(info[0] < 7) return false;
+
+            // OS has to save the ymm registers on context switches
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            if(!osxsave || !avx) return false;
+            if((_xgetbv(0) & 0x6) != 0x6) return false;
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+    #else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+    #endif
+#else
+            return false;
+#endif
+        }
+    }
+
+    bool SupportsAVX2()
+    {
+        static const bool s_SupportsAVX2 = QueryAVX2();
+        return s_SupportsAVX2;
+    }
+}
@@ -0,0 +1,101 @@
+#include "ecs/entity_manager.hpp"
+#include "ecs/component_manager.hpp"
+#include "core/asserts.hpp"
+
+namespace Raw
+{
+    void EntityManager::Init()
+    {
+        m_Generations.reserve(1024);
+        m_FreeIndices.reserve(1024);
+        m_PendingDestroy.reserve(256);
+        m_AliveCount = 0;
+    }
+
+    void EntityManager::Shutdown()
+    {
+        m_Generations.clear();
+        m_FreeIndices.clear();
+        m_PendingDestroy.clear();
+        m_ComponentManagers.clear();
+        m_AliveCount = 0;
+    }
+
+    Entity EntityManager::Create()
+    {
+        u32 index;
+        if(!m_FreeIndices.empty())
+        {
+            index = m_FreeIndices.back();
+            m_FreeIndices.pop_back();
+        }
+        else
+        {
+            RAW_ASSERT_MSG(m_Generations.size() < (MAX_ENTITIES), "Exceeded max entity count of %u!", MAX_ENTITIES);
+            index = (u32)m_Generations.size();
+            // generations start at 1 so no live entity can equal INVALID_ENTITY_ID
+            m_Generations.push_back(1);
+        }
+
+        m_AliveCount++;
+        return MakeEntity(index, m_Generations[index]);
+    }
+
+    void EntityManager::Destroy(Entity e)
+    {
+        if(!IsAlive(e))
+        {
+            RAW_WARN("Attempted to destroy stale entity %u (index %u, generation %u)", e, GetEntityIndex(e), GetEntityGeneration(e));
+            return;
+        }
+
+        // invalidate the handle right away, the slot is only recycled once components are gone
+        const u32 index = GetEntityIndex(e);
+        u16 generation = (u16)((m_Generations[index] + 1) & ENTITY_GENERATION_MASK);
+        m_Generations[index] = generation == 0 ? 1 : generation;
+
+        m_PendingDestroy.push_back(e);
+        m_AliveCount--;
+    }
+
+    void EntityManager::Destroy(const Entity* entities, u32 count)
+    {
+        for(u32 i = 0; i < count; i++)
+        {
+            Destroy(entities[i]);
+        }
+    }
+
+    void EntityManager::Flush()
+    {
+        if(m_PendingDestroy.empty()) return;
+
+        const u32 count = (u32)m_PendingDestroy.size();
+        for(IComponentManager* manager : m_ComponentManagers)
+        {
+            manager->RemoveBatch(m_PendingDestroy.data(), count);
+        }
+
+        for(Entity e : m_PendingDestroy)
+        {
+            m_FreeIndices.push_back(GetEntityIndex(e));
+        }
+        m_PendingDestroy.clear();
+    }
+
+    bool EntityManager::IsAlive(Entity e) const
+    {
+        const u32 index = GetEntityIndex(e);
+        return e != INVALID_ENTITY_ID && index < m_Generations.size() && m_Generations[index] == GetEntityGeneration(e);
+    }
+
+    void EntityManager::RegisterComponentManager(IComponentManager* manager)
+    {
+        RAW_ASSERT(manager != nullptr);
+        for(IComponentManager* registered : m_ComponentManagers)
+        {
+            if(registered == manager) return;
+        }
+        m_ComponentManagers.push_back(manager);
+    }
+}
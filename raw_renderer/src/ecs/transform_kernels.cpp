@@ -0,0 +1,170 @@
+#include "ecs/transform_kernels.hpp"
+#include "core/simd.hpp"
+#include <cmath>
+
+namespace Raw
+{
+    namespace TransformKernels
+    {
+        void ComposeTRSScalar(const TRSStreams& streams, u32 first, u32 count, glm::mat4* outMatrices)
+        {
+            for(u32 i = first; i < first + count; i++)
+            {
+                const f32 hx = streams.rotation[0][i] * 0.5f;
+                const f32 hy = streams.rotation[1][i] * 0.5f;
+                const f32 hz = streams.rotation[2][i] * 0.5f;
+                const f32 cx = cosf(hx), sx = sinf(hx);
+                const f32 cy = cosf(hy), sy = sinf(hy);
+                const f32 cz = cosf(hz), sz = sinf(hz);
+
+                // euler to quaternion, same convention as glm::quat(glm::vec3)
+                const f32 qw = cx * cy * cz + sx * sy * sz;
+                const f32 qx = sx * cy * cz - cx * sy * sz;
+                const f32 qy = cx * sy * cz + sx * cy * sz;
+                const f32 qz = cx * cy * sz - sx * sy * cz;
+
+                const f32 xx = qx * qx, yy = qy * qy, zz = qz * qz;
+                const f32 xy = qx * qy, xz = qx * qz, yz = qy * qz;
+                const f32 wx = qw * qx, wy = qw * qy, wz = qw * qz;
+
+                const f32 scaleX = streams.scale[0][i];
+                const f32 scaleY = streams.scale[1][i];
+                const f32 scaleZ = streams.scale[2][i];
+
+                glm::mat4& m = outMatrices[i];
+                m[0] = glm::vec4((1.f - 2.f * (yy + zz)) * scaleX, 2.f * (xy + wz) * scaleX, 2.f * (xz - wy) * scaleX, 0.f);
+                m[1] = glm::vec4(2.f * (xy - wz) * scaleY, (1.f - 2.f * (xx + zz)) * scaleY, 2.f * (yz + wx) * scaleY, 0.f);
+                m[2] = glm::vec4(2.f * (xz + wy) * scaleZ, 2.f * (yz - wx) * scaleZ, (1.f - 2.f * (xx + yy)) * scaleZ, 0.f);
+                m[3] = glm::vec4(streams.position[0][i], streams.position[1][i], streams.position[2][i], 1.f);
+            }
+        }
+
+#if defined(RAW_ARCH_X86)
+        namespace
+        {
+            // cephes style sin/cos, reduced to [-pi/4, pi/4] by quadrant
+            RAW_TARGET_AVX2 RAW_INLINE void SinCos8(__m256 x, __m256& outSin, __m256& outCos)
+            {
+                const __m256 twoOverPi = _mm256_set1_ps(0.63661977236f);
+                const __m256 piOver2Hi = _mm256_set1_ps(1.5703125f);
+                const __m256 piOver2Mid = _mm256_set1_ps(4.837512969970703125e-4f);
+                const __m256 piOver2Lo = _mm256_set1_ps(7.54978995489188216e-8f);
+
+                const __m256 quadrantF = _mm256_round_ps(_mm256_mul_ps(x, twoOverPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                const __m256i quadrant = _mm256_cvtps_epi32(quadrantF);
+
+                __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(quadrantF, piOver2Hi));
+                r = _mm256_sub_ps(r, _mm256_mul_ps(quadrantF, piOver2Mid));
+                r = _mm256_sub_ps(r, _mm256_mul_ps(quadrantF, piOver2Lo));
+                const __m256 r2 = _mm256_mul_ps(r, r);
+
+                __m256 s = _mm256_set1_ps(-1.9515295891e-4f);
+                s = _mm256_add_ps(_mm256_mul_ps(s, r2), _mm256_set1_ps(8.3321608736e-3f));
+                s = _mm256_add_ps(_mm256_mul_ps(s, r2), _mm256_set1_ps(-1.6666654611e-1f));
+                s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, r2), r), r);
+
+                __m256 c = _mm256_set1_ps(2.443315711809948e-5f);
+                c = _mm256_add_ps(_mm256_mul_ps(c, r2), _mm256_set1_ps(-1.388731625493765e-3f));
+                c = _mm256_add_ps(_mm256_mul_ps(c, r2), _mm256_set1_ps(4.166664568298827e-2f));
+                c = _mm256_mul_ps(_mm256_mul_ps(c, r2), r2);
+                c = _mm256_add_ps(_mm256_sub_ps(c, _mm256_mul_ps(r2, _mm256_set1_ps(0.5f))), _mm256_set1_ps(1.f));
+
+                // odd quadrants swap sin and cos, quadrants 2,3 negate sin and 1,2 negate cos
+                const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+                const __m256 signBit = _mm256_set1_ps(-0.f);
+                const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+                const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+                outSin = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), _mm256_and_ps(sinSign, signBit));
+                outCos = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), _mm256_and_ps(cosSign, signBit));
+            }
+        }
+
+        RAW_TARGET_AVX2 void ComposeTRSAVX2(const TRSStreams& streams, u32 first, u32 count, glm::mat4* outMatrices)
+        {
+            const __m256 half = _mm256_set1_ps(0.5f);
+            const __m256 one = _mm256_set1_ps(1.f);
+            const __m256 two = _mm256_set1_ps(2.f);
+            const __m256 zero = _mm256_setzero_ps();
+
+            const u32 wideCount = count & ~7u;
+            for(u32 i = first; i < first + wideCount; i += 8)
+            {
+                __m256 sx, cx, sy, cy, sz, cz;
+                SinCos8(_mm256_mul_ps(_mm256_loadu_ps(streams.rotation[0] + i), half), sx, cx);
+                SinCos8(_mm256_mul_ps(_mm256_loadu_ps(streams.rotation[1] + i), half), sy, cy);
+                SinCos8(_mm256_mul_ps(_mm256_loadu_ps(streams.rotation[2] + i), half), sz, cz);
+
+                const __m256 cxcy = _mm256_mul_ps(cx, cy);
+                const __m256 sxsy = _mm256_mul_ps(sx, sy);
+                const __m256 sxcy = _mm256_mul_ps(sx, cy);
+                const __m256 cxsy = _mm256_mul_ps(cx, sy);
+
+                const __m256 qw = _mm256_add_ps(_mm256_mul_ps(cxcy, cz), _mm256_mul_ps(sxsy, sz));
+                const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sxcy, cz), _mm256_mul_ps(cxsy, sz));
+                const __m256 qy = _mm256_add_ps(_mm256_mul_ps(cxsy, cz), _mm256_mul_ps(sxcy, sz));
+                const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(cxcy, sz), _mm256_mul_ps(sxsy, cz));
+
+                const __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+                const __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+                const __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+
+                const __m256 scaleX = _mm256_loadu_ps(streams.scale[0] + i);
+                const __m256 scaleY = _mm256_loadu_ps(streams.scale[1] + i);
+                const __m256 scaleZ = _mm256_loadu_ps(streams.scale[2] + i);
+
+                // first half of every matrix, columns 0 and 1
+                __m256 lo[8];
+                lo[0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), scaleX);
+                lo[1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), scaleX);
+                lo[2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), scaleX);
+                lo[3] = zero;
+                lo[4] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), scaleY);
+                lo[5] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), scaleY);
+                lo[6] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), scaleY);
+                lo[7] = zero;
+
+                // second half, columns 2 and 3
+                __m256 hi[8];
+                hi[0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), scaleZ);
+                hi[1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), scaleZ);
+                hi[2] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), scaleZ);
+                hi[3] = zero;
+                hi[4] = _mm256_loadu_ps(streams.position[0] + i);
+                hi[5] = _mm256_loadu_ps(streams.position[1] + i);
+                hi[6] = _mm256_loadu_ps(streams.position[2] + i);
+                hi[7] = one;
+
+                SIMD::Transpose8(lo);
+                SIMD::Transpose8(hi);
+
+                for(u32 j = 0; j < 8; j++)
+                {
+                    f32* dst = &outMatrices[i + j][0][0];
+                    _mm256_storeu_ps(dst, lo[j]);
+                    _mm256_storeu_ps(dst + 8, hi[j]);
+                }
+            }
+
+            if(wideCount < count) ComposeTRSScalar(streams, first + wideCount, count - wideCount, outMatrices);
+        }
+#else
+        void ComposeTRSAVX2(const TRSStreams& streams, u32 first, u32 count, glm::mat4* outMatrices)
+        {
+            ComposeTRSScalar(streams, first, count, outMatrices);
+        }
+#endif
+
+        void ComposeTRS(const TRSStreams& streams, u32 first, u32 count, glm::mat4* outMatrices)
+        {
+            if(SIMD::SupportsAVX2())
+            {
+                ComposeTRSAVX2(streams, first, count, outMatrices);
+            }
+            else
+            {
+                ComposeTRSScalar(streams, first, count, outMatrices);
+            }
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#include "ecs/transform_storage.hpp"
+
+namespace Raw
+{
+    void TransformStorage::Init()
+    {
+        for(u32 i = 0; i < 3; i++)
+        {
+            m_Position[i].reserve(64);
+            m_Rotation[i].reserve(64);
+            m_Scale[i].reserve(64);
+        }
+        m_Entities.reserve(64);
+    }
+
+    void TransformStorage::Shutdown()
+    {
+        for(u32 i = 0; i < 3; i++)
+        {
+            m_Position[i].clear();
+            m_Rotation[i].clear();
+            m_Scale[i].clear();
+        }
+        m_Entities.clear();
+        m_LookUp.clear();
+        m_Changes.Clear();
+    }
+
+    bool TransformStorage::Contains(Entity e) const
+    {
+        return m_LookUp.find(e) != m_LookUp.end();
+    }
+
+    void TransformStorage::Add(Entity e, const TransformComponent& transform)
+    {
+        RAW_ASSERT(e != INVALID_ENTITY_ID);
+        RAW_ASSERT(m_LookUp.find(e) == m_LookUp.end());
+
+        m_LookUp[e] = (u32)m_Entities.size();
+        m_Entities.push_back(e);
+        for(u32 i = 0; i < 3; i++)
+        {
+            m_Position[i].push_back(0.f);
+            m_Rotation[i].push_back(0.f);
+            m_Scale[i].push_back(1.f);
+        }
+        m_Changes.Push(m_CurrentFrame);
+        Write((u32)m_Entities.size() - 1, transform);
+    }
+
+    void TransformStorage::Remove(Entity e)
+    {
+        auto it = m_LookUp.find(e);
+        if(it == m_LookUp.end()) return;
+
+        const u32 index = it->second;
+        const u32 last = (u32)m_Entities.size() - 1;
+        const Entity lastEntity = m_Entities[last];
+
+        for(u32 i = 0; i < 3; i++)
+        {
+            m_Position[i][index] = m_Position[i][last];
+            m_Rotation[i][index] = m_Rotation[i][last];
+            m_Scale[i][index] = m_Scale[i][last];
+            m_Position[i].pop_back();
+            m_Rotation[i].pop_back();
+            m_Scale[i].pop_back();
+        }
+        m_Entities[index] = lastEntity;
+        m_Entities.pop_back();
+        m_Changes.RemoveSwap(index);
+        if(index < last) m_Changes.MarkChanged(index, m_CurrentFrame);
+
+        m_LookUp[lastEntity] = index;
+        m_LookUp.erase(e);
+    }
+
+    void TransformStorage::Set(Entity e, const TransformComponent& transform)
+    {
+        auto it = m_LookUp.find(e);
+        RAW_ASSERT_MSG(it != m_LookUp.end(), "Entity %u has no transform!", e);
+        Write(it->second, transform);
+        m_Changes.MarkChanged(it->second, m_CurrentFrame);
+    }
+
+    TransformComponent TransformStorage::Get(Entity e) const
+    {
+        TransformComponent transform;
+        auto it = m_LookUp.find(e);
+        if(it == m_LookUp.end()) return transform;
+
+        const u32 index = it->second;
+        transform.position = glm::vec3(m_Position[0][index], m_Position[1][index], m_Position[2][index]);
+        transform.rotation = glm::vec3(m_Rotation[0][index], m_Rotation[1][index], m_Rotation[2][index]);
+        transform.scale = glm::vec3(m_Scale[0][index], m_Scale[1][index], m_Scale[2][index]);
+        return transform;
+    }
+
+    void TransformStorage::ComputeMatrices(glm::mat4* outMatrices) const
+    {
+        TransformKernels::ComposeTRS(GetStreams(), 0, GetCount(), outMatrices);
+    }
+
+    u32 TransformStorage::ComputeChangedMatrices(u64 frame, glm::mat4* outMatrices)
+    {
+        m_Changes.GetChangedRangesSince(frame, m_ChangeRanges);
+
+        const TRSStreams streams = GetStreams();
+        u32 written = 0;
+        for(const ChangeRange& range : m_ChangeRanges)
+        {
+            TransformKernels::ComposeTRS(streams, range.first, range.count, outMatrices);
+            written += range.count;
+        }
+        return written;
+    }
+
+    void TransformStorage::Write(u32 index, const TransformComponent& transform)
+    {
+        for(u32 i = 0; i < 3; i++)
+        {
+            m_Position[i][index] = transform.position[i];
+            m_Rotation[i][index] = transform.rotation[i];
+            m_Scale[i][index] = transform.scale[i];
+        }
+    }
+}
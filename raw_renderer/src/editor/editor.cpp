@@ -10,6 +10,7 @@ namespace Raw
     static Editor s_Editor;
     static GFX::RenderPassData prevData;
     static i32 lightIndex = 0;
+    static u32 selectedInstance = U32_MAX;
 
     Editor* Editor::Get()
     {
@@ -49,6 +50,8 @@ namespace Raw
         ImGui::Checkbox("SSAO", &passData->enableAO);
         ImGui::Checkbox("SSR", &passData->enableSSR);
         ImGui::Checkbox("FXAA", &passData->enableFXAA);
+        ImGui::Checkbox("CPU Culling", &passData->enableCPUCulling);
+        ImGui::Checkbox("Occlusion Culling", &passData->enableOcclusionCulling);
         ImGui::Spacing();
         
         ImGui::Separator();
@@ -58,35 +61,68 @@ namespace Raw
         ImGui::SliderFloat("Y", &globalData.lightDir.y, -1.f, 1.f, "%.3f");
         ImGui::SliderFloat("Z", &globalData.lightDir.z, -1.f, 1.f, "%.3f");
         ImGui::SliderFloat("Intensity", &globalData.lightIntensity, 0.f, 100.f, "%.1f");
+        ImGui::SliderFloat("Shadow Distance", &passData->shadowDistance, 5.f, 100.f, "%.1f");
         globalData.lightDir = glm::normalize(globalData.lightDir);
-        globalData.lightView = glm::lookAt(glm::vec3(0, 15.f, 0), glm::vec3(-globalData.lightDir.x, -globalData.lightDir.y, -globalData.lightDir.z), glm::vec3(0, 0, 1));
-        globalData.lightProj = glm::ortho(-20.f, 20.f, -20.f, 20.f, -15.f, 15.f);
     
         ImGui::Spacing();
         ImGui::Text("Point Lights");
-        ImGui::SliderInt("Point Light Index", &lightIndex, 0, MAX_LIGHT_COUNT - 1);
+        ImGui::SliderInt("Point Light Index", &lightIndex, 0, (i32)scene->GetPointLightCount() - 1);
         GFX::PointLight* rootLight = scene->GetPointLights();
 
+        bool lightChanged = false;
         ImGui::Text("Position:");
-        ImGui::SliderFloat("PointLight X", &rootLight[lightIndex].position.x, -10.f, 10.f, "%.3f");
-        ImGui::SliderFloat("PointLight Y", &rootLight[lightIndex].position.y, -10.f, 10.f, "%.3f");
-        ImGui::SliderFloat("PointLight Z", &rootLight[lightIndex].position.z, -10.f, 10.f, "%.3f");
+        lightChanged |= ImGui::SliderFloat("PointLight X", &rootLight[lightIndex].position.x, -10.f, 10.f, "%.3f");
+        lightChanged |= ImGui::SliderFloat("PointLight Y", &rootLight[lightIndex].position.y, -10.f, 10.f, "%.3f");
+        lightChanged |= ImGui::SliderFloat("PointLight Z", &rootLight[lightIndex].position.z, -10.f, 10.f, "%.3f");
 
         ImGui::Text("Direction:");
-        ImGui::SliderFloat("PointLight Dir X", &rootLight[lightIndex].direction.x, -1.f, 1.f, "%.3f");
-        ImGui::SliderFloat("PointLight Dir Y", &rootLight[lightIndex].direction.y, -1.f, 1.f, "%.3f");
-        ImGui::SliderFloat("PointLight Dir Z", &rootLight[lightIndex].direction.z, -1.f, 1.f, "%.3f");
+        lightChanged |= ImGui::SliderFloat("PointLight Dir X", &rootLight[lightIndex].direction.x, -1.f, 1.f, "%.3f");
+        lightChanged |= ImGui::SliderFloat("PointLight Dir Y", &rootLight[lightIndex].direction.y, -1.f, 1.f, "%.3f");
+        lightChanged |= ImGui::SliderFloat("PointLight Dir Z", &rootLight[lightIndex].direction.z, -1.f, 1.f, "%.3f");
 
         ImGui::Text("Color:");
-        ImGui::SliderFloat("R", &rootLight[lightIndex].color.r, 0.f, 1.f, "%.1f");
-        ImGui::SliderFloat("G", &rootLight[lightIndex].color.g, 0.f, 1.f, "%.1f");
-        ImGui::SliderFloat("B", &rootLight[lightIndex].color.b, 0.f, 1.f, "%.1f");
-        ImGui::SliderFloat("A", &rootLight[lightIndex].color.a, 0.f, 1.f, "%.1f");
+        lightChanged |= ImGui::SliderFloat("R", &rootLight[lightIndex].color.r, 0.f, 1.f, "%.1f");
+        lightChanged |= ImGui::SliderFloat("G", &rootLight[lightIndex].color.g, 0.f, 1.f, "%.1f");
+        lightChanged |= ImGui::SliderFloat("B", &rootLight[lightIndex].color.b, 0.f, 1.f, "%.1f");
+        lightChanged |= ImGui::SliderFloat("A", &rootLight[lightIndex].color.a, 0.f, 1.f, "%.1f");
 
-        ImGui::SliderFloat("Intensity:", &rootLight[lightIndex].intensity, 0.f, 10.f, "%.1f");
-        ImGui::SliderFloat("Radius:", &rootLight[lightIndex].radius, 0.f, 100.f, "%.1f");
+        lightChanged |= ImGui::SliderFloat("Intensity:", &rootLight[lightIndex].intensity, 0.f, 10.f, "%.1f");
+        lightChanged |= ImGui::SliderFloat("Radius:", &rootLight[lightIndex].radius, 0.f, 100.f, "%.1f");
 
-        rootLight[lightIndex].direction = glm::normalize(rootLight[lightIndex].direction);
+        if(lightChanged)
+        {
+            rootLight[lightIndex].direction = glm::normalize(rootLight[lightIndex].direction);
+            scene->MarkLightChanged(lightIndex);
+        }
+
+        // picks against the instances' bounds, the ray runs from the near to the far plane through the cursor
+        if(ImGui::IsMouseClicked(ImGuiMouseButton_Left) && !io.WantCaptureMouse && io.DisplaySize.x > 0.f && io.DisplaySize.y > 0.f)
+        {
+            const glm::vec2 ndc = glm::vec2(io.MousePos.x / io.DisplaySize.x, io.MousePos.y / io.DisplaySize.y) * 2.f - 1.f;
+            const glm::mat4 clipToWorld = globalData.viewInv * globalData.projInv;
+            glm::vec4 nearPoint = clipToWorld * glm::vec4(ndc.x, ndc.y, 0.f, 1.f);
+            glm::vec4 farPoint = clipToWorld * glm::vec4(ndc.x, ndc.y, 1.f, 1.f);
+            nearPoint /= nearPoint.w;
+            farPoint /= farPoint.w;
+
+            BVHRayHit hit;
+            scene->GetBVH().Raycast(glm::vec3(nearPoint), glm::vec3(farPoint - nearPoint), hit);
+            selectedInstance = hit.instance;
+        }
+
+        ImGui::Spacing();
+        ImGui::Text("Picking");
+        if(selectedInstance < sceneData.draws.size())
+        {
+            const GFX::MeshDrawData& draw = sceneData.draws[selectedInstance];
+            ImGui::Text("Selected Instance: %u", selectedInstance);
+            ImGui::Text("Indirect Draw: %u", draw.drawIndex);
+            ImGui::Text("Material: %u", draw.materialIndex);
+        }
+        else
+        {
+            ImGui::Text("LMB : Select Instance");
+        }
 
         ImGui::Spacing();
         ImGui::Text("Meshes");
@@ -103,14 +139,16 @@ namespace Raw
                         ImGui::Text("Material Data");
                         ImGui::Spacing();
                         ImGui::Text("Base Color Factor");
-                        ImGui::SliderFloat("R", &materialData.baseColorFactor.x, 0.0f, 1.0f);
-                        ImGui::SliderFloat("G", &materialData.baseColorFactor.y, 0.0f, 1.0f);
-                        ImGui::SliderFloat("B", &materialData.baseColorFactor.z, 0.0f, 1.0f);
-                        ImGui::SliderFloat("A", &materialData.baseColorFactor.w, 0.0f, 1.0f);
+                        bool materialChanged = false;
+                        materialChanged |= ImGui::SliderFloat("R", &materialData.baseColorFactor.x, 0.0f, 1.0f);
+                        materialChanged |= ImGui::SliderFloat("G", &materialData.baseColorFactor.y, 0.0f, 1.0f);
+                        materialChanged |= ImGui::SliderFloat("B", &materialData.baseColorFactor.z, 0.0f, 1.0f);
+                        materialChanged |= ImGui::SliderFloat("A", &materialData.baseColorFactor.w, 0.0f, 1.0f);
                         ImGui::Spacing();
                         ImGui::Text("Metallic Roughness Factor");
-                        ImGui::SliderFloat("Metallic", &materialData.metalRoughnessFactor.x, 0.0f, 1.0f);
-                        ImGui::SliderFloat("Roughness", &materialData.metalRoughnessFactor.y, 0.0f, 1.0f);
+                        materialChanged |= ImGui::SliderFloat("Metallic", &materialData.metalRoughnessFactor.x, 0.0f, 1.0f);
+                        materialChanged |= ImGui::SliderFloat("Roughness", &materialData.metalRoughnessFactor.y, 0.0f, 1.0f);
+                        if(materialChanged) scene->MarkMaterialChanged(mesh.materialIndex);
                     }
                     
                     ImGui::TreePop();
@@ -0,0 +1,241 @@
+#include "memory/allocators/offset_allocator.hpp"
+#include "core/asserts.hpp"
+#include <bit>
+#include <algorithm>
+
+namespace Raw
+{
+    namespace
+    {
+        // sizes below 8 get a bin each, above that the top bit picks the group and the next three bits the bin within it
+        u32 BinIndexRoundDown(u32 size)
+        {
+            if(size < 8) return size;
+
+            const u32 topBit = 31 - (u32)std::countl_zero(size);
+            const u32 subBin = (size >> (topBit - 3)) & 7u;
+            return (topBit - 2) * 8 + subBin;
+        }
+
+        // the first bin whose every range is at least size
+        u32 BinIndexRoundUp(u32 size)
+        {
+            const u32 bin = BinIndexRoundDown(size);
+            if(size < 8) return bin;
+
+            const u32 topBit = 31 - (u32)std::countl_zero(size);
+            const u32 remainderMask = (1u << (topBit - 3)) - 1;
+            return (size & remainderMask) ? bin + 1 : bin;
+        }
+    }
+
+    void OffsetAllocator::Init(u32 size)
+    {
+        m_Nodes.clear();
+        m_UnusedNodes.clear();
+        std::fill(std::begin(m_BinHeads), std::end(m_BinHeads), INVALID_OFFSET_NODE);
+        std::fill(std::begin(m_UsedSubBins), std::end(m_UsedSubBins), (u8)0);
+        m_UsedGroups = 0;
+        m_Size = size;
+        m_FreeSize = size;
+
+        if(size > 0) InsertFreeNode(0, size, INVALID_OFFSET_NODE, INVALID_OFFSET_NODE);
+    }
+
+    void OffsetAllocator::Shutdown()
+    {
+        RAW_ASSERT_MSG(m_FreeSize == m_Size, "OffsetAllocator shut down with %u of %u still allocated!", m_Size - m_FreeSize, m_Size);
+
+        m_Nodes.clear();
+        m_UnusedNodes.clear();
+        m_UsedGroups = 0;
+        m_Size = 0;
+        m_FreeSize = 0;
+    }
+
+    bool OffsetAllocator::Allocate(u32 size, OffsetAllocation& outAllocation)
+    {
+        outAllocation = OffsetAllocation();
+        if(size == 0) return true;
+        if(size > m_FreeSize) return false;
+
+        // the rounded up bin only holds ranges that fit, anything above it does too
+        const u32 minBin = BinIndexRoundUp(size);
+        if(minBin >= k_BinCount) return false;
+
+        const u32 group = minBin / k_SubBinCount;
+        u32 bin = INVALID_OFFSET_NODE;
+        const u32 subBins = m_UsedSubBins[group] & (0xFFu << (minBin % k_SubBinCount));
+        if(subBins)
+        {
+            bin = group * k_SubBinCount + (u32)std::countr_zero(subBins);
+        }
+        else
+        {
+            const u32 groups = group + 1 < k_BinGroupCount ? m_UsedGroups & (~0u << (group + 1)) : 0;
+            if(groups == 0) return false;
+
+            const u32 freeGroup = (u32)std::countr_zero(groups);
+            bin = freeGroup * k_SubBinCount + (u32)std::countr_zero((u32)m_UsedSubBins[freeGroup]);
+        }
+
+        const u32 node = m_BinHeads[bin];
+        UnlinkFromBin(node);
+        m_Nodes[node].used = true;
+
+        // the tail goes back as its own free range between this node and its old neighbour
+        if(m_Nodes[node].size > size)
+        {
+            const u32 next = m_Nodes[node].neighbourNext;
+            const u32 remainder = InsertFreeNode(m_Nodes[node].offset + size, m_Nodes[node].size - size, node, next);
+            if(next != INVALID_OFFSET_NODE) m_Nodes[next].neighbourPrev = remainder;
+            m_Nodes[node].neighbourNext = remainder;
+            m_Nodes[node].size = size;
+        }
+
+        m_FreeSize -= size;
+
+        outAllocation.offset = m_Nodes[node].offset;
+        outAllocation.size = size;
+        outAllocation.node = node;
+        return true;
+    }
+
+    void OffsetAllocator::Free(const OffsetAllocation& allocation)
+    {
+        if(!allocation.IsValid()) return;
+
+        const u32 node = allocation.node;
+        RAW_ASSERT_MSG(m_Nodes[node].used, "Offset allocation freed twice!");
+
+        m_FreeSize += m_Nodes[node].size;
+
+        u32 offset = m_Nodes[node].offset;
+        u32 size = m_Nodes[node].size;
+        u32 prev = m_Nodes[node].neighbourPrev;
+        u32 next = m_Nodes[node].neighbourNext;
+
+        if(prev != INVALID_OFFSET_NODE && !m_Nodes[prev].used)
+        {
+            offset = m_Nodes[prev].offset;
+            size += m_Nodes[prev].size;
+            UnlinkFromBin(prev);
+
+            const u32 merged = prev;
+            prev = m_Nodes[prev].neighbourPrev;
+            ReleaseNode(merged);
+        }
+
+        if(next != INVALID_OFFSET_NODE && !m_Nodes[next].used)
+        {
+            size += m_Nodes[next].size;
+            UnlinkFromBin(next);
+
+            const u32 merged = next;
+            next = m_Nodes[next].neighbourNext;
+            ReleaseNode(merged);
+        }
+
+        Node& freed = m_Nodes[node];
+        freed.offset = offset;
+        freed.size = size;
+        freed.used = false;
+        freed.neighbourPrev = prev;
+        freed.neighbourNext = next;
+        if(prev != INVALID_OFFSET_NODE) m_Nodes[prev].neighbourNext = node;
+        if(next != INVALID_OFFSET_NODE) m_Nodes[next].neighbourPrev = node;
+
+        LinkIntoBin(node);
+    }
+
+    u32 OffsetAllocator::GetLargestFreeRange() const
+    {
+        if(m_UsedGroups == 0) return 0;
+
+        const u32 group = 31 - (u32)std::countl_zero(m_UsedGroups);
+        const u32 subBin = 31 - (u32)std::countl_zero((u32)m_UsedSubBins[group]);
+
+        // ranges within a bin differ in size, so its whole list is checked
+        u32 largest = 0;
+        for(u32 node = m_BinHeads[group * k_SubBinCount + subBin]; node != INVALID_OFFSET_NODE; node = m_Nodes[node].binNext)
+        {
+            largest = std::max(largest, m_Nodes[node].size);
+        }
+        return largest;
+    }
+
+    u32 OffsetAllocator::InsertFreeNode(u32 offset, u32 size, u32 neighbourPrev, u32 neighbourNext)
+    {
+        const u32 node = NewNode();
+
+        Node& newNode = m_Nodes[node];
+        newNode.offset = offset;
+        newNode.size = size;
+        newNode.used = false;
+        newNode.neighbourPrev = neighbourPrev;
+        newNode.neighbourNext = neighbourNext;
+
+        LinkIntoBin(node);
+        return node;
+    }
+
+    void OffsetAllocator::LinkIntoBin(u32 node)
+    {
+        const u32 bin = BinIndexRoundDown(m_Nodes[node].size);
+        const u32 head = m_BinHeads[bin];
+
+        m_Nodes[node].binPrev = INVALID_OFFSET_NODE;
+        m_Nodes[node].binNext = head;
+        if(head != INVALID_OFFSET_NODE) m_Nodes[head].binPrev = node;
+        m_BinHeads[bin] = node;
+
+        m_UsedSubBins[bin / k_SubBinCount] |= (u8)(1u << (bin % k_SubBinCount));
+        m_UsedGroups |= 1u << (bin / k_SubBinCount);
+    }
+
+    void OffsetAllocator::UnlinkFromBin(u32 node)
+    {
+        const u32 prev = m_Nodes[node].binPrev;
+        const u32 next = m_Nodes[node].binNext;
+
+        if(prev != INVALID_OFFSET_NODE)
+        {
+            m_Nodes[prev].binNext = next;
+        }
+        else
+        {
+            const u32 bin = BinIndexRoundDown(m_Nodes[node].size);
+            m_BinHeads[bin] = next;
+            if(next == INVALID_OFFSET_NODE)
+            {
+                const u32 group = bin / k_SubBinCount;
+                m_UsedSubBins[group] &= (u8)~(1u << (bin % k_SubBinCount));
+                if(m_UsedSubBins[group] == 0) m_UsedGroups &= ~(1u << group);
+            }
+        }
+
+        if(next != INVALID_OFFSET_NODE) m_Nodes[next].binPrev = prev;
+
+        m_Nodes[node].binPrev = INVALID_OFFSET_NODE;
+        m_Nodes[node].binNext = INVALID_OFFSET_NODE;
+    }
+
+    u32 OffsetAllocator::NewNode()
+    {
+        if(!m_UnusedNodes.empty())
+        {
+            const u32 node = m_UnusedNodes.back();
+            m_UnusedNodes.pop_back();
+            m_Nodes[node] = Node();
+            return node;
+        }
+
+        m_Nodes.emplace_back();
+        return (u32)m_Nodes.size() - 1;
+    }
+
+    void OffsetAllocator::ReleaseNode(u32 node)
+    {
+        m_UnusedNodes.push_back(node);
+    }
+}
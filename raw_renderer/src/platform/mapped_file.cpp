@@ -0,0 +1,119 @@
+#include "platform/mapped_file.hpp"
+#include "core/logger.hpp"
+
+#if defined(RAW_PLATFORM_WINDOWS)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Raw
+{
+#if defined(RAW_PLATFORM_WINDOWS)
+    bool MappedFile::Open(cstring filepath)
+    {
+        Close();
+
+        HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(file == INVALID_HANDLE_VALUE)
+        {
+            RAW_ERROR("Failed to open '%s' for mapping!", filepath);
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            RAW_ERROR("Cannot map empty file '%s'!", filepath);
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(!mapping)
+        {
+            RAW_ERROR("Failed to create file mapping for '%s'!", filepath);
+            CloseHandle(file);
+            return false;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if(!data)
+        {
+            RAW_ERROR("Failed to map view of '%s'!", filepath);
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_File = file;
+        m_Mapping = mapping;
+        m_Data = (const u8*)data;
+        m_Size = (u64)fileSize.QuadPart;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if(m_Data) UnmapViewOfFile(m_Data);
+        if(m_Mapping) CloseHandle((HANDLE)m_Mapping);
+        if(m_File) CloseHandle((HANDLE)m_File);
+
+        m_Data = nullptr;
+        m_Mapping = nullptr;
+        m_File = nullptr;
+        m_Size = 0;
+    }
+#else
+    bool MappedFile::Open(cstring filepath)
+    {
+        Close();
+
+        i32 file = open(filepath, O_RDONLY);
+        if(file < 0)
+        {
+            RAW_ERROR("Failed to open '%s' for mapping!", filepath);
+            return false;
+        }
+
+        struct stat fileStat;
+        if(fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+        {
+            RAW_ERROR("Cannot map empty file '%s'!", filepath);
+            close(file);
+            return false;
+        }
+
+        void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if(data == MAP_FAILED)
+        {
+            RAW_ERROR("Failed to map '%s'!", filepath);
+            close(file);
+            return false;
+        }
+        // accessors are walked front to back
+        madvise(data, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+
+        m_File = file;
+        m_Data = (const u8*)data;
+        m_Size = (u64)fileStat.st_size;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if(m_Data) munmap((void*)m_Data, (size_t)m_Size);
+        if(m_File >= 0) close(m_File);
+
+        m_Data = nullptr;
+        m_File = -1;
+        m_Size = 0;
+    }
+#endif
+}
@@ -0,0 +1,296 @@
+#include "renderer/cpu_culling.hpp"
+#include "core/simd.hpp"
+#include "core/job_system.hpp"
+#include "core/asserts.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Raw::GFX
+{
+    namespace
+    {
+        constexpr u8 CULLED_LOD = 0xFF;
+        // instances per job, a multiple of 8 so no two jobs share a mask byte
+        constexpr u32 CULL_BATCH_SIZE = 1024;
+        // keep in sync with LOD_ERROR_THRESHOLD in common.glsl
+        constexpr f32 LOD_ERROR_THRESHOLD = 0.001f;
+
+        static_assert(sizeof(Frustum) == 6 * sizeof(Plane), "the frustum is read as an array of six planes");
+
+        bool IsInsideFrustum(const InstanceBoundsData& bounds, const Frustum& frustum)
+        {
+            const Plane* planes = &frustum.topFace;
+            const glm::vec3 center = (bounds.boundsMin + bounds.boundsMax) * 0.5f;
+            const glm::vec3 extents = (bounds.boundsMax - bounds.boundsMin) * 0.5f;
+
+            for(u32 p = 0; p < 6; p++)
+            {
+                const glm::vec3& n = planes[p].normal;
+                const f32 dist = center.x * n.x + center.y * n.y + center.z * n.z
+                    + extents.x * std::abs(n.x) + extents.y * std::abs(n.y) + extents.z * std::abs(n.z)
+                    + planes[p].distance;
+                // written as the shader's early out so a nan keeps the instance like it does on the gpu
+                if(dist < 0.f) return false;
+            }
+            return true;
+        }
+    }
+
+    namespace CullingKernels
+    {
+        void CullBoundsScalar(const InstanceBoundsData* bounds, u32 first, u32 count, const Frustum& frustum, u8* outMasks)
+        {
+            RAW_ASSERT((first & 7u) == 0);
+
+            for(u32 i = first; i < first + count; i++)
+            {
+                if((i & 7u) == 0) outMasks[i / 8] = 0;
+                if(IsInsideFrustum(bounds[i], frustum)) outMasks[i / 8] |= (u8)(1u << (i & 7u));
+            }
+        }
+
+#if defined(RAW_ARCH_X86)
+        RAW_TARGET_AVX2 void CullBoundsAVX2(const InstanceBoundsData* bounds, u32 first, u32 count, const Frustum& frustum, u8* outMasks)
+        {
+            static_assert(sizeof(InstanceBoundsData) == 8 * sizeof(f32), "instance bounds are loaded as one 8 wide row each");
+            RAW_ASSERT((first & 7u) == 0);
+
+            const Plane* planes = &frustum.topFace;
+            const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+            __m256 nx[6], ny[6], nz[6], ax[6], ay[6], az[6], d[6];
+            for(u32 p = 0; p < 6; p++)
+            {
+                nx[p] = _mm256_set1_ps(planes[p].normal.x);
+                ny[p] = _mm256_set1_ps(planes[p].normal.y);
+                nz[p] = _mm256_set1_ps(planes[p].normal.z);
+                ax[p] = _mm256_and_ps(nx[p], absMask);
+                ay[p] = _mm256_and_ps(ny[p], absMask);
+                az[p] = _mm256_and_ps(nz[p], absMask);
+                d[p] = _mm256_set1_ps(planes[p].distance);
+            }
+
+            const __m256 half = _mm256_set1_ps(0.5f);
+            const __m256 zero = _mm256_setzero_ps();
+
+            const u32 wideCount = count & ~7u;
+            for(u32 i = first; i < first + wideCount; i += 8)
+            {
+                // one row per instance, transposed into one register per field with lane j belonging to instance i + j
+                __m256 rows[8];
+                for(u32 j = 0; j < 8; j++) rows[j] = _mm256_loadu_ps((const f32*)&bounds[i + j]);
+                SIMD::Transpose8(rows);
+
+                const __m256 cx = _mm256_mul_ps(_mm256_add_ps(rows[0], rows[4]), half);
+                const __m256 cy = _mm256_mul_ps(_mm256_add_ps(rows[1], rows[5]), half);
+                const __m256 cz = _mm256_mul_ps(_mm256_add_ps(rows[2], rows[6]), half);
+                const __m256 ex = _mm256_mul_ps(_mm256_sub_ps(rows[4], rows[0]), half);
+                const __m256 ey = _mm256_mul_ps(_mm256_sub_ps(rows[5], rows[1]), half);
+                const __m256 ez = _mm256_mul_ps(_mm256_sub_ps(rows[6], rows[2]), half);
+
+                __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                for(u32 p = 0; p < 6; p++)
+                {
+                    __m256 dist = _mm256_add_ps(_mm256_mul_ps(cx, nx[p]), d[p]);
+                    dist = _mm256_add_ps(dist, _mm256_mul_ps(cy, ny[p]));
+                    dist = _mm256_add_ps(dist, _mm256_mul_ps(cz, nz[p]));
+                    dist = _mm256_add_ps(dist, _mm256_mul_ps(ex, ax[p]));
+                    dist = _mm256_add_ps(dist, _mm256_mul_ps(ey, ay[p]));
+                    dist = _mm256_add_ps(dist, _mm256_mul_ps(ez, az[p]));
+                    visible = _mm256_and_ps(visible, _mm256_cmp_ps(dist, zero, _CMP_NLT_UQ));
+                }
+
+                outMasks[i / 8] = (u8)_mm256_movemask_ps(visible);
+            }
+
+            if(wideCount < count) CullBoundsScalar(bounds, first + wideCount, count - wideCount, frustum, outMasks);
+        }
+#else
+        void CullBoundsAVX2(const InstanceBoundsData* bounds, u32 first, u32 count, const Frustum& frustum, u8* outMasks)
+        {
+            CullBoundsScalar(bounds, first, count, frustum, outMasks);
+        }
+#endif
+
+        void CullBounds(const InstanceBoundsData* bounds, u32 first, u32 count, const Frustum& frustum, u8* outMasks)
+        {
+            if(SIMD::SupportsAVX2())
+            {
+                CullBoundsAVX2(bounds, first, count, frustum, outMasks);
+            }
+            else
+            {
+                CullBoundsScalar(bounds, first, count, frustum, outMasks);
+            }
+        }
+    }
+
+    u32 SelectLod(const MeshBoundsData& bounds, const glm::mat4& transform, const CullView& view)
+    {
+        if(bounds.lodCount <= 1) return 0;
+
+        const f32 maxScale = std::max(glm::length(glm::vec3(transform[0])), std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+        const glm::vec3 center = glm::vec3(transform * glm::vec4((bounds.boundsMin + bounds.boundsMax) * 0.5f, 1.f));
+        const f32 radius = glm::length(bounds.boundsMax - bounds.boundsMin) * 0.5f * maxScale;
+
+        const f32 distance = std::max(glm::length(center - view.cameraPosition) - radius, 0.f);
+        const f32 screenScale = std::abs(view.projectionScale) * 0.5f / std::max(distance, 0.0001f);
+
+        u32 lod = 0;
+        for(u32 i = 1; i < bounds.lodCount; i++)
+        {
+            if(bounds.lodErrors[i] * maxScale * screenScale > LOD_ERROR_THRESHOLD) break;
+            lod = i;
+        }
+        return lod;
+    }
+
+    void CPUCuller::Cull(const SceneData& scene, const CullView& view, IndirectDraw* outCommands, u32* outInstances, CulledDrawList& outList)
+    {
+        const u32 instanceCount = scene.instanceCount;
+        m_Masks.resize((instanceCount + 7) / 8);
+        m_Lods.resize(instanceCount);
+        const bool keepStatic = view.instanceFilter != CULL_DYNAMIC_INSTANCES;
+        const bool keepDynamic = view.instanceFilter != CULL_STATIC_INSTANCES;
+
+        const u32 batchCount = (instanceCount + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE;
+        JobSystem::Dispatch(batchCount, 1, [&](JobSystem::JobDispatchArgs args)
+            {
+                const u32 first = args.jobIndex * CULL_BATCH_SIZE;
+                const u32 count = std::min(CULL_BATCH_SIZE, instanceCount - first);
+                CullingKernels::CullBounds(scene.instanceBounds.data(), first, count, view.frustum, m_Masks.data());
+
+                for(u32 i = first; i < first + count; i++)
+                {
+                    const MeshDrawData& draw = scene.draws[i];
+                    const bool kept = draw.isDynamic ? keepDynamic : keepStatic;
+                    if((m_Masks[i / 8] & (1u << (i & 7u))) && !draw.isTransparent && kept)
+                    {
+                        m_Lods[i] = (u8)SelectLod(scene.meshBoundsData[draw.drawIndex], draw.transform, view);
+                    }
+                    else
+                    {
+                        m_Lods[i] = CULLED_LOD;
+                    }
+                }
+            }
+        );
+
+        JobSystem::Wait();
+
+        // visible instances per command, then a prefix sum over the commands that kept any gives each its instance range
+        m_CommandCursors.assign((u64)scene.drawCount * MAX_LOD_COUNT, 0);
+        m_VertexOffsets.resize(scene.drawCount);
+        for(u32 i = 0; i < instanceCount; i++)
+        {
+            const u32 drawIndex = scene.draws[i].drawIndex;
+            m_VertexOffsets[drawIndex] = (i32)scene.meshes[i].vertexOffset;
+            if(m_Lods[i] != CULLED_LOD) m_CommandCursors[drawIndex * MAX_LOD_COUNT + m_Lods[i]]++;
+        }
+
+        u32 commandCount = 0;
+        u32 firstInstance = 0;
+        auto emitCommands = [&](const DrawRange& draws, DrawRange& outRange)
+            {
+                outRange.first = commandCount;
+                for(u32 drawIndex = draws.first; drawIndex < draws.first + draws.count; drawIndex++)
+                {
+                    const MeshBoundsData& bounds = scene.meshBoundsData[drawIndex];
+                    for(u32 lod = 0; lod < MAX_LOD_COUNT; lod++)
+                    {
+                        u32& cursor = m_CommandCursors[drawIndex * MAX_LOD_COUNT + lod];
+                        if(cursor == 0) continue;
+
+                        IndirectDraw& command = outCommands[commandCount++];
+                        command.indexCount = bounds.lods[lod].indexCount;
+                        command.instanceCount = cursor;
+                        command.firstIndex = bounds.lods[lod].firstIndex;
+                        command.vertexOffset = m_VertexOffsets[drawIndex];
+                        command.firstInstance = firstInstance;
+
+                        firstInstance += cursor;
+                        cursor = command.firstInstance;
+                    }
+                }
+                outRange.count = commandCount - outRange.first;
+            };
+
+        for(u32 stream = 0; stream < DRAW_STREAM_COUNT; stream++)
+        {
+            outList.streams[stream] = DrawStream();
+            if(stream == BLENDED_STREAM) continue;
+
+            emitCommands(scene.streams[stream].shortRange, outList.streams[stream].shortRange);
+            emitCommands(scene.streams[stream].wideRange, outList.streams[stream].wideRange);
+        }
+
+        for(u32 i = 0; i < instanceCount; i++)
+        {
+            if(m_Lods[i] == CULLED_LOD) continue;
+            outInstances[m_CommandCursors[scene.draws[i].drawIndex * MAX_LOD_COUNT + m_Lods[i]]++] = i;
+        }
+
+        m_VisibleInstanceCount = firstInstance;
+    }
+
+    u32 CPUCuller::SortBlended(const SceneData& scene, const CullView& view)
+    {
+        m_Blended.clear();
+        m_BlendedInstanceCount = 0;
+        for(u32 i = 0; i < scene.instanceCount; i++)
+        {
+            const MeshDrawData& draw = scene.draws[i];
+            if(!draw.isTransparent) continue;
+
+            m_BlendedInstanceCount++;
+            const InstanceBoundsData& bounds = scene.instanceBounds[i];
+            if(!IsInsideFrustum(bounds, view.frustum)) continue;
+
+            const glm::vec3 offset = (bounds.boundsMin + bounds.boundsMax) * 0.5f - view.cameraPosition;
+
+            BlendedInstance blended;
+            blended.instance = i;
+            blended.lod = SelectLod(scene.meshBoundsData[draw.drawIndex], draw.transform, view);
+            blended.distance = glm::dot(offset, offset);
+            m_Blended.push_back(blended);
+        }
+
+        // ties go by instance so equally distant instances don't swap from one frame to the next
+        std::sort(m_Blended.begin(), m_Blended.end(), [](const BlendedInstance& a, const BlendedInstance& b)
+            {
+                return a.distance != b.distance ? a.distance > b.distance : a.instance < b.instance;
+            }
+        );
+
+        return (u32)m_Blended.size();
+    }
+
+    void CPUCuller::WriteBlended(const SceneData& scene, IndirectDraw* outCommands, u32* outInstances, CulledDrawList& outList) const
+    {
+        outList.blendedRuns.clear();
+        for(u32 c = 0; c < (u32)m_Blended.size(); c++)
+        {
+            const u32 instance = m_Blended[c].instance;
+            const u32 drawIndex = scene.draws[instance].drawIndex;
+            const MeshLodData& level = scene.meshBoundsData[drawIndex].lods[m_Blended[c].lod];
+
+            IndirectDraw& command = outCommands[c];
+            command.indexCount = level.indexCount;
+            command.instanceCount = 1;
+            command.firstIndex = level.firstIndex;
+            command.vertexOffset = (i32)scene.meshes[instance].vertexOffset;
+            command.firstInstance = c;
+            outInstances[c] = instance;
+
+            // the sorted order wins over batching, a run ends wherever the index width changes
+            const bool shortIndices = drawIndex < scene.shortIndexDrawCount;
+            if(outList.blendedRuns.empty() || outList.blendedRuns.back().shortIndices != shortIndices)
+            {
+                BlendedDrawRun run;
+                run.commands.first = c;
+                run.shortIndices = shortIndices;
+                outList.blendedRuns.push_back(run);
+            }
+            outList.blendedRuns.back().commands.count++;
+        }
+    }
+}
@@ -0,0 +1,242 @@
+#include "renderer/geometry_heap.hpp"
+#include "core/logger.hpp"
+#include "core/asserts.hpp"
+
+namespace Raw::GFX
+{
+    namespace
+    {
+        // reserved up front, an asset or draw list that doesn't fit in what's left fails to load instead of growing the buffers
+        constexpr u64 VERTEX_HEAP_SIZE = 256 * 1024 * 1024;
+        constexpr u64 SHORT_INDEX_HEAP_SIZE = 64 * 1024 * 1024;
+        constexpr u64 WIDE_INDEX_HEAP_SIZE = 192 * 1024 * 1024;
+        constexpr u64 MESHLET_HEAP_SIZE = 16 * 1024 * 1024;
+        constexpr u64 MESHLET_VERTEX_HEAP_SIZE = 64 * 1024 * 1024;
+        constexpr u64 MESHLET_TRIANGLE_HEAP_SIZE = 64 * 1024 * 1024;
+        // a rebuilt draw list is allocated before the one it replaces is released, so these hold two of the largest
+        constexpr u64 DRAW_HEAP_SIZE = 128 * 1024 * 1024;
+        constexpr u64 BOUNDS_HEAP_SIZE = 32 * 1024 * 1024;
+
+        BufferHandle CreateHeapBuffer(IGFXDevice* device, u64 size, u8 type)
+        {
+            BufferDesc desc;
+            desc.bufferSize = size;
+            desc.memoryType = EMemoryType::DEVICE_LOCAL;
+            desc.type = type;
+            return device->CreateBuffer(desc);
+        }
+
+        u32 ToBlocks(u64 size)
+        {
+            return (u32)((size + GeometryHeap::k_BlockSize - 1) / GeometryHeap::k_BlockSize);
+        }
+    }
+
+    static GeometryHeap s_GeometryHeap;
+
+    GeometryHeap* GeometryHeap::Instance()
+    {
+        return &s_GeometryHeap;
+    }
+
+    void GeometryHeap::Init(IGFXDevice* device)
+    {
+        const u32 vertexCapacity = (u32)(VERTEX_HEAP_SIZE / sizeof(SceneVertex));
+        const u32 shortIndexCapacity = (u32)(SHORT_INDEX_HEAP_SIZE / sizeof(u16));
+        const u32 wideIndexCapacity = (u32)(WIDE_INDEX_HEAP_SIZE / sizeof(u32));
+        const u32 meshletCapacity = (u32)(MESHLET_HEAP_SIZE / sizeof(MeshletData));
+        const u32 meshletVertexCapacity = (u32)(MESHLET_VERTEX_HEAP_SIZE / sizeof(u32));
+        const u32 meshletTriangleCapacity = (u32)(MESHLET_TRIANGLE_HEAP_SIZE / sizeof(u32));
+
+        m_Vertices.Init(vertexCapacity);
+        m_ShortIndices.Init(shortIndexCapacity);
+        m_WideIndices.Init(wideIndexCapacity);
+        m_Meshlets.Init(meshletCapacity);
+        m_MeshletVertices.Init(meshletVertexCapacity);
+        m_MeshletTriangles.Init(meshletTriangleCapacity);
+        m_Draws.Init(ToBlocks(DRAW_HEAP_SIZE));
+        m_Bounds.Init(ToBlocks(BOUNDS_HEAP_SIZE));
+
+        const u8 storage = EBufferType::STORAGE | EBufferType::TRANSFER_DST | EBufferType::SHADER_DEVICE_ADDRESS;
+        m_VertexBuffer = CreateHeapBuffer(device, (u64)vertexCapacity * sizeof(SceneVertex), EBufferType::VERTEX);
+        m_IndexBuffer = CreateHeapBuffer(device, GetWideIndexOffset() + (u64)wideIndexCapacity * sizeof(u32), EBufferType::INDEX);
+        m_MeshletBuffer = CreateHeapBuffer(device, (u64)meshletCapacity * sizeof(MeshletData), storage);
+        m_MeshletVertexBuffer = CreateHeapBuffer(device, (u64)meshletVertexCapacity * sizeof(u32), storage);
+        m_MeshletTriangleBuffer = CreateHeapBuffer(device, (u64)meshletTriangleCapacity * sizeof(u32), storage);
+        // draw lists hold indirect commands and, without mesh shaders, the expanded meshlet index buffer
+        m_DrawBuffer = CreateHeapBuffer(device, (u64)m_Draws.GetSize() * k_BlockSize, storage | EBufferType::INDIRECT | EBufferType::INDEX);
+        m_BoundsBuffer = CreateHeapBuffer(device, (u64)m_Bounds.GetSize() * k_BlockSize, storage);
+
+        m_PendingRemovals.clear();
+        m_Frame = 0;
+        m_Initialized = true;
+
+        RAW_INFO("GeometryHeap created with room for %u vertices, %u 16 bit and %u 32 bit indices, %u meshlets.", vertexCapacity, shortIndexCapacity, wideIndexCapacity, meshletCapacity);
+    }
+
+    void GeometryHeap::Shutdown(IGFXDevice* device)
+    {
+        if(!m_Initialized) return;
+
+        // the device waits for idle before it destroys anything, so whatever is still pending can go now
+        for(const PendingRemoval& removal : m_PendingRemovals) removal.allocator->Free(removal.allocation);
+        m_PendingRemovals.clear();
+
+        m_Vertices.Shutdown();
+        m_ShortIndices.Shutdown();
+        m_WideIndices.Shutdown();
+        m_Meshlets.Shutdown();
+        m_MeshletVertices.Shutdown();
+        m_MeshletTriangles.Shutdown();
+        m_Draws.Shutdown();
+        m_Bounds.Shutdown();
+
+        device->DestroyBuffer(m_VertexBuffer);
+        device->DestroyBuffer(m_IndexBuffer);
+        device->DestroyBuffer(m_MeshletBuffer);
+        device->DestroyBuffer(m_MeshletVertexBuffer);
+        device->DestroyBuffer(m_MeshletTriangleBuffer);
+        device->DestroyBuffer(m_DrawBuffer);
+        device->DestroyBuffer(m_BoundsBuffer);
+        m_Initialized = false;
+    }
+
+    void GeometryHeap::BeginFrame()
+    {
+        m_Frame++;
+
+        // a frame that read the ranges was recorded at most MAX_SWAPCHAIN_IMAGES frames before this one
+        u64 kept = 0;
+        for(u64 i = 0; i < m_PendingRemovals.size(); i++)
+        {
+            if(m_Frame > m_PendingRemovals[i].frame + MAX_SWAPCHAIN_IMAGES)
+            {
+                m_PendingRemovals[i].allocator->Free(m_PendingRemovals[i].allocation);
+            }
+            else
+            {
+                m_PendingRemovals[kept++] = m_PendingRemovals[i];
+            }
+        }
+        m_PendingRemovals.resize(kept);
+    }
+
+    bool GeometryHeap::Add(IGFXDevice* device, const SceneVertex* vertices, u32 vertexCount, const u8* indices, u64 wideIndexOffset, u64 indexSize, GeometryAllocation& outAllocation)
+    {
+        RAW_ASSERT_MSG(m_Initialized, "GeometryHeap used before it was initialized!");
+        RAW_ASSERT((wideIndexOffset & 3) == 0 && wideIndexOffset <= indexSize);
+
+        const u32 shortIndexCount = (u32)(wideIndexOffset / sizeof(u16));
+        const u32 wideIndexCount = (u32)((indexSize - wideIndexOffset) / sizeof(u32));
+
+        outAllocation = GeometryAllocation();
+        if(!m_Vertices.Allocate(vertexCount, outAllocation.vertices) ||
+            !m_ShortIndices.Allocate(shortIndexCount, outAllocation.shortIndices) ||
+            !m_WideIndices.Allocate(wideIndexCount, outAllocation.wideIndices))
+        {
+            RAW_ERROR("GeometryHeap is out of space for %u vertices, %u 16 bit and %u 32 bit indices. Largest free ranges: %u, %u, %u.",
+                vertexCount, shortIndexCount, wideIndexCount,
+                m_Vertices.GetLargestFreeRange(), m_ShortIndices.GetLargestFreeRange(), m_WideIndices.GetLargestFreeRange());
+            m_Vertices.Free(outAllocation.vertices);
+            m_ShortIndices.Free(outAllocation.shortIndices);
+            m_WideIndices.Free(outAllocation.wideIndices);
+            outAllocation = GeometryAllocation();
+            return false;
+        }
+
+        device->UploadBufferData(m_VertexBuffer, (u64)outAllocation.vertices.offset * sizeof(SceneVertex), vertices, (u64)vertexCount * sizeof(SceneVertex));
+        device->UploadBufferData(m_IndexBuffer, (u64)outAllocation.shortIndices.offset * sizeof(u16), indices, (u64)shortIndexCount * sizeof(u16));
+        device->UploadBufferData(m_IndexBuffer, GetWideIndexOffset() + (u64)outAllocation.wideIndices.offset * sizeof(u32),
+            indices + wideIndexOffset, (u64)wideIndexCount * sizeof(u32));
+
+        return true;
+    }
+
+    bool GeometryHeap::AddMeshlets(IGFXDevice* device, const MeshletData* meshlets, u32 meshletCount, const u32* vertices, u32 vertexCount,
+        const u32* triangles, u32 triangleCount, GeometryAllocation& outAllocation)
+    {
+        RAW_ASSERT_MSG(m_Initialized, "GeometryHeap used before it was initialized!");
+
+        outAllocation.meshlets = OffsetAllocation();
+        outAllocation.meshletVertices = OffsetAllocation();
+        outAllocation.meshletTriangles = OffsetAllocation();
+        if(!m_Meshlets.Allocate(meshletCount, outAllocation.meshlets) ||
+            !m_MeshletVertices.Allocate(vertexCount, outAllocation.meshletVertices) ||
+            !m_MeshletTriangles.Allocate(triangleCount, outAllocation.meshletTriangles))
+        {
+            RAW_ERROR("GeometryHeap is out of space for %u meshlets with %u vertices and %u triangles. Largest free ranges: %u, %u, %u.",
+                meshletCount, vertexCount, triangleCount,
+                m_Meshlets.GetLargestFreeRange(), m_MeshletVertices.GetLargestFreeRange(), m_MeshletTriangles.GetLargestFreeRange());
+            m_Meshlets.Free(outAllocation.meshlets);
+            m_MeshletVertices.Free(outAllocation.meshletVertices);
+            m_MeshletTriangles.Free(outAllocation.meshletTriangles);
+            outAllocation.meshlets = OffsetAllocation();
+            outAllocation.meshletVertices = OffsetAllocation();
+            outAllocation.meshletTriangles = OffsetAllocation();
+            return false;
+        }
+
+        // meshlets address the heaps directly rather than through a draw's offsets
+        std::vector<MeshletData> rebasedMeshlets(meshlets, meshlets + meshletCount);
+        for(MeshletData& meshlet : rebasedMeshlets)
+        {
+            meshlet.vertexOffset += outAllocation.meshletVertices.offset;
+            meshlet.triangleOffset += outAllocation.meshletTriangles.offset;
+        }
+
+        std::vector<u32> rebasedVertices(vertices, vertices + vertexCount);
+        for(u32& vertex : rebasedVertices) vertex += outAllocation.vertices.offset;
+
+        device->UploadBufferData(m_MeshletBuffer, (u64)outAllocation.meshlets.offset * sizeof(MeshletData), rebasedMeshlets.data(), (u64)meshletCount * sizeof(MeshletData));
+        device->UploadBufferData(m_MeshletVertexBuffer, (u64)outAllocation.meshletVertices.offset * sizeof(u32), rebasedVertices.data(), (u64)vertexCount * sizeof(u32));
+        device->UploadBufferData(m_MeshletTriangleBuffer, (u64)outAllocation.meshletTriangles.offset * sizeof(u32), triangles, (u64)triangleCount * sizeof(u32));
+
+        return true;
+    }
+
+    void GeometryHeap::Remove(const GeometryAllocation& allocation)
+    {
+        Defer(m_Vertices, allocation.vertices);
+        Defer(m_ShortIndices, allocation.shortIndices);
+        Defer(m_WideIndices, allocation.wideIndices);
+        Defer(m_Meshlets, allocation.meshlets);
+        Defer(m_MeshletVertices, allocation.meshletVertices);
+        Defer(m_MeshletTriangles, allocation.meshletTriangles);
+    }
+
+    bool GeometryHeap::AddDrawList(u64 drawSize, u64 boundsSize, DrawListAllocation& outAllocation)
+    {
+        RAW_ASSERT_MSG(m_Initialized, "GeometryHeap used before it was initialized!");
+
+        outAllocation = DrawListAllocation();
+        if(!m_Draws.Allocate(ToBlocks(drawSize), outAllocation.draws) ||
+            !m_Bounds.Allocate(ToBlocks(boundsSize), outAllocation.bounds))
+        {
+            RAW_ERROR("GeometryHeap is out of space for a draw list of %llu draw and %llu bounds bytes. Largest free ranges: %llu, %llu bytes.",
+                drawSize, boundsSize, (u64)m_Draws.GetLargestFreeRange() * k_BlockSize, (u64)m_Bounds.GetLargestFreeRange() * k_BlockSize);
+            m_Draws.Free(outAllocation.draws);
+            m_Bounds.Free(outAllocation.bounds);
+            outAllocation = DrawListAllocation();
+            return false;
+        }
+
+        return true;
+    }
+
+    void GeometryHeap::Remove(const DrawListAllocation& allocation)
+    {
+        Defer(m_Draws, allocation.draws);
+        Defer(m_Bounds, allocation.bounds);
+    }
+
+    void GeometryHeap::Defer(OffsetAllocator& allocator, const OffsetAllocation& allocation)
+    {
+        if(!allocation.IsValid()) return;
+
+        PendingRemoval removal;
+        removal.allocator = &allocator;
+        removal.allocation = allocation;
+        removal.frame = m_Frame;
+        m_PendingRemovals.push_back(removal);
+    }
+}
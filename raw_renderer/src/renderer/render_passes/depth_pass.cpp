@@ -36,8 +36,8 @@ namespace Raw::GFX
 
         cmd->BindVertexBuffer(scene->vertexBuffer);
         cmd->BindDrawData(scene->meshDrawsBuffer);
-        cmd->BindIndexBuffer(scene->indexBuffer);
-        cmd->DrawIndexedIndirect(scene->indirectBuffer, 0, scene->drawCount);
+        cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+        DrawSceneIndexedIndirect(cmd, scene, scene->indirectBuffer, OPAQUE_STREAM);
 
         cmd->EndRendering();
         cmd->AddMemoryBarrier(
@@ -58,8 +58,8 @@ namespace Raw::GFX
 
                 cmd->BindVertexBuffer(scene->vertexBuffer);
                 cmd->BindDrawData(scene->meshDrawsBuffer);
-                cmd->BindIndexBuffer(scene->indexBuffer);
-                cmd->DrawIndexedIndirect(scene->indirectBuffer, 0, scene->drawCount);
+                cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+                DrawSceneIndexedIndirect(cmd, scene, scene->indirectBuffer, OPAQUE_STREAM);
 
                 cmd->EndRendering();
                 cmd->AddMemoryBarrier(
@@ -0,0 +1,149 @@
+#include "renderer/render_passes/depth_pyramid_pass.hpp"
+#include "core/servicelocator.hpp"
+#include "events/event_manager.hpp"
+#include "core/job_system.hpp"
+#include <algorithm>
+
+namespace Raw::GFX
+{
+    namespace
+    {
+        // each workgroup reduces a 32x32 tile of the first level
+        constexpr u32 PYRAMID_TILE_SIZE = 32;
+
+        u32 PreviousPowerOfTwo(u32 value)
+        {
+            u32 result = 1;
+            while(result * 2 <= value) result *= 2;
+            return result;
+        }
+    }
+
+    void DepthPyramidPass::Init(IGFXDevice* device)
+    {
+        m_ResizeHandler = BIND_EVENT_FN(DepthPyramidPass::OnWindowResize);
+        EventManager::Get()->Subscribe(EVENT_HANDLER_PTR(m_ResizeHandler, WindowResizeEvent), WindowResizeEvent::GetStaticEventType());
+
+        std::pair<u32, u32> windowSize = device->GetBackBufferSize();
+        CreateMips(device, windowSize.first, windowSize.second);
+
+        // zeroed once, the last workgroup of every build puts it back to zero
+        u32 counter = 0;
+        BufferDesc counterDesc;
+        counterDesc.bufferSize = sizeof(u32);
+        counterDesc.memoryType = EMemoryType::DEVICE_LOCAL;
+        counterDesc.type = EBufferType::STORAGE | EBufferType::TRANSFER_DST | EBufferType::SHADER_DEVICE_ADDRESS;
+        m_CounterBuffer = device->CreateBuffer(counterDesc);
+        device->UploadBufferData(m_CounterBuffer, 0, &counter, sizeof(u32));
+
+        techniqueDesc.computeShader.shaderName = "depth_pyramid";
+        techniqueDesc.computeShader.stage = EShaderStage::COMPUTE_STAGE;
+
+        techniqueDesc.pushConstant.offset = 0;
+        techniqueDesc.pushConstant.size = 128;
+        techniqueDesc.pushConstant.stage = EShaderStage::COMPUTE_STAGE;
+
+        techniqueDesc.name = "Depth Pyramid Pass";
+
+        technique.computePipeline = device->CreateComputePipeline(techniqueDesc);
+    }
+
+    void DepthPyramidPass::Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
+    {
+        RecordPyramid(device, cmd);
+    }
+
+    void DepthPyramidPass::ExecuteAsync(IGFXDevice* device, SceneData* scene)
+    {
+        JobSystem::Execute([&]()
+            {
+                ICommandBuffer* cmd = device->GetCommandBuffer();
+                cmd->BeginCommandBuffer();
+
+                RecordPyramid(device, cmd);
+
+                device->SubmitCommandBuffer(cmd);
+            }
+        );
+    }
+
+    void DepthPyramidPass::Shutdown(IGFXDevice* device)
+    {
+        DestroyMips(device);
+        device->DestroyBuffer(m_CounterBuffer);
+    }
+
+    void DepthPyramidPass::RecordPyramid(IGFXDevice* device, ICommandBuffer* cmd)
+    {
+        // the depth buffer is recreated with the swapchain, so its handle is looked up every build
+        TextureHandle& depthBuffer = device->GetDepthBufferHandle();
+        std::pair<u32, u32> depthSize = device->GetBackBufferSize();
+
+        cmd->TransitionImage(depthBuffer, ETextureLayout::SHADER_READ_ONLY_OPTIMAL);
+        for(u32 i = 0; i < m_Pyramid.mipCount; i++) cmd->TransitionImage(m_Mips[i], ETextureLayout::GENERAL);
+
+        DepthPyramidBuildData buildData;
+        buildData.pyramid = m_Pyramid;
+        buildData.depthBuffer = depthBuffer.id;
+        buildData.depthWidth = depthSize.first;
+        buildData.depthHeight = depthSize.second;
+        buildData.counterBuffer = m_CounterBuffer;
+
+        u32 groupX = (m_Pyramid.width + PYRAMID_TILE_SIZE - 1) / PYRAMID_TILE_SIZE;
+        u32 groupY = (m_Pyramid.height + PYRAMID_TILE_SIZE - 1) / PYRAMID_TILE_SIZE;
+        u32 groupZ = 1;
+        buildData.workGroupCount = groupX * groupY;
+
+        cmd->BindComputePipeline(technique.computePipeline);
+        cmd->BindDepthPyramidData(buildData);
+        cmd->Dispatch(technique.computePipeline, groupX, groupY, groupZ);
+
+        cmd->AddMemoryBarrier(
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EAccessFlags::SHADER_READ_BIT, 
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+    }
+
+    void DepthPyramidPass::CreateMips(IGFXDevice* device, u32 depthWidth, u32 depthHeight)
+    {
+        m_Pyramid = DepthPyramidData();
+        m_Pyramid.width = PreviousPowerOfTwo(std::max(depthWidth, 1u));
+        m_Pyramid.height = PreviousPowerOfTwo(std::max(depthHeight, 1u));
+
+        // down to a single texel, or as far as the push constants have room for
+        u32 largest = std::max(m_Pyramid.width, m_Pyramid.height);
+        while(m_Pyramid.mipCount < MAX_DEPTH_PYRAMID_MIPS && (largest >> m_Pyramid.mipCount) > 0) m_Pyramid.mipCount++;
+
+        TextureDesc mipDesc;
+        mipDesc.depth = 1;
+        mipDesc.isMipmapped = false;
+        mipDesc.isStorageImage = true;
+        mipDesc.isSampledImage = false;
+        mipDesc.type = ETextureType::TEXTURE2D;
+        mipDesc.format = ETextureFormat::R32G32_SFLOAT;
+        for(u32 i = 0; i < m_Pyramid.mipCount; i++)
+        {
+            mipDesc.width = std::max(m_Pyramid.width >> i, 1u);
+            mipDesc.height = std::max(m_Pyramid.height >> i, 1u);
+            m_Mips[i] = device->CreateTexture(mipDesc);
+            m_Pyramid.mips[i] = m_Mips[i].id;
+        }
+    }
+
+    void DepthPyramidPass::DestroyMips(IGFXDevice* device)
+    {
+        for(u32 i = 0; i < m_Pyramid.mipCount; i++) device->DestroyTexture(m_Mips[i]);
+        m_Pyramid.mipCount = 0;
+    }
+
+    bool DepthPyramidPass::OnWindowResize(const WindowResizeEvent& e)
+    {
+        IGFXDevice* device = (IGFXDevice*)ServiceLocator::Get()->GetService(IGFXDevice::k_ServiceName);
+
+        DestroyMips(device);
+        CreateMips(device, e.GetWidth(), e.GetHeight());
+
+        return false;
+    }
+}
@@ -64,28 +64,37 @@ namespace Raw::GFX
 
         cmd->BindVertexBuffer(scene->vertexBuffer);
         cmd->BindDrawData(scene->meshDrawsBuffer);
-        cmd->BindIndexBuffer(scene->indexBuffer);
+        cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+
+        // the index buffer is only rebound when a mesh's index width differs from the previous one
+        i32 boundShortIndices = -1;
+        auto drawMesh = [&](u32 i)
+            {
+                const MeshData& mesh = scene->meshes[i];
+                const i32 shortIndices = scene->draws[i].drawIndex < scene->shortIndexDrawCount ? 1 : 0;
+                if(shortIndices != boundShortIndices)
+                {
+                    if(shortIndices)    cmd->BindIndexBuffer(scene->indexBuffer, 0, EIndexType::UINT16);
+                    else                cmd->BindIndexBuffer(scene->indexBuffer, scene->wideIndexOffset, EIndexType::UINT32);
+                    boundShortIndices = shortIndices;
+                }
+                cmd->DrawIndexed(mesh.indexCount, mesh.instanceCount, mesh.firstIndex, mesh.vertexOffset, mesh.baseInstance);
+            };
 
         for(u32 i = 0; i < scene->meshes.size(); i++)
         {
-            MeshData mesh = scene->meshes[i];
-            glm::mat4 meshTransform = scene->transforms[mesh.transformIndex];
-            PBRMaterialData material = scene->materials[mesh.materialIndex];
+            PBRMaterialData material = scene->materials[scene->meshes[i].materialIndex];
             if(material.isTransparent) continue;
 
-            cmd->DrawIndexed(mesh.indexCount, mesh.instanceCount, mesh.firstIndex, mesh.vertexOffset, mesh.baseInstance);
-            //cmd->DrawIndexedIndirect(scene->indirectBuffer, 0, scene->drawCount);
+            drawMesh(i);
         }
 
         for(u32 i = 0; i < scene->meshes.size(); i++)
         {
-            MeshData mesh = scene->meshes[i];
-            glm::mat4 meshTransform = scene->transforms[mesh.transformIndex];
-            PBRMaterialData material = scene->materials[mesh.materialIndex];
+            PBRMaterialData material = scene->materials[scene->meshes[i].materialIndex];
             if(!material.isTransparent) continue;
 
-            cmd->DrawIndexed(mesh.indexCount, mesh.instanceCount, mesh.firstIndex, mesh.vertexOffset, mesh.baseInstance);
-            //cmd->DrawIndexedIndirect(scene->indirectBuffer, 0, scene->drawCount);
+            drawMesh(i);
         }
 
         cmd->EndRendering();
@@ -103,8 +112,8 @@ namespace Raw::GFX
 
                 cmd->BindVertexBuffer(scene->vertexBuffer);
                 cmd->BindDrawData(scene->meshDrawsBuffer);
-                cmd->BindIndexBuffer(scene->indexBuffer);
-                cmd->DrawIndexedIndirect(scene->indirectBuffer, 0, scene->drawCount);
+                cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+                for(u32 stream = 0; stream < DRAW_STREAM_COUNT; stream++) DrawSceneIndexedIndirect(cmd, scene, scene->indirectBuffer, (EDrawStream)stream);
 
                 cmd->EndRendering();
 
@@ -4,6 +4,7 @@
 #include "resources/texture_loader.hpp"
 #include "events/event_manager.hpp"
 #include "core/job_system.hpp"
+#include <algorithm>
 
 namespace Raw::GFX
 {
@@ -19,62 +20,566 @@ namespace Raw::GFX
         techniqueDesc.name = "Frustum Culling Pass";
 
         technique.computePipeline = device->CreateComputePipeline(techniqueDesc);
+
+        if(!device->SupportsMeshShaders())
+        {
+            meshletTechniqueDesc.computeShader.shaderName = "meshlet_culling";
+            meshletTechniqueDesc.computeShader.stage = EShaderStage::COMPUTE_STAGE;
+
+            meshletTechniqueDesc.pushConstant.offset = 0;
+            meshletTechniqueDesc.pushConstant.size = 128;
+            meshletTechniqueDesc.pushConstant.stage = EShaderStage::COMPUTE_STAGE;
+
+            meshletTechniqueDesc.name = "Meshlet Culling Pass";
+
+            meshletTechnique.computePipeline = device->CreateComputePipeline(meshletTechniqueDesc);
+        }
+
+        if(device->SupportsDrawIndirectCount())
+        {
+            compactionTechniqueDesc.computeShader.shaderName = "draw_compaction";
+            compactionTechniqueDesc.computeShader.stage = EShaderStage::COMPUTE_STAGE;
+
+            compactionTechniqueDesc.pushConstant.offset = 0;
+            compactionTechniqueDesc.pushConstant.size = 128;
+            compactionTechniqueDesc.pushConstant.stage = EShaderStage::COMPUTE_STAGE;
+
+            compactionTechniqueDesc.name = "Draw Compaction Pass";
+
+            compactionTechnique.computePipeline = device->CreateComputePipeline(compactionTechniqueDesc);
+        }
+
+        occlusionTechniqueDesc.computeShader.shaderName = "occlusion_culling";
+        occlusionTechniqueDesc.computeShader.stage = EShaderStage::COMPUTE_STAGE;
+
+        occlusionTechniqueDesc.pushConstant.offset = 0;
+        occlusionTechniqueDesc.pushConstant.size = 128;
+        occlusionTechniqueDesc.pushConstant.stage = EShaderStage::COMPUTE_STAGE;
+
+        occlusionTechniqueDesc.name = "Occlusion Culling Pass";
+
+        occlusionTechnique.computePipeline = device->CreateComputePipeline(occlusionTechniqueDesc);
     }
 
     void FrustumCullingPass::Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
     {
-        cmd->AddMemoryBarrier(scene->culledIndirectBuffer, 
+        if(useCPUCulling)
+        {
+            CullOnCPU(device, scene);
+        }
+        else
+        {
+            ReserveCompactionBuffers(device, scene->drawCount * MAX_LOD_COUNT);
+            ReserveCascadeBuffers(device, scene->drawCount * MAX_LOD_COUNT, scene->instanceCount * MAX_LOD_COUNT);
+            RecordViews(cmd, scene);
+        }
+        SortBlended(device, scene);
+        RecordMeshletCulling(device, cmd, scene, useOcclusionCulling ? EARLY_CULL_PHASE : ALL_INSTANCES_PHASE);
+    }
+
+    void FrustumCullingPass::ExecuteAsync(IGFXDevice* device, SceneData* scene)
+    {
+        // cpu culling waits on its own jobs, so it can't run from inside one
+        if(useCPUCulling)
+        {
+            CullOnCPU(device, scene);
+        }
+        else
+        {
+            ReserveCompactionBuffers(device, scene->drawCount * MAX_LOD_COUNT);
+            ReserveCascadeBuffers(device, scene->drawCount * MAX_LOD_COUNT, scene->instanceCount * MAX_LOD_COUNT);
+        }
+        SortBlended(device, scene);
+
+        JobSystem::Execute([&]()
+            {
+                ICommandBuffer* cmd = device->GetCommandBuffer();
+                cmd->BeginCommandBuffer();
+
+                if(!useCPUCulling) RecordViews(cmd, scene);
+                RecordMeshletCulling(device, cmd, scene, useOcclusionCulling ? EARLY_CULL_PHASE : ALL_INSTANCES_PHASE);
+
+                device->SubmitCommandBuffer(cmd);
+            }
+        );
+    }
+
+    void FrustumCullingPass::ExecuteLate(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
+    {
+        if(!useOcclusionCulling || scene->meshletTaskCount == 0) return;
+
+        RecordOcclusionCulling(device, cmd, scene);
+        RecordMeshletCulling(device, cmd, scene, LATE_CULL_PHASE);
+    }
+
+    void FrustumCullingPass::Shutdown(IGFXDevice* device)
+    {
+        DestroyHostBuffers(device, m_CPUBuffers);
+        DestroyHostBuffers(device, m_BlendedBuffers);
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            DestroyHostBuffers(device, m_CPUCascadeBuffers[i]);
+            DestroyHostBuffers(device, m_CPUCascadeStaticBuffers[i]);
+        }
+        DestroyCascadeBuffers(device);
+        if(m_CompactedCapacity > 0)
+        {
+            device->DestroyBuffer(m_CompactedIndirectBuffer);
+            device->DestroyBuffer(m_DrawCountBuffer);
+            m_CompactedCapacity = 0;
+        }
+    }
+
+    void FrustumCullingPass::RecordViews(ICommandBuffer* cmd, SceneData* scene)
+    {
+        DeviceDrawBuffers cameraBuffers;
+        cameraBuffers.indirectBuffer = scene->culledIndirectBuffer;
+        cameraBuffers.instanceBuffer = scene->visibleInstancesBuffer;
+        cameraBuffers.compactedIndirectBuffer = m_CompactedIndirectBuffer;
+        cameraBuffers.drawCountBuffer = m_DrawCountBuffer;
+        RecordCulling(cmd, scene, cameraBuffers, CAMERA_CULL_VIEW, CULL_ALL_INSTANCES, scene->culledDraws);
+
+        // the shadow pass only draws the lists culled here, the rest keep whatever they held
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            const u32 view = CAMERA_CULL_VIEW + 1 + i;
+            if(scene->cascadeRebuildMask & (1u << i)) RecordCulling(cmd, scene, m_CascadeStaticBuffers[i], view, CULL_STATIC_INSTANCES, scene->cascadeStaticDraws[i]);
+            if(scene->dynamicInstanceCount > 0) RecordCulling(cmd, scene, m_CascadeBuffers[i], view, CULL_DYNAMIC_INSTANCES, scene->cascadeDraws[i]);
+        }
+    }
+
+    void FrustumCullingPass::RecordCulling(ICommandBuffer* cmd, SceneData* scene, const DeviceDrawBuffers& buffers, u32 view, u32 instanceFilter, CulledDrawList& outList)
+    {
+        if(scene->drawCount == 0) return;
+
+        // every draw keeps MAX_LOD_COUNT commands, empty ones included, and each level reads its own instance range.
+        // blended draws get commands too but are drawn from the sorted list instead
+        outList.indirectBuffer = buffers.indirectBuffer;
+        outList.instanceBuffer = buffers.instanceBuffer;
+        outList.drawCountBuffer = BufferHandle();
+        const bool compact = compactionTechnique.computePipeline.IsValid();
+        for(u32 stream = 0; stream < DRAW_STREAM_COUNT; stream++)
+        {
+            DrawStream& commands = outList.streams[stream];
+            commands = DrawStream();
+            if(stream == BLENDED_STREAM) continue;
+
+            const DrawStream& draws = scene->streams[stream];
+            commands.shortRange.first = draws.shortRange.first * MAX_LOD_COUNT;
+            commands.shortRange.count = draws.shortRange.count * MAX_LOD_COUNT;
+            commands.wideRange.first = draws.wideRange.first * MAX_LOD_COUNT;
+            commands.wideRange.count = draws.wideRange.count * MAX_LOD_COUNT;
+        }
+
+        // instance counts are rebuilt with atomics every frame, the rest of each command is rewritten by the shader.
+        // with compaction last frame's commands were read by the compaction pass rather than the draws
+        if(compact)
+        {
+            cmd->AddMemoryBarrier(buffers.indirectBuffer, 
+                EAccessFlags::SHADER_READ_BIT, 
+                EAccessFlags::TRANSFER_WRITE_BIT, 
+                EPipelineStageFlags::COMPUTE_SHADER_BIT,
+                EPipelineStageFlags::TRANSFER_BIT);
+        }
+        else
+        {
+            cmd->AddMemoryBarrier(buffers.indirectBuffer, 
+                EAccessFlags::INDIRECT_COMMAND_READ_BIT, 
+                EAccessFlags::TRANSFER_WRITE_BIT, 
+                EPipelineStageFlags::DRAW_INDIRECT_BIT,
+                EPipelineStageFlags::TRANSFER_BIT);
+        }
+
+        cmd->FillBuffer(buffers.indirectBuffer, 0, scene->drawCount * MAX_LOD_COUNT * sizeof(IndirectDraw), 0);
+
+        cmd->AddMemoryBarrier(buffers.indirectBuffer, 
+            EAccessFlags::TRANSFER_WRITE_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EPipelineStageFlags::TRANSFER_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        cmd->AddMemoryBarrier(buffers.instanceBuffer, 
             EAccessFlags::SHADER_READ_BIT, 
             EAccessFlags::SHADER_WRITE_BIT, 
-            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::VERTEX_SHADER_BIT,
             EPipelineStageFlags::COMPUTE_SHADER_BIT);
 
         cmd->BindComputePipeline(technique.computePipeline);
-        cmd->BindCullData(scene->indirectBuffer, scene->meshBoundsBuffer, scene->culledIndirectBuffer, scene->drawCount);
+        cmd->BindCullData(scene->indirectBuffer, scene->meshBoundsBuffer, scene->instanceBoundsBuffer, scene->meshDrawsBuffer, buffers.indirectBuffer, buffers.instanceBuffer, scene->instanceCount, view, instanceFilter);
 
         u32 workGroupSize = 32;
-        u32 groupX = (scene->drawCount + workGroupSize - 1) / workGroupSize;
+        u32 groupX = (scene->instanceCount + workGroupSize - 1) / workGroupSize;
         u32 groupY = 1;
         u32 groupZ = 1;
         cmd->Dispatch(technique.computePipeline, groupX, groupY, groupZ);
 
-        cmd->AddMemoryBarrier(scene->culledIndirectBuffer, 
+        cmd->AddMemoryBarrier(buffers.instanceBuffer, 
             EAccessFlags::SHADER_WRITE_BIT, 
             EAccessFlags::SHADER_READ_BIT, 
             EPipelineStageFlags::COMPUTE_SHADER_BIT,
             EPipelineStageFlags::VERTEX_SHADER_BIT);
+
+        if(compact)
+        {
+            RecordCompaction(cmd, scene, buffers, outList);
+        }
+        else
+        {
+            cmd->AddMemoryBarrier(buffers.indirectBuffer, 
+                EAccessFlags::SHADER_WRITE_BIT, 
+                EAccessFlags::INDIRECT_COMMAND_READ_BIT, 
+                EPipelineStageFlags::COMPUTE_SHADER_BIT,
+                EPipelineStageFlags::DRAW_INDIRECT_BIT);
+        }
     }
 
-    void FrustumCullingPass::ExecuteAsync(IGFXDevice* device, SceneData* scene)
+    void FrustumCullingPass::RecordCompaction(ICommandBuffer* cmd, SceneData* scene, const DeviceDrawBuffers& buffers, CulledDrawList& outList)
     {
-        JobSystem::Execute([&]()
+        const u32 commandCount = scene->drawCount * MAX_LOD_COUNT;
+
+        // final instance counts only exist once every instance was culled, so packing is its own dispatch
+        cmd->AddMemoryBarrier(buffers.indirectBuffer, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EAccessFlags::SHADER_READ_BIT, 
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        cmd->AddMemoryBarrier(buffers.drawCountBuffer, 
+            EAccessFlags::INDIRECT_COMMAND_READ_BIT, 
+            EAccessFlags::TRANSFER_WRITE_BIT, 
+            EPipelineStageFlags::DRAW_INDIRECT_BIT,
+            EPipelineStageFlags::TRANSFER_BIT);
+
+        cmd->FillBuffer(buffers.drawCountBuffer, 0, DRAW_STREAM_COUNT * 2 * sizeof(u32), 0);
+
+        cmd->AddMemoryBarrier(buffers.drawCountBuffer, 
+            EAccessFlags::TRANSFER_WRITE_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EPipelineStageFlags::TRANSFER_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        cmd->AddMemoryBarrier(buffers.compactedIndirectBuffer, 
+            EAccessFlags::INDIRECT_COMMAND_READ_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EPipelineStageFlags::DRAW_INDIRECT_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        DrawCompactionData compactionData;
+        compactionData.commandBuffer = buffers.indirectBuffer;
+        compactionData.compactedCommandBuffer = buffers.compactedIndirectBuffer;
+        compactionData.drawCountBuffer = buffers.drawCountBuffer;
+        compactionData.commandCount = commandCount;
+        for(u32 stream = 0; stream < DRAW_STREAM_COUNT; stream++)
+        {
+            compactionData.streams[stream] = outList.streams[stream];
+        }
+
+        cmd->BindComputePipeline(compactionTechnique.computePipeline);
+        cmd->BindDrawCompactionData(compactionData);
+
+        u32 workGroupSize = 64;
+        u32 groupX = (commandCount + workGroupSize - 1) / workGroupSize;
+        u32 groupY = 1;
+        u32 groupZ = 1;
+        cmd->Dispatch(compactionTechnique.computePipeline, groupX, groupY, groupZ);
+
+        cmd->AddMemoryBarrier(buffers.compactedIndirectBuffer, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EAccessFlags::INDIRECT_COMMAND_READ_BIT, 
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::DRAW_INDIRECT_BIT);
+
+        cmd->AddMemoryBarrier(buffers.drawCountBuffer, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EAccessFlags::INDIRECT_COMMAND_READ_BIT, 
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::DRAW_INDIRECT_BIT);
+
+        // ranges keep their place in the compacted buffer, each is drawn up to its count
+        outList.indirectBuffer = buffers.compactedIndirectBuffer;
+        outList.drawCountBuffer = buffers.drawCountBuffer;
+    }
+
+    void FrustumCullingPass::CullOnCPU(IGFXDevice* device, SceneData* scene)
+    {
+        if(scene->drawCount == 0) return;
+
+        ReserveHostBuffers(device, m_CPUBuffers, scene->drawCount * MAX_LOD_COUNT, scene->instanceCount);
+
+        // the frame's fence has signaled by now, so its buffers are free. host writes made before the submit
+        // are visible to the draws without a barrier
+        const u32 frame = device->GetCurrentFrameIndex();
+
+        auto cullCasters = [&](HostDrawBuffers& buffers, const CullView& view, u32 instanceFilter, CulledDrawList& outList)
             {
-                ICommandBuffer* cmd = device->GetCommandBuffer();
-                cmd->BeginCommandBuffer();
+                ReserveHostBuffers(device, buffers, scene->drawCount * MAX_LOD_COUNT, scene->instanceCount);
 
-                cmd->AddMemoryBarrier(scene->culledIndirectBuffer, 
-                    EAccessFlags::SHADER_READ_BIT, 
-                    EAccessFlags::SHADER_WRITE_BIT, 
-                    EPipelineStageFlags::COMPUTE_SHADER_BIT,
-                    EPipelineStageFlags::COMPUTE_SHADER_BIT);
+                IndirectDraw* casterCommands = (IndirectDraw*)device->GetMappedData(buffers.indirectBuffers[frame]);
+                u32* casterInstances = (u32*)device->GetMappedData(buffers.instanceBuffers[frame]);
 
-                cmd->BindComputePipeline(technique.computePipeline);
-                cmd->BindCullData(scene->indirectBuffer, scene->meshBoundsBuffer, scene->culledIndirectBuffer, scene->drawCount);
+                CullView casterView = view;
+                casterView.instanceFilter = instanceFilter;
+                m_CPUCuller.Cull(*scene, casterView, casterCommands, casterInstances, outList);
+                outList.indirectBuffer = buffers.indirectBuffers[frame];
+                outList.instanceBuffer = buffers.instanceBuffers[frame];
+                outList.drawCountBuffer = BufferHandle();
+            };
 
-                u32 workGroupSize = 32;
-                u32 groupX = (scene->drawCount + workGroupSize - 1) / workGroupSize;
-                u32 groupY = 1;
-                u32 groupZ = 1;
-                cmd->Dispatch(technique.computePipeline, groupX, groupY, groupZ);
+        // cascades go first so the culler's visible count is left at the camera's
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            if(scene->cascadeRebuildMask & (1u << i)) cullCasters(m_CPUCascadeStaticBuffers[i], cascadeViews[i], CULL_STATIC_INSTANCES, scene->cascadeStaticDraws[i]);
+            if(scene->dynamicInstanceCount > 0) cullCasters(m_CPUCascadeBuffers[i], cascadeViews[i], CULL_DYNAMIC_INSTANCES, scene->cascadeDraws[i]);
+        }
 
-                cmd->AddMemoryBarrier(scene->culledIndirectBuffer, 
-                    EAccessFlags::SHADER_WRITE_BIT, 
-                    EAccessFlags::SHADER_READ_BIT, 
-                    EPipelineStageFlags::COMPUTE_SHADER_BIT,
-                    EPipelineStageFlags::VERTEX_SHADER_BIT);
+        IndirectDraw* commands = (IndirectDraw*)device->GetMappedData(m_CPUBuffers.indirectBuffers[frame]);
+        u32* instances = (u32*)device->GetMappedData(m_CPUBuffers.instanceBuffers[frame]);
 
-                device->SubmitCommandBuffer(cmd);
-            }
-        );
+        m_CPUCuller.Cull(*scene, cullView, commands, instances, scene->culledDraws);
+        scene->culledDraws.indirectBuffer = m_CPUBuffers.indirectBuffers[frame];
+        scene->culledDraws.instanceBuffer = m_CPUBuffers.instanceBuffers[frame];
+        scene->culledDraws.drawCountBuffer = BufferHandle();
+    }
+
+    void FrustumCullingPass::SortBlended(IGFXDevice* device, SceneData* scene)
+    {
+        scene->culledDraws.blendedRuns.clear();
+        if(m_CPUCuller.SortBlended(*scene, cullView) == 0) return;
+
+        // sized for every blended instance so the buffers don't churn as the camera moves
+        const u32 blendedCount = m_CPUCuller.GetBlendedInstanceCount();
+        ReserveHostBuffers(device, m_BlendedBuffers, blendedCount, blendedCount);
+
+        const u32 frame = device->GetCurrentFrameIndex();
+        IndirectDraw* commands = (IndirectDraw*)device->GetMappedData(m_BlendedBuffers.indirectBuffers[frame]);
+        u32* instances = (u32*)device->GetMappedData(m_BlendedBuffers.instanceBuffers[frame]);
+
+        m_CPUCuller.WriteBlended(*scene, commands, instances, scene->culledDraws);
+        scene->culledDraws.blendedIndirectBuffer = m_BlendedBuffers.indirectBuffers[frame];
+        scene->culledDraws.blendedInstanceBuffer = m_BlendedBuffers.instanceBuffers[frame];
+    }
+
+    void FrustumCullingPass::ReserveHostBuffers(IGFXDevice* device, HostDrawBuffers& buffers, u32 commandCount, u32 instanceCount)
+    {
+        if(commandCount <= buffers.commandCapacity && instanceCount <= buffers.instanceCapacity) return;
+
+        DestroyHostBuffers(device, buffers);
+
+        BufferDesc indirectDesc;
+        indirectDesc.bufferSize = commandCount * sizeof(IndirectDraw);
+        indirectDesc.memoryType = EMemoryType::HOST_VISIBLE;
+        indirectDesc.type = EBufferType::INDIRECT;
+
+        BufferDesc instanceDesc;
+        instanceDesc.bufferSize = std::max(instanceCount, 1u) * sizeof(u32);
+        instanceDesc.memoryType = EMemoryType::HOST_VISIBLE;
+        instanceDesc.type = EBufferType::STORAGE | EBufferType::SHADER_DEVICE_ADDRESS;
+
+        for(u32 i = 0; i < MAX_SWAPCHAIN_IMAGES; i++)
+        {
+            buffers.indirectBuffers[i] = device->CreateBuffer(indirectDesc);
+            buffers.instanceBuffers[i] = device->CreateBuffer(instanceDesc);
+        }
+        buffers.commandCapacity = commandCount;
+        buffers.instanceCapacity = instanceCount;
+    }
+
+    void FrustumCullingPass::DestroyHostBuffers(IGFXDevice* device, HostDrawBuffers& buffers)
+    {
+        for(u32 i = 0; i < MAX_SWAPCHAIN_IMAGES && buffers.commandCapacity > 0; i++)
+        {
+            device->DestroyBuffer(buffers.indirectBuffers[i]);
+            device->DestroyBuffer(buffers.instanceBuffers[i]);
+        }
+        buffers.commandCapacity = 0;
+        buffers.instanceCapacity = 0;
+    }
+
+    void FrustumCullingPass::ReserveCompactionBuffers(IGFXDevice* device, u32 commandCount)
+    {
+        if(!compactionTechnique.computePipeline.IsValid() || commandCount <= m_CompactedCapacity) return;
+
+        if(m_CompactedCapacity > 0)
+        {
+            device->DestroyBuffer(m_CompactedIndirectBuffer);
+            device->DestroyBuffer(m_DrawCountBuffer);
+        }
+
+        BufferDesc compactedDesc;
+        compactedDesc.bufferSize = commandCount * sizeof(IndirectDraw);
+        compactedDesc.memoryType = EMemoryType::DEVICE_LOCAL;
+        compactedDesc.type = EBufferType::INDIRECT | EBufferType::STORAGE | EBufferType::TRANSFER_DST | EBufferType::SHADER_DEVICE_ADDRESS;
+        m_CompactedIndirectBuffer = device->CreateBuffer(compactedDesc);
+
+        BufferDesc countDesc = compactedDesc;
+        countDesc.bufferSize = DRAW_STREAM_COUNT * 2 * sizeof(u32);
+        m_DrawCountBuffer = device->CreateBuffer(countDesc);
+
+        m_CompactedCapacity = commandCount;
+    }
+
+    void FrustumCullingPass::ReserveCascadeBuffers(IGFXDevice* device, u32 commandCount, u32 instanceCount)
+    {
+        if(commandCount <= m_CascadeCommandCapacity && instanceCount <= m_CascadeInstanceCapacity) return;
+
+        DestroyCascadeBuffers(device);
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            CreateDeviceBuffers(device, m_CascadeBuffers[i], commandCount, instanceCount);
+            CreateDeviceBuffers(device, m_CascadeStaticBuffers[i], commandCount, instanceCount);
+        }
+        m_CascadeCommandCapacity = commandCount;
+        m_CascadeInstanceCapacity = instanceCount;
+    }
+
+    void FrustumCullingPass::DestroyCascadeBuffers(IGFXDevice* device)
+    {
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT && m_CascadeCommandCapacity > 0; i++)
+        {
+            DestroyDeviceBuffers(device, m_CascadeBuffers[i]);
+            DestroyDeviceBuffers(device, m_CascadeStaticBuffers[i]);
+        }
+        m_CascadeCommandCapacity = 0;
+        m_CascadeInstanceCapacity = 0;
+    }
+
+    void FrustumCullingPass::CreateDeviceBuffers(IGFXDevice* device, DeviceDrawBuffers& buffers, u32 commandCount, u32 instanceCount)
+    {
+        BufferDesc indirectDesc;
+        indirectDesc.bufferSize = commandCount * sizeof(IndirectDraw);
+        indirectDesc.memoryType = EMemoryType::DEVICE_LOCAL;
+        indirectDesc.type = EBufferType::INDIRECT | EBufferType::STORAGE | EBufferType::TRANSFER_DST | EBufferType::SHADER_DEVICE_ADDRESS;
+
+        // every level of a draw has its own copy of the instance range, like the scene's visible instance list
+        BufferDesc instanceDesc;
+        instanceDesc.bufferSize = std::max(instanceCount, 1u) * sizeof(u32);
+        instanceDesc.memoryType = EMemoryType::DEVICE_LOCAL;
+        instanceDesc.type = EBufferType::STORAGE | EBufferType::SHADER_DEVICE_ADDRESS;
+
+        buffers.indirectBuffer = device->CreateBuffer(indirectDesc);
+        buffers.instanceBuffer = device->CreateBuffer(instanceDesc);
+        if(compactionTechnique.computePipeline.IsValid())
+        {
+            BufferDesc countDesc = indirectDesc;
+            countDesc.bufferSize = DRAW_STREAM_COUNT * 2 * sizeof(u32);
+
+            buffers.compactedIndirectBuffer = device->CreateBuffer(indirectDesc);
+            buffers.drawCountBuffer = device->CreateBuffer(countDesc);
+        }
+    }
+
+    void FrustumCullingPass::DestroyDeviceBuffers(IGFXDevice* device, DeviceDrawBuffers& buffers)
+    {
+        device->DestroyBuffer(buffers.indirectBuffer);
+        device->DestroyBuffer(buffers.instanceBuffer);
+        if(buffers.compactedIndirectBuffer.IsValid()) device->DestroyBuffer(buffers.compactedIndirectBuffer);
+        if(buffers.drawCountBuffer.IsValid()) device->DestroyBuffer(buffers.drawCountBuffer);
+        buffers = DeviceDrawBuffers();
+    }
+
+    void FrustumCullingPass::RecordOcclusionCulling(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
+    {
+        // the flags were last read by whichever stage culls meshlets in the early phase
+        const EPipelineStageFlags meshletCullStage = device->SupportsMeshShaders() ? EPipelineStageFlags::TASK_SHADER_BIT : EPipelineStageFlags::COMPUTE_SHADER_BIT;
+
+        cmd->AddMemoryBarrier(scene->instanceVisibilityBuffer, 
+            EAccessFlags::SHADER_READ_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            meshletCullStage,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        OcclusionCullData cullData;
+        cullData.instanceBoundsBuffer = scene->instanceBoundsBuffer;
+        cullData.instanceVisibilityBuffer = scene->instanceVisibilityBuffer;
+        cullData.instanceCount = scene->instanceCount;
+        cullData.pyramid = depthPyramid;
+
+        cmd->BindComputePipeline(occlusionTechnique.computePipeline);
+        cmd->BindOcclusionCullData(cullData);
+
+        u32 workGroupSize = 64;
+        u32 groupX = (scene->instanceCount + workGroupSize - 1) / workGroupSize;
+        u32 groupY = 1;
+        u32 groupZ = 1;
+        cmd->Dispatch(occlusionTechnique.computePipeline, groupX, groupY, groupZ);
+
+        cmd->AddMemoryBarrier(scene->instanceVisibilityBuffer, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EAccessFlags::SHADER_READ_BIT, 
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            meshletCullStage);
+    }
+
+    void FrustumCullingPass::RecordMeshletCulling(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene, ECullPhase phase)
+    {
+        // task shaders cull meshlets themselves
+        if(device->SupportsMeshShaders() || scene->meshletTaskCount == 0) return;
+
+        // the index count and visible meshlet counter are rebuilt with atomics every frame
+        cmd->AddMemoryBarrier(scene->meshletDrawBuffer, 
+            EAccessFlags::INDIRECT_COMMAND_READ_BIT, 
+            EAccessFlags::TRANSFER_WRITE_BIT, 
+            EPipelineStageFlags::DRAW_INDIRECT_BIT,
+            EPipelineStageFlags::TRANSFER_BIT);
+
+        cmd->FillBuffer(scene->meshletDrawBuffer, 0, sizeof(IndirectDraw) + sizeof(u32), 0);
+
+        cmd->AddMemoryBarrier(scene->meshletDrawBuffer, 
+            EAccessFlags::TRANSFER_WRITE_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EPipelineStageFlags::TRANSFER_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        cmd->AddMemoryBarrier(scene->meshletIndexBuffer, 
+            EAccessFlags::INDEX_READ_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EPipelineStageFlags::VERTEX_INPUT_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        cmd->AddMemoryBarrier(scene->visibleMeshletsBuffer, 
+            EAccessFlags::SHADER_READ_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EPipelineStageFlags::VERTEX_SHADER_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        MeshletCullData cullData;
+        cullData.meshDrawBuffer = scene->meshDrawsBuffer;
+        cullData.meshBoundsBuffer = scene->meshBoundsBuffer;
+        cullData.meshletBuffer = scene->meshletBuffer;
+        cullData.meshletTrianglesBuffer = scene->meshletTrianglesBuffer;
+        cullData.meshletTasksBuffer = scene->meshletTasksBuffer;
+        cullData.visibleMeshletsBuffer = scene->visibleMeshletsBuffer;
+        cullData.meshletIndexBuffer = scene->meshletIndexBuffer;
+        cullData.meshletDrawBuffer = scene->meshletDrawBuffer;
+        cullData.taskCount = scene->meshletTaskCount;
+        cullData.instanceVisibilityBuffer = scene->instanceVisibilityBuffer;
+        cullData.cullPhase = phase;
+
+        cmd->BindComputePipeline(meshletTechnique.computePipeline);
+        cmd->BindMeshletCullData(cullData);
+
+        // one workgroup per task, split across y once it exceeds the guaranteed x limit
+        u32 groupX = std::min(scene->meshletTaskCount, MAX_MESHLET_TASK_GROUPS_X);
+        u32 groupY = (scene->meshletTaskCount + groupX - 1) / groupX;
+        u32 groupZ = 1;
+        cmd->Dispatch(meshletTechnique.computePipeline, groupX, groupY, groupZ);
+
+        cmd->AddMemoryBarrier(scene->meshletDrawBuffer, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EAccessFlags::INDIRECT_COMMAND_READ_BIT, 
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::DRAW_INDIRECT_BIT);
+
+        cmd->AddMemoryBarrier(scene->meshletIndexBuffer, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EAccessFlags::INDEX_READ_BIT, 
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::VERTEX_INPUT_BIT);
+
+        cmd->AddMemoryBarrier(scene->visibleMeshletsBuffer, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EAccessFlags::SHADER_READ_BIT, 
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::VERTEX_SHADER_BIT);
     }
-}
\ No newline at end of file
+}
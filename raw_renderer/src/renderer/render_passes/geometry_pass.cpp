@@ -4,6 +4,7 @@
 #include "resources/texture_loader.hpp"
 #include "events/event_manager.hpp"
 #include "core/job_system.hpp"
+#include <algorithm>
 
 namespace Raw::GFX
 {
@@ -123,6 +124,27 @@ namespace Raw::GFX
         techiqueDesc.name = "Geometry Pass";
 
         technique.gfxPipeline = device->CreateGraphicsPipeline(techiqueDesc);
+
+        // same state and attachments, only the geometry stages differ
+        meshletTechniqueDesc = techiqueDesc;
+        if(device->SupportsMeshShaders())
+        {
+            meshletTechniqueDesc.sDesc.numStages = 3;
+            meshletTechniqueDesc.sDesc.shaders[0].shaderName = "gbuffer";
+            meshletTechniqueDesc.sDesc.shaders[0].stage = EShaderStage::TASK_STAGE;
+            meshletTechniqueDesc.sDesc.shaders[1].shaderName = "gbuffer";
+            meshletTechniqueDesc.sDesc.shaders[1].stage = EShaderStage::MESH_STAGE;
+            meshletTechniqueDesc.sDesc.shaders[2].shaderName = "gbuffer";
+            meshletTechniqueDesc.sDesc.shaders[2].stage = EShaderStage::FRAGMENT_STAGE;
+            meshletTechniqueDesc.pushConstant.stage = EShaderStage::TASK_STAGE | EShaderStage::MESH_STAGE;
+        }
+        else
+        {
+            meshletTechniqueDesc.sDesc.shaders[0].shaderName = "gbuffer_meshlet";
+        }
+        meshletTechniqueDesc.name = "Geometry Pass Meshlets";
+
+        meshletTechnique.gfxPipeline = device->CreateGraphicsPipeline(meshletTechniqueDesc);
         
         TextureResource* tex = (TextureResource*)TextureLoader::Instance()->Get(ERROR_TEXTURE);
         errorTexture = tex->handle;
@@ -141,18 +163,14 @@ namespace Raw::GFX
 
     void GeometryPass::Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
     {
-        cmd->TransitionImage(device->GetDepthBufferHandle(), ETextureLayout::DEPTH_ATTACHMENT_OPTIMAL);
-
-        cmd->BeginRendering(technique.gfxPipeline, ERenderingOp::CLEAR, ERenderingOp::CLEAR);
-        cmd->BindPipeline(technique.gfxPipeline);
-
-        cmd->BindVertexBuffer(scene->vertexBuffer);
-        cmd->BindIndexBuffer(scene->indexBuffer);
-        cmd->BindDrawData(scene->meshDrawsBuffer);
+        RecordGeometry(device, cmd, scene, useOcclusionCulling ? EARLY_CULL_PHASE : ALL_INSTANCES_PHASE);
+    }
 
-        cmd->DrawIndexedIndirect(scene->culledIndirectBuffer, 0, scene->drawCount);
+    void GeometryPass::ExecuteLate(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
+    {
+        if(!useOcclusionCulling || scene->meshletTaskCount == 0) return;
 
-        cmd->EndRendering();
+        RecordGeometry(device, cmd, scene, LATE_CULL_PHASE);
     }
 
     
@@ -163,23 +181,60 @@ namespace Raw::GFX
                 ICommandBuffer* cmd = device->GetCommandBuffer();
                 cmd->BeginCommandBuffer();
 
-                cmd->TransitionImage(device->GetDepthBufferHandle(), ETextureLayout::DEPTH_ATTACHMENT_OPTIMAL);
-
-                cmd->BeginRendering(technique.gfxPipeline, ERenderingOp::CLEAR, ERenderingOp::CLEAR);
-                cmd->BindPipeline(technique.gfxPipeline);
-
-                cmd->BindVertexBuffer(scene->vertexBuffer);
-                cmd->BindDrawData(scene->meshDrawsBuffer);
-                cmd->BindIndexBuffer(scene->indexBuffer);
-                cmd->DrawIndexedIndirect(scene->culledIndirectBuffer, 0, scene->drawCount);
-
-                cmd->EndRendering();
+                RecordGeometry(device, cmd, scene, useOcclusionCulling ? EARLY_CULL_PHASE : ALL_INSTANCES_PHASE);
                 
                 device->SubmitCommandBuffer(cmd);
             }
         );
     }
     
+    void GeometryPass::RecordGeometry(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene, ECullPhase phase)
+    {
+        cmd->TransitionImage(device->GetDepthBufferHandle(), ETextureLayout::DEPTH_ATTACHMENT_OPTIMAL);
+
+        // scenes without meshlets keep the per instance culled indirect draws
+        if(scene->meshletTaskCount == 0)
+        {
+            cmd->BeginRendering(technique.gfxPipeline, ERenderingOp::CLEAR, ERenderingOp::CLEAR);
+            cmd->BindPipeline(technique.gfxPipeline);
+
+            cmd->BindVertexBuffer(scene->vertexBuffer);
+            cmd->BindDrawData(scene->meshDrawsBuffer);
+            cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+            // opaque first, so most alpha tested fragments of the masked draws land behind depth that's already written
+            DrawSceneCulled(cmd, scene, OPAQUE_STREAM);
+            DrawSceneCulled(cmd, scene, MASKED_STREAM);
+
+            cmd->EndRendering();
+            return;
+        }
+
+        // the late phase adds to the early phase's targets
+        const ERenderingOp renderingOp = phase == LATE_CULL_PHASE ? ERenderingOp::LOAD : ERenderingOp::CLEAR;
+        cmd->BeginRendering(meshletTechnique.gfxPipeline, renderingOp, renderingOp);
+        cmd->BindPipeline(meshletTechnique.gfxPipeline);
+
+        cmd->BindVertexBuffer(scene->vertexBuffer);
+        cmd->BindDrawData(scene->meshDrawsBuffer);
+        cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+        cmd->BindMeshletData(scene->meshletBuffer, scene->meshletVerticesBuffer, scene->meshletTrianglesBuffer, scene->meshletTasksBuffer, scene->meshletTaskCount, scene->instanceVisibilityBuffer, phase);
+        if(device->SupportsMeshShaders())
+        {
+            // one task workgroup per task, split across y once it exceeds the guaranteed x limit
+            u32 groupX = std::min(scene->meshletTaskCount, MAX_MESHLET_TASK_GROUPS_X);
+            u32 groupY = (scene->meshletTaskCount + groupX - 1) / groupX;
+            cmd->DrawMeshTasks(groupX, groupY, 1);
+        }
+        else
+        {
+            cmd->BindInstanceData(scene->visibleMeshletsBuffer);
+            cmd->BindIndexBuffer(scene->meshletIndexBuffer, 0, EIndexType::UINT32);
+            cmd->DrawIndexedIndirect(scene->meshletDrawBuffer, 0, 1);
+        }
+
+        cmd->EndRendering();
+    }
+
     bool GeometryPass::OnWindowResize(const WindowResizeEvent& e)
     {
         IGFXDevice* device = (IGFXDevice*)ServiceLocator::Get()->GetService(IGFXDevice::k_ServiceName);
@@ -224,6 +279,7 @@ namespace Raw::GFX
         geometryPassImages[5] = lightClipSpacePosition;
 
         device->UpdateGraphicsPipelineImageAttachments(technique.gfxPipeline, ArraySize(geometryPassImages), geometryPassImages);
+        device->UpdateGraphicsPipelineImageAttachments(meshletTechnique.gfxPipeline, ArraySize(geometryPassImages), geometryPassImages);
 
         return false;
     }
@@ -0,0 +1,90 @@
+#include "renderer/render_passes/light_culling_pass.hpp"
+#include "core/job_system.hpp"
+
+namespace Raw::GFX
+{
+    void LightCullingPass::Init(IGFXDevice* device)
+    {
+        // every workgroup writes its cluster's count, so neither buffer has to be cleared between frames
+        BufferDesc countDesc;
+        countDesc.bufferSize = LIGHT_CLUSTER_COUNT * sizeof(u32);
+        countDesc.memoryType = EMemoryType::DEVICE_LOCAL;
+        countDesc.type = EBufferType::STORAGE | EBufferType::SHADER_DEVICE_ADDRESS;
+        m_ClusterLightCountBuffer = device->CreateBuffer(countDesc);
+
+        BufferDesc indexDesc;
+        indexDesc.bufferSize = LIGHT_CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER * sizeof(u32);
+        indexDesc.memoryType = EMemoryType::DEVICE_LOCAL;
+        indexDesc.type = EBufferType::STORAGE | EBufferType::SHADER_DEVICE_ADDRESS;
+        m_ClusterLightIndexBuffer = device->CreateBuffer(indexDesc);
+
+        m_ClusterData.clusterLightCountBuffer = m_ClusterLightCountBuffer;
+        m_ClusterData.clusterLightIndexBuffer = m_ClusterLightIndexBuffer;
+
+        techniqueDesc.computeShader.shaderName = "light_culling";
+        techniqueDesc.computeShader.stage = EShaderStage::COMPUTE_STAGE;
+
+        techniqueDesc.pushConstant.offset = 0;
+        techniqueDesc.pushConstant.size = 128;
+        techniqueDesc.pushConstant.stage = EShaderStage::COMPUTE_STAGE;
+
+        techniqueDesc.name = "Light Culling Pass";
+
+        technique.computePipeline = device->CreateComputePipeline(techniqueDesc);
+    }
+
+    void LightCullingPass::Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
+    {
+        RecordCulling(device, cmd, scene);
+    }
+
+    void LightCullingPass::ExecuteAsync(IGFXDevice* device, SceneData* scene)
+    {
+        JobSystem::Execute([&]()
+            {
+                ICommandBuffer* cmd = device->GetCommandBuffer();
+                cmd->BeginCommandBuffer();
+
+                RecordCulling(device, cmd, scene);
+
+                device->SubmitCommandBuffer(cmd);
+            }
+        );
+    }
+
+    void LightCullingPass::Shutdown(IGFXDevice* device)
+    {
+        device->DestroyBuffer(m_ClusterLightCountBuffer);
+        device->DestroyBuffer(m_ClusterLightIndexBuffer);
+    }
+
+    void LightCullingPass::RecordCulling(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
+    {
+        m_ClusterData.pointLightBuffer = scene->pointLightBuffer;
+        m_ClusterData.pointLightCount = scene->pointLightCount;
+
+        // both buffers are shared by every frame in flight, the previous frame's lighting may still be reading them
+        cmd->AddMemoryBarrier(m_ClusterLightCountBuffer, 
+            EAccessFlags::SHADER_READ_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EPipelineStageFlags::FRAGMENT_SHADER_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        cmd->AddMemoryBarrier(m_ClusterLightIndexBuffer, 
+            EAccessFlags::SHADER_READ_BIT, 
+            EAccessFlags::SHADER_WRITE_BIT, 
+            EPipelineStageFlags::FRAGMENT_SHADER_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+        // one workgroup per cluster
+        cmd->BindComputePipeline(technique.computePipeline);
+        cmd->BindLightCullData(m_ClusterData);
+        cmd->Dispatch(technique.computePipeline, LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y, LIGHT_CLUSTER_Z);
+
+        cmd->AddMemoryBarrier(
+            EAccessFlags::SHADER_WRITE_BIT,
+            EAccessFlags::SHADER_READ_BIT,
+            EPipelineStageFlags::COMPUTE_SHADER_BIT,
+            EPipelineStageFlags::FRAGMENT_SHADER_BIT);
+    }
+}
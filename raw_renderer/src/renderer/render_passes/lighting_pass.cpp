@@ -66,6 +66,7 @@ namespace Raw::GFX
         cmd->BindPipeline(technique.gfxPipeline);
 
         cmd->BindFullScreenData(data);
+        cmd->BindLightClusterData(clusterData);
         cmd->Draw(3, 1, 0, 0);
         
         cmd->EndRendering();
@@ -14,8 +14,9 @@ namespace Raw::GFX
         shadowMapDesc.format = ETextureFormat::D32_SFLOAT;
         shadowMapDesc.isMipmapped = false;
         shadowMapDesc.isRenderTarget = true;
-        shadowMapDesc.isStorageImage = true;
-        shadowMap = device->CreateTexture(shadowMapDesc, true);
+        shadowMapDesc.isStorageImage = false;
+        // sampled through globalImages with the shadow sampler rather than a combined image sampler
+        shadowMapDesc.isSampledImage = false;
 
         techiqueDesc.sDesc.numStages = 1;
         techiqueDesc.sDesc.shaders[0].shaderName = "shadow_pass";
@@ -35,26 +36,38 @@ namespace Raw::GFX
         techiqueDesc.rDesc.frontFace = EFrontFace::CLOCKWISE;
 
         techiqueDesc.numImageAttachments = 0;
-        techiqueDesc.depthAttachment = &shadowMap;
         techiqueDesc.name = "Shadow Pass";
 
-        technique.gfxPipeline = device->CreateGraphicsPipeline(techiqueDesc);
+        // same state, the fragment stage discards what the material's alpha cutoff cuts away
+        maskedTechniqueDesc = techiqueDesc;
+        maskedTechniqueDesc.sDesc.numStages = 2;
+        maskedTechniqueDesc.sDesc.shaders[0].shaderName = "shadow_pass_masked";
+        maskedTechniqueDesc.sDesc.shaders[1].shaderName = "shadow_pass_masked";
+        maskedTechniqueDesc.sDesc.shaders[1].stage = EShaderStage::FRAGMENT_STAGE;
+        maskedTechniqueDesc.name = "Shadow Pass Masked";
 
-        TextureLoader::Instance()->CreateFromHandle(DIR_SHADOW_MAP, shadowMap);
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            shadowMaps[i] = device->CreateTexture(shadowMapDesc, true);
+            staticShadowMaps[i] = device->CreateTexture(shadowMapDesc, true);
+
+            techiqueDesc.depthAttachment = &shadowMaps[i];
+            techniques[i].gfxPipeline = device->CreateGraphicsPipeline(techiqueDesc);
+            maskedTechniqueDesc.depthAttachment = &shadowMaps[i];
+            maskedTechniques[i].gfxPipeline = device->CreateGraphicsPipeline(maskedTechniqueDesc);
+
+            techiqueDesc.depthAttachment = &staticShadowMaps[i];
+            staticTechniques[i].gfxPipeline = device->CreateGraphicsPipeline(techiqueDesc);
+            maskedTechniqueDesc.depthAttachment = &staticShadowMaps[i];
+            staticMaskedTechniques[i].gfxPipeline = device->CreateGraphicsPipeline(maskedTechniqueDesc);
+        }
+
+        TextureLoader::Instance()->CreateFromHandle(DIR_SHADOW_MAP, shadowMaps[0]);
     }
 
     void ShadowPass::Execute(IGFXDevice* device, ICommandBuffer* cmd, SceneData* scene)
     {
-        cmd->TransitionImage(shadowMap, ETextureLayout::DEPTH_ATTACHMENT_OPTIMAL);
-        cmd->BeginRendering(technique.gfxPipeline, ERenderingOp::LOAD, ERenderingOp::CLEAR);
-        cmd->BindPipeline(technique.gfxPipeline);
-
-        cmd->BindVertexBuffer(scene->vertexBuffer);
-        cmd->BindDrawData(scene->meshDrawsBuffer);
-        cmd->BindIndexBuffer(scene->indexBuffer);
-        cmd->DrawIndexedIndirect(scene->culledIndirectBuffer, 0, scene->drawCount);
-
-        cmd->EndRendering();
+        RecordCascades(cmd, scene);
     }
 
     void ShadowPass::ExecuteAsync(IGFXDevice* device, SceneData* scene)
@@ -63,19 +76,84 @@ namespace Raw::GFX
             {
                 ICommandBuffer* cmd = device->GetCommandBuffer();
                 cmd->BeginCommandBuffer();
-                cmd->TransitionImage(shadowMap, ETextureLayout::DEPTH_ATTACHMENT_OPTIMAL);
-                cmd->BeginRendering(technique.gfxPipeline, ERenderingOp::LOAD, ERenderingOp::CLEAR);
-                cmd->BindPipeline(technique.gfxPipeline);
+                RecordCascades(cmd, scene);
+                device->SubmitCommandBuffer(cmd);
+            }
+        );
+    }
 
-                cmd->BindVertexBuffer(scene->vertexBuffer);
-                cmd->BindDrawData(scene->meshDrawsBuffer);
-                cmd->BindIndexBuffer(scene->indexBuffer);
-                cmd->DrawIndexedIndirect(scene->culledIndirectBuffer, 0, scene->drawCount);
+    void ShadowPass::UpdateCache(const GlobalSceneData& sceneData, SceneData* scene)
+    {
+        // a new scene, a moved static instance or a new light direction invalidates every cascade
+        const bool invalidateAll = scene != m_CachedScene || scene->staticCasterVersion != m_CachedStaticVersion || sceneData.lightDir != m_CachedLightDir;
+        m_CachedScene = scene;
+        m_CachedStaticVersion = scene->staticCasterVersion;
+        m_CachedLightDir = sceneData.lightDir;
 
-                cmd->EndRendering();
+        // projections move in whole texels, so a cascade is only redrawn once the camera moved it by at least one
+        scene->cascadeRebuildMask = 0;
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            if(!invalidateAll && m_CacheValid[i] && sceneData.cascadeViewProj[i] == m_CachedViewProj[i]) continue;
 
-                device->SubmitCommandBuffer(cmd);
+            m_CachedViewProj[i] = sceneData.cascadeViewProj[i];
+            m_CacheValid[i] = true;
+            scene->cascadeRebuildMask |= 1u << i;
+        }
+    }
+
+    void ShadowPass::RecordCascades(ICommandBuffer* cmd, SceneData* scene)
+    {
+        const bool hasDynamic = scene->dynamicInstanceCount > 0;
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            const bool rebuild = (scene->cascadeRebuildMask & (1u << i)) != 0;
+            if(rebuild)
+            {
+                cmd->TransitionImage(staticShadowMaps[i], ETextureLayout::DEPTH_ATTACHMENT_OPTIMAL);
+                DrawCasters(cmd, scene, staticTechniques[i].gfxPipeline, staticMaskedTechniques[i].gfxPipeline, ERenderingOp::CLEAR, i, scene->cascadeStaticDraws[i]);
             }
-        );
+
+            // with nothing to composite and an unchanged cache last frame's map is still correct
+            if(!rebuild && !hasDynamic && !m_HasDynamic[i]) continue;
+
+            cmd->TransitionImage(staticShadowMaps[i], ETextureLayout::TRANSFER_SRC_OPTIMAL);
+            cmd->TransitionImage(shadowMaps[i], ETextureLayout::TRANSFER_DST_OPTIMAL);
+            cmd->CopyImage(staticShadowMaps[i], shadowMaps[i]);
+
+            if(hasDynamic)
+            {
+                cmd->TransitionImage(shadowMaps[i], ETextureLayout::DEPTH_ATTACHMENT_OPTIMAL);
+                // over the static depth it was just copied from
+                DrawCasters(cmd, scene, techniques[i].gfxPipeline, maskedTechniques[i].gfxPipeline, ERenderingOp::LOAD, i, scene->cascadeDraws[i]);
+            }
+            m_HasDynamic[i] = hasDynamic;
+
+            cmd->TransitionImage(shadowMaps[i], ETextureLayout::SHADER_READ_ONLY_OPTIMAL);
+        }
+    }
+
+    void ShadowPass::DrawCasters(ICommandBuffer* cmd, SceneData* scene, const GraphicsPipelineHandle& pipeline, const GraphicsPipelineHandle& maskedPipeline, 
+        ERenderingOp depthOp, u32 cascade, const CulledDrawList& draws)
+    {
+        cmd->BeginRendering(pipeline, ERenderingOp::LOAD, depthOp);
+        cmd->BindPipeline(pipeline);
+
+        cmd->BindVertexBuffer(scene->vertexBuffer);
+        cmd->BindDrawData(scene->meshDrawsBuffer);
+        cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+        cmd->BindShadowCascadeData(cascade);
+        DrawListCulled(cmd, scene, draws, OPAQUE_STREAM);
+
+        // alpha tested casters only pay for the fragment stage they need
+        cmd->BindPipeline(maskedPipeline);
+
+        cmd->BindVertexBuffer(scene->vertexBuffer);
+        cmd->BindDrawData(scene->meshDrawsBuffer);
+        cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+        cmd->BindShadowCascadeData(cascade);
+        DrawListCulled(cmd, scene, draws, MASKED_STREAM);
+
+        cmd->EndRendering();
     }
-}
\ No newline at end of file
+}
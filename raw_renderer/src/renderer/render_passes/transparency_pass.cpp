@@ -81,8 +81,8 @@ namespace Raw::GFX
 
         cmd->BindVertexBuffer(scene->vertexBuffer);
         cmd->BindDrawData(scene->meshDrawsBuffer);
-        cmd->BindIndexBuffer(scene->indexBuffer);
-        cmd->DrawIndexedIndirect(scene->culledIndirectBuffer, 0, scene->drawCount);
+        cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+        DrawSceneBlended(cmd, scene);
 
         cmd->EndRendering();
     }
@@ -99,8 +99,8 @@ namespace Raw::GFX
                 
                 cmd->BindVertexBuffer(scene->vertexBuffer);
                 cmd->BindDrawData(scene->meshDrawsBuffer);
-                cmd->BindIndexBuffer(scene->indexBuffer);
-                cmd->DrawIndexedIndirect(scene->culledIndirectBuffer, 0, scene->drawCount);
+                cmd->BindMeshBoundsData(scene->meshBoundsBuffer);
+                DrawSceneBlended(cmd, scene);
 
                 cmd->EndRendering();
 
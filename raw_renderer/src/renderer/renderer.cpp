@@ -5,9 +5,12 @@
 #include "resources/buffer_loader.hpp"
 #include "resources/texture_loader.hpp"
 #include "scene/scene.hpp"
+#include "renderer/geometry_heap.hpp"
+#include "renderer/shadow_cascades.hpp"
 #include "core/job_system.hpp"
 #include "editor/editor.hpp"
 #include "memory/memory_service.hpp"
+#include <algorithm>
 
 #include "renderer/render_passes/depth_pass.hpp"
 #include "renderer/render_passes/forward_pass.hpp"
@@ -19,6 +22,8 @@
 #include "renderer/render_passes/ssao_pass.hpp"
 #include "renderer/render_passes/ssr_pass.hpp"
 #include "renderer/render_passes/frustum_culling_pass.hpp"
+#include "renderer/render_passes/depth_pyramid_pass.hpp"
+#include "renderer/render_passes/light_culling_pass.hpp"
 #include "renderer/render_passes/fxaa_pass.hpp"
 
 namespace Raw::GFX
@@ -40,6 +45,8 @@ namespace Raw::GFX
         SSAOPass* m_SSAOPass{ nullptr };
         SSRPass* m_SSRPass{ nullptr };
         FrustumCullingPass* m_FrustumCullingPass{ nullptr };
+        DepthPyramidPass* m_DepthPyramidPass{ nullptr };
+        LightCullingPass* m_LightCullingPass{ nullptr };
         FXAAPass* m_FXAAPass{ nullptr };
 
         BufferHandle m_SceneDataBuffer;
@@ -55,7 +62,12 @@ namespace Raw::GFX
         RAW_DEALLOCATE(m_SSRPass);
         RAW_DEALLOCATE(m_LightingPass);
         RAW_DEALLOCATE(m_FXAAPass);
+        m_FrustumCullingPass->Shutdown(device);
         RAW_DEALLOCATE(m_FrustumCullingPass);
+        m_DepthPyramidPass->Shutdown(device);
+        RAW_DEALLOCATE(m_DepthPyramidPass);
+        m_LightCullingPass->Shutdown(device);
+        RAW_DEALLOCATE(m_LightCullingPass);
     }
 
     void Renderer::Init()
@@ -98,6 +110,15 @@ namespace Raw::GFX
         void* fcData = RAW_ALLOCATE(sizeof(FrustumCullingPass), alignof(FrustumCullingPass));
         m_Impl->m_FrustumCullingPass = new (fcData) FrustumCullingPass();
         m_Impl->m_FrustumCullingPass->Init(device);
+        data.enableCPUCulling = device->IsCPUDevice();
+
+        void* pyramidData = RAW_ALLOCATE(sizeof(DepthPyramidPass), alignof(DepthPyramidPass));
+        m_Impl->m_DepthPyramidPass = new (pyramidData) DepthPyramidPass();
+        m_Impl->m_DepthPyramidPass->Init(device);
+
+        void* lightCullData = RAW_ALLOCATE(sizeof(LightCullingPass), alignof(LightCullingPass));
+        m_Impl->m_LightCullingPass = new (lightCullData) LightCullingPass();
+        m_Impl->m_LightCullingPass->Init(device);
 
         void* fxaaData = RAW_ALLOCATE(sizeof(FXAAPass), alignof(FXAAPass));
         m_Impl->m_FXAAPass = new (fxaaData) FXAAPass();
@@ -137,7 +158,25 @@ namespace Raw::GFX
         sceneData.projInv = glm::inverse(sceneData.projection);
         sceneData.viewProj = sceneData.projection * sceneData.view;
         sceneData.cameraFrustum = camera.GetFrustum();
+        sceneData.zNear = camera.GetNearPlane();
+        sceneData.zFar = camera.GetFarPlane();
         if(tex) sceneData.shadowMapIndex = tex->handle.id;
+
+        // cascades follow the camera out to the shadow distance, their depth reaches back to every caster in the scene
+        CascadeFitDesc cascadeDesc;
+        cascadeDesc.zNear = camera.GetNearPlane();
+        cascadeDesc.shadowDistance = std::min(camera.GetFarPlane(), data.shadowDistance);
+        const AABB sceneBounds = scene->GetBVH().GetBounds();
+        if(sceneBounds.IsValid())
+        {
+            cascadeDesc.sceneMin = sceneBounds.min;
+            cascadeDesc.sceneMax = sceneBounds.max;
+        }
+        FitShadowCascades(cascadeDesc, sceneData);
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            sceneData.cascadeShadowMaps[i] = m_Impl->m_ShadowPass->shadowMaps[i].id;
+        }
         
         device->MapBuffer(m_Impl->m_SceneDataBuffer, &sceneData, sizeof(GlobalSceneData));
         device->UnmapBuffer(m_Impl->m_SceneDataBuffer, EBufferMapType::SCENE);
@@ -148,19 +187,44 @@ namespace Raw::GFX
         Editor::Get()->Render(dt, scene, sceneData, &data);
         
         device->BeginFrame();
+        GeometryHeap::Instance()->BeginFrame();
         
         ICommandBuffer* cmd = device->GetCommandBuffer();
         
         cmd->BeginCommandBuffer();
         cmd->Clear(glm::vec4(0.2f, 0.2f, 0.2f, 1.0f));
+        scene->UploadDirtyData(device, cmd);
+        // decides which cascades cull and redraw their static casters, so it runs ahead of culling
+        m_Impl->m_ShadowPass->UpdateCache(sceneData, scene->GetSceneData());
        
+        m_Impl->m_FrustumCullingPass->cullView = MakeCullView(sceneData);
+        for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+        {
+            m_Impl->m_FrustumCullingPass->cascadeViews[i] = m_Impl->m_FrustumCullingPass->cullView;
+            m_Impl->m_FrustumCullingPass->cascadeViews[i].frustum = sceneData.cascadeFrustums[i];
+        }
+        m_Impl->m_FrustumCullingPass->useCPUCulling = data.enableCPUCulling;
+        // only meshlet geometry is drawn in two phases, instance draws and shadow casters stay frustum culled
+        const bool occlusionCulling = data.enableOcclusionCulling && scene->GetSceneData()->meshletTaskCount > 0;
+        m_Impl->m_FrustumCullingPass->useOcclusionCulling = occlusionCulling;
+        m_Impl->m_GeometryPass->useOcclusionCulling = occlusionCulling;
         m_Impl->m_FrustumCullingPass->Execute(device, cmd, scene->GetSceneData());
         m_Impl->m_GeometryPass->Execute(device, cmd, scene->GetSceneData());
-        m_Impl->m_TransparencyPass->Execute(device, cmd, scene->GetSceneData());
+        if(occlusionCulling)
+        {
+            m_Impl->m_DepthPyramidPass->Execute(device, cmd, scene->GetSceneData());
+            m_Impl->m_FrustumCullingPass->depthPyramid = m_Impl->m_DepthPyramidPass->GetPyramidData();
+            m_Impl->m_FrustumCullingPass->ExecuteLate(device, cmd, scene->GetSceneData());
+            m_Impl->m_GeometryPass->ExecuteLate(device, cmd, scene->GetSceneData());
+        }
+        // forward shaded transparency and the lighting pass both sample this frame's cascades
         m_Impl->m_ShadowPass->Execute(device, cmd, scene->GetSceneData());
+        m_Impl->m_TransparencyPass->Execute(device, cmd, scene->GetSceneData());
         
         if(data.enableAO) m_Impl->m_SSAOPass->Execute(device, cmd, nullptr);
         if(data.enableSSR) m_Impl->m_SSRPass->Execute(device, cmd, nullptr);
+        m_Impl->m_LightCullingPass->Execute(device, cmd, scene->GetSceneData());
+        m_Impl->m_LightingPass->clusterData = m_Impl->m_LightCullingPass->GetClusterData();
         m_Impl->m_LightingPass->Execute(device, cmd, scene->GetSceneData());
         if(data.enableFXAA) m_Impl->m_FXAAPass->Execute(device, cmd, nullptr);
         m_Impl->m_FullScreenPass->Execute(device, cmd, scene->GetSceneData());
@@ -0,0 +1,109 @@
+#include "renderer/shadow_cascades.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Raw::GFX
+{
+    namespace
+    {
+        Plane MakePlane(const glm::vec4& coefficients)
+        {
+            const f32 length = glm::length(glm::vec3(coefficients));
+
+            Plane plane;
+            plane.normal = glm::vec3(coefficients) / length;
+            plane.distance = coefficients.w / length;
+            return plane;
+        }
+    }
+
+    Frustum MakeFrustum(const glm::mat4& viewProj)
+    {
+        const glm::mat4 rows = glm::transpose(viewProj);
+
+        Frustum frustum;
+        frustum.leftFace = MakePlane(rows[3] + rows[0]);
+        frustum.rightFace = MakePlane(rows[3] - rows[0]);
+        frustum.bottomFace = MakePlane(rows[3] + rows[1]);
+        frustum.topFace = MakePlane(rows[3] - rows[1]);
+        frustum.nearFace = MakePlane(rows[2]);
+        frustum.farFace = MakePlane(rows[3] - rows[2]);
+        return frustum;
+    }
+
+    void FitShadowCascades(const CascadeFitDesc& desc, GlobalSceneData& sceneData)
+    {
+        const glm::vec3 lightDir = glm::normalize(glm::vec3(sceneData.lightDir));
+
+        // only the light's direction matters, a rotation that ignores the camera keeps texels fixed in the world
+        const glm::vec3 up = std::abs(lightDir.y) > 0.99f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(0.f, 1.f, 0.f);
+        const glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.f), lightDir, up);
+
+        // depth in light space grows away from the light, the scene's nearest corner is where casters start
+        f32 sceneNearest = std::numeric_limits<f32>::max();
+        for(u32 i = 0; i < 8; i++)
+        {
+            const glm::vec3 corner((i & 1) ? desc.sceneMax.x : desc.sceneMin.x, (i & 2) ? desc.sceneMax.y : desc.sceneMin.y, (i & 4) ? desc.sceneMax.z : desc.sceneMin.z);
+            sceneNearest = std::min(sceneNearest, -(lightRotation * glm::vec4(corner, 1.f)).z);
+        }
+
+        // tangents of the half angles, straight from the projection so they match what the camera draws
+        const f32 tanX = 1.f / sceneData.projection[0][0];
+        const f32 tanY = 1.f / std::abs(sceneData.projection[1][1]);
+
+        const f32 zNear = desc.zNear;
+        const f32 zFar = std::max(desc.shadowDistance, zNear * 2.f);
+        f32 sliceNear = zNear;
+        for(u32 cascade = 0; cascade < SHADOW_CASCADE_COUNT; cascade++)
+        {
+            const f32 t = (f32)(cascade + 1) / (f32)SHADOW_CASCADE_COUNT;
+            const f32 logSplit = zNear * std::pow(zFar / zNear, t);
+            const f32 linearSplit = zNear + (zFar - zNear) * t;
+            const f32 sliceFar = desc.splitLambda * logSplit + (1.f - desc.splitLambda) * linearSplit;
+
+            glm::vec3 corners[8];
+            glm::vec3 center(0.f);
+            for(u32 i = 0; i < 8; i++)
+            {
+                const f32 depth = (i & 4) ? sliceFar : sliceNear;
+                const glm::vec4 viewCorner((i & 1 ? 1.f : -1.f) * tanX * depth, (i & 2 ? 1.f : -1.f) * tanY * depth, -depth, 1.f);
+                corners[i] = glm::vec3(sceneData.viewInv * viewCorner);
+                center += corners[i] / 8.f;
+            }
+
+            f32 radius = 0.f;
+            for(u32 i = 0; i < 8; i++) radius = std::max(radius, glm::length(corners[i] - center));
+            // rounded up so float noise in the corners can't change the texel size from frame to frame
+            radius = std::ceil(radius * 16.f) / 16.f;
+
+            const f32 texelSize = 2.f * radius / (f32)SHADOW_MAP_SIZE;
+            glm::vec3 lightCenter = glm::vec3(lightRotation * glm::vec4(center, 1.f));
+            lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+            lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+            // depth is snapped as well so the projection only changes in whole steps, cached shadows rely on it.
+            // the near plane takes a step of slack to make up for the rounding
+            lightCenter.z = std::floor(lightCenter.z / texelSize) * texelSize;
+
+            // the scene's extent moves with its dynamic casters, whole steps of the cascade's size keep it from
+            // changing the projection every frame
+            const f32 casterNear = std::floor(sceneNearest / radius) * radius;
+            const f32 depthNear = std::min(casterNear, -lightCenter.z - radius - texelSize);
+            const f32 depthFar = -lightCenter.z + radius;
+            const glm::mat4 projection = glm::orthoRH_ZO(lightCenter.x - radius, lightCenter.x + radius, 
+                lightCenter.y - radius, lightCenter.y + radius, depthNear, depthFar);
+
+            // anything still reading the single light matrices gets the nearest cascade
+            if(cascade == 0)
+            {
+                sceneData.lightView = lightRotation;
+                sceneData.lightProj = projection;
+            }
+
+            sceneData.cascadeViewProj[cascade] = projection * lightRotation;
+            sceneData.cascadeFrustums[cascade] = MakeFrustum(sceneData.cascadeViewProj[cascade]);
+            sceneData.cascadeSplits[cascade] = sliceFar;
+            sliceNear = sliceFar;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include "renderer/upload_buffer.hpp"
+#include "renderer/command_buffer.hpp"
+#include "core/asserts.hpp"
+#include <cstring>
+
+namespace Raw::GFX
+{
+    namespace
+    {
+        constexpr u64 UPLOAD_ALIGNMENT = 16;
+    }
+
+    void UploadBuffer::Init(IGFXDevice* device, u64 sizePerFrame)
+    {
+        m_SizePerFrame = (sizePerFrame + UPLOAD_ALIGNMENT - 1) & ~(UPLOAD_ALIGNMENT - 1);
+
+        BufferDesc desc;
+        desc.bufferSize = m_SizePerFrame * MAX_SWAPCHAIN_IMAGES;
+        desc.type = EBufferType::TRANSFER_SRC;
+        desc.memoryType = EMemoryType::HOST_VISIBLE;
+
+        m_Buffer = device->CreateBuffer(desc);
+        m_MappedData = (u8*)device->GetMappedData(m_Buffer);
+        RAW_ASSERT_MSG(m_MappedData != nullptr, "Upload buffer must be persistently mapped!");
+
+        m_RegionStart = 0;
+        m_Offset = 0;
+    }
+
+    void UploadBuffer::Shutdown(IGFXDevice* device)
+    {
+        if(m_MappedData) device->DestroyBuffer(m_Buffer);
+        m_MappedData = nullptr;
+        m_SizePerFrame = 0;
+        m_RegionStart = 0;
+        m_Offset = 0;
+    }
+
+    void UploadBuffer::BeginFrame(u32 frameIndex)
+    {
+        RAW_ASSERT(frameIndex < MAX_SWAPCHAIN_IMAGES);
+        m_RegionStart = frameIndex * m_SizePerFrame;
+        m_Offset = m_RegionStart;
+    }
+
+    bool UploadBuffer::Stage(ICommandBuffer* cmd, const BufferHandle& dst, u64 dstOffset, const void* data, u64 size)
+    {
+        if(size == 0) return true;
+
+        const u64 alignedSize = (size + UPLOAD_ALIGNMENT - 1) & ~(UPLOAD_ALIGNMENT - 1);
+        if(m_Offset + alignedSize > m_RegionStart + m_SizePerFrame) return false;
+
+        memcpy(m_MappedData + m_Offset, data, size);
+        cmd->CopyBuffer(m_Buffer, dst, m_Offset, dstOffset, size);
+        m_Offset += alignedSize;
+
+        return true;
+    }
+}
@@ -93,9 +93,54 @@ namespace Raw::GFX
         VulkanTexture* vkSrc = VulkanGFXDevice::Get()->GetTexture(src);
         VulkanTexture* vkDst = VulkanGFXDevice::Get()->GetTexture(dst);
 
+        // depth can't be blitted with a linear filter, depth images are expected to match in size and format
+        if(vkSrc->isDepthTexture)
+        {
+            vkUtils::CopyImageExact(vulkanCmdBuffer, vkSrc->image, vkDst->image, { vkSrc->imageExtent.width, vkSrc->imageExtent.height }, VK_IMAGE_ASPECT_DEPTH_BIT);
+            return;
+        }
+
         vkUtils::CopyImageToImage(vulkanCmdBuffer, vkSrc->image, vkDst->image, { vkSrc->imageExtent.width, vkSrc->imageExtent.height }, { vkDst->imageExtent.width, vkDst->imageExtent.height });
     }
 
+    void VulkanCommandBuffer::UpdateBuffer(const BufferHandle& buffer, u64 offset, u64 size, const void* data)
+    {
+        RAW_ASSERT_MSG((offset % 4) == 0 && (size % 4) == 0, "Buffer updates must be 4 byte aligned!");
+        VulkanBuffer* vBuffer = VulkanGFXDevice::Get()->GetBuffer(buffer);
+
+        // vkCmdUpdateBuffer is limited to 65536 bytes per call
+        constexpr u64 maxUpdateSize = 65536;
+        const u8* src = (const u8*)data;
+        while(size > 0)
+        {
+            u64 chunkSize = size < maxUpdateSize ? size : maxUpdateSize;
+            vkCmdUpdateBuffer(vulkanCmdBuffer, vBuffer->buffer, vBuffer->offset + offset, chunkSize, src);
+            offset += chunkSize;
+            src += chunkSize;
+            size -= chunkSize;
+        }
+    }
+
+    void VulkanCommandBuffer::CopyBuffer(const BufferHandle& src, const BufferHandle& dst, u64 srcOffset, u64 dstOffset, u64 size)
+    {
+        VulkanBuffer* srcBuffer = VulkanGFXDevice::Get()->GetBuffer(src);
+        VulkanBuffer* dstBuffer = VulkanGFXDevice::Get()->GetBuffer(dst);
+
+        VkBufferCopy bufferCopy{ 0 };
+        bufferCopy.srcOffset = srcBuffer->offset + srcOffset;
+        bufferCopy.dstOffset = dstBuffer->offset + dstOffset;
+        bufferCopy.size = size;
+
+        vkCmdCopyBuffer(vulkanCmdBuffer, srcBuffer->buffer, dstBuffer->buffer, 1, &bufferCopy);
+    }
+
+    void VulkanCommandBuffer::FillBuffer(const BufferHandle& buffer, u64 offset, u64 size, u32 value)
+    {
+        RAW_ASSERT_MSG((offset % 4) == 0, "Buffer fills must be 4 byte aligned!");
+        VulkanBuffer* vBuffer = VulkanGFXDevice::Get()->GetBuffer(buffer);
+        vkCmdFillBuffer(vulkanCmdBuffer, vBuffer->buffer, vBuffer->offset + offset, size, value);
+    }
+
     void VulkanCommandBuffer::Dispatch(const ComputePipelineHandle& handle, u32 groupX, u32 groupY, u32 groupZ)
     {
         vkCmdDispatch(vulkanCmdBuffer, groupX, groupY, groupZ);
@@ -130,8 +175,8 @@ namespace Raw::GFX
         bufferBarrier.srcAccessMask = srcVk;
         bufferBarrier.dstAccessMask = dstVk;
         bufferBarrier.buffer = vBuffer->buffer;
-        bufferBarrier.offset = 0;
-        bufferBarrier.size = VK_WHOLE_SIZE;
+        bufferBarrier.offset = vBuffer->offset;
+        bufferBarrier.size = vBuffer->range;
 
         VkPipelineStageFlags srcVkP = vkUtils::ToVkPipelineStageFlags(srcPipeline);
         VkPipelineStageFlags dstVkP = vkUtils::ToVkPipelineStageFlags(dstPipeline);
@@ -225,22 +270,14 @@ namespace Raw::GFX
      
         vkCmdBindPipeline(vulkanCmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gfxPipeline->pipeline);
 
-        const u32 numAttachments = gfxPipeline->numImageAttachments;
         u32 curFrame = VulkanGFXDevice::Get()->m_CurFrame;
         VkDescriptorSet sceneDataSet = VulkanGFXDevice::Get()->m_SceneDataSet[curFrame];
         VkDescriptorSet bindlessSet = VulkanGFXDevice::Get()->m_BindlessSet;
         VkDescriptorSet materialDataSet = VulkanGFXDevice::Get()->m_MaterialDataSet[curFrame];
         VkDescriptorSet lightSet = VulkanGFXDevice::Get()->m_LightSet[curFrame];
-        if(numAttachments > 0)
-        {
-            VkDescriptorSet sets[] = { sceneDataSet, bindlessSet, materialDataSet, lightSet };
-            vkCmdBindDescriptorSets(vulkanCmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gfxPipeline->pipelineLayout, 0, ArraySize(sets), sets, 0, nullptr);
-        }
-        else
-        {
-            VkDescriptorSet sets[] = { sceneDataSet };
-            vkCmdBindDescriptorSets(vulkanCmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gfxPipeline->pipelineLayout, 0, ArraySize(sets), sets, 0, nullptr);
-        }
+        // the layout was created with either the scene data alone or every set, see CreateGraphicsPipeline
+        VkDescriptorSet sets[] = { sceneDataSet, bindlessSet, materialDataSet, lightSet };
+        vkCmdBindDescriptorSets(vulkanCmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gfxPipeline->pipelineLayout, 0, gfxPipeline->numDescriptorSets, sets, 0, nullptr);
 
         VkExtent2D drawExent = VulkanGFXDevice::Get()->GetDrawExtent();
         VkViewport viewport = {};
@@ -309,13 +346,13 @@ namespace Raw::GFX
         VulkanBuffer* buffer = VulkanGFXDevice::Get()->GetBuffer(vertexBuffer);
         pushConstant.vBuffer = buffer->bufferAddress;
 
-        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, pcSize, &pushConstant);
+        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, activeGraphicsPipeline->pushConstantStages, 0, pcSize, &pushConstant);
     }
 
-    void VulkanCommandBuffer::BindIndexBuffer(const BufferHandle& indexBuffer)
+    void VulkanCommandBuffer::BindIndexBuffer(const BufferHandle& indexBuffer, u64 offset, EIndexType type)
     {
         VulkanBuffer* buffer = VulkanGFXDevice::Get()->GetBuffer(indexBuffer);
-        vkCmdBindIndexBuffer(vulkanCmdBuffer, buffer->buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(vulkanCmdBuffer, buffer->buffer, buffer->offset + offset, vkUtils::ToVkIndexType(type));
     }
 
     void VulkanCommandBuffer::BindDrawData(const BufferHandle& meshDrawBuffer)
@@ -330,7 +367,51 @@ namespace Raw::GFX
         VulkanBuffer* buffer = VulkanGFXDevice::Get()->GetBuffer(meshDrawBuffer);
         pushConstant.meshDrawBuffer = buffer->bufferAddress;
 
-        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, (u32)sizeof(VkDeviceAddress), pcSize, &pushConstant);
+        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, activeGraphicsPipeline->pushConstantStages, (u32)sizeof(VkDeviceAddress), pcSize, &pushConstant);
+    }
+
+    void VulkanCommandBuffer::BindInstanceData(const BufferHandle& visibleInstancesBuffer)
+    {
+        struct
+        {
+            VkDeviceAddress visibleInstancesBuffer;
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        VulkanBuffer* buffer = VulkanGFXDevice::Get()->GetBuffer(visibleInstancesBuffer);
+        pushConstant.visibleInstancesBuffer = buffer->bufferAddress;
+
+        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, activeGraphicsPipeline->pushConstantStages, 2 * (u32)sizeof(VkDeviceAddress), pcSize, &pushConstant);
+    }
+
+    void VulkanCommandBuffer::BindMeshBoundsData(const BufferHandle& meshBoundsBuffer)
+    {
+        struct
+        {
+            VkDeviceAddress meshBoundsBuffer;
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        VulkanBuffer* buffer = VulkanGFXDevice::Get()->GetBuffer(meshBoundsBuffer);
+        pushConstant.meshBoundsBuffer = buffer->bufferAddress;
+
+        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, activeGraphicsPipeline->pushConstantStages, 3 * (u32)sizeof(VkDeviceAddress), pcSize, &pushConstant);
+    }
+
+    void VulkanCommandBuffer::BindShadowCascadeData(u32 cascadeIndex)
+    {
+        struct
+        {
+            u32 cascadeIndex;
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        pushConstant.cascadeIndex = cascadeIndex;
+
+        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, activeGraphicsPipeline->pushConstantStages, 4 * (u32)sizeof(VkDeviceAddress), pcSize, &pushConstant);
     }
 
     void VulkanCommandBuffer::BindFullScreenData(const FullScreenData& data)
@@ -360,7 +441,7 @@ namespace Raw::GFX
         pushConstant.transparent = data.transparent;
         pushConstant.reflection = data.reflection;
 
-        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, pcSize, &pushConstant);
+        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, activeGraphicsPipeline->pushConstantStages, 0, pcSize, &pushConstant);
     }
 
     void VulkanCommandBuffer::BindAOData(const AOData& data)
@@ -385,26 +466,38 @@ namespace Raw::GFX
         vkCmdPushConstants(vulkanCmdBuffer, activeComputePipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pcSize, &pushConstant);
     }
 
-    void VulkanCommandBuffer::BindCullData(const BufferHandle& indirectDrawData, const BufferHandle& meshBoundsData, const BufferHandle& culledIndirectDrawData, u32 drawCount)
+    void VulkanCommandBuffer::BindCullData(const BufferHandle& indirectDrawData, const BufferHandle& meshBoundsData, const BufferHandle& instanceBoundsData, const BufferHandle& meshDrawData, const BufferHandle& culledIndirectDrawData, const BufferHandle& visibleInstancesData, u32 instanceCount, u32 cullView, u32 instanceFilter)
     {
         struct
         {
             VkDeviceAddress indirectDrawBuffer;
             VkDeviceAddress meshBoundsBuffer;
+            VkDeviceAddress instanceBoundsBuffer;
+            VkDeviceAddress meshDrawBuffer;
             VkDeviceAddress culledIndrectBuffer;
-            u32 drawCount;
-            u32 padding;
+            VkDeviceAddress visibleInstancesBuffer;
+            u32 instanceCount;
+            u32 cullView;
+            u32 instanceFilter;
         } pushConstant;
 
         u32 pcSize = sizeof(pushConstant);
 
         VulkanBuffer* iBuffer = VulkanGFXDevice::Get()->GetBuffer(indirectDrawData);
         VulkanBuffer* mbBuffer = VulkanGFXDevice::Get()->GetBuffer(meshBoundsData);
+        VulkanBuffer* ibBuffer = VulkanGFXDevice::Get()->GetBuffer(instanceBoundsData);
+        VulkanBuffer* mdBuffer = VulkanGFXDevice::Get()->GetBuffer(meshDrawData);
         VulkanBuffer* ciBuffer = VulkanGFXDevice::Get()->GetBuffer(culledIndirectDrawData);
+        VulkanBuffer* viBuffer = VulkanGFXDevice::Get()->GetBuffer(visibleInstancesData);
         pushConstant.indirectDrawBuffer = iBuffer->bufferAddress;
         pushConstant.meshBoundsBuffer = mbBuffer->bufferAddress;
+        pushConstant.instanceBoundsBuffer = ibBuffer->bufferAddress;
+        pushConstant.meshDrawBuffer = mdBuffer->bufferAddress;
         pushConstant.culledIndrectBuffer = ciBuffer->bufferAddress;
-        pushConstant.drawCount = drawCount;
+        pushConstant.visibleInstancesBuffer = viBuffer->bufferAddress;
+        pushConstant.instanceCount = instanceCount;
+        pushConstant.cullView = cullView;
+        pushConstant.instanceFilter = instanceFilter;
 
         vkCmdPushConstants(vulkanCmdBuffer, activeComputePipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pcSize, &pushConstant);
     }
@@ -412,6 +505,207 @@ namespace Raw::GFX
     void VulkanCommandBuffer::DrawIndexedIndirect(const BufferHandle& indirectBuffer, u64 offset, u32 drawCount)
     {
         VulkanBuffer* iBuffer = VulkanGFXDevice::Get()->GetBuffer(indirectBuffer);
-        vkCmdDrawIndexedIndirect(vulkanCmdBuffer, iBuffer->buffer, offset, drawCount, sizeof(GFX::IndirectDraw));
+        vkCmdDrawIndexedIndirect(vulkanCmdBuffer, iBuffer->buffer, iBuffer->offset + offset, drawCount, sizeof(GFX::IndirectDraw));
+    }
+
+    void VulkanCommandBuffer::DrawIndexedIndirectCount(const BufferHandle& indirectBuffer, u64 offset, const BufferHandle& countBuffer, u64 countOffset, u32 maxDrawCount)
+    {
+        VulkanGFXDevice* device = VulkanGFXDevice::Get();
+        VulkanBuffer* iBuffer = device->GetBuffer(indirectBuffer);
+        VulkanBuffer* cBuffer = device->GetBuffer(countBuffer);
+        vkCmdDrawIndexedIndirectCount(vulkanCmdBuffer, iBuffer->buffer, iBuffer->offset + offset, cBuffer->buffer, cBuffer->offset + countOffset, maxDrawCount, sizeof(GFX::IndirectDraw));
+    }
+
+    void VulkanCommandBuffer::DrawMeshTasks(u32 groupX, u32 groupY, u32 groupZ)
+    {
+        VulkanGFXDevice::Get()->m_CmdDrawMeshTasks(vulkanCmdBuffer, groupX, groupY, groupZ);
+    }
+
+    void VulkanCommandBuffer::BindMeshletData(const BufferHandle& meshletData, const BufferHandle& meshletVertexData, const BufferHandle& meshletTriangleData, const BufferHandle& meshletTaskData, u32 taskCount, const BufferHandle& instanceVisibilityData, ECullPhase cullPhase)
+    {
+        struct
+        {
+            VkDeviceAddress meshletBuffer;
+            VkDeviceAddress meshletVerticesBuffer;
+            VkDeviceAddress meshletTrianglesBuffer;
+            VkDeviceAddress meshletTasksBuffer;
+            u32 taskCount;
+            u32 cullPhase;
+            VkDeviceAddress instanceVisibilityBuffer;
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        VulkanBuffer* mBuffer = VulkanGFXDevice::Get()->GetBuffer(meshletData);
+        VulkanBuffer* mvBuffer = VulkanGFXDevice::Get()->GetBuffer(meshletVertexData);
+        VulkanBuffer* mtBuffer = VulkanGFXDevice::Get()->GetBuffer(meshletTriangleData);
+        VulkanBuffer* tBuffer = VulkanGFXDevice::Get()->GetBuffer(meshletTaskData);
+        pushConstant.meshletBuffer = mBuffer->bufferAddress;
+        pushConstant.meshletVerticesBuffer = mvBuffer->bufferAddress;
+        pushConstant.meshletTrianglesBuffer = mtBuffer->bufferAddress;
+        pushConstant.meshletTasksBuffer = tBuffer->bufferAddress;
+        pushConstant.taskCount = taskCount;
+        pushConstant.cullPhase = cullPhase;
+        pushConstant.instanceVisibilityBuffer = VulkanGFXDevice::Get()->GetBuffer(instanceVisibilityData)->bufferAddress;
+
+        // follows the vertex, draw, instance and bounds addresses
+        vkCmdPushConstants(vulkanCmdBuffer, activeGraphicsPipeline->pipelineLayout, activeGraphicsPipeline->pushConstantStages, 4 * (u32)sizeof(VkDeviceAddress), pcSize, &pushConstant);
+    }
+
+    void VulkanCommandBuffer::BindMeshletCullData(const MeshletCullData& data)
+    {
+        struct
+        {
+            VkDeviceAddress meshDrawBuffer;
+            VkDeviceAddress meshBoundsBuffer;
+            VkDeviceAddress meshletBuffer;
+            VkDeviceAddress meshletTrianglesBuffer;
+            VkDeviceAddress meshletTasksBuffer;
+            VkDeviceAddress visibleMeshletsBuffer;
+            VkDeviceAddress meshletIndexBuffer;
+            VkDeviceAddress meshletDrawBuffer;
+            u32 taskCount;
+            u32 cullPhase;
+            VkDeviceAddress instanceVisibilityBuffer;
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        VulkanGFXDevice* device = VulkanGFXDevice::Get();
+        pushConstant.meshDrawBuffer = device->GetBuffer(data.meshDrawBuffer)->bufferAddress;
+        pushConstant.meshBoundsBuffer = device->GetBuffer(data.meshBoundsBuffer)->bufferAddress;
+        pushConstant.meshletBuffer = device->GetBuffer(data.meshletBuffer)->bufferAddress;
+        pushConstant.meshletTrianglesBuffer = device->GetBuffer(data.meshletTrianglesBuffer)->bufferAddress;
+        pushConstant.meshletTasksBuffer = device->GetBuffer(data.meshletTasksBuffer)->bufferAddress;
+        pushConstant.visibleMeshletsBuffer = device->GetBuffer(data.visibleMeshletsBuffer)->bufferAddress;
+        pushConstant.meshletIndexBuffer = device->GetBuffer(data.meshletIndexBuffer)->bufferAddress;
+        pushConstant.meshletDrawBuffer = device->GetBuffer(data.meshletDrawBuffer)->bufferAddress;
+        pushConstant.taskCount = data.taskCount;
+        pushConstant.cullPhase = data.cullPhase;
+        pushConstant.instanceVisibilityBuffer = device->GetBuffer(data.instanceVisibilityBuffer)->bufferAddress;
+
+        vkCmdPushConstants(vulkanCmdBuffer, activeComputePipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pcSize, &pushConstant);
+    }
+
+    void VulkanCommandBuffer::BindDrawCompactionData(const DrawCompactionData& data)
+    {
+        struct
+        {
+            VkDeviceAddress commandBuffer;
+            VkDeviceAddress compactedCommandBuffer;
+            VkDeviceAddress drawCountBuffer;
+            u32 commandCount;
+            u32 padding;
+            u32 segmentFirst[DRAW_STREAM_COUNT * 2];
+            u32 segmentCount[DRAW_STREAM_COUNT * 2];
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        VulkanGFXDevice* device = VulkanGFXDevice::Get();
+        pushConstant.commandBuffer = device->GetBuffer(data.commandBuffer)->bufferAddress;
+        pushConstant.compactedCommandBuffer = device->GetBuffer(data.compactedCommandBuffer)->bufferAddress;
+        pushConstant.drawCountBuffer = device->GetBuffer(data.drawCountBuffer)->bufferAddress;
+        pushConstant.commandCount = data.commandCount;
+        pushConstant.padding = 0;
+        for(u32 i = 0; i < DRAW_STREAM_COUNT; i++)
+        {
+            pushConstant.segmentFirst[i * 2] = data.streams[i].shortRange.first;
+            pushConstant.segmentCount[i * 2] = data.streams[i].shortRange.count;
+            pushConstant.segmentFirst[i * 2 + 1] = data.streams[i].wideRange.first;
+            pushConstant.segmentCount[i * 2 + 1] = data.streams[i].wideRange.count;
+        }
+
+        vkCmdPushConstants(vulkanCmdBuffer, activeComputePipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pcSize, &pushConstant);
+    }
+
+    void VulkanCommandBuffer::BindDepthPyramidData(const DepthPyramidBuildData& data)
+    {
+        struct
+        {
+            VkDeviceAddress counterBuffer;
+            u32 depthBuffer;
+            u32 depthWidth;
+            u32 depthHeight;
+            u32 width;
+            u32 height;
+            u32 mipCount;
+            u32 workGroupCount;
+            u32 mips[MAX_DEPTH_PYRAMID_MIPS];
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        pushConstant.counterBuffer = VulkanGFXDevice::Get()->GetBuffer(data.counterBuffer)->bufferAddress;
+        pushConstant.depthBuffer = data.depthBuffer;
+        pushConstant.depthWidth = data.depthWidth;
+        pushConstant.depthHeight = data.depthHeight;
+        pushConstant.width = data.pyramid.width;
+        pushConstant.height = data.pyramid.height;
+        pushConstant.mipCount = data.pyramid.mipCount;
+        pushConstant.workGroupCount = data.workGroupCount;
+        for(u32 i = 0; i < MAX_DEPTH_PYRAMID_MIPS; i++) pushConstant.mips[i] = data.pyramid.mips[i];
+
+        vkCmdPushConstants(vulkanCmdBuffer, activeComputePipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pcSize, &pushConstant);
+    }
+
+    void VulkanCommandBuffer::BindOcclusionCullData(const OcclusionCullData& data)
+    {
+        struct
+        {
+            VkDeviceAddress instanceBoundsBuffer;
+            VkDeviceAddress instanceVisibilityBuffer;
+            u32 instanceCount;
+            u32 width;
+            u32 height;
+            u32 mipCount;
+            u32 mips[MAX_DEPTH_PYRAMID_MIPS];
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        VulkanGFXDevice* device = VulkanGFXDevice::Get();
+        pushConstant.instanceBoundsBuffer = device->GetBuffer(data.instanceBoundsBuffer)->bufferAddress;
+        pushConstant.instanceVisibilityBuffer = device->GetBuffer(data.instanceVisibilityBuffer)->bufferAddress;
+        pushConstant.instanceCount = data.instanceCount;
+        pushConstant.width = data.pyramid.width;
+        pushConstant.height = data.pyramid.height;
+        pushConstant.mipCount = data.pyramid.mipCount;
+        for(u32 i = 0; i < MAX_DEPTH_PYRAMID_MIPS; i++) pushConstant.mips[i] = data.pyramid.mips[i];
+
+        vkCmdPushConstants(vulkanCmdBuffer, activeComputePipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pcSize, &pushConstant);
+    }
+
+    void VulkanCommandBuffer::BindLightCullData(const LightClusterData& data)
+    {
+        PushLightClusterData(activeComputePipeline->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, data);
+    }
+
+    void VulkanCommandBuffer::BindLightClusterData(const LightClusterData& data)
+    {
+        // after the nine texture indices of BindFullScreenData, aligned for the addresses
+        u32 offset = 10 * (u32)sizeof(u32);
+        PushLightClusterData(activeGraphicsPipeline->pipelineLayout, activeGraphicsPipeline->pushConstantStages, offset, data);
+    }
+
+    void VulkanCommandBuffer::PushLightClusterData(VkPipelineLayout layout, VkShaderStageFlags stages, u32 offset, const LightClusterData& data)
+    {
+        struct
+        {
+            VkDeviceAddress pointLightBuffer;
+            VkDeviceAddress clusterLightCountBuffer;
+            VkDeviceAddress clusterLightIndexBuffer;
+            u32 pointLightCount;
+        } pushConstant;
+
+        u32 pcSize = sizeof(pushConstant);
+
+        VulkanGFXDevice* device = VulkanGFXDevice::Get();
+        pushConstant.pointLightBuffer = device->GetBuffer(data.pointLightBuffer)->bufferAddress;
+        pushConstant.clusterLightCountBuffer = device->GetBuffer(data.clusterLightCountBuffer)->bufferAddress;
+        pushConstant.clusterLightIndexBuffer = device->GetBuffer(data.clusterLightIndexBuffer)->bufferAddress;
+        pushConstant.pointLightCount = data.pointLightCount;
+
+        vkCmdPushConstants(vulkanCmdBuffer, layout, stages, offset, pcSize, &pushConstant);
     }
-}
\ No newline at end of file
+}
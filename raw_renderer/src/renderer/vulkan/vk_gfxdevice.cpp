@@ -263,6 +263,7 @@ namespace Raw::GFX
 
         VkPhysicalDevice discreteGPU = VK_NULL_HANDLE;
         VkPhysicalDevice integratedGPU = VK_NULL_HANDLE;
+        VkPhysicalDevice cpuDevice = VK_NULL_HANDLE;
         for(u32 i = 0; i < numGPUs; i++)
         {
             VkPhysicalDevice gpu = gpus[i];
@@ -287,6 +288,13 @@ namespace Raw::GFX
                 }
                 continue;
             }
+
+            // software rasterizers are only used when nothing else is around, so keep looking
+            if(m_GPUProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU && cpuDevice == VK_NULL_HANDLE)
+            {
+                if(GetFamilyQueue(gpu)) cpuDevice = gpu;
+                continue;
+            }
         }
 
         if(discreteGPU != VK_NULL_HANDLE)
@@ -297,11 +305,18 @@ namespace Raw::GFX
         {
             m_GPU = integratedGPU;
         }
+        else if(cpuDevice != VK_NULL_HANDLE)
+        {
+            m_GPU = cpuDevice;
+        }
         else
         {
             RAW_ASSERT_MSG(false, "Suitable GPU device not found!");
         }
 
+        // the loop leaves the properties of whichever device it looked at last
+        vkGetPhysicalDeviceProperties(m_GPU, &m_GPUProperties);
+
 
         RAW_INFO("Physical Device Obtained: %s", m_GPUProperties.deviceName);
         RAW_INFO("GPU Driver version: %d.%d.%d", 
@@ -342,8 +357,22 @@ namespace Raw::GFX
             }
         }
         
-        u32 deviceExtensionCount = 1;
-        const char* deviceExt[] = { "VK_KHR_swapchain" };
+        std::vector<const char*> deviceExt = { "VK_KHR_swapchain" };
+
+        u32 availableExtensionCount = 0;
+        vkEnumerateDeviceExtensionProperties(m_GPU, nullptr, &availableExtensionCount, nullptr);
+        std::vector<VkExtensionProperties> availableExtensions(availableExtensionCount);
+        vkEnumerateDeviceExtensionProperties(m_GPU, nullptr, &availableExtensionCount, availableExtensions.data());
+
+        bool meshShaderExtPresent = false;
+        for(const VkExtensionProperties& ext : availableExtensions)
+        {
+            if(!strcmp(ext.extensionName, VK_EXT_MESH_SHADER_EXTENSION_NAME))
+            {
+                meshShaderExtPresent = true;
+                break;
+            }
+        }
         const float queuePriority[] = { 1.0f };
         VkDeviceQueueCreateInfo queueInfo[2] = {};
         queueInfo[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -379,19 +408,49 @@ namespace Raw::GFX
 
         features12.pNext = &features13;
 
+        // optional, the geometry pass falls back to compute culled index buffers without it
+        VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
+        if(meshShaderExtPresent) features13.pNext = &meshShaderFeatures;
+
         vkGetPhysicalDeviceFeatures2(m_GPU, &features2);
 
+        m_MeshShadersSupported = meshShaderFeatures.taskShader && meshShaderFeatures.meshShader;
+        if(m_MeshShadersSupported)
+        {
+            // only task and mesh stages are used, the rest depend on features that aren't enabled
+            meshShaderFeatures.multiviewMeshShader = VK_FALSE;
+            meshShaderFeatures.primitiveFragmentShadingRateMeshShader = VK_FALSE;
+            meshShaderFeatures.meshShaderQueries = VK_FALSE;
+            deviceExt.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+        }
+        else
+        {
+            features13.pNext = nullptr;
+        }
+        RAW_INFO("Mesh shaders %s.", m_MeshShadersSupported ? "supported" : "not supported, using compute meshlet culling");
+
+        // optional, culled draws keep one command per draw and lod without it
+        VkPhysicalDeviceSubgroupProperties subgroupProperties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES };
+        VkPhysicalDeviceProperties2 properties2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+        properties2.pNext = &subgroupProperties;
+        vkGetPhysicalDeviceProperties2(m_GPU, &properties2);
+        m_DrawIndirectCountSupported = features12.drawIndirectCount &&
+            (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+            (subgroupProperties.supportedOperations & VK_SUBGROUP_FEATURE_BALLOT_BIT);
+        RAW_INFO("Indirect count draws %s.", m_DrawIndirectCountSupported ? "supported" : "not supported, drawing every culled command");
+
         RAW_ASSERT_MSG(features12.descriptorBindingPartiallyBound  && features12.runtimeDescriptorArray, "Bindless rendering not supported!");
         RAW_ASSERT_MSG(features12.bufferDeviceAddress, "Buffer device addressing not supported!");
         RAW_ASSERT_MSG(features13.dynamicRendering, "Dynamic rendering not supported!");
         RAW_ASSERT_MSG(features11.shaderDrawParameters, "Shader Draw Parameters not supported!");
         RAW_ASSERT_MSG(features2.features.multiDrawIndirect, "MDI not supported!");
+        RAW_ASSERT_MSG(features2.features.drawIndirectFirstInstance, "Indirect first instance not supported!");
 
         VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
         deviceCreateInfo.queueCreateInfoCount = m_TransferQueueFamily < U32_MAX ? 2 : 1;
         deviceCreateInfo.pQueueCreateInfos = queueInfo;
-        deviceCreateInfo.enabledExtensionCount = deviceExtensionCount;
-        deviceCreateInfo.ppEnabledExtensionNames = deviceExt;
+        deviceCreateInfo.enabledExtensionCount = (u32)deviceExt.size();
+        deviceCreateInfo.ppEnabledExtensionNames = deviceExt.data();
         deviceCreateInfo.pNext = &features2;
 
         VK_CHECK(vkCreateDevice(m_GPU, &deviceCreateInfo, m_AllocCallbacks, &m_LogicalDevice));
@@ -406,6 +465,11 @@ namespace Raw::GFX
             vkDestroyDebugUtilsMessengerEXT = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(m_Instance, "vkDestroyDebugUtilsMessengerEXT");
         }
 
+        if(m_MeshShadersSupported)
+        {
+            m_CmdDrawMeshTasks = (PFN_vkCmdDrawMeshTasksEXT)vkGetDeviceProcAddr(m_LogicalDevice, "vkCmdDrawMeshTasksEXT");
+        }
+
         vkGetDeviceQueue(m_LogicalDevice, m_GFXQueueFamily, 0, &m_GFXQueue);
         if(m_TransferQueueFamily < U32_MAX) vkGetDeviceQueue(m_LogicalDevice, m_TransferQueueFamily, 0, &m_TransferQueue);
 
@@ -1097,65 +1161,56 @@ namespace Raw::GFX
         VulkanBuffer* buffer = GetBuffer(handle);
         vmaUnmapMemory(m_VmaAllocator, buffer->allocation);
 
-        if(buffer->usageFlags & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
-        {
-            switch(type)
-            {
-                case EBufferMapType::SCENE:
-                {
-                    frameManager.sceneDataUpdates[m_CurFrame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-                    break;
-                }
-                case EBufferMapType::MATERIAL:
-                {
-                    frameManager.materialDataUpdates[m_CurFrame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-                    break;
-                }
-                case EBufferMapType::BINDLESS:
-                {
-                    frameManager.bindlessSetUpdates[m_CurFrame].WriteBuffer(VULKAN_UBO_BINDING, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-                    break;
-                }
-                case EBufferMapType::POINTLIGHT:
-                {
-                    frameManager.lightDataUpdates[m_CurFrame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-                    break;
-                }
-            }
-        }
+        QueueBufferWrite(buffer, type, m_CurFrame);
+    }
+
+    void* VulkanGFXDevice::GetMappedData(const BufferHandle& handle)
+    {
+        VulkanBuffer* buffer = GetBuffer(handle);
+        if(!buffer) return nullptr;
         
-        if(buffer->usageFlags & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
-        {
-            frameManager.bindlessSetUpdates[m_CurFrame].WriteBuffer(VULKAN_SSBO_BINDING, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
-        }
+        return buffer->allocInfo.pMappedData;
     }
 
     void VulkanGFXDevice::WriteBuffer(const BufferHandle& handle, EBufferMapType type)
     {
+        QueueBufferWrite(GetBuffer(handle), type, m_CurFrame);
+    }
+
+    void VulkanGFXDevice::WriteBufferAllFrames(const BufferHandle& handle, EBufferMapType type)
+    {
+        // each frame's writes are flushed once its fence has signaled, so no set is rewritten while the gpu reads it
         VulkanBuffer* buffer = GetBuffer(handle);
+        for(u32 frame = 0; frame < (u32)frameManager.materialDataUpdates.size(); frame++)
+        {
+            QueueBufferWrite(buffer, type, frame);
+        }
+    }
 
+    void VulkanGFXDevice::QueueBufferWrite(VulkanBuffer* buffer, EBufferMapType type, u32 frame)
+    {
         if(buffer->usageFlags & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
         {
             switch(type)
             {
                 case EBufferMapType::SCENE:
                 {
-                    frameManager.sceneDataUpdates[m_CurFrame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+                    frameManager.sceneDataUpdates[frame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, buffer->offset, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
                     break;
                 }
                 case EBufferMapType::MATERIAL:
                 {
-                    frameManager.materialDataUpdates[m_CurFrame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+                    frameManager.materialDataUpdates[frame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, buffer->offset, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
                     break;
                 }
                 case EBufferMapType::BINDLESS:
                 {
-                    frameManager.bindlessSetUpdates[m_CurFrame].WriteBuffer(VULKAN_UBO_BINDING, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+                    frameManager.bindlessSetUpdates[frame].WriteBuffer(VULKAN_UBO_BINDING, buffer->buffer, buffer->allocInfo.size, buffer->offset, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
                     break;
                 }
                 case EBufferMapType::POINTLIGHT:
                 {
-                    frameManager.lightDataUpdates[m_CurFrame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+                    frameManager.lightDataUpdates[frame].WriteBuffer(0, buffer->buffer, buffer->allocInfo.size, buffer->offset, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
                     break;
                 }
             }
@@ -1163,7 +1218,7 @@ namespace Raw::GFX
         
         if(buffer->usageFlags & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
         {
-            frameManager.bindlessSetUpdates[m_CurFrame].WriteBuffer(VULKAN_SSBO_BINDING, buffer->buffer, buffer->allocInfo.size, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+            frameManager.bindlessSetUpdates[frame].WriteBuffer(VULKAN_SSBO_BINDING, buffer->buffer, buffer->allocInfo.size, buffer->offset, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
         }
     }
 
@@ -1470,6 +1525,70 @@ namespace Raw::GFX
         return newTexture;
     }
 
+    void VulkanGFXDevice::CreateTextures(const TextureDesc* descs, void* const* initialData, u32 count, TextureHandle* outHandles)
+    {
+        if(count == 0) return;
+
+        // texel offsets must be a multiple of the texel size, 16 keeps every copy well aligned
+        std::vector<u64> offsets(count);
+        u64 stagingSize = 0;
+        for(u32 i = 0; i < count; i++)
+        {
+            offsets[i] = stagingSize;
+            stagingSize += ((u64)descs[i].width * descs[i].height * 4 + 15) & ~15ull;
+        }
+
+        BufferDesc bufferDesc = {};
+        bufferDesc.bufferSize = stagingSize;
+        bufferDesc.type = EBufferType::TRANSFER_SRC;
+        bufferDesc.memoryType = EMemoryType::HOST_VISIBLE;
+
+        BufferHandle temporaryBuffer = CreateBuffer(bufferDesc);
+        VulkanBuffer* stagingBuffer = GetBuffer(temporaryBuffer);
+        u8* stagingData = (u8*)stagingBuffer->allocInfo.pMappedData;
+
+        for(u32 i = 0; i < count; i++)
+        {
+            outHandles[i] = CreateTexture(descs[i]);
+            if(outHandles[i].IsValid()) memcpy(stagingData + offsets[i], initialData[i], (u64)descs[i].width * descs[i].height * 4);
+        }
+
+        immExecGFX.ImmediateSubmit(
+            [&](VkCommandBuffer cmd)
+            {
+                for(u32 i = 0; i < count; i++)
+                {
+                    if(!outHandles[i].IsValid()) continue;
+
+                    const TextureDesc& desc = descs[i];
+                    VulkanTexture* vulkanTexture = GetTexture(outHandles[i]);
+
+                    VkBufferImageCopy copyRegion = {};
+                    copyRegion.bufferOffset = offsets[i];
+                    copyRegion.bufferRowLength = 0;
+                    copyRegion.bufferImageHeight = 0;
+
+                    copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                    copyRegion.imageSubresource.mipLevel = 0;
+                    copyRegion.imageSubresource.baseArrayLayer = 0;
+                    copyRegion.imageSubresource.layerCount = 1;
+                    copyRegion.imageExtent.width = desc.width;
+                    copyRegion.imageExtent.height = desc.height;
+                    copyRegion.imageExtent.depth = desc.depth;
+
+                    u32 mipLevelCount = (u32)(std::floor(std::log2(std::max(desc.width, desc.height)))) + 1;
+                    vkUtils::TransitionImage(cmd, vulkanTexture->image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, false, mipLevelCount);
+                    vkCmdCopyBufferToImage(cmd, stagingBuffer->buffer, vulkanTexture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+                    vkUtils::GenerateMipMaps(cmd, vulkanTexture->image, { vulkanTexture->imageExtent.width, vulkanTexture->imageExtent.height });
+                    vkUtils::TransitionImage(cmd, vulkanTexture->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false, mipLevelCount);
+                    vulkanTexture->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                }
+            }
+        );
+
+        DestroyBufferInstant(temporaryBuffer);
+    }
+
     BufferHandle VulkanGFXDevice::CreateBuffer(const BufferDesc& desc)
     {
         BufferHandle handle = { resCache.buffers.ObtainResource() };
@@ -1525,38 +1644,68 @@ namespace Raw::GFX
     BufferHandle VulkanGFXDevice::CreateBuffer(const BufferDesc& desc, void* initialData)
     {
         BufferHandle newBuffer = CreateBuffer(desc);
-        if(newBuffer.IsValid())
+        if(newBuffer.IsValid()) UploadBufferData(newBuffer, 0, initialData, desc.bufferSize);
+        
+        return newBuffer;
+    }
+
+    BufferHandle VulkanGFXDevice::CreateBufferRange(const BufferHandle& buffer, u64 offset, u64 size)
+    {
+        VulkanBuffer* parent = GetBuffer(buffer);
+        RAW_ASSERT_MSG(parent->range == VK_WHOLE_SIZE, "Buffer ranges can't be created from other ranges!");
+        RAW_ASSERT_MSG(offset + size <= parent->allocInfo.size, "Buffer range [%llu, %llu) exceeds its buffer!", offset, offset + size);
+
+        BufferHandle handle = { resCache.buffers.ObtainResource() };
+        if(!handle.IsValid())
         {
-            VulkanBuffer* buffer = GetBuffer(newBuffer);
+            RAW_ERROR("Invalid BufferHandle!");
+            return handle;
+        }
 
-            BufferDesc stagingDesc;
-            stagingDesc.bufferSize = desc.bufferSize;
-            stagingDesc.memoryType = EMemoryType::HOST_VISIBLE;
-            stagingDesc.type = EBufferType::TRANSFER_SRC;
+        VulkanBuffer* vulkanBuffer = resCache.buffers.GetResource(handle.id);
+        *vulkanBuffer = {};
+        vulkanBuffer->buffer = parent->buffer;
+        vulkanBuffer->usageFlags = parent->usageFlags;
+        vulkanBuffer->offset = offset;
+        vulkanBuffer->range = size;
+        vulkanBuffer->allocInfo.size = size;
+        if(parent->allocInfo.pMappedData) vulkanBuffer->allocInfo.pMappedData = (u8*)parent->allocInfo.pMappedData + offset;
+        if(parent->bufferAddress) vulkanBuffer->bufferAddress = parent->bufferAddress + offset;
 
-            BufferHandle stagingHandle = CreateBuffer(stagingDesc);
-            VulkanBuffer* stagingBuffer = GetBuffer(stagingHandle);
+        return handle;
+    }
 
-            void* data = nullptr;
-            VK_CHECK(vmaMapMemory(m_VmaAllocator, stagingBuffer->allocation, &data));
-            memcpy(data, initialData, stagingDesc.bufferSize);
-            vmaUnmapMemory(m_VmaAllocator, stagingBuffer->allocation);
+    void VulkanGFXDevice::UploadBufferData(const BufferHandle& handle, u64 offset, const void* data, u64 size)
+    {
+        if(size == 0) return;
 
-            immExecTransfer.ImmediateSubmit([&](VkCommandBuffer cmd)
-                {
-                    VkBufferCopy bufferCopy{ 0 };
-                    bufferCopy.dstOffset = 0;
-                    bufferCopy.srcOffset = 0;
-                    bufferCopy.size = stagingDesc.bufferSize;
+        VulkanBuffer* buffer = GetBuffer(handle);
 
-                    vkCmdCopyBuffer(cmd, stagingBuffer->buffer, buffer->buffer, 1, &bufferCopy);
-                }
-            );
-            
-            DestroyBufferInstant(stagingHandle);
-        }
+        BufferDesc stagingDesc;
+        stagingDesc.bufferSize = size;
+        stagingDesc.memoryType = EMemoryType::HOST_VISIBLE;
+        stagingDesc.type = EBufferType::TRANSFER_SRC;
+
+        BufferHandle stagingHandle = CreateBuffer(stagingDesc);
+        VulkanBuffer* stagingBuffer = GetBuffer(stagingHandle);
+
+        void* stagingData = nullptr;
+        VK_CHECK(vmaMapMemory(m_VmaAllocator, stagingBuffer->allocation, &stagingData));
+        memcpy(stagingData, data, size);
+        vmaUnmapMemory(m_VmaAllocator, stagingBuffer->allocation);
+
+        immExecTransfer.ImmediateSubmit([&](VkCommandBuffer cmd)
+            {
+                VkBufferCopy bufferCopy{ 0 };
+                bufferCopy.dstOffset = buffer->offset + offset;
+                bufferCopy.srcOffset = 0;
+                bufferCopy.size = size;
+
+                vkCmdCopyBuffer(cmd, stagingBuffer->buffer, buffer->buffer, 1, &bufferCopy);
+            }
+        );
         
-        return newBuffer;
+        DestroyBufferInstant(stagingHandle);
     }
 
     SamplerHandle VulkanGFXDevice::CreateSampler(const SamplerDesc& desc)
@@ -1686,9 +1835,15 @@ namespace Raw::GFX
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
         
-        // use bindless descriptor set layout, scene data layout, material data layout, and point light data layout for all graphics pipelines
+        // use bindless descriptor set layout, scene data layout, material data layout, and point light data layout for all graphics pipelines.
+        // depth only pipelines get just the scene data, unless a fragment stage has to read materials
         std::vector<VkDescriptorSetLayout> layouts = { m_SceneLayout, m_BindlessLayout, m_MaterialDataLayout, m_LightLayout };
-        if(desc.numImageAttachments > 0)
+        bool hasFragmentStage = false;
+        for(u32 i = 0; i < MAX_SHADER_STAGES; i++)
+        {
+            if(desc.sDesc.shaders[i].shaderName != nullptr && desc.sDesc.shaders[i].stage == EShaderStage::FRAGMENT_STAGE) hasFragmentStage = true;
+        }
+        if(desc.numImageAttachments > 0 || hasFragmentStage)
         {
             pipelineLayoutInfo.pSetLayouts = layouts.data();
             pipelineLayoutInfo.setLayoutCount = (u32)layouts.size();
@@ -1704,8 +1859,7 @@ namespace Raw::GFX
         {
             pc.offset = desc.pushConstant.offset;
             pc.size = desc.pushConstant.size;
-            // temporary
-            pc.stageFlags = desc.pushConstant.stage & EShaderStage::VERTEX_STAGE ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+            pc.stageFlags = vkUtils::ToVkShaderStageFlags(desc.pushConstant.stage);
 
             pipelineLayoutInfo.pPushConstantRanges = &pc;
             pipelineLayoutInfo.pushConstantRangeCount = 1;
@@ -1851,6 +2005,8 @@ namespace Raw::GFX
         gfxPipeline->imageAttachements = desc.imageAttachments;
         gfxPipeline->numImageAttachments = desc.numImageAttachments;
         gfxPipeline->depthAttachment = desc.depthAttachment;
+        gfxPipeline->pushConstantStages = pc.stageFlags;
+        gfxPipeline->numDescriptorSets = pipelineLayoutInfo.setLayoutCount;
         // TODO: allow for custom layouts for each pipeline, first need to create DSLayout handle 
         gfxPipeline->dsLayout = VK_NULL_HANDLE;
 
@@ -2164,6 +2320,13 @@ namespace Raw::GFX
                 fullName += ".mesh.spv";
                 break;
             }
+
+            case EShaderStage::TASK_STAGE:
+            {
+                stageFlags = VK_SHADER_STAGE_TASK_BIT_EXT;
+                fullName += ".task.spv";
+                break;
+            }
             
             case EShaderStage::GEOM_STAGE:
             {
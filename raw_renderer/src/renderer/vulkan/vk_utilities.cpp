@@ -73,6 +73,33 @@ namespace Raw::GFX::vkUtils
 		vkCmdBlitImage2(cmd, &blitInfo);
 	}
 
+	void CopyImageExact(VkCommandBuffer cmd, VkImage src, VkImage dst, VkExtent2D size, VkImageAspectFlags aspect)
+	{
+		VkImageCopy2 copyRegion{};
+		copyRegion.sType = VK_STRUCTURE_TYPE_IMAGE_COPY_2;
+		copyRegion.pNext = nullptr;
+
+		copyRegion.srcSubresource.aspectMask = aspect;
+		copyRegion.srcSubresource.baseArrayLayer = 0;
+		copyRegion.srcSubresource.layerCount = 1;
+		copyRegion.srcSubresource.mipLevel = 0;
+
+		copyRegion.dstSubresource = copyRegion.srcSubresource;
+		copyRegion.extent = { size.width, size.height, 1 };
+
+		VkCopyImageInfo2 copyInfo{};
+		copyInfo.sType = VK_STRUCTURE_TYPE_COPY_IMAGE_INFO_2;
+		copyInfo.pNext = nullptr;
+		copyInfo.dstImage = dst;
+		copyInfo.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		copyInfo.srcImage = src;
+		copyInfo.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		copyInfo.regionCount = 1;
+		copyInfo.pRegions = &copyRegion;
+
+		vkCmdCopyImage2(cmd, &copyInfo);
+	}
+
 	void GenerateMipMaps(VkCommandBuffer cmd, VkImage image, VkExtent2D imageSize)
 	{
 		u32 mipLevels = (u32)(std::floor(std::log2(std::max(imageSize.width, imageSize.height)))) + 1;
@@ -182,11 +209,16 @@ namespace Raw::GFX::vkUtils
 			case EAccessFlags::DEPTH_STENCIL_ATTACHMENT_WRITE_BIT:		return VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 			case EAccessFlags::SHADER_WRITE_BIT:						return VK_ACCESS_SHADER_WRITE_BIT;
 			case EAccessFlags::SHADER_READ_BIT:							return VK_ACCESS_SHADER_READ_BIT;
+			case EAccessFlags::TRANSFER_READ_BIT:						return VK_ACCESS_TRANSFER_READ_BIT;
+			case EAccessFlags::TRANSFER_WRITE_BIT:						return VK_ACCESS_TRANSFER_WRITE_BIT;
+			case EAccessFlags::UNIFORM_READ_BIT:						return VK_ACCESS_UNIFORM_READ_BIT;
+			case EAccessFlags::INDIRECT_COMMAND_READ_BIT:				return VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+			case EAccessFlags::INDEX_READ_BIT:							return VK_ACCESS_INDEX_READ_BIT;
 			default:													return VK_ACCESS_FLAG_BITS_MAX_ENUM;
 		}
 	}
 
-	VkPipelineStageFlags ToVkPipelineStageFlags(EPipelineStageFlags flag)
+	VkPipelineStageFlags ToVkPipelineStage(EPipelineStageFlags flag)
 	{
 		switch(flag)
 		{
@@ -201,10 +233,24 @@ namespace Raw::GFX::vkUtils
 			case EPipelineStageFlags::LATE_FRAGMENT_TESTS_BIT:				return VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
 			case EPipelineStageFlags::COLOR_ATTACHMENT_OUTPUT_BIT:			return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 			case EPipelineStageFlags::NONE:									return VK_PIPELINE_STAGE_NONE;
+			case EPipelineStageFlags::TRANSFER_BIT:							return VK_PIPELINE_STAGE_TRANSFER_BIT;
+			case EPipelineStageFlags::DRAW_INDIRECT_BIT:					return VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+			case EPipelineStageFlags::TASK_SHADER_BIT:						return VK_PIPELINE_STAGE_TASK_SHADER_BIT_EXT;
+			case EPipelineStageFlags::MESH_SHADER_BIT:						return VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT;
 			default:														return VK_PIPELINE_STAGE_FLAG_BITS_MAX_ENUM;
 		}
 	}
 
+	VkPipelineStageFlags ToVkPipelineStageFlags(EPipelineStageFlags flags)
+	{
+		VkPipelineStageFlags vkFlags = 0;
+		for(u32 bit = 0; bit < 15; bit++)
+		{
+			if(flags & (1 << bit)) vkFlags |= ToVkPipelineStage((EPipelineStageFlags)(1 << bit));
+		}
+		return vkFlags;
+	}
+
 	VkImageViewType ToVkImageViewType(ETextureType type)
 	{
 		switch(type)
@@ -231,6 +277,7 @@ namespace Raw::GFX::vkUtils
 			case ETextureFormat::D32_SFLOAT: 							return VK_FORMAT_D32_SFLOAT;
 			case ETextureFormat::D24_UNORM_S8_UINT: 					return VK_FORMAT_D24_UNORM_S8_UINT;
 			case ETextureFormat::D32_SFLOAT_S8_UINT: 					return VK_FORMAT_D32_SFLOAT_S8_UINT;
+			case ETextureFormat::R32G32_SFLOAT: 						return VK_FORMAT_R32G32_SFLOAT;
 			default:													return VK_FORMAT_UNDEFINED;
 		}
 	}
@@ -246,6 +293,7 @@ namespace Raw::GFX::vkUtils
 			case VK_FORMAT_D32_SFLOAT: 									return ETextureFormat::D32_SFLOAT;
 			case VK_FORMAT_D24_UNORM_S8_UINT:							return ETextureFormat::D24_UNORM_S8_UINT;
 			case VK_FORMAT_D32_SFLOAT_S8_UINT:							return ETextureFormat::D32_SFLOAT_S8_UINT;
+			case VK_FORMAT_R32G32_SFLOAT:								return ETextureFormat::R32G32_SFLOAT;
 			default:													return ETextureFormat::UNDEFINED;
 		}
 	}
@@ -419,10 +467,21 @@ namespace Raw::GFX::vkUtils
         	case EShaderStage::GEOM_STAGE:								return VK_SHADER_STAGE_GEOMETRY_BIT;
         	case EShaderStage::TESS_EVAL_STAGE:							return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
         	case EShaderStage::TESS_CONTROL_STAGE:						return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        	case EShaderStage::TASK_STAGE:								return VK_SHADER_STAGE_TASK_BIT_EXT;
 			default:													return VK_SHADER_STAGE_ALL;
 		}
 	}
 
+	VkShaderStageFlags ToVkShaderStageFlags(u8 stages)
+	{
+		VkShaderStageFlags flags = 0;
+		for(u32 bit = 0; bit < 8; bit++)
+		{
+			if(stages & (1 << bit)) flags |= ToVkShaderStage((EShaderStage)(1 << bit));
+		}
+		return flags;
+	}
+
 	VkPolygonMode ToVkPolygonMode(EFillMode fillMode)
 	{
 		switch(fillMode)
@@ -460,4 +519,14 @@ namespace Raw::GFX::vkUtils
 			default:													return VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		}
 	}
+
+	VkIndexType ToVkIndexType(EIndexType type)
+	{
+		switch(type)
+		{
+			case EIndexType::UINT16:									return VK_INDEX_TYPE_UINT16;
+			case EIndexType::UINT32:									return VK_INDEX_TYPE_UINT32;
+			default:													return VK_INDEX_TYPE_UINT32;
+		}
+	}
 }
\ No newline at end of file
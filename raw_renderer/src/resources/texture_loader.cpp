@@ -4,6 +4,7 @@
 #include "core/logger.hpp"
 #include "utility/hash.hpp"
 #include "stb_image.h"
+#include <vector>
 
 namespace Raw
 {
@@ -187,6 +188,65 @@ namespace Raw
         return m_TextureMap[hashedName].get();
     }
 
+    void TextureLoader::CreateFromDataBatch(const cstring* names, const GFX::TextureDesc* descs, void* const* data, u32 count, Resource** outResources)
+    {
+        std::vector<u64> hashedNames(count);
+        std::vector<u32> pending;
+        std::vector<GFX::TextureDesc> pendingDescs;
+        std::vector<void*> pendingData;
+        std::unordered_map<u64, u32> pendingLookUp;
+        pending.reserve(count);
+        pendingDescs.reserve(count);
+        pendingData.reserve(count);
+
+        for(u32 i = 0; i < count; i++)
+        {
+            hashedNames[i] = Utils::HashCString(names[i]);
+            outResources[i] = nullptr;
+
+            auto it = m_TextureMap.find(hashedNames[i]);
+            if(it != m_TextureMap.end())
+            {
+                outResources[i] = it->second.get();
+                continue;
+            }
+            // a name repeated within the batch is only uploaded once
+            if(pendingLookUp.find(hashedNames[i]) != pendingLookUp.end()) continue;
+
+            pendingLookUp[hashedNames[i]] = (u32)pending.size();
+            pending.push_back(i);
+            pendingDescs.push_back(descs[i]);
+            pendingData.push_back(data[i]);
+        }
+        if(pending.empty()) return;
+
+        std::vector<GFX::TextureHandle> handles(pending.size());
+        GFX::IGFXDevice* device = (GFX::IGFXDevice*)ServiceLocator::Get()->GetService(GFX::IGFXDevice::k_ServiceName);
+        device->CreateTextures(pendingDescs.data(), pendingData.data(), (u32)pending.size(), handles.data());
+
+        for(u64 i = 0; i < pending.size(); i++)
+        {
+            if(!handles[i].IsValid()) continue;
+
+            const u32 index = pending[i];
+            rstd::unique_ptr<TextureResource> tex = rstd::make_unique<TextureResource>();
+            tex->name = names[index];
+            tex->textureId = hashedNames[index];
+            tex->handle = handles[i];
+            tex->AddRef();
+
+            m_TextureMap.insert(std::pair<u64, rstd::unique_ptr<TextureResource>>(hashedNames[index], std::move(tex)));
+        }
+
+        for(u32 i = 0; i < count; i++)
+        {
+            if(outResources[i]) continue;
+
+            auto it = m_TextureMap.find(hashedNames[i]);
+            if(it != m_TextureMap.end()) outResources[i] = it->second.get();
+        }
+    }
+
     Resource* TextureLoader::CreateFromHandle(cstring name, const GFX::TextureHandle& texture)
     {
         RAW_ASSERT_MSG(texture.IsValid(), "Cannot create texture resource with invalid texture handle!");
@@ -0,0 +1,168 @@
+#include "resources/texture_streamer.hpp"
+#include "resources/texture_loader.hpp"
+#include "platform/mapped_file.hpp"
+#include "core/job_system.hpp"
+#include "core/logger.hpp"
+#include "core/timer.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace Raw
+{
+    namespace
+    {
+        enum EStreamState : u8
+        {
+            QUEUED = 0,
+            DECODING,
+            DECODED,
+            UPLOADED,
+        };
+    }
+
+    void TextureStreamer::Begin(std::vector<StreamedImageSource>&& sources, std::vector<u32>& images)
+    {
+        Cancel();
+
+        // the entries hold atomics, so the vector is built at its final size and never reallocated while jobs point into it
+        m_Images = std::vector<StreamedImage>(sources.size());
+        for(u64 i = 0; i < sources.size(); i++) m_Images[i].source = std::move(sources[i]);
+
+        images.assign(sources.size(), k_PendingImage);
+        m_NextDecode = 0;
+        m_FirstPending = 0;
+        m_Remaining = (u32)m_Images.size();
+        m_StartTime = Timer::Get()->Now();
+    }
+
+    void TextureStreamer::Update(u64 uploadBudget, std::vector<u32>& images, std::vector<u64>& imageIds, std::vector<u32>& outUpdated)
+    {
+        if(IsDone()) return;
+
+        // half the workers stay free for the frame's own jobs, which would otherwise queue behind a decode
+        const u32 maxInFlight = std::max(1u, JobSystem::GetNumThreads() / 2);
+        while(m_NextDecode < (u32)m_Images.size() && m_InFlight.load() < maxInFlight)
+        {
+            StreamedImage* image = &m_Images[m_NextDecode++];
+            image->state.store(DECODING);
+            m_InFlight.fetch_add(1);
+
+            JobSystem::ExecuteBackground([this, image]()
+                {
+                    if(!m_Cancelled.load())
+                    {
+                        const StreamedImageSource& source = image->source;
+                        if(!source.encoded.empty())
+                        {
+                            Utils::DecodeImage(source.encoded.data(), source.encoded.size(), source.name.c_str(), image->decoded);
+                        }
+                        else
+                        {
+                            MappedFile imageFile;
+                            if(imageFile.Open(source.path.c_str()))
+                            {
+                                Utils::DecodeImage(imageFile.GetData(), imageFile.GetSize(), source.name.c_str(), image->decoded);
+                            }
+                        }
+                    }
+
+                    image->state.store(DECODED, std::memory_order_release);
+                    m_InFlight.fetch_sub(1);
+                }
+            );
+        }
+
+        TextureResource* errorTex = (TextureResource*)TextureLoader::Instance()->Get(ERROR_TEXTURE);
+
+        std::vector<cstring> batchNames;
+        std::vector<GFX::TextureDesc> batchDescs;
+        std::vector<void*> batchData;
+        std::vector<u32> batchImages;
+        u64 batchSize = 0;
+
+        // decodes finish out of order, whatever is ready goes into this frame's batch. the first image always fits
+        // so one texture larger than the budget still gets through
+        for(u32 i = m_FirstPending; i < m_NextDecode; i++)
+        {
+            StreamedImage& image = m_Images[i];
+            if(image.state.load(std::memory_order_acquire) != DECODED) continue;
+
+            if(!image.decoded.pixels)
+            {
+                images[i] = errorTex->handle.id;
+                image.state.store(UPLOADED);
+                outUpdated.push_back(i);
+                m_Remaining--;
+                continue;
+            }
+
+            const u64 imageSize = (u64)image.decoded.width * image.decoded.height * 4;
+            if(batchSize > 0 && batchSize + imageSize > uploadBudget) break;
+
+            GFX::TextureDesc desc;
+            desc.depth = 1;
+            desc.width = image.decoded.width;
+            desc.height = image.decoded.height;
+            desc.isMipmapped = true;
+            desc.isRenderTarget = false;
+            desc.isStorageImage = false;
+            desc.type = GFX::ETextureType::TEXTURE2D;
+            desc.format = GFX::ETextureFormat::R8G8B8A8_UNORM;
+
+            batchNames.push_back(image.source.name.c_str());
+            batchDescs.push_back(desc);
+            batchData.push_back(image.decoded.pixels);
+            batchImages.push_back(i);
+            batchSize += imageSize;
+        }
+
+        if(!batchNames.empty())
+        {
+            std::vector<Resource*> batchResources(batchNames.size());
+            TextureLoader::Instance()->CreateFromDataBatch(batchNames.data(), batchDescs.data(), batchData.data(), (u32)batchNames.size(), batchResources.data());
+
+            for(u64 i = 0; i < batchResources.size(); i++)
+            {
+                const u32 index = batchImages[i];
+                TextureResource* tex = (TextureResource*)batchResources[i];
+                if(tex)
+                {
+                    images[index] = tex->handle.id;
+                    imageIds.push_back(tex->textureId);
+                    tex->AddRef();
+                }
+                else
+                {
+                    images[index] = errorTex->handle.id;
+                }
+
+                Utils::FreeDecodedImage(m_Images[index].decoded);
+                m_Images[index].state.store(UPLOADED);
+                outUpdated.push_back(index);
+                m_Remaining--;
+            }
+        }
+
+        while(m_FirstPending < m_NextDecode && m_Images[m_FirstPending].state.load() == UPLOADED) m_FirstPending++;
+
+        if(IsDone())
+        {
+            const f64 streamTime = Timer::Get()->DeltaSeconds(m_StartTime, Timer::Get()->Now());
+            RAW_INFO("Streamed %u images in %0.2lf s.", (u32)m_Images.size(), streamTime);
+        }
+    }
+
+    void TextureStreamer::Cancel()
+    {
+        // jobs skip their decode once cancelled, but still touch their entry before they finish
+        m_Cancelled.store(true);
+        while(m_InFlight.load() > 0) { std::this_thread::yield(); }
+        m_Cancelled.store(false);
+
+        for(StreamedImage& image : m_Images) Utils::FreeDecodedImage(image.decoded);
+        m_Images.clear();
+        m_NextDecode = 0;
+        m_FirstPending = 0;
+        m_Remaining = 0;
+    }
+}
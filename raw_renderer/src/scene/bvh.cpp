@@ -0,0 +1,569 @@
+#include "scene/bvh.hpp"
+#include "core/asserts.hpp"
+#include "core/simd.hpp"
+#include <algorithm>
+
+namespace Raw
+{
+    namespace
+    {
+        constexpr u32 MAX_LEAF_PRIMITIVES = 4;
+        constexpr u32 SAH_BIN_COUNT = 16;
+
+        struct BuildRange
+        {
+            u32 first{ 0 };
+            u32 count{ 0 };
+            f32 halfArea{ 0.f };
+        };
+
+        struct RayStackEntry
+        {
+            u32 node{ 0 };
+            f32 distance{ 0.f };
+        };
+
+        RAW_INLINE AABB LoadInstanceBounds(const GFX::SceneData& sceneData, u32 instance)
+        {
+            const GFX::InstanceBoundsData& bounds = sceneData.instanceBounds[instance];
+            AABB out;
+            out.min = bounds.boundsMin;
+            out.max = bounds.boundsMax;
+            return out;
+        }
+
+        RAW_INLINE void GetFrustumPlanes(const GFX::Frustum& frustum, GFX::Plane* outPlanes)
+        {
+            outPlanes[0] = frustum.topFace;
+            outPlanes[1] = frustum.bottomFace;
+            outPlanes[2] = frustum.leftFace;
+            outPlanes[3] = frustum.rightFace;
+            outPlanes[4] = frustum.nearFace;
+            outPlanes[5] = frustum.farFace;
+        }
+
+        RAW_INLINE u32 GetValidMask(const BVHNode& node)
+        {
+            u32 mask = 0;
+            for(u32 i = 0; i < BVH_WIDTH; i++)
+            {
+                if(node.counts[i] > 0 || node.children[i] != INVALID_BVH_NODE) mask |= 1u << i;
+            }
+            return mask;
+        }
+
+        // bit i is set if child i is at least partially in front of every plane, tested against the corner furthest along each normal
+        u32 TestFrustum(const BVHNode& node, const GFX::Plane* planes)
+        {
+#if defined(RAW_SIMD_SSE)
+            const __m128 minX = _mm_load_ps(node.minX);
+            const __m128 minY = _mm_load_ps(node.minY);
+            const __m128 minZ = _mm_load_ps(node.minZ);
+            const __m128 maxX = _mm_load_ps(node.maxX);
+            const __m128 maxY = _mm_load_ps(node.maxY);
+            const __m128 maxZ = _mm_load_ps(node.maxZ);
+            const __m128 zero = _mm_setzero_ps();
+
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for(u32 p = 0; p < 6; p++)
+            {
+                const GFX::Plane& plane = planes[p];
+                const __m128 x = plane.normal.x >= 0.f ? maxX : minX;
+                const __m128 y = plane.normal.y >= 0.f ? maxY : minY;
+                const __m128 z = plane.normal.z >= 0.f ? maxZ : minZ;
+
+                __m128 dist = _mm_mul_ps(x, _mm_set1_ps(plane.normal.x));
+                dist = _mm_add_ps(dist, _mm_mul_ps(y, _mm_set1_ps(plane.normal.y)));
+                dist = _mm_add_ps(dist, _mm_mul_ps(z, _mm_set1_ps(plane.normal.z)));
+                dist = _mm_add_ps(dist, _mm_set1_ps(plane.distance));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, zero));
+            }
+            return (u32)_mm_movemask_ps(inside) & GetValidMask(node);
+#else
+            u32 mask = GetValidMask(node);
+            for(u32 i = 0; i < BVH_WIDTH; i++)
+            {
+                for(u32 p = 0; p < 6; p++)
+                {
+                    const GFX::Plane& plane = planes[p];
+                    const f32 x = plane.normal.x >= 0.f ? node.maxX[i] : node.minX[i];
+                    const f32 y = plane.normal.y >= 0.f ? node.maxY[i] : node.minY[i];
+                    const f32 z = plane.normal.z >= 0.f ? node.maxZ[i] : node.minZ[i];
+                    if(plane.normal.x * x + plane.normal.y * y + plane.normal.z * z + plane.distance < 0.f)
+                    {
+                        mask &= ~(1u << i);
+                        break;
+                    }
+                }
+            }
+            return mask;
+#endif
+        }
+
+        u32 TestOverlap(const BVHNode& node, const AABB& bounds)
+        {
+#if defined(RAW_SIMD_SSE)
+            __m128 overlap = _mm_cmple_ps(_mm_load_ps(node.minX), _mm_set1_ps(bounds.max.x));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_load_ps(node.minY), _mm_set1_ps(bounds.max.y)));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_load_ps(node.minZ), _mm_set1_ps(bounds.max.z)));
+            overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_load_ps(node.maxX), _mm_set1_ps(bounds.min.x)));
+            overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_load_ps(node.maxY), _mm_set1_ps(bounds.min.y)));
+            overlap = _mm_and_ps(overlap, _mm_cmpge_ps(_mm_load_ps(node.maxZ), _mm_set1_ps(bounds.min.z)));
+            return (u32)_mm_movemask_ps(overlap) & GetValidMask(node);
+#else
+            u32 mask = 0;
+            for(u32 i = 0; i < BVH_WIDTH; i++)
+            {
+                if(node.minX[i] <= bounds.max.x && node.minY[i] <= bounds.max.y && node.minZ[i] <= bounds.max.z &&
+                    node.maxX[i] >= bounds.min.x && node.maxY[i] >= bounds.min.y && node.maxZ[i] >= bounds.min.z)
+                {
+                    mask |= 1u << i;
+                }
+            }
+            return mask & GetValidMask(node);
+#endif
+        }
+
+        // slab test of the ray against all four children, outDistances receives where the ray enters each hit child
+        u32 TestRay(const BVHNode& node, const glm::vec3& origin, const glm::vec3& invDir, f32 maxDistance, f32* outDistances)
+        {
+#if defined(RAW_SIMD_SSE)
+            const __m128 ox = _mm_set1_ps(origin.x);
+            const __m128 oy = _mm_set1_ps(origin.y);
+            const __m128 oz = _mm_set1_ps(origin.z);
+            const __m128 ix = _mm_set1_ps(invDir.x);
+            const __m128 iy = _mm_set1_ps(invDir.y);
+            const __m128 iz = _mm_set1_ps(invDir.z);
+
+            const __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), ox), ix);
+            const __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), ox), ix);
+            const __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), oy), iy);
+            const __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), oy), iy);
+            const __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), oz), iz);
+            const __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), oz), iz);
+
+            __m128 tEnter = _mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1));
+            tEnter = _mm_max_ps(tEnter, _mm_min_ps(z0, z1));
+            tEnter = _mm_max_ps(tEnter, _mm_setzero_ps());
+            __m128 tExit = _mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1));
+            tExit = _mm_min_ps(tExit, _mm_max_ps(z0, z1));
+            tExit = _mm_min_ps(tExit, _mm_set1_ps(maxDistance));
+
+            _mm_storeu_ps(outDistances, tEnter);
+            return (u32)_mm_movemask_ps(_mm_cmple_ps(tEnter, tExit)) & GetValidMask(node);
+#else
+            u32 mask = 0;
+            for(u32 i = 0; i < BVH_WIDTH; i++)
+            {
+                const f32 x0 = (node.minX[i] - origin.x) * invDir.x;
+                const f32 x1 = (node.maxX[i] - origin.x) * invDir.x;
+                const f32 y0 = (node.minY[i] - origin.y) * invDir.y;
+                const f32 y1 = (node.maxY[i] - origin.y) * invDir.y;
+                const f32 z0 = (node.minZ[i] - origin.z) * invDir.z;
+                const f32 z1 = (node.maxZ[i] - origin.z) * invDir.z;
+
+                const f32 tEnter = std::max(std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::min(z0, z1)), 0.f);
+                const f32 tExit = std::min(std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::max(z0, z1)), maxDistance);
+                outDistances[i] = tEnter;
+                if(tEnter <= tExit) mask |= 1u << i;
+            }
+            return mask & GetValidMask(node);
+#endif
+        }
+
+        bool IsInFrustum(const AABB& bounds, const GFX::Plane* planes)
+        {
+            for(u32 p = 0; p < 6; p++)
+            {
+                const GFX::Plane& plane = planes[p];
+                const glm::vec3 corner = glm::vec3(
+                    plane.normal.x >= 0.f ? bounds.max.x : bounds.min.x,
+                    plane.normal.y >= 0.f ? bounds.max.y : bounds.min.y,
+                    plane.normal.z >= 0.f ? bounds.max.z : bounds.min.z);
+                if(glm::dot(plane.normal, corner) + plane.distance < 0.f) return false;
+            }
+            return true;
+        }
+
+        RAW_INLINE bool Overlaps(const AABB& a, const AABB& b)
+        {
+            return a.min.x <= b.max.x && a.min.y <= b.max.y && a.min.z <= b.max.z &&
+                a.max.x >= b.min.x && a.max.y >= b.min.y && a.max.z >= b.min.z;
+        }
+
+        bool IntersectRay(const AABB& bounds, const glm::vec3& origin, const glm::vec3& invDir, f32 maxDistance, f32& outDistance)
+        {
+            const glm::vec3 t0 = (bounds.min - origin) * invDir;
+            const glm::vec3 t1 = (bounds.max - origin) * invDir;
+            const glm::vec3 tMin = glm::min(t0, t1);
+            const glm::vec3 tMax = glm::max(t0, t1);
+
+            const f32 tEnter = std::max(std::max(std::max(tMin.x, tMin.y), tMin.z), 0.f);
+            const f32 tExit = std::min(std::min(std::min(tMax.x, tMax.y), tMax.z), maxDistance);
+            outDistance = tEnter;
+            return tEnter <= tExit;
+        }
+    }
+
+    void BVH::Build(const GFX::SceneData& sceneData)
+    {
+        Clear();
+
+        const u32 instanceCount = (u32)sceneData.draws.size();
+        if(instanceCount == 0) return;
+
+        m_InstanceBounds.resize(instanceCount);
+        m_Centers.resize(instanceCount);
+        m_Primitives.resize(instanceCount);
+        for(u32 i = 0; i < instanceCount; i++)
+        {
+            m_InstanceBounds[i] = LoadInstanceBounds(sceneData, i);
+            m_Centers[i] = m_InstanceBounds[i].GetCenter();
+            m_Primitives[i] = i;
+        }
+
+        // every node holds at least two children, so there are fewer nodes than leaves
+        m_Nodes.reserve(instanceCount / 2 + 1);
+        BuildNode(0, instanceCount);
+        RefitNodes();
+    }
+
+    void BVH::Refit(const GFX::SceneData& sceneData, const std::vector<ChangeRange>& changedDraws)
+    {
+        if(changedDraws.empty()) return;
+
+        if(sceneData.draws.size() != m_InstanceBounds.size())
+        {
+            Build(sceneData);
+            return;
+        }
+
+        for(const ChangeRange& range : changedDraws)
+        {
+            for(u32 i = range.first; i < range.first + range.count; i++)
+            {
+                m_InstanceBounds[i] = LoadInstanceBounds(sceneData, i);
+            }
+        }
+        RefitNodes();
+    }
+
+    void BVH::Clear()
+    {
+        m_Nodes.clear();
+        m_Primitives.clear();
+        m_InstanceBounds.clear();
+        m_Centers.clear();
+    }
+
+    u32 BVH::BuildNode(u32 first, u32 count)
+    {
+        const u32 nodeIndex = (u32)m_Nodes.size();
+        m_Nodes.emplace_back();
+
+        BuildRange ranges[BVH_WIDTH];
+        u32 rangeCount = 1;
+        ranges[0].first = first;
+        ranges[0].count = count;
+        ranges[0].halfArea = std::numeric_limits<f32>::max();
+
+        // keep splitting the largest child until there are four or all of them fit in a leaf
+        while(rangeCount < BVH_WIDTH)
+        {
+            u32 largest = U32_MAX;
+            for(u32 i = 0; i < rangeCount; i++)
+            {
+                if(ranges[i].count <= MAX_LEAF_PRIMITIVES) continue;
+                if(largest == U32_MAX || ranges[i].halfArea > ranges[largest].halfArea) largest = i;
+            }
+            if(largest == U32_MAX) break;
+
+            const BuildRange range = ranges[largest];
+            const u32 split = SplitRange(range.first, range.count);
+
+            ranges[largest] = { range.first, split - range.first, GetRangeHalfArea(range.first, split - range.first) };
+            ranges[rangeCount++] = { split, range.first + range.count - split, GetRangeHalfArea(split, range.first + range.count - split) };
+        }
+
+        for(u32 i = 0; i < BVH_WIDTH; i++)
+        {
+            u32 child = INVALID_BVH_NODE;
+            u32 leafCount = 0;
+            if(i < rangeCount)
+            {
+                if(ranges[i].count <= MAX_LEAF_PRIMITIVES)
+                {
+                    child = ranges[i].first;
+                    leafCount = ranges[i].count;
+                }
+                else
+                {
+                    child = BuildNode(ranges[i].first, ranges[i].count);
+                }
+            }
+
+            // the recursion may have reallocated m_Nodes
+            m_Nodes[nodeIndex].children[i] = child;
+            m_Nodes[nodeIndex].counts[i] = leafCount;
+        }
+
+        return nodeIndex;
+    }
+
+    u32 BVH::SplitRange(u32 first, u32 count)
+    {
+        AABB centerBounds;
+        for(u32 i = first; i < first + count; i++) centerBounds.Grow(m_Centers[m_Primitives[i]]);
+
+        const glm::vec3 extent = centerBounds.max - centerBounds.min;
+
+        struct Bin
+        {
+            AABB bounds;
+            u32 count{ 0 };
+        };
+
+        f32 bestCost = std::numeric_limits<f32>::max();
+        u32 bestAxis = U32_MAX;
+        u32 bestBin = 0;
+        for(u32 axis = 0; axis < 3; axis++)
+        {
+            if(extent[axis] <= 0.f) continue;
+
+            Bin bins[SAH_BIN_COUNT];
+            const f32 scale = (f32)SAH_BIN_COUNT / extent[axis];
+            for(u32 i = first; i < first + count; i++)
+            {
+                const u32 primitive = m_Primitives[i];
+                const u32 bin = std::min(SAH_BIN_COUNT - 1, (u32)((m_Centers[primitive][axis] - centerBounds.min[axis]) * scale));
+                bins[bin].bounds.Grow(m_InstanceBounds[primitive]);
+                bins[bin].count++;
+            }
+
+            // cost of splitting after bin i is area * count of both sides, swept from the right then from the left
+            f32 rightCosts[SAH_BIN_COUNT];
+            AABB rightBounds;
+            u32 rightCount = 0;
+            for(u32 i = SAH_BIN_COUNT - 1; i > 0; i--)
+            {
+                rightBounds.Grow(bins[i].bounds);
+                rightCount += bins[i].count;
+                rightCosts[i - 1] = rightCount > 0 ? rightBounds.GetHalfArea() * rightCount : 0.f;
+            }
+
+            AABB leftBounds;
+            u32 leftCount = 0;
+            for(u32 i = 0; i < SAH_BIN_COUNT - 1; i++)
+            {
+                leftBounds.Grow(bins[i].bounds);
+                leftCount += bins[i].count;
+                if(leftCount == 0 || leftCount == count) continue;
+
+                const f32 cost = leftBounds.GetHalfArea() * leftCount + rightCosts[i];
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = i;
+                }
+            }
+        }
+
+        const u32 mid = first + count / 2;
+        if(bestAxis == U32_MAX)
+        {
+            // every center is in the same place, any split is as good as another
+            return mid;
+        }
+
+        const f32 scale = (f32)SAH_BIN_COUNT / extent[bestAxis];
+        const f32 minCenter = centerBounds.min[bestAxis];
+        u32* split = std::partition(m_Primitives.data() + first, m_Primitives.data() + first + count, [&](u32 primitive)
+            {
+                const u32 bin = std::min(SAH_BIN_COUNT - 1, (u32)((m_Centers[primitive][bestAxis] - minCenter) * scale));
+                return bin <= bestBin;
+            }
+        );
+
+        const u32 splitIndex = (u32)(split - m_Primitives.data());
+        RAW_ASSERT(splitIndex > first && splitIndex < first + count);
+        return splitIndex;
+    }
+
+    f32 BVH::GetRangeHalfArea(u32 first, u32 count) const
+    {
+        AABB bounds;
+        for(u32 i = first; i < first + count; i++) bounds.Grow(m_InstanceBounds[m_Primitives[i]]);
+        return bounds.GetHalfArea();
+    }
+
+    AABB BVH::GetBounds() const
+    {
+        AABB bounds;
+        if(m_Nodes.empty()) return bounds;
+
+        // empty slots of the root have inverted bounds, so they don't grow anything
+        const BVHNode& root = m_Nodes[0];
+        for(u32 i = 0; i < BVH_WIDTH; i++)
+        {
+            bounds.min = glm::min(bounds.min, glm::vec3(root.minX[i], root.minY[i], root.minZ[i]));
+            bounds.max = glm::max(bounds.max, glm::vec3(root.maxX[i], root.maxY[i], root.maxZ[i]));
+        }
+        return bounds;
+    }
+
+    void BVH::RefitNodes()
+    {
+        // children are always located after their parent
+        for(u32 n = (u32)m_Nodes.size(); n-- > 0;)
+        {
+            BVHNode& node = m_Nodes[n];
+            for(u32 i = 0; i < BVH_WIDTH; i++)
+            {
+                AABB bounds;
+                if(node.counts[i] > 0)
+                {
+                    for(u32 p = node.children[i]; p < node.children[i] + node.counts[i]; p++) bounds.Grow(m_InstanceBounds[m_Primitives[p]]);
+                }
+                else if(node.children[i] != INVALID_BVH_NODE)
+                {
+                    const BVHNode& child = m_Nodes[node.children[i]];
+                    for(u32 c = 0; c < BVH_WIDTH; c++)
+                    {
+                        bounds.min = glm::min(bounds.min, glm::vec3(child.minX[c], child.minY[c], child.minZ[c]));
+                        bounds.max = glm::max(bounds.max, glm::vec3(child.maxX[c], child.maxY[c], child.maxZ[c]));
+                    }
+                }
+
+                node.minX[i] = bounds.min.x;
+                node.minY[i] = bounds.min.y;
+                node.minZ[i] = bounds.min.z;
+                node.maxX[i] = bounds.max.x;
+                node.maxY[i] = bounds.max.y;
+                node.maxZ[i] = bounds.max.z;
+            }
+        }
+    }
+
+    void BVH::QueryFrustum(const GFX::Frustum& frustum, std::vector<u32>& outInstances) const
+    {
+        if(m_Nodes.empty()) return;
+
+        GFX::Plane planes[6];
+        GetFrustumPlanes(frustum, planes);
+
+        std::vector<u32> stack;
+        stack.reserve(64);
+        stack.push_back(0);
+        while(!stack.empty())
+        {
+            const BVHNode& node = m_Nodes[stack.back()];
+            stack.pop_back();
+
+            const u32 mask = TestFrustum(node, planes);
+            for(u32 i = 0; i < BVH_WIDTH; i++)
+            {
+                if(!(mask & (1u << i))) continue;
+
+                if(node.counts[i] == 0)
+                {
+                    stack.push_back(node.children[i]);
+                    continue;
+                }
+
+                for(u32 p = node.children[i]; p < node.children[i] + node.counts[i]; p++)
+                {
+                    const u32 instance = m_Primitives[p];
+                    if(IsInFrustum(m_InstanceBounds[instance], planes)) outInstances.push_back(instance);
+                }
+            }
+        }
+    }
+
+    void BVH::QueryOverlap(const AABB& bounds, std::vector<u32>& outInstances) const
+    {
+        if(m_Nodes.empty()) return;
+
+        std::vector<u32> stack;
+        stack.reserve(64);
+        stack.push_back(0);
+        while(!stack.empty())
+        {
+            const BVHNode& node = m_Nodes[stack.back()];
+            stack.pop_back();
+
+            const u32 mask = TestOverlap(node, bounds);
+            for(u32 i = 0; i < BVH_WIDTH; i++)
+            {
+                if(!(mask & (1u << i))) continue;
+
+                if(node.counts[i] == 0)
+                {
+                    stack.push_back(node.children[i]);
+                    continue;
+                }
+
+                for(u32 p = node.children[i]; p < node.children[i] + node.counts[i]; p++)
+                {
+                    const u32 instance = m_Primitives[p];
+                    if(Overlaps(m_InstanceBounds[instance], bounds)) outInstances.push_back(instance);
+                }
+            }
+        }
+    }
+
+    bool BVH::Raycast(const glm::vec3& origin, const glm::vec3& dir, BVHRayHit& outHit, f32 maxDistance) const
+    {
+        outHit = BVHRayHit();
+        if(m_Nodes.empty()) return false;
+
+        // a zero component gives an infinite slab, which the min/max in the slab test handles
+        const glm::vec3 invDir = glm::vec3(1.f) / dir;
+        f32 closest = maxDistance;
+
+        std::vector<RayStackEntry> stack;
+        stack.reserve(64);
+        stack.push_back({ 0, 0.f });
+        while(!stack.empty())
+        {
+            const RayStackEntry entry = stack.back();
+            stack.pop_back();
+            if(entry.distance > closest) continue;
+
+            const BVHNode& node = m_Nodes[entry.node];
+            f32 distances[BVH_WIDTH];
+            const u32 mask = TestRay(node, origin, invDir, closest, distances);
+
+            // inner children are pushed furthest first so the nearest one is visited next
+            RayStackEntry inner[BVH_WIDTH];
+            u32 innerCount = 0;
+            for(u32 i = 0; i < BVH_WIDTH; i++)
+            {
+                if(!(mask & (1u << i))) continue;
+
+                if(node.counts[i] == 0)
+                {
+                    inner[innerCount++] = { node.children[i], distances[i] };
+                    continue;
+                }
+
+                for(u32 p = node.children[i]; p < node.children[i] + node.counts[i]; p++)
+                {
+                    const u32 instance = m_Primitives[p];
+                    f32 distance = 0.f;
+                    if(IntersectRay(m_InstanceBounds[instance], origin, invDir, closest, distance) && distance < outHit.distance)
+                    {
+                        outHit.instance = instance;
+                        outHit.distance = distance;
+                        closest = distance;
+                    }
+                }
+            }
+
+            std::sort(inner, inner + innerCount, [](const RayStackEntry& a, const RayStackEntry& b) { return a.distance > b.distance; });
+            for(u32 i = 0; i < innerCount; i++) stack.push_back(inner[i]);
+        }
+
+        return outHit.instance != U32_MAX;
+    }
+}
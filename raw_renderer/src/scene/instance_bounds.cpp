@@ -0,0 +1,130 @@
+#include "scene/instance_bounds.hpp"
+#include "core/simd.hpp"
+#include <cmath>
+#include <cstddef>
+
+namespace Raw
+{
+    namespace BoundsKernels
+    {
+        void TransformBoundsScalar(const GFX::MeshDrawData* draws, const GFX::MeshBoundsData* meshBounds, u32 first, u32 count, GFX::InstanceBoundsData* outBounds)
+        {
+            for(u32 i = first; i < first + count; i++)
+            {
+                const glm::mat4& m = draws[i].transform;
+                const GFX::MeshBoundsData& bounds = meshBounds[draws[i].drawIndex];
+                const glm::vec3 center = (bounds.boundsMin + bounds.boundsMax) * 0.5f;
+                const glm::vec3 extents = (bounds.boundsMax - bounds.boundsMin) * 0.5f;
+
+                glm::vec3 worldCenter = glm::vec3(m[3]);
+                glm::vec3 worldExtents = glm::vec3(0.f);
+                for(u32 c = 0; c < 3; c++)
+                {
+                    for(u32 r = 0; r < 3; r++)
+                    {
+                        worldCenter[r] += m[c][r] * center[c];
+                        worldExtents[r] += std::abs(m[c][r]) * extents[c];
+                    }
+                }
+
+                GFX::InstanceBoundsData& out = outBounds[i];
+                out.boundsMin = worldCenter - worldExtents;
+                out.boundsMax = worldCenter + worldExtents;
+                out.padding0 = 0.f;
+                out.padding1 = 0.f;
+            }
+        }
+
+#if defined(RAW_ARCH_X86)
+        RAW_TARGET_AVX2 void TransformBoundsAVX2(const GFX::MeshDrawData* draws, const GFX::MeshBoundsData* meshBounds, u32 first, u32 count, GFX::InstanceBoundsData* outBounds)
+        {
+            static_assert(sizeof(GFX::InstanceBoundsData) == 8 * sizeof(f32), "instance bounds are written as one 8 wide row each");
+
+            // the eight draws' matrices and their bounds are gathered by element, index i of every register belongs to draw i
+            const i32 drawStride = (i32)(sizeof(GFX::MeshDrawData) / sizeof(f32));
+            const i32 boundsStride = (i32)(sizeof(GFX::MeshBoundsData) / sizeof(f32));
+            const i32 drawIndexOffset = (i32)(offsetof(GFX::MeshDrawData, drawIndex) / sizeof(u32));
+            const f32* drawData = (const f32*)draws;
+            const f32* boundsMin = (const f32*)meshBounds + offsetof(GFX::MeshBoundsData, boundsMin) / sizeof(f32);
+            const f32* boundsMax = (const f32*)meshBounds + offsetof(GFX::MeshBoundsData, boundsMax) / sizeof(f32);
+
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const __m256 half = _mm256_set1_ps(0.5f);
+            const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+            const u32 wideCount = count & ~7u;
+            for(u32 i = first; i < first + wideCount; i += 8)
+            {
+                const __m256i drawOffsets = _mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32((i32)i), lanes), _mm256_set1_epi32(drawStride));
+                const __m256i drawIndices = _mm256_i32gather_epi32((const i32*)draws + drawIndexOffset, drawOffsets, 4);
+                const __m256i boundsOffsets = _mm256_mullo_epi32(drawIndices, _mm256_set1_epi32(boundsStride));
+
+                __m256 center[3];
+                __m256 extents[3];
+                for(u32 c = 0; c < 3; c++)
+                {
+                    const __m256 localMin = _mm256_i32gather_ps(boundsMin + c, boundsOffsets, 4);
+                    const __m256 localMax = _mm256_i32gather_ps(boundsMax + c, boundsOffsets, 4);
+                    center[c] = _mm256_mul_ps(_mm256_add_ps(localMin, localMax), half);
+                    extents[c] = _mm256_mul_ps(_mm256_sub_ps(localMax, localMin), half);
+                }
+
+                __m256 worldCenter[3];
+                __m256 worldExtents[3];
+                for(u32 r = 0; r < 3; r++)
+                {
+                    worldCenter[r] = _mm256_i32gather_ps(drawData + 12 + r, drawOffsets, 4);
+                    worldExtents[r] = _mm256_setzero_ps();
+                }
+
+                for(u32 c = 0; c < 3; c++)
+                {
+                    for(u32 r = 0; r < 3; r++)
+                    {
+                        const __m256 m = _mm256_i32gather_ps(drawData + c * 4 + r, drawOffsets, 4);
+                        worldCenter[r] = _mm256_add_ps(worldCenter[r], _mm256_mul_ps(m, center[c]));
+                        worldExtents[r] = _mm256_add_ps(worldExtents[r], _mm256_mul_ps(_mm256_and_ps(m, absMask), extents[c]));
+                    }
+                }
+
+                // one register per output field, transposed into one row per instance
+                __m256 rows[8];
+                rows[0] = _mm256_sub_ps(worldCenter[0], worldExtents[0]);
+                rows[1] = _mm256_sub_ps(worldCenter[1], worldExtents[1]);
+                rows[2] = _mm256_sub_ps(worldCenter[2], worldExtents[2]);
+                rows[3] = _mm256_setzero_ps();
+                rows[4] = _mm256_add_ps(worldCenter[0], worldExtents[0]);
+                rows[5] = _mm256_add_ps(worldCenter[1], worldExtents[1]);
+                rows[6] = _mm256_add_ps(worldCenter[2], worldExtents[2]);
+                rows[7] = _mm256_setzero_ps();
+
+                SIMD::Transpose8(rows);
+
+                for(u32 j = 0; j < 8; j++)
+                {
+                    _mm256_storeu_ps((f32*)&outBounds[i + j], rows[j]);
+                }
+            }
+
+            if(wideCount < count) TransformBoundsScalar(draws, meshBounds, first + wideCount, count - wideCount, outBounds);
+        }
+#else
+        void TransformBoundsAVX2(const GFX::MeshDrawData* draws, const GFX::MeshBoundsData* meshBounds, u32 first, u32 count, GFX::InstanceBoundsData* outBounds)
+        {
+            TransformBoundsScalar(draws, meshBounds, first, count, outBounds);
+        }
+#endif
+
+        void TransformBounds(const GFX::MeshDrawData* draws, const GFX::MeshBoundsData* meshBounds, u32 first, u32 count, GFX::InstanceBoundsData* outBounds)
+        {
+            if(SIMD::SupportsAVX2())
+            {
+                TransformBoundsAVX2(draws, meshBounds, first, count, outBounds);
+            }
+            else
+            {
+                TransformBoundsScalar(draws, meshBounds, first, count, outBounds);
+            }
+        }
+    }
+}
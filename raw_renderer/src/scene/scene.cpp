@@ -1,96 +1,108 @@
 #include "scene/scene.hpp"
+#include "scene/instance_bounds.hpp"
 #include "utility/gltf.hpp"
-#include "resources/buffer_loader.hpp"
+#include "utility/scene_cache.hpp"
 #include "resources/texture_loader.hpp"
+#include "renderer/command_buffer.hpp"
+#include "renderer/geometry_heap.hpp"
+#include "core/servicelocator.hpp"
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 #include "core/timer.hpp"
 
 namespace Raw
 {
     namespace
     {
-        void ProcessMaterialData(std::vector<GFX::PBRMaterialData>& matData, GFX::SceneData* sceneData)
+        // staging budget per frame in flight, anything past it falls back to inline buffer updates
+        constexpr u64 UPLOAD_BUFFER_SIZE = 4 * 1024 * 1024;
+        // texels a streamed load may upload per frame, the upload and its mip chain are waited on before the frame is recorded
+        constexpr u64 STREAMING_UPLOAD_BUDGET = 16 * 1024 * 1024;
+
+        GFX::PBRMaterialData ResolveMaterial(const GFX::PBRMaterialData& material, const GFX::SceneData* sceneData, 
+            u32 errorTexture, u32 defaultTexture, u32 defaultEmissive)
         {
-            matData.resize(GFX::MAX_MATERIALS);
+            GFX::PBRMaterialData resolved = material;
 
-            GFX::TextureHandle errorTexture;
-            GFX::TextureHandle defaultTexture;
-            GFX::TextureHandle defaultEmissive;
+            // an image that is still streaming in is drawn with the placeholder of its slot
+            auto resolveImage = [sceneData](i32 texture, u32 missing, u32 placeholder)
+            {
+                if(texture == -1) return missing;
 
-            TextureResource* tex = (TextureResource*)TextureLoader::Instance()->Get(ERROR_TEXTURE);
-            errorTexture = tex->handle;
+                const u32 image = sceneData->images[sceneData->textures[texture]];
+                return image == TextureStreamer::k_PendingImage ? placeholder : image;
+            };
 
-            tex = (TextureResource*)TextureLoader::Instance()->Get(DEFAULT_TEXTURE);
-            defaultTexture = tex->handle;
+            const u32 diffuse = resolveImage(material.diffuse, errorTexture, defaultTexture);
+            const u32 normal = resolveImage(material.normal, defaultTexture, defaultTexture);
+            const u32 roughness = resolveImage(material.roughness, defaultTexture, defaultTexture);
+            const u32 occlusion = resolveImage(material.occlusion, defaultTexture, defaultTexture);
+            const u32 emissive = resolveImage(material.emissive, defaultEmissive, defaultEmissive);
 
-            tex = (TextureResource*)TextureLoader::Instance()->Get(DEFAULT_EMISSIVE);
-            defaultEmissive = tex->handle;
+            resolved.diffuse = diffuse;
+            resolved.roughness = roughness;
+            resolved.occlusion = occlusion;
+            resolved.normal = normal;
+            resolved.emissive = emissive;
 
-            for(u32 i = 0; i < matData.size(); i++)
-            {
-                matData[i].diffuse = errorTexture.id;
-                matData[i].roughness = defaultTexture.id;
-                matData[i].occlusion = defaultTexture.id;
-                matData[i].normal = defaultTexture.id;
-                matData[i].emissive = defaultEmissive.id;
-            }
+            return resolved;
+        }
 
-            for(u32 i = 0; i < sceneData->materials.size(); i++)
+        // moves a material's texture indices by offset, -1 stays no texture
+        void OffsetTextures(GFX::PBRMaterialData& material, i32 offset)
+        {
+            i32* textures[] = { &material.diffuse, &material.roughness, &material.normal, &material.occlusion, &material.emissive };
+            for(i32* texture : textures)
             {
-                if(i >= matData.size()) break;
-                
-                GFX::PBRMaterialData material = sceneData->materials[i];
-            
-                u32 diffuse = errorTexture.id;
-                u32 normal = defaultTexture.id;
-                u32 roughness = defaultTexture.id;
-                u32 occlusion = defaultTexture.id;
-                u32 emissive = defaultEmissive.id;
-
-                if(material.diffuse != -1)      diffuse = sceneData->images[sceneData->textures[material.diffuse]];
-                if(material.normal != -1)       normal = sceneData->images[sceneData->textures[material.normal]];
-                if(material.roughness != -1)    roughness = sceneData->images[sceneData->textures[material.roughness]];
-                if(material.occlusion != -1)    occlusion = sceneData->images[sceneData->textures[material.occlusion]];
-                if(material.emissive != -1)     emissive = sceneData->images[sceneData->textures[material.emissive]];
-
-                material.diffuse = diffuse;
-                material.roughness = roughness;
-                material.occlusion = occlusion;
-                material.normal = normal;
-                material.emissive = emissive;
-
-                matData[i] = material;
+                if(*texture != -1) *texture += offset;
             }
         }
     }
 
-    void Scene::Init(std::string& filePath, GFX::IGFXDevice* device)
+    bool Scene::Init(std::string& filePath, GFX::IGFXDevice* device, bool streamTextures)
     {
         u32 curTime = (u32)Timer::Get()->Now();
         srand(curTime);
 
-        if(m_SceneData)
-        {
-            BufferLoader::Instance()->Unload(m_SceneData->vertexBufferId);
-            BufferLoader::Instance()->Unload(m_SceneData->indexBufferId);
-            BufferLoader::Instance()->Unload(m_SceneData->indirectBufferId);
-            BufferLoader::Instance()->Unload(m_SceneData->culledIndirectBufferId);
-            BufferLoader::Instance()->Unload(m_SceneData->meshDrawsBufferId);
+        // images of the previous scene that are still streaming would land in the new one
+        m_TextureStreamer.Cancel();
+        m_StreamingAsset = U32_MAX;
 
-            for(u64 i = 0; i < m_SceneData->imageIds.size(); i++)
-            {
-                TextureLoader::Instance()->Unload(m_SceneData->imageIds[i]);
-            }
+        for(SceneAsset& asset : m_Assets) ReleaseAsset(asset);
+        m_Assets.clear();
+        if(m_SceneData) Utils::DestroySceneBuffers(*m_SceneData.get());
+        m_SceneData = rstd::make_unique<GFX::SceneData>();
+        m_SceneGraph.Clear();
+        m_BVH.Clear();
 
-            m_SceneData.reset();
+        // default textures are resolved once, looking them up every frame would keep adding references
+        TextureResource* tex = (TextureResource*)TextureLoader::Instance()->Get(ERROR_TEXTURE);
+        m_ErrorTexture = tex->handle;
+
+        tex = (TextureResource*)TextureLoader::Instance()->Get(DEFAULT_TEXTURE);
+        m_DefaultTexture = tex->handle;
+
+        tex = (TextureResource*)TextureLoader::Instance()->Get(DEFAULT_EMISSIVE);
+        m_DefaultEmissive = tex->handle;
+
+        m_ResolvedMaterials.resize(GFX::MAX_MATERIALS);
+        for(u32 i = 0; i < m_ResolvedMaterials.size(); i++)
+        {
+            m_ResolvedMaterials[i].diffuse = m_ErrorTexture.id;
+            m_ResolvedMaterials[i].roughness = m_DefaultTexture.id;
+            m_ResolvedMaterials[i].occlusion = m_DefaultTexture.id;
+            m_ResolvedMaterials[i].normal = m_DefaultTexture.id;
+            m_ResolvedMaterials[i].emissive = m_DefaultEmissive.id;
         }
 
-        m_SceneData = rstd::make_unique<GFX::SceneData>();
-        Utils::LoadGLTF(filePath, *m_SceneData.get());
+        // only later modifications are tracked, the assets' materials are staged with the first frame's dirty data
+        m_FrameIndex = 1;
+        m_LastUploadFrame = 0;
+        m_DrawChanges.Clear();
+        m_MaterialChanges.Clear();
 
-        std::vector<GFX::PBRMaterialData> matData;
-        ProcessMaterialData(matData, m_SceneData.get());
+        if(!m_UploadBuffer.IsValid()) m_UploadBuffer.Init(device, UPLOAD_BUFFER_SIZE);
 
         u64 materialSize = sizeof(GFX::PBRMaterialData);
 
@@ -99,11 +111,13 @@ namespace Raw
         materialDataDesc.memoryType = GFX::EMemoryType::HOST_VISIBLE;
         materialDataDesc.type = GFX::EBufferType::UNIFORM;
 
+        // the buffer stays mapped, later edits go through UploadDirtyData so frames in flight never see a half written material
         m_MaterialDataBuffer = device->CreateBuffer(materialDataDesc);
-        device->MapBuffer(m_MaterialDataBuffer, matData.data(), matData.size() * materialSize);
-        device->UnmapBuffer(m_MaterialDataBuffer, GFX::EBufferMapType::MATERIAL);
+        memcpy(device->GetMappedData(m_MaterialDataBuffer), m_ResolvedMaterials.data(), m_ResolvedMaterials.size() * materialSize);
+        device->WriteBufferAllFrames(m_MaterialDataBuffer, GFX::EBufferMapType::MATERIAL);
 
-        m_PointLights.resize(MAX_LIGHT_COUNT);
+        m_PointLights.reserve(MAX_LIGHT_COUNT);
+        m_PointLights.resize(DEFAULT_LIGHT_COUNT);
         for(u32 i = 0; i < m_PointLights.size(); i++)
         {
             f32 x = (f32)((rand() % 10) * pow(-1, curTime + 1)); 
@@ -134,30 +148,442 @@ namespace Raw
         u64 lightSize = sizeof(GFX::PointLight);
         GFX::BufferDesc lightBufferDesc;
         lightBufferDesc.bufferSize = MAX_LIGHT_COUNT * lightSize;
-        lightBufferDesc.memoryType = GFX::EMemoryType::HOST_VISIBLE;
-        lightBufferDesc.type = GFX::EBufferType::UNIFORM;
+        lightBufferDesc.memoryType = GFX::EMemoryType::DEVICE_LOCAL;
+        lightBufferDesc.type = GFX::EBufferType::STORAGE | GFX::EBufferType::TRANSFER_DST | GFX::EBufferType::SHADER_DEVICE_ADDRESS;
+
+        // sized for every light the scene can have, the light culling and lighting passes read it through its address
+        m_PointLightBuffer = device->CreateBuffer(lightBufferDesc);
+        device->UploadBufferData(m_PointLightBuffer, 0, m_PointLights.data(), m_PointLights.size() * lightSize);
+        m_SceneData->pointLightBuffer = m_PointLightBuffer;
+        m_SceneData->pointLightCount = m_PointLights.size();
+
+        m_LightChanges.Clear();
+        m_LightChanges.Resize((u32)m_PointLights.size());
+
+        // an empty scene still has a draw list, so the passes never see a scene without buffers
+        if(!Compose()) return false;
+
+        return AddAsset(filePath, streamTextures) != U32_MAX;
+    }
+
+    u32 Scene::AddAsset(const std::string& filePath, bool streamTextures)
+    {
+        SceneAsset asset;
+        asset.id = m_NextAssetId++;
+        asset.filePath = filePath;
+        asset.data = rstd::make_unique<GFX::SceneData>();
+
+        // the streamer patches the images of one asset at a time
+        TextureStreamer* streamer = streamTextures && m_TextureStreamer.IsDone() ? &m_TextureStreamer : nullptr;
+
+        // the baked cache skips parsing and conversion entirely, it's rebuilt whenever the source changes
+        Utils::ESceneCacheResult cacheResult = Utils::LoadSceneCache(filePath, *asset.data.get(), streamer);
+        bool loaded = cacheResult == Utils::ESceneCacheResult::LOADED;
+        if(cacheResult == Utils::ESceneCacheResult::MISS)
+        {
+            // a stale cache may have been read partway
+            asset.data = rstd::make_unique<GFX::SceneData>();
+            loaded = Utils::LoadGLTF(filePath, *asset.data.get(), streamer);
+        }
+
+        if(loaded)
+        {
+            GatherAssetState();
+            m_Assets.push_back(std::move(asset));
+            if(Compose())
+            {
+                if(streamer) m_StreamingAsset = m_Assets.back().id;
+                return m_Assets.back().id;
+            }
+
+            asset = std::move(m_Assets.back());
+            m_Assets.pop_back();
+        }
+
+        RAW_ERROR("Failed to add '%s' to the scene!", filePath.c_str());
+        if(streamer) streamer->Cancel();
+        ReleaseAsset(asset);
+        return U32_MAX;
+    }
+
+    bool Scene::RemoveAsset(u32 assetId)
+    {
+        u32 index = 0;
+        while(index < (u32)m_Assets.size() && m_Assets[index].id != assetId) index++;
+        if(index == (u32)m_Assets.size()) return false;
+
+        GatherAssetState();
+        SceneAsset asset = std::move(m_Assets[index]);
+        m_Assets.erase(m_Assets.begin() + index);
+        if(!Compose())
+        {
+            m_Assets.insert(m_Assets.begin() + index, std::move(asset));
+            return false;
+        }
+
+        if(asset.id == m_StreamingAsset)
+        {
+            m_TextureStreamer.Cancel();
+            m_StreamingAsset = U32_MAX;
+        }
+        ReleaseAsset(asset);
+        return true;
+    }
+
+    bool Scene::Compose()
+    {
+        GFX::SceneData scene;
+        std::vector<AssetPlacement> placements(m_Assets.size());
+
+        u32 materialCount = 0;
+        for(const SceneAsset& asset : m_Assets) materialCount += (u32)asset.data->materials.size();
+        if(materialCount > GFX::MAX_MATERIALS)
+        {
+            RAW_ERROR("Scene needs %u materials, the material buffer holds %u!", materialCount, GFX::MAX_MATERIALS);
+            return false;
+        }
+
+        for(u32 a = 0; a < (u32)m_Assets.size(); a++)
+        {
+            const GFX::SceneData& data = *m_Assets[a].data.get();
+            AssetPlacement& placement = placements[a];
+            placement.firstTransform = (u32)scene.transforms.size();
+            placement.firstMaterial = (u32)scene.materials.size();
+            placement.firstTexture = (u32)scene.textures.size();
+            placement.firstImage = (u32)scene.images.size();
+            placement.instances.resize(data.draws.size());
+
+            scene.transforms.insert(scene.transforms.end(), data.transforms.begin(), data.transforms.end());
+            scene.localTransforms.insert(scene.localTransforms.end(), data.localTransforms.begin(), data.localTransforms.end());
+            for(u32 parent : data.transformParents)
+            {
+                scene.transformParents.push_back(parent == INVALID_NODE ? INVALID_NODE : parent + placement.firstTransform);
+            }
+
+            for(GFX::PBRMaterialData material : data.materials)
+            {
+                OffsetTextures(material, (i32)placement.firstTexture);
+                scene.materials.push_back(material);
+            }
+            for(u32 image : data.textures) scene.textures.push_back(image + placement.firstImage);
+            scene.images.insert(scene.images.end(), data.images.begin(), data.images.end());
+            scene.imageIds.insert(scene.imageIds.end(), data.imageIds.begin(), data.imageIds.end());
+        }
+
+        // each asset's draws are ordered by index width, stream and material already. taking every width and stream
+        // across the assets in turn keeps that order, material indices only grow from one asset to the next
+        for(u32 wide = 0; wide < 2; wide++)
+        {
+            for(u32 stream = 0; stream < GFX::DRAW_STREAM_COUNT; stream++)
+            {
+                GFX::DrawRange& composed = wide ? scene.streams[stream].wideRange : scene.streams[stream].shortRange;
+                composed.first = (u32)scene.indirectDraws.size();
+                for(u32 a = 0; a < (u32)m_Assets.size(); a++)
+                {
+                    const GFX::SceneData& data = *m_Assets[a].data.get();
+                    AssetPlacement& placement = placements[a];
+                    const GFX::DrawRange& range = wide ? data.streams[stream].wideRange : data.streams[stream].shortRange;
+                    for(u32 d = range.first; d < range.first + range.count; d++)
+                    {
+                        const u32 drawIndex = (u32)scene.indirectDraws.size();
+                        GFX::IndirectDraw iDraw = data.indirectDraws[d];
+                        const u32 firstInstance = iDraw.firstInstance;
+                        iDraw.firstInstance = (u32)scene.draws.size();
+                        scene.indirectDraws.push_back(iDraw);
+                        scene.meshBoundsData.push_back(data.meshBoundsData[d]);
+
+                        // the draw's instances stay contiguous from its new firstInstance
+                        for(u32 i = firstInstance; i < firstInstance + iDraw.instanceCount; i++)
+                        {
+                            const u32 instance = (u32)scene.draws.size();
+                            GFX::MeshDrawData draw = data.draws[i];
+                            draw.drawIndex = drawIndex;
+                            if(draw.materialIndex != U32_MAX) draw.materialIndex += placement.firstMaterial;
+
+                            GFX::MeshData mesh = data.meshes[i];
+                            mesh.baseInstance = instance;
+                            mesh.transformIndex += placement.firstTransform;
+                            if(mesh.materialIndex != U32_MAX) mesh.materialIndex += placement.firstMaterial;
+
+                            scene.dynamicInstanceCount += draw.isDynamic ? 1 : 0;
+                            scene.draws.push_back(draw);
+                            scene.meshes.push_back(mesh);
+                            placement.instances[i] = instance;
+                        }
+                    }
+                }
+                composed.count = (u32)scene.indirectDraws.size() - composed.first;
+            }
+            if(!wide) scene.shortIndexDrawCount = (u32)scene.indirectDraws.size();
+        }
+
+        if(!Utils::CreateSceneBuffers(scene)) return false;
+
+        // frames in flight keep drawing the old draw list, its ranges are only reused once they're done with it
+        Utils::DestroySceneBuffers(*m_SceneData.get());
+
+        // passes hold on to m_SceneData, so it's refilled in place and keeps what they left in it.
+        // an empty draw list is never culled, it mustn't be left drawing the old one's commands
+        scene.pointLightBuffer = m_SceneData->pointLightBuffer;
+        scene.pointLightCount = m_SceneData->pointLightCount;
+        if(scene.drawCount > 0)
+        {
+            scene.culledDraws = std::move(m_SceneData->culledDraws);
+            for(u32 i = 0; i < SHADOW_CASCADE_COUNT; i++)
+            {
+                scene.cascadeDraws[i] = std::move(m_SceneData->cascadeDraws[i]);
+                scene.cascadeStaticDraws[i] = std::move(m_SceneData->cascadeStaticDraws[i]);
+            }
+        }
+        scene.cascadeRebuildMask = m_SceneData->cascadeRebuildMask;
+        // instances came or went, the cached static shadows are stale
+        scene.staticCasterVersion = m_SceneData->staticCasterVersion + 1;
+        *m_SceneData.get() = std::move(scene);
+
+        for(u32 a = 0; a < (u32)m_Assets.size(); a++) m_Assets[a].placement = std::move(placements[a]);
+
+        m_SceneGraph.Build(*m_SceneData.get());
+        m_BVH.Build(*m_SceneData.get());
+
+        // draws were uploaded in full with the buffers, materials are staged with the next dirty data
+        m_DrawChanges.Clear();
+        m_DrawChanges.Resize((u32)m_SceneData->draws.size());
+        m_MaterialChanges.Clear();
+        m_MaterialChanges.Resize(materialCount, m_LastUploadFrame + 1);
+
+        return true;
+    }
+
+    void Scene::GatherAssetState()
+    {
+        // local edits the graph hasn't propagated yet would be lost with it
+        m_SceneGraph.Update(*m_SceneData.get(), m_DrawChanges, m_FrameIndex);
+
+        for(SceneAsset& asset : m_Assets)
+        {
+            GFX::SceneData& data = *asset.data.get();
+            const AssetPlacement& placement = asset.placement;
+            for(u32 i = 0; i < (u32)placement.instances.size(); i++)
+            {
+                const GFX::MeshDrawData& draw = m_SceneData->draws[placement.instances[i]];
+                data.draws[i].transform = draw.transform;
+                data.draws[i].isDynamic = draw.isDynamic;
+            }
+
+            for(u32 t = 0; t < (u32)data.transforms.size(); t++)
+            {
+                const u32 node = m_SceneGraph.GetNode(placement.firstTransform + t);
+                data.localTransforms[t] = m_SceneGraph.GetLocalTransform(node);
+                data.transforms[t] = m_SceneGraph.GetWorldTransform(node);
+            }
+
+            for(u32 m = 0; m < (u32)data.materials.size(); m++)
+            {
+                data.materials[m] = m_SceneData->materials[placement.firstMaterial + m];
+                OffsetTextures(data.materials[m], -(i32)placement.firstTexture);
+            }
+        }
+    }
+
+    void Scene::ReleaseAsset(SceneAsset& asset)
+    {
+        if(!asset.data) return;
 
-        m_PointLightBuffer = device->CreateBuffer(materialDataDesc);
-        device->MapBuffer(m_PointLightBuffer, m_PointLights.data(), m_PointLights.size() * lightSize);
-        device->UnmapBuffer(m_PointLightBuffer, GFX::EBufferMapType::POINTLIGHT);
+        GFX::GeometryHeap::Instance()->Remove(asset.data->geometryAllocation);
+        for(u64 i = 0; i < asset.data->imageIds.size(); i++)
+        {
+            TextureLoader::Instance()->Unload(asset.data->imageIds[i]);
+        }
+        asset.data.reset();
     }
     
     void Scene::Update(GFX::IGFXDevice* device)
     {
-        std::vector<GFX::PBRMaterialData> matData;
-        ProcessMaterialData(matData, m_SceneData.get());
-        
-        u64 materialSize = sizeof(GFX::PBRMaterialData);
-        device->MapBuffer(m_MaterialDataBuffer, matData.data(), matData.size() * materialSize);
-        device->UnmapBuffer(m_MaterialDataBuffer, GFX::EBufferMapType::MATERIAL);
+        m_FrameIndex++;
+        m_SceneGraph.Update(*m_SceneData.get(), m_DrawChanges, m_FrameIndex);
 
-        u64 lightSize = sizeof(GFX::PointLight);
-        device->MapBuffer(m_PointLightBuffer, m_PointLights.data(), m_PointLights.size() * lightSize);
-        device->UnmapBuffer(m_PointLightBuffer, GFX::EBufferMapType::POINTLIGHT);
+        // runs before the device begins the frame so the new textures' descriptors are written with this frame's updates
+        if(!m_TextureStreamer.IsDone())
+        {
+            u32 index = 0;
+            while(index < (u32)m_Assets.size() && m_Assets[index].id != m_StreamingAsset) index++;
+            RAW_ASSERT_MSG(index < (u32)m_Assets.size(), "Streaming images of an asset that isn't in the scene!");
+
+            SceneAsset& asset = m_Assets[index];
+            m_StreamedImages.clear();
+            m_TextureStreamer.Update(STREAMING_UPLOAD_BUDGET, asset.data->images, asset.data->imageIds, m_StreamedImages);
+
+            // the scene's images are a copy of the asset's
+            for(u32& image : m_StreamedImages)
+            {
+                m_SceneData->images[asset.placement.firstImage + image] = asset.data->images[image];
+                m_SceneData->imageIds[asset.placement.firstImage + image] = asset.data->imageIds[image];
+                image += asset.placement.firstImage;
+            }
+            MarkMaterialsUsingImages(m_StreamedImages);
+            if(m_TextureStreamer.IsDone()) m_StreamingAsset = U32_MAX;
+        }
+    }
+
+    void Scene::UploadDirtyData(GFX::IGFXDevice* device, GFX::ICommandBuffer* cmd)
+    {
+        m_UploadBuffer.BeginFrame(device->GetCurrentFrameIndex());
+
+        // every buffer below is shared by the frames in flight, any shader stage may still be reading it
+        GFX::EPipelineStageFlags readStages = GFX::EPipelineStageFlags::VERTEX_SHADER_BIT | GFX::EPipelineStageFlags::COMPUTE_SHADER_BIT | GFX::EPipelineStageFlags::FRAGMENT_SHADER_BIT;
+        if(device->SupportsMeshShaders()) readStages = readStages | GFX::EPipelineStageFlags::TASK_SHADER_BIT | GFX::EPipelineStageFlags::MESH_SHADER_BIT;
+
+        m_DrawChanges.GetChangedRangesSince(m_LastUploadFrame, m_ChangeRanges);
+        if(!m_ChangeRanges.empty())
+        {
+            StageRanges(cmd, m_SceneData->meshDrawsBuffer, (const u8*)m_SceneData->draws.data(), sizeof(GFX::MeshDrawData), readStages);
+
+            // culling and the bvh read world space bounds, only the moved instances are transformed again
+            for(const ChangeRange& range : m_ChangeRanges) UpdateInstanceBounds(*m_SceneData.get(), range.first, range.count);
+            StageRanges(cmd, m_SceneData->instanceBoundsBuffer, (const u8*)m_SceneData->instanceBounds.data(), sizeof(GFX::InstanceBoundsData), readStages);
+            m_BVH.Refit(*m_SceneData.get(), m_ChangeRanges);
+
+            cmd->AddMemoryBarrier(m_SceneData->instanceBoundsBuffer,
+                GFX::EAccessFlags::TRANSFER_WRITE_BIT,
+                GFX::EAccessFlags::SHADER_READ_BIT,
+                GFX::EPipelineStageFlags::TRANSFER_BIT,
+                GFX::EPipelineStageFlags::COMPUTE_SHADER_BIT);
+
+            // draws are read by culling and meshlet culling as well as every vertex, task and mesh shader
+            GFX::EPipelineStageFlags drawStages = GFX::EPipelineStageFlags::COMPUTE_SHADER_BIT | GFX::EPipelineStageFlags::VERTEX_SHADER_BIT;
+            if(device->SupportsMeshShaders()) drawStages = drawStages | GFX::EPipelineStageFlags::TASK_SHADER_BIT | GFX::EPipelineStageFlags::MESH_SHADER_BIT;
+            cmd->AddMemoryBarrier(m_SceneData->meshDrawsBuffer,
+                GFX::EAccessFlags::TRANSFER_WRITE_BIT,
+                GFX::EAccessFlags::SHADER_READ_BIT,
+                GFX::EPipelineStageFlags::TRANSFER_BIT,
+                drawStages);
+        }
+
+        m_MaterialChanges.GetChangedRangesSince(m_LastUploadFrame, m_ChangeRanges);
+        if(!m_ChangeRanges.empty())
+        {
+            for(const ChangeRange& range : m_ChangeRanges)
+            {
+                for(u32 i = range.first; i < range.first + range.count; i++)
+                {
+                    m_ResolvedMaterials[i] = ResolveMaterial(m_SceneData->materials[i], m_SceneData.get(), m_ErrorTexture.id, m_DefaultTexture.id, m_DefaultEmissive.id);
+                }
+            }
+            StageRanges(cmd, m_MaterialDataBuffer, (const u8*)m_ResolvedMaterials.data(), sizeof(GFX::PBRMaterialData), readStages);
+
+            cmd->AddMemoryBarrier(m_MaterialDataBuffer,
+                GFX::EAccessFlags::TRANSFER_WRITE_BIT,
+                GFX::EAccessFlags::UNIFORM_READ_BIT,
+                GFX::EPipelineStageFlags::TRANSFER_BIT,
+                GFX::EPipelineStageFlags::FRAGMENT_SHADER_BIT);
+        }
+
+        m_LightChanges.GetChangedRangesSince(m_LastUploadFrame, m_ChangeRanges);
+        if(!m_ChangeRanges.empty())
+        {
+            StageRanges(cmd, m_PointLightBuffer, (const u8*)m_PointLights.data(), sizeof(GFX::PointLight), readStages);
+
+            // binned by the light culling pass, then shaded by the lighting pass
+            cmd->AddMemoryBarrier(m_PointLightBuffer,
+                GFX::EAccessFlags::TRANSFER_WRITE_BIT,
+                GFX::EAccessFlags::SHADER_READ_BIT,
+                GFX::EPipelineStageFlags::TRANSFER_BIT,
+                GFX::EPipelineStageFlags::COMPUTE_SHADER_BIT | GFX::EPipelineStageFlags::FRAGMENT_SHADER_BIT);
+        }
+
+        m_LastUploadFrame = m_FrameIndex;
+    }
+
+    u32 Scene::AddPointLight(const GFX::PointLight& light)
+    {
+        if(m_PointLights.size() >= MAX_LIGHT_COUNT) return U32_MAX;
+
+        const u32 lightIndex = m_PointLights.size();
+        m_PointLights.push_back(light);
+        m_LightChanges.Push(m_FrameIndex);
+        m_SceneData->pointLightCount = m_PointLights.size();
+
+        return lightIndex;
+    }
+
+    void Scene::SetDrawDynamic(u32 drawIndex, bool dynamic)
+    {
+        if(drawIndex >= m_DrawChanges.GetCount()) return;
+
+        GFX::MeshDrawData& draw = m_SceneData->draws[drawIndex];
+        if((draw.isDynamic != 0) == dynamic) return;
+
+        draw.isDynamic = dynamic ? 1 : 0;
+        if(dynamic) m_SceneData->dynamicInstanceCount++;
+        else        m_SceneData->dynamicInstanceCount--;
+        // the cached static shadows gain or lose the instance either way
+        m_SceneData->staticCasterVersion++;
+        MarkDrawChanged(drawIndex);
+    }
+
+    void Scene::MarkMaterialsUsingImages(const std::vector<u32>& images)
+    {
+        if(images.empty()) return;
+
+        m_ImageFlags.assign(m_SceneData->images.size(), false);
+        for(u32 image : images) m_ImageFlags[image] = true;
+
+        auto usesImage = [this](i32 texture)
+        {
+            return texture != -1 && m_ImageFlags[m_SceneData->textures[texture]];
+        };
+
+        for(u32 i = 0; i < m_MaterialChanges.GetCount(); i++)
+        {
+            const GFX::PBRMaterialData& material = m_SceneData->materials[i];
+            if(usesImage(material.diffuse) || usesImage(material.normal) || usesImage(material.roughness) || 
+                usesImage(material.occlusion) || usesImage(material.emissive))
+            {
+                MarkMaterialChanged(i);
+            }
+
+            // alpha tested casters were cached against the placeholder's alpha, the static shadows have to be redrawn
+            if(material.alphaCutoff > 0.f && usesImage(material.diffuse)) m_SceneData->staticCasterVersion++;
+        }
+    }
+
+    void Scene::StageRanges(GFX::ICommandBuffer* cmd, const GFX::BufferHandle& dst, const u8* src, u64 stride, GFX::EPipelineStageFlags readStages)
+    {
+        if(m_ChangeRanges.empty()) return;
+
+        cmd->AddMemoryBarrier(dst,
+            GFX::EAccessFlags::SHADER_READ_BIT,
+            GFX::EAccessFlags::TRANSFER_WRITE_BIT,
+            readStages,
+            GFX::EPipelineStageFlags::TRANSFER_BIT);
+
+        for(const ChangeRange& range : m_ChangeRanges)
+        {
+            const u64 offset = range.first * stride;
+            const u64 size = range.count * stride;
+            if(!m_UploadBuffer.Stage(cmd, dst, offset, src + offset, size))
+            {
+                cmd->UpdateBuffer(dst, offset, size, src + offset);
+            }
+        }
     }
 
     void Scene::Shutdown()
     {
+        GFX::IGFXDevice* device = (GFX::IGFXDevice*)ServiceLocator::Get()->GetService(GFX::IGFXDevice::k_ServiceName);
+        m_TextureStreamer.Cancel();
+        m_StreamingAsset = U32_MAX;
+        m_UploadBuffer.Shutdown(device);
+
+        m_DrawChanges.Clear();
+        m_MaterialChanges.Clear();
+        m_LightChanges.Clear();
+        m_ResolvedMaterials.clear();
+        m_SceneGraph.Clear();
+        m_BVH.Clear();
+        for(SceneAsset& asset : m_Assets) GFX::GeometryHeap::Instance()->Remove(asset.data->geometryAllocation);
+        m_Assets.clear();
+        if(m_SceneData) Utils::DestroySceneBuffers(*m_SceneData.get());
         m_SceneData.reset();
         m_PointLights.shutdown();
     }
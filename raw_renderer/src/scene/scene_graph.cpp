@@ -0,0 +1,253 @@
+#include "scene/scene_graph.hpp"
+#include "core/asserts.hpp"
+#include "core/simd.hpp"
+#include <algorithm>
+
+namespace Raw
+{
+    namespace
+    {
+        // out = a * b, column major
+        RAW_INLINE void MultiplyMat4(const f32* a, const f32* b, f32* out)
+        {
+#if defined(RAW_SIMD_SSE)
+            const __m128 a0 = _mm_loadu_ps(a + 0);
+            const __m128 a1 = _mm_loadu_ps(a + 4);
+            const __m128 a2 = _mm_loadu_ps(a + 8);
+            const __m128 a3 = _mm_loadu_ps(a + 12);
+
+            for(u32 c = 0; c < 4; c++)
+            {
+                __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[c * 4 + 0]));
+                r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[c * 4 + 1])));
+                r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[c * 4 + 2])));
+                r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[c * 4 + 3])));
+                _mm_storeu_ps(out + c * 4, r);
+            }
+#else
+            *(glm::mat4*)out = (*(const glm::mat4*)a) * (*(const glm::mat4*)b);
+#endif
+        }
+
+        // world = parent world * local for every node of a level, nodes of one level never depend on each other
+        void MultiplyLevelScalar(const u32* nodes, u32 count, const u32* parents, const glm::mat4* locals, glm::mat4* worlds)
+        {
+            for(u32 i = 0; i < count; i++)
+            {
+                const u32 node = nodes[i];
+                MultiplyMat4(&worlds[parents[node]][0][0], &locals[node][0][0], &worlds[node][0][0]);
+            }
+        }
+
+#if defined(RAW_ARCH_X86)
+        RAW_TARGET_AVX2 RAW_INLINE __m256 Load2(const f32* lo, const f32* hi)
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+        }
+
+        RAW_TARGET_AVX2 RAW_INLINE __m256 Broadcast2(f32 lo, f32 hi)
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(lo)), _mm_set1_ps(hi), 1);
+        }
+
+        // two matrix products at once, one in each 128 bit lane
+        RAW_TARGET_AVX2 RAW_INLINE void MultiplyMat4Pair(const f32* a0, const f32* b0, f32* out0, const f32* a1, const f32* b1, f32* out1)
+        {
+            const __m256 c0 = Load2(a0 + 0, a1 + 0);
+            const __m256 c1 = Load2(a0 + 4, a1 + 4);
+            const __m256 c2 = Load2(a0 + 8, a1 + 8);
+            const __m256 c3 = Load2(a0 + 12, a1 + 12);
+
+            for(u32 c = 0; c < 4; c++)
+            {
+                __m256 r = _mm256_mul_ps(c0, Broadcast2(b0[c * 4 + 0], b1[c * 4 + 0]));
+                r = _mm256_add_ps(r, _mm256_mul_ps(c1, Broadcast2(b0[c * 4 + 1], b1[c * 4 + 1])));
+                r = _mm256_add_ps(r, _mm256_mul_ps(c2, Broadcast2(b0[c * 4 + 2], b1[c * 4 + 2])));
+                r = _mm256_add_ps(r, _mm256_mul_ps(c3, Broadcast2(b0[c * 4 + 3], b1[c * 4 + 3])));
+                _mm_storeu_ps(out0 + c * 4, _mm256_castps256_ps128(r));
+                _mm_storeu_ps(out1 + c * 4, _mm256_extractf128_ps(r, 1));
+            }
+        }
+
+        RAW_TARGET_AVX2 void MultiplyLevelAVX2(const u32* nodes, u32 count, const u32* parents, const glm::mat4* locals, glm::mat4* worlds)
+        {
+            const u32 pairCount = count & ~1u;
+            for(u32 i = 0; i < pairCount; i += 2)
+            {
+                const u32 n0 = nodes[i];
+                const u32 n1 = nodes[i + 1];
+                MultiplyMat4Pair(&worlds[parents[n0]][0][0], &locals[n0][0][0], &worlds[n0][0][0], 
+                    &worlds[parents[n1]][0][0], &locals[n1][0][0], &worlds[n1][0][0]);
+            }
+            if(pairCount < count) MultiplyLevelScalar(nodes + pairCount, count - pairCount, parents, locals, worlds);
+        }
+#else
+        void MultiplyLevelAVX2(const u32* nodes, u32 count, const u32* parents, const glm::mat4* locals, glm::mat4* worlds)
+        {
+            MultiplyLevelScalar(nodes, count, parents, locals, worlds);
+        }
+#endif
+
+        void MultiplyLevel(const u32* nodes, u32 count, const u32* parents, const glm::mat4* locals, glm::mat4* worlds)
+        {
+            if(SIMD::SupportsAVX2())
+            {
+                MultiplyLevelAVX2(nodes, count, parents, locals, worlds);
+            }
+            else
+            {
+                MultiplyLevelScalar(nodes, count, parents, locals, worlds);
+            }
+        }
+    }
+
+    void SceneGraph::Build(const GFX::SceneData& sceneData)
+    {
+        Clear();
+
+        const u32 transformCount = (u32)sceneData.transforms.size();
+        RAW_ASSERT(sceneData.localTransforms.size() == transformCount);
+        RAW_ASSERT(sceneData.transformParents.size() == transformCount);
+        if(transformCount == 0) return;
+
+        // transforms are loaded depth first, parents always come before their children
+        std::vector<u32> depth(transformCount, 0);
+        u32 maxDepth = 0;
+        for(u32 i = 0; i < transformCount; i++)
+        {
+            const u32 parent = sceneData.transformParents[i];
+            if(parent != INVALID_NODE)
+            {
+                RAW_ASSERT_MSG(parent < i, "Transform %u is located before its parent %u!", i, parent);
+                depth[i] = depth[parent] + 1;
+                maxDepth = std::max(maxDepth, depth[i]);
+            }
+        }
+
+        // counting sort by depth, stable so siblings keep their relative order
+        m_LevelOffsets.assign(maxDepth + 2, 0);
+        for(u32 i = 0; i < transformCount; i++) m_LevelOffsets[depth[i] + 1]++;
+        for(u32 i = 1; i < m_LevelOffsets.size(); i++) m_LevelOffsets[i] += m_LevelOffsets[i - 1];
+
+        std::vector<u32> levelCursor(m_LevelOffsets.begin(), m_LevelOffsets.end() - 1);
+        m_NodeToTransform.resize(transformCount);
+        m_TransformToNode.resize(transformCount);
+        for(u32 i = 0; i < transformCount; i++)
+        {
+            const u32 node = levelCursor[depth[i]]++;
+            m_NodeToTransform[node] = i;
+            m_TransformToNode[i] = node;
+        }
+
+        m_Parents.resize(transformCount);
+        m_LocalTransforms.resize(transformCount);
+        m_WorldTransforms.resize(transformCount);
+        m_Dirty.assign(transformCount, 0);
+        for(u32 node = 0; node < transformCount; node++)
+        {
+            const u32 transform = m_NodeToTransform[node];
+            const u32 parent = sceneData.transformParents[transform];
+            m_Parents[node] = parent == INVALID_NODE ? INVALID_NODE : m_TransformToNode[parent];
+            m_LocalTransforms[node] = sceneData.localTransforms[transform];
+            m_WorldTransforms[node] = sceneData.transforms[transform];
+        }
+
+        // group draws by the node they reference
+        const u32 drawCount = (u32)sceneData.meshes.size();
+        m_NodeDrawOffsets.assign(transformCount + 1, 0);
+        for(u32 d = 0; d < drawCount; d++)
+        {
+            m_NodeDrawOffsets[m_TransformToNode[sceneData.meshes[d].transformIndex] + 1]++;
+        }
+        for(u32 i = 1; i < m_NodeDrawOffsets.size(); i++) m_NodeDrawOffsets[i] += m_NodeDrawOffsets[i - 1];
+
+        std::vector<u32> drawCursor(m_NodeDrawOffsets.begin(), m_NodeDrawOffsets.end() - 1);
+        m_NodeDraws.resize(drawCount);
+        for(u32 d = 0; d < drawCount; d++)
+        {
+            const u32 node = m_TransformToNode[sceneData.meshes[d].transformIndex];
+            m_NodeDraws[drawCursor[node]++] = d;
+        }
+
+        m_DirtyNodes.reserve(transformCount);
+    }
+
+    void SceneGraph::Clear()
+    {
+        m_LocalTransforms.clear();
+        m_WorldTransforms.clear();
+        m_Parents.clear();
+        m_NodeToTransform.clear();
+        m_TransformToNode.clear();
+        m_Dirty.clear();
+        m_LevelOffsets.clear();
+        m_NodeDrawOffsets.clear();
+        m_NodeDraws.clear();
+        m_DirtyNodes.clear();
+        m_AnyDirty = false;
+    }
+
+    void SceneGraph::SetLocalTransform(u32 node, const glm::mat4& local)
+    {
+        RAW_ASSERT(node < m_LocalTransforms.size());
+        m_LocalTransforms[node] = local;
+        m_Dirty[node] = 1;
+        m_AnyDirty = true;
+    }
+
+    void SceneGraph::Update(GFX::SceneData& sceneData, ChangeTracker& drawChanges, u64 frame)
+    {
+        if(!m_AnyDirty) return;
+
+        const u32 nodeCount = GetNodeCount();
+
+        // parents precede children, a single forward pass propagates the flags
+        for(u32 node = 0; node < nodeCount; node++)
+        {
+            const u32 parent = m_Parents[node];
+            if(parent != INVALID_NODE) m_Dirty[node] |= m_Dirty[parent];
+        }
+
+        for(u32 level = 0; level + 1 < m_LevelOffsets.size(); level++)
+        {
+            m_DirtyNodes.clear();
+            for(u32 node = m_LevelOffsets[level]; node < m_LevelOffsets[level + 1]; node++)
+            {
+                if(m_Dirty[node]) m_DirtyNodes.push_back(node);
+            }
+            if(m_DirtyNodes.empty()) continue;
+
+            if(level == 0)
+            {
+                for(u32 node : m_DirtyNodes) m_WorldTransforms[node] = m_LocalTransforms[node];
+            }
+            else
+            {
+                // nodes within a level are independent, their parents were finished in the previous level
+                MultiplyLevel(m_DirtyNodes.data(), (u32)m_DirtyNodes.size(), m_Parents.data(), m_LocalTransforms.data(), m_WorldTransforms.data());
+            }
+
+            for(u32 node : m_DirtyNodes)
+            {
+                sceneData.transforms[m_NodeToTransform[node]] = m_WorldTransforms[node];
+                for(u32 d = m_NodeDrawOffsets[node]; d < m_NodeDrawOffsets[node + 1]; d++)
+                {
+                    const u32 drawIndex = m_NodeDraws[d];
+                    GFX::MeshDrawData& draw = sceneData.draws[drawIndex];
+                    draw.transform = m_WorldTransforms[node];
+                    drawChanges.MarkChanged(drawIndex, frame);
+
+                    // a static instance that moves becomes dynamic, cached static shadows are redrawn once without it
+                    if(!draw.isDynamic)
+                    {
+                        draw.isDynamic = 1;
+                        sceneData.dynamicInstanceCount++;
+                        sceneData.staticCasterVersion++;
+                    }
+                }
+                m_Dirty[node] = 0;
+            }
+        }
+        m_AnyDirty = false;
+    }
+}
@@ -4,13 +4,22 @@
 #include "core/asserts.hpp"
 #include "renderer/gfxdevice.hpp"
 #include "resources/texture_loader.hpp"
-#include "resources/buffer_loader.hpp"
 #include "core/timer.hpp"
 #include "core/job_system.hpp"
+#include "platform/mapped_file.hpp"
+#include "utility/image.hpp"
+#include "utility/scene_cache.hpp"
+#include "utility/mesh_optimizer.hpp"
+#include "scene/instance_bounds.hpp"
+#include "renderer/geometry_heap.hpp"
+#include "resources/texture_streamer.hpp"
 #include <vector>
 #include <glm/gtc/type_ptr.hpp>
 #include <tiny_gltf.h>
 #include <limits>
+#include <cctype>
+#include <algorithm>
+#include <tuple>
 
 using namespace tinygltf;
 
@@ -18,14 +27,164 @@ namespace Raw::Utils
 {
     namespace
     {
+        constexpr u32 GLB_MAGIC = 0x46546C67;         // "glTF"
+        constexpr u32 GLB_CHUNK_BIN = 0x004E4942;     // "BIN\0"
+
+        // locates the embedded BIN chunk of a glb so accessors can be read in place
+        bool FindGLBBinaryChunk(const u8* data, u64 size, const u8*& outBin, u64& outBinSize)
+        {
+            outBin = nullptr;
+            outBinSize = 0;
+            if(size < 20) return false;
+
+            u32 header[3];
+            memcpy(header, data, sizeof(header));
+            if(header[0] != GLB_MAGIC || header[1] != 2 || header[2] > size) return false;
+
+            u64 offset = 12;
+            while(offset + 8 <= header[2])
+            {
+                u32 chunk[2];
+                memcpy(chunk, data + offset, sizeof(chunk));
+                offset += 8;
+                if(offset + chunk[0] > header[2]) return false;
+
+                if(chunk[1] == GLB_CHUNK_BIN)
+                {
+                    outBin = data + offset;
+                    outBinSize = chunk[0];
+                    return true;
+                }
+                // chunks are padded to 4 bytes
+                offset += (chunk[0] + 3) & ~3u;
+            }
+            return false;
+        }
+
+        struct AccessorView
+        {
+            const u8* data{ nullptr };
+            u64 stride{ 0 };
+            u64 count{ 0 };
+
+            template<typename T>
+            RAW_INLINE const T* At(u64 index) const { return reinterpret_cast<const T*>(data + index * stride); }
+        };
+
+        // resolves an accessor to a strided view, the glb buffer is read straight from the file mapping
+        AccessorView GetAccessorView(const Model& input, i32 accessorIndex, const u8* binChunk)
+        {
+            AccessorView view;
+            if(accessorIndex < 0) return view;
+
+            const Accessor& accessor = input.accessors[accessorIndex];
+            if(accessor.bufferView < 0) return view;
+
+            const BufferView& bufferView = input.bufferViews[accessor.bufferView];
+            const Buffer& buffer = input.buffers[bufferView.buffer];
+            const u8* base = (binChunk && bufferView.buffer == 0 && buffer.uri.empty()) ? binChunk : buffer.data.data();
+
+            i32 stride = accessor.ByteStride(bufferView);
+            if(stride <= 0) return view;
+
+            view.data = base + bufferView.byteOffset + accessor.byteOffset;
+            view.stride = (u64)stride;
+            view.count = accessor.count;
+            return view;
+        }
+
+        i32 FindAttribute(const Primitive& primitive, cstring name)
+        {
+            auto it = primitive.attributes.find(name);
+            return it != primitive.attributes.end() ? it->second : -1;
+        }
+
+        GFX::EDrawStream GetDrawStream(const Model& input, i32 material)
+        {
+            if(material < 0) return GFX::OPAQUE_STREAM;
+
+            const std::string& alphaMode = input.materials[material].alphaMode;
+            if(alphaMode == "BLEND") return GFX::BLENDED_STREAM;
+            if(alphaMode == "MASK") return GFX::MASKED_STREAM;
+            return GFX::OPAQUE_STREAM;
+        }
+
+        // primitives whose vertices can all be addressed by a u16 index use 16 bit index buffers
+        constexpr u32 MAX_SHORT_INDEX_VERTICES = 1u << 16;
+
+        // where a primitive's converted geometry lands in the scene wide vertex and index arrays,
+        // indices are local to the primitive and firstIndex counts in the primitive's index width
+        struct PrimitiveRange
+        {
+            i32 mesh{ -1 };
+            u32 primitive{ 0 };
+            u32 drawIndex{ 0 };
+            u32 firstVertex{ 0 };
+            u32 vertexCount{ 0 };
+            u32 firstIndex{ 0 };
+            u32 indexCount{ 0 };
+            u64 indexByteOffset{ 0 };
+            i32 material{ -1 };
+            GFX::EDrawStream stream{ GFX::OPAQUE_STREAM };
+            bool shortIndices{ false };
+            bool triangleList{ false };
+            bool opaque{ false };
+        };
+
+        // post transform cache efficiency of a primitive before and after its indices were reordered
+        struct PrimitiveCacheStats
+        {
+            Utils::VertexCacheStats before;
+            Utils::VertexCacheStats after;
+            bool optimized{ false };
+        };
+
+        // meshlets of one primitive, built by its job and appended to the scene wide lists afterwards.
+        // every level of detail is split separately, lodFirstMeshlet is relative to the primitive's first meshlet
+        struct PrimitiveMeshlets
+        {
+            std::vector<Utils::Meshlet> meshlets;
+            std::vector<Utils::MeshletBounds> bounds;
+            std::vector<u32> vertices;
+            std::vector<u32> triangles;
+            u32 lodFirstMeshlet[MAX_LOD_COUNT]{};
+            u32 lodMeshletCount[MAX_LOD_COUNT]{};
+        };
+
+        // levels of detail are only built for primitives big enough for the savings to outweigh the extra draws
+        constexpr u32 MIN_LOD_TRIANGLES = 256;
+        // largest simplification error accepted for any level, relative to the diagonal of the primitive's bounds
+        constexpr f32 LOD_MAX_RELATIVE_ERROR = 0.05f;
+
+        // coarser levels of one primitive, local indices like the source mesh, lod 0 is the source mesh itself
+        struct PrimitiveLods
+        {
+            u32 count{ 1 };
+            f32 errors[MAX_LOD_COUNT]{};
+            std::vector<u32> indices[MAX_LOD_COUNT];
+        };
+
+        // a node's reference to a mesh primitive, expanded into MeshDrawData once every node has been visited
+        struct PrimitiveInstance
+        {
+            u32 drawIndex{ 0 };
+            u32 transformIndex{ 0 };
+            u32 materialIndex{ 0 };
+            u32 isTransparent{ 0 };
+        };
+
+        // serial pass, walks the hierarchy and reserves a slice of the vertex/index arrays for each unique primitive,
+        // a primitive referenced by several nodes is converted once and drawn instanced
         void LoadNode(
             const Node& inputNode, 
-            Model& input,
+            const Model& input,
             GFX::SceneData& outSceneData, 
             glm::mat4 parentTransform, 
-            std::vector<GFX::VertexData>& vertices, 
-            std::vector<u32>& indices, 
-            std::vector<GFX::IndirectDraw>& indirectDraws)
+            u32 parentIndex,
+            u32& vertexTotal,
+            std::vector<PrimitiveRange>& primitives,
+            std::vector<GFX::IndirectDraw>& indirectDraws,
+            std::vector<PrimitiveInstance>& instances)
         {
             glm::mat4 curTransform = glm::mat4(1.f);
 
@@ -47,242 +206,565 @@ namespace Raw::Utils
                 curTransform = glm::make_mat4x4(inputNode.matrix.data());
             }
 
+            outSceneData.localTransforms.push_back(curTransform);
+            outSceneData.transformParents.push_back(parentIndex);
+
             curTransform = parentTransform * curTransform;
 
             outSceneData.transforms.push_back(curTransform);
-            
+            const u32 transformIndex = (u32)outSceneData.transforms.size() - 1;
             
             if(inputNode.children.size() > 0)
             {
                 for(u64 i = 0; i < inputNode.children.size(); i++)
                 {
                     const Node& childNode = input.nodes[inputNode.children[i]];
-                    LoadNode(childNode, input, outSceneData, curTransform, vertices, indices, indirectDraws);
+                    LoadNode(childNode, input, outSceneData, curTransform, transformIndex, vertexTotal, primitives, indirectDraws, instances);
                 }
             }
             
             if(inputNode.mesh > -1)
             {
-                const Mesh gltfMesh = input.meshes[inputNode.mesh];
+                const Mesh& gltfMesh = input.meshes[inputNode.mesh];
                 RAW_DEBUG("Loading glTF mesh: %s", gltfMesh.name.c_str());
-                GFX::MeshData mesh;
-                glm::vec3 boundsMin = glm::vec3(std::numeric_limits<float>::max());
-                glm::vec3 boundsMax = glm::vec3(std::numeric_limits<float>::min());
                 
                 for(u64 i = 0; i < gltfMesh.primitives.size(); i++)
                 {
-                    GFX::MeshData mesh;
-                    u64 meshId = Utils::HashCString(gltfMesh.name.c_str());
                     const Primitive& gltfPrimitive = gltfMesh.primitives[i];
-                    u32 firstIndex = indices.size();
-                    u32 vertexStart = vertices.size();
-                    u32 indexCount = 0;
+                    const u64 primitiveKey = ((u64)inputNode.mesh << 32) | (u64)i;
 
-                    // vertices
+                    auto it = outSceneData.meshLookup.find(primitiveKey);
+                    u32 drawIndex = 0;
+                    if(it != outSceneData.meshLookup.end())
                     {
-                        const f32* positionBuffer = nullptr;
-                        const f32* normalBuffer = nullptr;
-                        const f32* texCoordBuffer = nullptr;
-                        const f32* tangentsBuffer = nullptr;
-                        u64 vertexCount = 0;
+                        drawIndex = it->second;
+                    }
+                    else
+                    {
+                        const i32 positionAccessor = FindAttribute(gltfPrimitive, "POSITION");
+                        if(positionAccessor < 0 || gltfPrimitive.indices < 0) continue;
 
-                        if(gltfPrimitive.attributes.find("POSITION") != gltfPrimitive.attributes.end())
-                        {
-                            const Accessor& accessor = input.accessors[gltfPrimitive.attributes.find("POSITION")->second];
-                            const BufferView& view = input.bufferViews[accessor.bufferView];
-                            positionBuffer = reinterpret_cast<const f32*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
-                            vertexCount = accessor.count;
-                        }
-                        
-                        if(gltfPrimitive.attributes.find("NORMAL") != gltfPrimitive.attributes.end())
+                        const Accessor& indexAccessor = input.accessors[gltfPrimitive.indices];
+                        if(indexAccessor.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT &&
+                            indexAccessor.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT &&
+                            indexAccessor.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
                         {
-                            const Accessor& accessor = input.accessors[gltfPrimitive.attributes.find("NORMAL")->second];
-                            const BufferView& view = input.bufferViews[accessor.bufferView];
-                            normalBuffer = reinterpret_cast<const f32*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
+                            RAW_ERROR("Index of component type %u not supported!", indexAccessor.componentType);
+                            continue;
                         }
 
-                        if(gltfPrimitive.attributes.find("TEXCOORD_0") != gltfPrimitive.attributes.end())
-                        {
-                            const tinygltf::Accessor& accessor = input.accessors[gltfPrimitive.attributes.find("TEXCOORD_0")->second];
-                            const tinygltf::BufferView& view = input.bufferViews[accessor.bufferView];
-                            texCoordBuffer = reinterpret_cast<const f32*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
-                        }
-                        
-                        if(gltfPrimitive.attributes.find("TANGENT") != gltfPrimitive.attributes.end())
-                        {
-                            const tinygltf::Accessor& accessor = input.accessors[gltfPrimitive.attributes.find("TANGENT")->second];
-                            const tinygltf::BufferView& view = input.bufferViews[accessor.bufferView];
-                            tangentsBuffer = reinterpret_cast<const f32*>(&(input.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset]));
-                        }
+                        drawIndex = (u32)indirectDraws.size();
+                        outSceneData.meshLookup[primitiveKey] = drawIndex;
 
-                        for(u64 v = 0; v < vertexCount; v++)
-                        {
-                            GFX::VertexData vert{};
-                            vert.position = glm::make_vec3(&positionBuffer[v*3]);
-                            vert.normal = glm::normalize(glm::vec3(normalBuffer ? glm::make_vec3(&normalBuffer[v * 3]) : glm::vec3(0.0f)));
-                            glm::vec2 uv = texCoordBuffer ? glm::make_vec2(&texCoordBuffer[v * 2]) : glm::vec2(0.0f);
-                            vert.texCoordU = uv.x;
-                            vert.texCoordV = uv.y;
-                            if(tangentsBuffer)
-                            {
-                                vert.tangent = glm::make_vec4(&tangentsBuffer[v * 4]);
-                            }
-                            else
-                            {
-                                glm::vec3 arbitraryVec = vert.normal;
-                                arbitraryVec.x *= -1;
-                                glm::vec3 temp = glm::cross(vert.normal, arbitraryVec);
-                                vert.tangent = glm::vec4(temp.x, temp.y, temp.z, 1.0f);
-                            }
-
-                            boundsMin = glm::min(boundsMin, vert.position);
-                            boundsMax = glm::max(boundsMax, vert.position);
-                            vertices.push_back(vert);
-                        }
-                    }
+                        PrimitiveRange range;
+                        range.mesh = inputNode.mesh;
+                        range.primitive = (u32)i;
+                        range.drawIndex = drawIndex;
+                        range.firstVertex = vertexTotal;
+                        range.vertexCount = (u32)input.accessors[positionAccessor].count;
+                        range.indexCount = (u32)indexAccessor.count;
+                        range.shortIndices = range.vertexCount <= MAX_SHORT_INDEX_VERTICES;
+                        range.triangleList = gltfPrimitive.mode == TINYGLTF_MODE_TRIANGLES || gltfPrimitive.mode == -1;
+                        range.material = gltfPrimitive.material;
+                        range.stream = GetDrawStream(input, gltfPrimitive.material);
+                        range.opaque = range.stream == GFX::OPAQUE_STREAM;
+                        primitives.push_back(range);
 
-                    // indices
-                    {
-                        const Accessor& accessor = input.accessors[gltfPrimitive.indices];
-                        const BufferView& bufferView = input.bufferViews[accessor.bufferView];
-                        const Buffer& buffer = input.buffers[bufferView.buffer];
+                        vertexTotal += range.vertexCount;
 
-                        indexCount += (u32)accessor.count;
-                        switch(accessor.componentType)
-                        {
-                            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-                            {
-                                const u32* buf = reinterpret_cast<const u32*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                                for(u64 index = 0; index < accessor.count; index++)
-                                {
-                                    indices.push_back(buf[index] + vertexStart);
-                                }
-                                break;
-                            }
-                            
-                            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-                            {
-                                const u16* buf = reinterpret_cast<const u16*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                                for(u64 index = 0; index < accessor.count; index++)
-                                {
-                                    indices.push_back(buf[index] + vertexStart);
-                                }
-                                break;
-                            }
-
-                            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                            {
-                                const uint8_t* buf = reinterpret_cast<const uint8_t*>(&buffer.data[accessor.byteOffset + bufferView.byteOffset]);
-                                for(u64 index = 0; index < accessor.count; index++)
-                                {
-                                    indices.push_back(buf[index] + vertexStart);
-                                }
-                                break;
-                            }
-                            default:
-                                RAW_ERROR("Index of component type %u not supported!", accessor.componentType);
-                                return;
-                        }
+                        // firstIndex is placed by LayoutIndices, instanceCount and firstInstance once all references are known
+                        GFX::IndirectDraw iDraw;
+                        iDraw.firstIndex = 0;
+                        iDraw.indexCount = range.indexCount;
+                        iDraw.vertexOffset = (i32)range.firstVertex;
+                        iDraw.instanceCount = 0;
+                        iDraw.firstInstance = 0;
+
+                        indirectDraws.push_back(iDraw);
                     }
 
-                    mesh.firstIndex = firstIndex;
-                    mesh.indexCount = indexCount;
-                    mesh.materialIndex = gltfPrimitive.material;
-                    mesh.vertexOffset = 0;
-                    mesh.baseInstance = 0;
-                    mesh.instanceCount = 1;
-                    mesh.transformIndex = (u32)outSceneData.transforms.size() - 1;
-
-                    GFX::MeshBoundsData meshBounds;
-                    meshBounds.boundsMin = boundsMin;
-                    meshBounds.boundsMax = boundsMax;
-
-                    GFX::IndirectDraw iDraw;
-                    iDraw.firstIndex = firstIndex;
-                    iDraw.indexCount = indexCount;
-                    iDraw.vertexOffset = 0;
-                    iDraw.instanceCount = 1;
-                    iDraw.firstInstance = 0;
-
-                    indirectDraws.push_back(iDraw);
-
-                    GFX::MeshDrawData meshDraw;
-                    meshDraw.transform = curTransform;
-                    meshDraw.materialIndex = mesh.materialIndex;
-                    meshDraw.isTransparent = input.materials[meshDraw.materialIndex].alphaMode == "OPAQUE" ? 0 : 1;
-
-                    outSceneData.drawCount++;
-                    outSceneData.draws.push_back(meshDraw);
-                    outSceneData.meshes.push_back(mesh);
-                    outSceneData.meshBoundsData.push_back(meshBounds);
+                    PrimitiveInstance instance;
+                    instance.drawIndex = drawIndex;
+                    instance.transformIndex = transformIndex;
+                    instance.materialIndex = gltfPrimitive.material;
+                    instance.isTransparent = GetDrawStream(input, gltfPrimitive.material) == GFX::BLENDED_STREAM ? 1 : 0;
+                    instances.push_back(instance);
+                }
+            }
+        }
+
+        // orders the draws so every 16 bit indexed draw comes first and each width is sorted by stream then material,
+        // then packs the 16 bit indices followed by the 32 bit ones. returns the size of the index buffer in bytes
+        u64 LayoutIndices(
+            std::vector<PrimitiveRange>& primitives, 
+            std::vector<GFX::IndirectDraw>& indirectDraws, 
+            std::vector<PrimitiveInstance>& instances, 
+            GFX::SceneData& outSceneData)
+        {
+            const u32 drawCount = (u32)indirectDraws.size();
+            u32 shortCount = 0;
+            for(const PrimitiveRange& range : primitives) shortCount += range.shortIndices ? 1 : 0;
+
+            // every pass draws one stream, and neighbouring draws of one material keep its textures hot
+            std::vector<u32> order(primitives.size());
+            for(u32 i = 0; i < (u32)order.size(); i++) order[i] = i;
+            std::sort(order.begin(), order.end(), [&](u32 a, u32 b)
+                {
+                    const PrimitiveRange& ra = primitives[a];
+                    const PrimitiveRange& rb = primitives[b];
+                    return std::make_tuple(!ra.shortIndices, ra.stream, ra.material, ra.drawIndex) < 
+                        std::make_tuple(!rb.shortIndices, rb.stream, rb.material, rb.drawIndex);
                 }
+            );
+
+            std::vector<u32> remap(drawCount);
+            for(u32 i = 0; i < (u32)order.size(); i++) remap[primitives[order[i]].drawIndex] = i;
+
+            for(GFX::DrawStream& stream : outSceneData.streams) stream = GFX::DrawStream();
+            for(const PrimitiveRange& range : primitives)
+            {
+                GFX::DrawStream& stream = outSceneData.streams[range.stream];
+                (range.shortIndices ? stream.shortRange : stream.wideRange).count++;
+            }
+
+            u32 streamCursor = 0;
+            for(GFX::DrawStream& stream : outSceneData.streams)
+            {
+                stream.shortRange.first = streamCursor;
+                streamCursor += stream.shortRange.count;
             }
+            for(GFX::DrawStream& stream : outSceneData.streams)
+            {
+                stream.wideRange.first = streamCursor;
+                streamCursor += stream.wideRange.count;
+            }
+
+            std::vector<GFX::IndirectDraw> sortedDraws(drawCount);
+            for(u32 d = 0; d < drawCount; d++) sortedDraws[remap[d]] = indirectDraws[d];
+            indirectDraws.swap(sortedDraws);
+
+            for(PrimitiveInstance& instance : instances) instance.drawIndex = remap[instance.drawIndex];
+            for(auto& kvPair : outSceneData.meshLookup) kvPair.second = remap[kvPair.second];
+
+            u64 shortTotal = 0;
+            u64 wideTotal = 0;
+            for(PrimitiveRange& range : primitives)
+            {
+                range.drawIndex = remap[range.drawIndex];
+                u64& total = range.shortIndices ? shortTotal : wideTotal;
+                range.firstIndex = (u32)total;
+                total += range.indexCount;
+                indirectDraws[range.drawIndex].firstIndex = range.firstIndex;
+            }
+
+            // the 32 bit range must start 4 byte aligned for vkCmdBindIndexBuffer
+            const u64 wideIndexOffset = (shortTotal * sizeof(u16) + 3) & ~3ull;
+            for(PrimitiveRange& range : primitives)
+            {
+                range.indexByteOffset = range.shortIndices ? range.firstIndex * sizeof(u16) : wideIndexOffset + range.firstIndex * sizeof(u32);
+            }
+
+            outSceneData.shortIndexDrawCount = shortCount;
+            outSceneData.wideIndexOffset = wideIndexOffset;
+            return wideIndexOffset + wideTotal * sizeof(u32);
         }
-        void LoadImages(Model& input, std::vector<u32>& images, std::vector<u64>& imageIds)
+
+        // groups instances by indirect draw so each draw's instances are contiguous from its firstInstance,
+        // gl_InstanceIndex then addresses the instance's MeshDrawData directly
+        void EmitInstances(const std::vector<PrimitiveInstance>& instances, std::vector<GFX::IndirectDraw>& indirectDraws, GFX::SceneData& outSceneData)
         {
-            for(u64 i = 0; i < input.images.size(); i++)
+            for(const PrimitiveInstance& instance : instances) indirectDraws[instance.drawIndex].instanceCount++;
+
+            u32 firstInstance = 0;
+            for(GFX::IndirectDraw& iDraw : indirectDraws)
             {
-                Image& glTFImage = input.images[i];
-                // RAW_DEBUG("Loading glTF image: %s", glTFImage.name.c_str());
-                u8* buffer = nullptr;
-                u64 bufferSize = 0;
+                iDraw.firstInstance = firstInstance;
+                firstInstance += iDraw.instanceCount;
+            }
+
+            std::vector<u32> cursor(indirectDraws.size());
+            for(u64 i = 0; i < indirectDraws.size(); i++) cursor[i] = indirectDraws[i].firstInstance;
 
-                if(glTFImage.component == 3)
+            outSceneData.draws.resize(instances.size());
+            outSceneData.meshes.resize(instances.size());
+            for(const PrimitiveInstance& instance : instances)
+            {
+                const GFX::IndirectDraw& iDraw = indirectDraws[instance.drawIndex];
+                const u32 slot = cursor[instance.drawIndex]++;
+
+                GFX::MeshDrawData& meshDraw = outSceneData.draws[slot];
+                meshDraw.transform = outSceneData.transforms[instance.transformIndex];
+                meshDraw.materialIndex = instance.materialIndex;
+                meshDraw.isTransparent = instance.isTransparent;
+                meshDraw.drawIndex = instance.drawIndex;
+                meshDraw.isDynamic = 0;
+
+                // a single instance draw of the slot, for passes that draw meshes one at a time
+                GFX::MeshData& mesh = outSceneData.meshes[slot];
+                mesh.firstIndex = iDraw.firstIndex;
+                mesh.indexCount = iDraw.indexCount;
+                mesh.materialIndex = instance.materialIndex;
+                mesh.vertexOffset = (u32)iDraw.vertexOffset;
+                mesh.baseInstance = slot;
+                mesh.instanceCount = 1;
+                mesh.transformIndex = instance.transformIndex;
+            }
+        }
+
+        GFX::VertexData ReadVertex(const AccessorView& positions, const AccessorView& normals, const AccessorView& texCoords, const AccessorView& tangents, u64 v)
+        {
+            GFX::VertexData vert{};
+            vert.position = glm::make_vec3(positions.At<f32>(v));
+            vert.normal = glm::normalize(glm::vec3(normals.data ? glm::make_vec3(normals.At<f32>(v)) : glm::vec3(0.0f)));
+            glm::vec2 uv = texCoords.data ? glm::make_vec2(texCoords.At<f32>(v)) : glm::vec2(0.0f);
+            vert.texCoordU = uv.x;
+            vert.texCoordV = uv.y;
+            if(tangents.data)
+            {
+                vert.tangent = glm::make_vec4(tangents.At<f32>(v));
+            }
+            else
+            {
+                glm::vec3 arbitraryVec = vert.normal;
+                arbitraryVec.x *= -1;
+                glm::vec3 temp = glm::cross(vert.normal, arbitraryVec);
+                vert.tangent = glm::vec4(temp.x, temp.y, temp.z, 1.0f);
+            }
+            return vert;
+        }
+
+#if defined(RAW_COMPACT_VERTICES)
+        // octahedral encoding, the unit sphere is folded onto the [-1, 1] square
+        u32 EncodeOctahedral(glm::vec3 n)
+        {
+            const f32 l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+            if(l1 <= 0.0f) return glm::packSnorm2x16(glm::vec2(0.0f));
+
+            glm::vec2 e = glm::vec2(n.x, n.y) / l1;
+            if(n.z < 0.0f)
+            {
+                e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) * glm::vec2(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+            }
+            return glm::packSnorm2x16(e);
+        }
+
+        GFX::CompactVertexData CompressVertex(const GFX::VertexData& vert, const glm::vec3& boundsMin, const glm::vec3& invExtent)
+        {
+            const glm::vec3 q = glm::clamp((vert.position - boundsMin) * invExtent, glm::vec3(0.0f), glm::vec3(1.0f));
+            const u32 handedness = vert.tangent.w < 0.0f ? 0u : 0xFFFFu;
+
+            GFX::CompactVertexData packed;
+            packed.positionXY = glm::packUnorm2x16(glm::vec2(q.x, q.y));
+            packed.positionZW = (glm::packUnorm2x16(glm::vec2(q.z, 0.0f)) & 0xFFFFu) | (handedness << 16);
+            packed.normal = EncodeOctahedral(vert.normal);
+            packed.tangent = EncodeOctahedral(glm::vec3(vert.tangent));
+            packed.texCoord = glm::packHalf2x16(glm::vec2(vert.texCoordU, vert.texCoordV));
+            return packed;
+        }
+#endif
+
+        template<typename T>
+        void WriteIndices(const AccessorView& indexView, i32 componentType, u64 count, T* outIndices)
+        {
+            switch(componentType)
+            {
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                {
+                    for(u64 index = 0; index < count; index++) outIndices[index] = (T)*indexView.At<u32>(index);
+                    break;
+                }
+                
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                {
+                    for(u64 index = 0; index < count; index++) outIndices[index] = (T)*indexView.At<u16>(index);
+                    break;
+                }
+
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                {
+                    for(u64 index = 0; index < count; index++) outIndices[index] = (T)*indexView.At<u8>(index);
+                    break;
+                }
+            }
+        }
+
+        // parallel pass, converts one primitive into its reserved slices, indices stay local to the primitive
+        // and are offset by the draw's vertexOffset. triangle lists are reordered for the post transform cache
+        // and their vertices renumbered in order of first use before being written, then split into meshlets
+        void LoadPrimitive(
+            const Model& input, 
+            const PrimitiveRange& range, 
+            const u8* binChunk, 
+            GFX::SceneVertex* vertices, 
+            u8* indices, 
+            GFX::MeshBoundsData& outBounds,
+            PrimitiveCacheStats& outStats,
+            PrimitiveMeshlets& outMeshlets,
+            PrimitiveLods& outLods)
+        {
+            const Primitive& gltfPrimitive = input.meshes[range.mesh].primitives[range.primitive];
+            glm::vec3 boundsMin = glm::vec3(std::numeric_limits<f32>::max());
+            glm::vec3 boundsMax = glm::vec3(std::numeric_limits<f32>::lowest());
+
+            const AccessorView positions = GetAccessorView(input, FindAttribute(gltfPrimitive, "POSITION"), binChunk);
+            std::vector<glm::vec3> positionData(range.vertexCount);
+            for(u64 v = 0; v < range.vertexCount; v++)
+            {
+                positionData[v] = glm::make_vec3(positions.At<f32>(v));
+                boundsMin = glm::min(boundsMin, positionData[v]);
+                boundsMax = glm::max(boundsMax, positionData[v]);
+            }
+
+            // indices are optimised at full width and narrowed when written
+            std::vector<u32> localIndices(range.indexCount);
+            {
+                const Accessor& accessor = input.accessors[gltfPrimitive.indices];
+                const AccessorView indexView = GetAccessorView(input, gltfPrimitive.indices, binChunk);
+                WriteIndices(indexView, accessor.componentType, range.indexCount, localIndices.data());
+            }
+
+            std::vector<u32> remap;
+            const bool indicesInRange = std::all_of(localIndices.begin(), localIndices.end(), 
+                [&](u32 index){ return index < range.vertexCount; });
+            if(range.triangleList && indicesInRange && range.indexCount >= 6)
+            {
+                outStats.before = Utils::AnalyzeVertexCache(localIndices.data(), localIndices.size(), range.vertexCount);
+
+                // blended geometry keeps Tipsify's order, sorting its clusters by occlusion would not help
+                Utils::OptimizeVertexCache(localIndices.data(), localIndices.size(), range.vertexCount, range.opaque ? positionData.data() : nullptr);
+
+                remap.resize(range.vertexCount);
+                Utils::OptimizeVertexFetch(localIndices.data(), localIndices.size(), range.vertexCount, remap.data());
+
+                outStats.after = Utils::AnalyzeVertexCache(localIndices.data(), localIndices.size(), range.vertexCount);
+                outStats.optimized = true;
+            }
+
+            // positions in the order the optimised indices address them
+            std::vector<glm::vec3> remappedPositions;
+            if(!remap.empty())
+            {
+                remappedPositions.resize(range.vertexCount);
+                for(u64 v = 0; v < range.vertexCount; v++) remappedPositions[remap[v]] = positionData[v];
+            }
+            const glm::vec3* localPositions = remap.empty() ? positionData.data() : remappedPositions.data();
+
+            // each level halves the previous one and reuses the source vertices, so only indices are added.
+            // the chain ends early once a level barely shrinks or the error limit stops the simplifier
+            if(outStats.optimized && range.indexCount / 3 >= MIN_LOD_TRIANGLES)
+            {
+                const f32 maxError = glm::length(boundsMax - boundsMin) * LOD_MAX_RELATIVE_ERROR;
+                for(u32 lod = 1; lod < MAX_LOD_COUNT; lod++)
                 {
-                    bufferSize = glTFImage.width * glTFImage.height * 4;
-                    buffer = (u8*)malloc(bufferSize);
-                    u8* rgba = buffer;
-                    u8* rgb = &glTFImage.image[0];
-                    for(u64 j = 0; j < glTFImage.width * glTFImage.height; i++)
+                    const std::vector<u32>& source = lod == 1 ? localIndices : outLods.indices[lod - 1];
+                    std::vector<u32>& target = outLods.indices[lod];
+                    target.resize(source.size());
+
+                    f32 error = 0.0f;
+                    const u64 count = Utils::SimplifyMesh(source.data(), source.size(), range.vertexCount, localPositions, 
+                        source.size() / 6 * 3, maxError, target.data(), error);
+                    if(count == 0 || count > source.size() * 4 / 5)
                     {
-                        memcpy(rgba, rgb, sizeof(u8) * 3);
-                        rgba += 4;
-                        rgb += 3;
+                        target.clear();
+                        break;
                     }
 
-                    GFX::TextureDesc desc;
-                    desc.depth = 1;
-                    desc.width = glTFImage.width;
-                    desc.height = glTFImage.height;
-                    desc.isMipmapped = true;
-                    desc.isRenderTarget = false;
-                    desc.isStorageImage = false;
-                    desc.type = GFX::ETextureType::TEXTURE2D;
-                    desc.format = GFX::ETextureFormat::R8G8B8A8_UNORM;
-
-                    TextureResource* tex = (TextureResource*)TextureLoader::Instance()->CreateFromData(glTFImage.uri.c_str(), desc, buffer);
-                    images.push_back(tex->handle.id);
-                    imageIds.push_back(tex->textureId);
-                    tex->AddRef();
-
-                    free(buffer);
+                    target.resize(count);
+                    Utils::OptimizeVertexCache(target.data(), target.size(), range.vertexCount, range.opaque ? localPositions : nullptr);
+                    outLods.errors[lod] = std::max(error, outLods.errors[lod - 1]);
+                    outLods.count = lod + 1;
+                }
+            }
+
+            // meshlets are cut from the optimised order so neighbouring triangles share a meshlet
+            if(indicesInRange && range.indexCount >= 3)
+            {
+                for(u32 lod = 0; lod < outLods.count; lod++)
+                {
+                    const std::vector<u32>& lodIndices = lod == 0 ? localIndices : outLods.indices[lod];
+                    outMeshlets.lodFirstMeshlet[lod] = (u32)outMeshlets.meshlets.size();
+                    Utils::BuildMeshlets(lodIndices.data(), lodIndices.size(), range.vertexCount, MAX_MESHLET_VERTICES, MAX_MESHLET_TRIANGLES, 
+                        outMeshlets.meshlets, outMeshlets.vertices, outMeshlets.triangles);
+                    outMeshlets.lodMeshletCount[lod] = (u32)outMeshlets.meshlets.size() - outMeshlets.lodFirstMeshlet[lod];
+                }
+
+                outMeshlets.bounds.resize(outMeshlets.meshlets.size());
+                for(u64 m = 0; m < outMeshlets.meshlets.size(); m++)
+                {
+                    outMeshlets.bounds[m] = Utils::ComputeMeshletBounds(outMeshlets.meshlets[m], outMeshlets.vertices.data(), outMeshlets.triangles.data(), localPositions);
+                }
+
+                // meshlet vertices index the scene wide vertex buffer directly
+                for(u32& vertex : outMeshlets.vertices) vertex += range.firstVertex;
+            }
+
+            // vertices
+            {
+                const AccessorView normals = GetAccessorView(input, FindAttribute(gltfPrimitive, "NORMAL"), binChunk);
+                const AccessorView texCoords = GetAccessorView(input, FindAttribute(gltfPrimitive, "TEXCOORD_0"), binChunk);
+                const AccessorView tangents = GetAccessorView(input, FindAttribute(gltfPrimitive, "TANGENT"), binChunk);
+
+                GFX::SceneVertex* outVertices = vertices + range.firstVertex;
+#if defined(RAW_COMPACT_VERTICES)
+                // positions are quantised against the bounds the shaders dequantise with
+                const glm::vec3 extent = boundsMax - boundsMin;
+                const glm::vec3 invExtent = glm::vec3(
+                    extent.x > 0.0f ? 1.0f / extent.x : 0.0f, 
+                    extent.y > 0.0f ? 1.0f / extent.y : 0.0f, 
+                    extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+                for(u64 v = 0; v < range.vertexCount; v++)
+                {
+                    const u64 dst = remap.empty() ? v : remap[v];
+                    outVertices[dst] = CompressVertex(ReadVertex(positions, normals, texCoords, tangents, v), boundsMin, invExtent);
                 }
-                else
+#else
+                for(u64 v = 0; v < range.vertexCount; v++)
                 {
-                    buffer = &glTFImage.image[0];
-                    bufferSize = glTFImage.image.size();
-
-                    GFX::TextureDesc desc;
-                    desc.depth = 1;
-                    desc.width = glTFImage.width;
-                    desc.height = glTFImage.height;
-                    desc.isMipmapped = true;
-                    desc.isRenderTarget = false;
-                    desc.isStorageImage = false;
-                    desc.type = GFX::ETextureType::TEXTURE2D;
-                    desc.format = GFX::ETextureFormat::R8G8B8A8_UNORM;
-
-                    TextureResource* tex = (TextureResource*)TextureLoader::Instance()->CreateFromData(glTFImage.uri.c_str(), desc, buffer);
-                    if(tex)
-                    { 
-                        images.push_back(tex->handle.id);
-                        imageIds.push_back(tex->textureId);
-                        tex->AddRef();
+                    const u64 dst = remap.empty() ? v : remap[v];
+                    outVertices[dst] = ReadVertex(positions, normals, texCoords, tangents, v);
+                }
+#endif
+            }
+
+            if(range.shortIndices)
+            {
+                u16* outIndices = (u16*)(indices + range.indexByteOffset);
+                for(u64 index = 0; index < localIndices.size(); index++) outIndices[index] = (u16)localIndices[index];
+            }
+            else
+            {
+                memcpy(indices + range.indexByteOffset, localIndices.data(), localIndices.size() * sizeof(u32));
+            }
+
+            outBounds.boundsMin = boundsMin;
+            outBounds.boundsMax = boundsMax;
+        }
+
+        // serial pass, appends every primitive's coarser levels behind the indices of the same width.
+        // the 32 bit range moves back to make room for the 16 bit levels and keeps its 4 byte alignment
+        void AppendLods(
+            const std::vector<PrimitiveRange>& primitives, 
+            const std::vector<PrimitiveLods>& primitiveLods, 
+            std::vector<u8>& indices, 
+            GFX::SceneData& outSceneData)
+        {
+            u64 shortLodTotal = 0;
+            u64 wideLodTotal = 0;
+            for(u64 i = 0; i < primitives.size(); i++)
+            {
+                u64& total = primitives[i].shortIndices ? shortLodTotal : wideLodTotal;
+                for(u32 lod = 1; lod < primitiveLods[i].count; lod++) total += primitiveLods[i].indices[lod].size();
+            }
+
+            const u64 wideIndexOffset = outSceneData.wideIndexOffset;
+            const u64 wideSize = indices.size() - wideIndexOffset;
+            const u64 newWideIndexOffset = (wideIndexOffset + shortLodTotal * sizeof(u16) + 3) & ~3ull;
+
+            std::vector<u8> packed;
+            if(shortLodTotal + wideLodTotal > 0)
+            {
+                packed.resize(newWideIndexOffset + wideSize + wideLodTotal * sizeof(u32));
+                memcpy(packed.data(), indices.data(), wideIndexOffset);
+                memcpy(packed.data() + newWideIndexOffset, indices.data() + wideIndexOffset, wideSize);
+            }
+
+            // cursors count in the width of their range, like IndirectDraw::firstIndex
+            u64 shortCursor = wideIndexOffset / sizeof(u16);
+            u64 wideCursor = wideSize / sizeof(u32);
+            for(u64 i = 0; i < primitives.size(); i++)
+            {
+                const PrimitiveRange& range = primitives[i];
+                const PrimitiveLods& lods = primitiveLods[i];
+                GFX::MeshBoundsData& bounds = outSceneData.meshBoundsData[range.drawIndex];
+
+                bounds.lodCount = lods.count;
+                bounds.lods[0].firstIndex = range.firstIndex;
+                bounds.lods[0].indexCount = range.indexCount;
+                for(u32 lod = 1; lod < lods.count; lod++)
+                {
+                    const std::vector<u32>& lodIndices = lods.indices[lod];
+                    GFX::MeshLodData& level = bounds.lods[lod];
+                    level.indexCount = (u32)lodIndices.size();
+                    bounds.lodErrors[lod] = lods.errors[lod];
+
+                    if(range.shortIndices)
+                    {
+                        level.firstIndex = (u32)shortCursor;
+                        u16* outIndices = (u16*)packed.data() + shortCursor;
+                        for(u64 index = 0; index < lodIndices.size(); index++) outIndices[index] = (u16)lodIndices[index];
+                        shortCursor += lodIndices.size();
                     }
+                    else
+                    {
+                        level.firstIndex = (u32)wideCursor;
+                        memcpy(packed.data() + newWideIndexOffset + wideCursor * sizeof(u32), lodIndices.data(), lodIndices.size() * sizeof(u32));
+                        wideCursor += lodIndices.size();
+                    }
+                }
+            }
+
+            if(packed.empty()) return;
+
+            indices.swap(packed);
+            outSceneData.wideIndexOffset = newWideIndexOffset;
+        }
+
+        // serial pass, concatenates every primitive's meshlets and points its indirect draw's bounds at them
+        void AppendMeshlets(
+            const std::vector<PrimitiveRange>& primitives, 
+            const std::vector<PrimitiveMeshlets>& primitiveMeshlets, 
+            std::vector<GFX::MeshBoundsData>& meshBounds,
+            std::vector<GFX::MeshletData>& outMeshlets, 
+            std::vector<u32>& outVertices, 
+            std::vector<u32>& outTriangles)
+        {
+            for(u64 i = 0; i < primitives.size(); i++)
+            {
+                const PrimitiveMeshlets& source = primitiveMeshlets[i];
+                GFX::MeshBoundsData& bounds = meshBounds[primitives[i].drawIndex];
+                for(u32 lod = 0; lod < MAX_LOD_COUNT; lod++)
+                {
+                    bounds.lods[lod].firstMeshlet = (u32)outMeshlets.size() + source.lodFirstMeshlet[lod];
+                    bounds.lods[lod].meshletCount = source.lodMeshletCount[lod];
                 }
+
+                const u32 vertexBase = (u32)outVertices.size();
+                const u32 triangleBase = (u32)outTriangles.size();
+                for(u64 m = 0; m < source.meshlets.size(); m++)
+                {
+                    const Utils::Meshlet& meshlet = source.meshlets[m];
+                    const Utils::MeshletBounds& meshletBounds = source.bounds[m];
+
+                    GFX::MeshletData data;
+                    data.center = meshletBounds.center;
+                    data.radius = meshletBounds.radius;
+                    data.coneApex = meshletBounds.coneApex;
+                    data.coneCutoff = meshletBounds.coneCutoff;
+                    data.coneAxis = meshletBounds.coneAxis;
+                    data.vertexOffset = vertexBase + meshlet.vertexOffset;
+                    data.triangleOffset = triangleBase + meshlet.triangleOffset;
+                    data.vertexCount = meshlet.vertexCount;
+                    data.triangleCount = meshlet.triangleCount;
+                    outMeshlets.push_back(data);
+                }
+
+                outVertices.insert(outVertices.end(), source.vertices.begin(), source.vertices.end());
+                outTriangles.insert(outTriangles.end(), source.triangles.begin(), source.triangles.end());
             }
         }
 
+        // only keeps the encoded bytes while parsing, decoding is spread across the job system afterwards
+        bool DeferImageDecode(Image* image, const i32 imageIndex, std::string* err, std::string* warn, 
+            i32 reqWidth, i32 reqHeight, const unsigned char* bytes, i32 size, void* userData)
+        {
+            image->image.assign(bytes, bytes + size);
+            image->width = 0;
+            image->height = 0;
+            image->component = 0;
+            return true;
+        }
+
         void LoadTextures(Model& input, std::vector<u32>& textures)
         {
             for(u64 i = 0; i < input.textures.size(); i++)
@@ -309,114 +791,470 @@ namespace Raw::Utils
                 materialData.metalRoughnessFactor.x = glTFMaterial.pbrMetallicRoughness.metallicFactor;
                 materialData.metalRoughnessFactor.y = glTFMaterial.pbrMetallicRoughness.roughnessFactor;
                 materialData.emissive = glTFMaterial.emissiveTexture.index;
-                materialData.alphaCutoff = glTFMaterial.alphaCutoff;
+                // only masked materials are alpha tested, 0 keeps every fragment
+                materialData.alphaCutoff = glTFMaterial.alphaMode == "MASK" ? (f32)glTFMaterial.alphaCutoff : 0.f;
                 materialData.isTransparent = glTFMaterial.alphaMode == "OPAQUE" ? false : true;
 
                 materials.push_back(materialData);
             }
         }
+
+        // consecutive ranges of one heap allocation, each starting on a block boundary
+        struct HeapLayout
+        {
+            u64 size{ 0 };
+
+            u64 Push(u64 bytes)
+            {
+                const u64 offset = size;
+                size += (bytes + GFX::GeometryHeap::k_BlockSize - 1) / GFX::GeometryHeap::k_BlockSize * GFX::GeometryHeap::k_BlockSize;
+                return offset;
+            }
+        };
+
+        // every opaque and masked instance is split into tasks of up to MESHLET_TASK_SIZE meshlets, blended instances keep the forward path.
+        // the level of detail is picked on the GPU, so tasks and the fallback buffers are sized for the largest level
+        void BuildMeshletTasks(const GFX::SceneData& scene, std::vector<GFX::MeshletTask>& outTasks, u64& outVisibleMeshletCount, u64& outMeshletIndexCount)
+        {
+            outVisibleMeshletCount = 0;
+            outMeshletIndexCount = 0;
+            for(u32 instance = 0; instance < (u32)scene.draws.size(); instance++)
+            {
+                const GFX::MeshDrawData& draw = scene.draws[instance];
+                if(draw.isTransparent) continue;
+
+                const GFX::MeshBoundsData& bounds = scene.meshBoundsData[draw.drawIndex];
+                u32 maxMeshletCount = 0;
+                u64 maxIndexCount = 0;
+                for(u32 lod = 0; lod < bounds.lodCount; lod++)
+                {
+                    // every triangle of a level is in one of its meshlets
+                    const GFX::MeshLodData& level = bounds.lods[lod];
+                    if(level.meshletCount == 0) continue;
+
+                    maxMeshletCount = std::max(maxMeshletCount, level.meshletCount);
+                    maxIndexCount = std::max<u64>(maxIndexCount, level.indexCount);
+                }
+
+                for(u32 offset = 0; offset < maxMeshletCount; offset += MESHLET_TASK_SIZE)
+                {
+                    outTasks.push_back({ instance, offset });
+                }
+                outMeshletIndexCount += maxIndexCount;
+                outVisibleMeshletCount += maxMeshletCount;
+            }
+        }
+    }
+
+    bool UploadSceneGeometry(const std::string& name, const SceneGeometry& geometry, GFX::SceneData& outScene)
+    {
+        GFX::IGFXDevice* device = (GFX::IGFXDevice*)ServiceLocator::Get()->GetService(GFX::IGFXDevice::k_ServiceName);
+        GFX::GeometryHeap* heap = GFX::GeometryHeap::Instance();
+
+        GFX::GeometryAllocation& allocation = outScene.geometryAllocation;
+        if(!heap->Add(device, geometry.vertices, (u32)geometry.vertexCount, geometry.indices, geometry.wideIndexOffset, geometry.indexSize, allocation))
+        {
+            RAW_ERROR("Asset '%s' doesn't fit in the geometry heap!", name.c_str());
+            return false;
+        }
+
+        if(!heap->AddMeshlets(device, geometry.meshlets, (u32)geometry.meshletCount, geometry.meshletVertices, (u32)geometry.meshletVertexCount, 
+            geometry.meshletTriangles, (u32)geometry.meshletTriangleCount, allocation))
+        {
+            RAW_ERROR("Meshlets of asset '%s' don't fit in the geometry heap!", name.c_str());
+            heap->Remove(allocation);
+            allocation = GFX::GeometryAllocation();
+            return false;
+        }
+
+        // everything that addresses vertices, indices or meshlets is moved from the asset's own blocks onto its heap ranges
+        const u32 vertexBase = allocation.vertices.offset;
+        auto indexBase = [&](u32 drawIndex) { return drawIndex < outScene.shortIndexDrawCount ? allocation.shortIndices.offset : allocation.wideIndices.offset; };
+
+        outScene.indirectDraws.assign(geometry.indirectDraws, geometry.indirectDraws + geometry.indirectDrawCount);
+        for(u32 d = 0; d < (u32)outScene.indirectDraws.size(); d++)
+        {
+            outScene.indirectDraws[d].vertexOffset += (i32)vertexBase;
+            outScene.indirectDraws[d].firstIndex += indexBase(d);
+        }
+
+        for(u32 d = 0; d < (u32)outScene.meshBoundsData.size(); d++)
+        {
+            GFX::MeshBoundsData& bounds = outScene.meshBoundsData[d];
+            for(u32 lod = 0; lod < bounds.lodCount; lod++) bounds.lods[lod].firstIndex += indexBase(d);
+            for(u32 lod = 0; lod < MAX_LOD_COUNT; lod++)
+            {
+                if(bounds.lods[lod].meshletCount > 0) bounds.lods[lod].firstMeshlet += allocation.meshlets.offset;
+            }
+        }
+
+        for(u32 i = 0; i < (u32)outScene.meshes.size(); i++)
+        {
+            outScene.meshes[i].vertexOffset += vertexBase;
+            outScene.meshes[i].firstIndex += indexBase(outScene.draws[i].drawIndex);
+        }
+
+        outScene.vertexBuffer = heap->GetVertexBuffer();
+        outScene.indexBuffer = heap->GetIndexBuffer();
+        outScene.meshletBuffer = heap->GetMeshletBuffer();
+        outScene.meshletVerticesBuffer = heap->GetMeshletVertexBuffer();
+        outScene.meshletTrianglesBuffer = heap->GetMeshletTriangleBuffer();
+        outScene.wideIndexOffset = heap->GetWideIndexOffset();
+        outScene.drawCount = (u32)outScene.indirectDraws.size();
+        outScene.instanceCount = (u32)outScene.draws.size();
+
+        return true;
+    }
+
+    bool CreateSceneBuffers(GFX::SceneData& outScene)
+    {
+        GFX::IGFXDevice* device = (GFX::IGFXDevice*)ServiceLocator::Get()->GetService(GFX::IGFXDevice::k_ServiceName);
+        GFX::GeometryHeap* heap = GFX::GeometryHeap::Instance();
+
+        std::vector<GFX::MeshletTask> tasks;
+        u64 visibleMeshletCount = 0;
+        u64 meshletIndexCount = 0;
+        BuildMeshletTasks(outScene, tasks, visibleMeshletCount, meshletIndexCount);
+        // without mesh shaders the surviving meshlets are expanded into an index buffer drawn with a single indirect draw,
+        // an index encodes the meshlet's slot in visibleMeshlets and the vertex within the meshlet
+        const bool meshletFallback = !tasks.empty() && !device->SupportsMeshShaders();
+
+        // empty scenes still get a command and an instance so no range is empty
+        const u64 drawCount = std::max<u64>(outScene.indirectDraws.size(), 1);
+        const u64 instanceCount = std::max<u64>(outScene.draws.size(), 1);
+
+        HeapLayout drawLayout;
+        const u64 indirectSize = drawCount * sizeof(GFX::IndirectDraw);
+        const u64 indirectOffset = drawLayout.Push(indirectSize);
+        // written by culling, MAX_LOD_COUNT commands per indirect draw, one per level of detail
+        const u64 culledIndirectSize = drawCount * MAX_LOD_COUNT * sizeof(GFX::IndirectDraw);
+        const u64 culledIndirectOffset = drawLayout.Push(culledIndirectSize);
+        const u64 meshDrawSize = instanceCount * sizeof(GFX::MeshDrawData);
+        const u64 meshDrawOffset = drawLayout.Push(meshDrawSize);
+        // written by culling, the instances that survived for each level of each indirect draw. every level has its own copy
+        // of the instance range, level l of a draw starts at l * instanceCount + firstInstance
+        const u64 visibleInstancesSize = instanceCount * MAX_LOD_COUNT * sizeof(u32);
+        const u64 visibleInstancesOffset = drawLayout.Push(visibleInstancesSize);
+        const u64 instanceVisibilitySize = instanceCount * sizeof(u32);
+        const u64 instanceVisibilityOffset = drawLayout.Push(instanceVisibilitySize);
+        const u64 tasksSize = tasks.size() * sizeof(GFX::MeshletTask);
+        const u64 tasksOffset = drawLayout.Push(tasksSize);
+        const u64 visibleMeshletsSize = std::max<u64>(visibleMeshletCount * 2 * sizeof(u32), 4);
+        const u64 visibleMeshletsOffset = meshletFallback ? drawLayout.Push(visibleMeshletsSize) : 0;
+        const u64 meshletIndicesSize = std::max<u64>(meshletIndexCount * sizeof(u32), 4);
+        const u64 meshletIndicesOffset = meshletFallback ? drawLayout.Push(meshletIndicesSize) : 0;
+        // the indirect draw followed by the visible meshlet counter
+        const u64 meshletDrawSize = sizeof(GFX::IndirectDraw) + sizeof(u32);
+        const u64 meshletDrawOffset = meshletFallback ? drawLayout.Push(meshletDrawSize) : 0;
+
+        HeapLayout boundsLayout;
+        const u64 meshBoundsSize = drawCount * sizeof(GFX::MeshBoundsData);
+        const u64 meshBoundsOffset = boundsLayout.Push(meshBoundsSize);
+        const u64 instanceBoundsSize = instanceCount * sizeof(GFX::InstanceBoundsData);
+        const u64 instanceBoundsOffset = boundsLayout.Push(instanceBoundsSize);
+
+        if(!heap->AddDrawList(drawLayout.size, boundsLayout.size, outScene.drawListAllocation)) return false;
+
+        const u64 drawBase = (u64)outScene.drawListAllocation.draws.offset * GFX::GeometryHeap::k_BlockSize;
+        const u64 boundsBase = (u64)outScene.drawListAllocation.bounds.offset * GFX::GeometryHeap::k_BlockSize;
+        auto drawRange = [&](u64 offset, u64 size) { return device->CreateBufferRange(heap->GetDrawBuffer(), drawBase + offset, size); };
+        auto boundsRange = [&](u64 offset, u64 size) { return device->CreateBufferRange(heap->GetBoundsBuffer(), boundsBase + offset, size); };
+
+        outScene.indirectBuffer = drawRange(indirectOffset, indirectSize);
+        outScene.culledIndirectBuffer = drawRange(culledIndirectOffset, culledIndirectSize);
+        outScene.meshDrawsBuffer = drawRange(meshDrawOffset, meshDrawSize);
+        outScene.visibleInstancesBuffer = drawRange(visibleInstancesOffset, visibleInstancesSize);
+        outScene.instanceVisibilityBuffer = drawRange(instanceVisibilityOffset, instanceVisibilitySize);
+        outScene.meshBoundsBuffer = boundsRange(meshBoundsOffset, meshBoundsSize);
+        outScene.instanceBoundsBuffer = boundsRange(instanceBoundsOffset, instanceBoundsSize);
+
+        // derived from the draws, so it's recomputed here rather than loaded or cached
+        outScene.instanceBounds.resize(outScene.draws.size());
+        UpdateInstanceBounds(outScene, 0, (u32)outScene.draws.size());
+
+        // ECullPhase flags per instance, read and rewritten by occlusion culling every frame. nothing was visible before
+        // the first frame, so it starts out cleared
+        std::vector<u32> instanceVisibility(instanceCount, 0);
+
+        device->UploadBufferData(outScene.indirectBuffer, 0, outScene.indirectDraws.data(), outScene.indirectDraws.size() * sizeof(GFX::IndirectDraw));
+        device->UploadBufferData(outScene.meshDrawsBuffer, 0, outScene.draws.data(), outScene.draws.size() * sizeof(GFX::MeshDrawData));
+        device->UploadBufferData(outScene.instanceVisibilityBuffer, 0, instanceVisibility.data(), instanceVisibilitySize);
+        device->UploadBufferData(outScene.meshBoundsBuffer, 0, outScene.meshBoundsData.data(), outScene.meshBoundsData.size() * sizeof(GFX::MeshBoundsData));
+        device->UploadBufferData(outScene.instanceBoundsBuffer, 0, outScene.instanceBounds.data(), outScene.instanceBounds.size() * sizeof(GFX::InstanceBoundsData));
+
+        if(!tasks.empty())
+        {
+            outScene.meshletTasksBuffer = drawRange(tasksOffset, tasksSize);
+            device->UploadBufferData(outScene.meshletTasksBuffer, 0, tasks.data(), tasksSize);
+        }
+        if(meshletFallback)
+        {
+            outScene.visibleMeshletsBuffer = drawRange(visibleMeshletsOffset, visibleMeshletsSize);
+            outScene.meshletIndexBuffer = drawRange(meshletIndicesOffset, meshletIndicesSize);
+            outScene.meshletDrawBuffer = drawRange(meshletDrawOffset, meshletDrawSize);
+        }
+
+        outScene.vertexBuffer = heap->GetVertexBuffer();
+        outScene.indexBuffer = heap->GetIndexBuffer();
+        outScene.meshletBuffer = heap->GetMeshletBuffer();
+        outScene.meshletVerticesBuffer = heap->GetMeshletVertexBuffer();
+        outScene.meshletTrianglesBuffer = heap->GetMeshletTriangleBuffer();
+        outScene.wideIndexOffset = heap->GetWideIndexOffset();
+        outScene.drawCount = (u32)outScene.indirectDraws.size();
+        outScene.instanceCount = (u32)outScene.draws.size();
+        outScene.meshletTaskCount = (u32)tasks.size();
+
+        return true;
     }
 
-    void LoadGLTF(std::string filepath, GFX::SceneData& outScene)
+    void DestroySceneBuffers(GFX::SceneData& scene)
+    {
+        GFX::IGFXDevice* device = (GFX::IGFXDevice*)ServiceLocator::Get()->GetService(GFX::IGFXDevice::k_ServiceName);
+
+        GFX::BufferHandle* ranges[] = 
+        { 
+            &scene.indirectBuffer, &scene.culledIndirectBuffer, &scene.meshDrawsBuffer, &scene.visibleInstancesBuffer, 
+            &scene.instanceVisibilityBuffer, &scene.meshBoundsBuffer, &scene.instanceBoundsBuffer, &scene.meshletTasksBuffer, 
+            &scene.visibleMeshletsBuffer, &scene.meshletIndexBuffer, &scene.meshletDrawBuffer 
+        };
+        // the handles are destroyed and the heap ranges reused only once the frames in flight are done with them
+        for(GFX::BufferHandle* range : ranges)
+        {
+            if(range->IsValid()) device->DestroyBuffer(*range);
+        }
+
+        GFX::GeometryHeap::Instance()->Remove(scene.drawListAllocation);
+        scene.drawListAllocation = GFX::DrawListAllocation();
+        scene.meshletTaskCount = 0;
+    }
+
+    bool IsBinaryGLTF(const std::string& filepath)
+    {
+        if(filepath.size() < 4) return false;
+
+        std::string extension = filepath.substr(filepath.size() - 4);
+        for(char& c : extension) c = (char)tolower(c);
+        return extension == ".glb";
+    }
+
+    bool LoadGLTF(std::string filepath, GFX::SceneData& outScene, TextureStreamer* streamer)
     {
         Model model;
         TinyGLTF loader;
         std::string err;
         std::string warn;
 
-        bool ret = loader.LoadASCIIFromFile(&model, &err, &warn, filepath);
+        // glb files are mapped and parsed in place, the BIN chunk is never read into an intermediate vector by us
+        MappedFile mappedFile;
+        const u8* binChunk = nullptr;
+        u64 binChunkSize = 0;
+
+        // images are decoded in parallel after parsing instead of serially inside tinygltf
+        loader.SetImageLoader(DeferImageDecode, nullptr);
+
+        u64 separator = filepath.find_last_of("/\\");
+        std::string baseDir = separator != std::string::npos ? filepath.substr(0, separator) : "";
+
+        bool ret = false;
+        if(IsBinaryGLTF(filepath))
+        {
+            ret = mappedFile.Open(filepath.c_str());
+            if(ret)
+            {
+                RAW_ASSERT_MSG(mappedFile.GetSize() < U32_MAX, "glb '%s' exceeds 4GB!", filepath.c_str());
+
+                ret = loader.LoadBinaryFromMemory(&model, &err, &warn, mappedFile.GetData(), (u32)mappedFile.GetSize(), baseDir);
+            }
+
+            if(ret && FindGLBBinaryChunk(mappedFile.GetData(), mappedFile.GetSize(), binChunk, binChunkSize))
+            {
+                // tinygltf keeps its own copy of the BIN chunk, encoded images were already copied out so it can be dropped
+                // and every accessor is resolved against the mapping instead
+                if(!model.buffers.empty() && model.buffers[0].uri.empty())
+                {
+                    model.buffers[0].data.clear();
+                    model.buffers[0].data.shrink_to_fit();
+                }
+            }
+        }
+        else
+        {
+            ret = loader.LoadASCIIFromFile(&model, &err, &warn, filepath);
+        }
 
         if(!warn.empty())   RAW_WARN("GLTF WARNING: %s", warn.c_str());
         if(!err.empty())    RAW_ERROR("GLTF ERROR: %s", err.c_str());
 
-        RAW_ASSERT_MSG(ret, "Failed to parse glTF '%s'", filepath.c_str());
-        
+        if(!ret)
+        {
+            RAW_ERROR("Failed to parse glTF '%s'", filepath.c_str());
+            return false;
+        }
 
         u64 startTime = Timer::Get()->Now();
 
-        JobSystem::Execute([&](){ LoadImages(model, outScene.images, outScene.imageIds); });
+        // embedded images have no uri, name them after the model so they don't collide in the texture cache
+        std::vector<std::string> imageNames(model.images.size());
+        for(u64 i = 0; i < model.images.size(); i++)
+        {
+            imageNames[i] = model.images[i].uri.empty() ? filepath + "_image" + std::to_string(i) : model.images[i].uri;
+        }
+
+        // a streamed load leaves decoding to the streamer, the scene is drawn with placeholders until its images arrive
+        std::vector<DecodedImage> decodedImages(model.images.size());
+        if(!streamer)
+        {
+            JobSystem::Dispatch((u32)model.images.size(), 1, [&](JobSystem::JobDispatchArgs args)
+                {
+                    const Image& image = model.images[args.jobIndex];
+                    DecodeImage(image.image.data(), image.image.size(), imageNames[args.jobIndex].c_str(), decodedImages[args.jobIndex]);
+                }
+            );
+        }
         JobSystem::Execute([&](){ LoadTextures(model, outScene.textures); });
         JobSystem::Execute([&](){ LoadMaterials(model, outScene.materials);});
 
         
-        JobSystem::Execute([&]()
+        std::vector<GFX::SceneVertex> vertices;
+        std::vector<u8> indices;
+        std::vector<GFX::IndirectDraw> indirectDraws;
+        std::vector<PrimitiveRange> primitives;
+        std::vector<PrimitiveInstance> instances;
+
+        // only walk root nodes, children are visited through their parents
+        std::vector<i32> rootNodes;
+        if(model.scenes.size() > 0)
+        {
+            const tinygltf::Scene& scene = model.scenes[model.defaultScene > -1 ? model.defaultScene : 0];
+            rootNodes.assign(scene.nodes.begin(), scene.nodes.end());
+        }
+        else
+        {
+            std::vector<bool> isChild(model.nodes.size(), false);
+            for(const Node& node : model.nodes)
             {
-                std::vector<GFX::VertexData> vertices;
-                std::vector<u32> indices;
-                std::vector<GFX::IndirectDraw> indirectDraws;
+                for(i32 child : node.children) isChild[child] = true;
+            }
+            for(u64 i = 0; i < model.nodes.size(); i++)
+            {
+                if(!isChild[i]) rootNodes.push_back((i32)i);
+            }
+        }
 
-                for(u64 i = 0; i < model.nodes.size(); i++)
-                {
-                    Node& curNode = model.nodes[i];
-                    LoadNode(curNode, model, outScene, glm::mat4(1.f), vertices, indices, indirectDraws);
-                }
+        u32 vertexTotal = 0;
+        for(i32 root : rootNodes)
+        {
+            const Node& curNode = model.nodes[root];
+            LoadNode(curNode, model, outScene, glm::mat4(1.f), U32_MAX, vertexTotal, primitives, indirectDraws, instances);
+        }
+        const u64 indexSize = LayoutIndices(primitives, indirectDraws, instances, outScene);
+        EmitInstances(instances, indirectDraws, outScene);
+        RAW_DEBUG("glTF '%s': %u instances of %u unique primitives.", filepath.c_str(), (u32)instances.size(), (u32)indirectDraws.size());
 
-                GFX::BufferDesc vertexDesc;
-                vertexDesc.bufferSize = vertices.size() * sizeof(GFX::VertexData);
-                vertexDesc.memoryType = GFX::EMemoryType::DEVICE_LOCAL;
-                vertexDesc.type = GFX::EBufferType::VERTEX;
-                
-                GFX::BufferDesc indexDesc;
-                indexDesc.bufferSize = indices.size() * sizeof(u32);
-                indexDesc.memoryType = GFX::EMemoryType::DEVICE_LOCAL;
-                indexDesc.type = GFX::EBufferType::INDEX;
-
-                GFX::BufferDesc indirectDesc;
-                indirectDesc.bufferSize = indirectDraws.size() * sizeof(GFX::IndirectDraw);
-                indirectDesc.memoryType = GFX::EMemoryType::DEVICE_LOCAL;
-                indirectDesc.type = GFX::EBufferType::INDIRECT | GFX::EBufferType::STORAGE | GFX::EBufferType::TRANSFER_DST | GFX::EBufferType::SHADER_DEVICE_ADDRESS;
-
-                GFX::BufferDesc meshDrawDesc;
-                meshDrawDesc.bufferSize = outScene.draws.size() * sizeof(GFX::MeshDrawData);
-                meshDrawDesc.memoryType = GFX::EMemoryType::DEVICE_LOCAL;
-                meshDrawDesc.type =  GFX::EBufferType::STORAGE | GFX::EBufferType::TRANSFER_DST | GFX::EBufferType::SHADER_DEVICE_ADDRESS;
-
-                GFX::BufferDesc meshBoundsDataDesc;
-                meshBoundsDataDesc.bufferSize = outScene.draws.size() * sizeof(GFX::MeshBoundsData);
-                meshBoundsDataDesc.memoryType = GFX::EMemoryType::DEVICE_LOCAL;
-                meshBoundsDataDesc.type =  GFX::EBufferType::STORAGE | GFX::EBufferType::TRANSFER_DST | GFX::EBufferType::SHADER_DEVICE_ADDRESS;
-
-                std::string vBufferName = filepath + "_vertex";
-                std::string iBufferName = filepath + "_index";
-                std::string indirectBufferName = filepath + "_indirect";
-                std::string culledIndirectBufferName = filepath + "_culled_indirect";
-                std::string meshDrawBufferName = filepath + "_meshDraw";
-                std::string meshBoundsDataBufferName = filepath + "_meshBoundsData";
-                BufferResource* vRes = (BufferResource*)BufferLoader::Instance()->CreateBuffer(vBufferName.c_str(), vertexDesc, vertices.data());
-                BufferResource* iRes = (BufferResource*)BufferLoader::Instance()->CreateBuffer(iBufferName.c_str(), indexDesc, indices.data());
-                BufferResource* indirectRes = (BufferResource*)BufferLoader::Instance()->CreateBuffer(indirectBufferName.c_str(), indirectDesc, indirectDraws.data());
-                BufferResource* culledIndirectRes = (BufferResource*)BufferLoader::Instance()->CreateBuffer(culledIndirectBufferName.c_str(), indirectDesc, indirectDraws.data());
-                BufferResource* meshDrawRes = (BufferResource*)BufferLoader::Instance()->CreateBuffer(meshDrawBufferName.c_str(), meshDrawDesc, outScene.draws.data());
-                BufferResource* meshBoundsData = (BufferResource*)BufferLoader::Instance()->CreateBuffer(meshBoundsDataBufferName.c_str(), meshBoundsDataDesc, outScene.meshBoundsData.data());
-                
-                outScene.vertexBuffer = vRes->buffer;
-                vRes->AddRef();
-                outScene.indexBuffer = iRes->buffer;
-                iRes->AddRef();
-                outScene.indirectBuffer = indirectRes->buffer;
-                indirectRes->AddRef();
-                outScene.culledIndirectBuffer = culledIndirectRes->buffer;
-                culledIndirectRes->AddRef();
-                outScene.meshDrawsBuffer = meshDrawRes->buffer;
-                meshDrawRes->AddRef();
-                outScene.meshBoundsBuffer = meshBoundsData->buffer;
-                meshBoundsData->AddRef();
-
-                outScene.vertexBufferId = vRes->bufferId;
-                outScene.indexBufferId = iRes->bufferId;
-                outScene.indirectBufferId = indirectRes->bufferId;
-                outScene.culledIndirectBufferId = culledIndirectRes->bufferId;
-                outScene.meshDrawsBufferId = meshDrawRes->bufferId;
-                outScene.meshBoundsBufferId = meshBoundsData->bufferId;
-                outScene.drawCount = (u32)indirectDraws.size();
+        // every primitive owns a disjoint slice, so they can be converted without synchronization
+        vertices.resize(vertexTotal);
+        indices.resize(indexSize);
+        outScene.meshBoundsData.resize(indirectDraws.size());
+
+        const u32 primitiveCount = (u32)primitives.size();
+        const u32 groupSize = std::max(1u, primitiveCount / (JobSystem::GetNumThreads() * 4));
+        std::vector<PrimitiveCacheStats> cacheStats(primitiveCount);
+        std::vector<PrimitiveMeshlets> primitiveMeshlets(primitiveCount);
+        std::vector<PrimitiveLods> primitiveLods(primitiveCount);
+        JobSystem::Dispatch(primitiveCount, groupSize, [&](JobSystem::JobDispatchArgs args)
+            {
+                const PrimitiveRange& range = primitives[args.jobIndex];
+                LoadPrimitive(model, range, binChunk, vertices.data(), indices.data(), outScene.meshBoundsData[range.drawIndex], 
+                    cacheStats[args.jobIndex], primitiveMeshlets[args.jobIndex], primitiveLods[args.jobIndex]);
             }
         );
 
         JobSystem::Wait();
+
+        AppendLods(primitives, primitiveLods, indices, outScene);
+
+        std::vector<GFX::MeshletData> meshlets;
+        std::vector<u32> meshletVertices;
+        std::vector<u32> meshletTriangles;
+        AppendMeshlets(primitives, primitiveMeshlets, outScene.meshBoundsData, meshlets, meshletVertices, meshletTriangles);
+
+        // logged once the jobs are done, workers only fill in their own slot
+        for(u32 i = 0; i < primitiveCount; i++)
+        {
+            if(!cacheStats[i].optimized) continue;
+
+            const PrimitiveRange& range = primitives[i];
+            RAW_DEBUG("Mesh '%s' primitive %u: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %u levels of detail", 
+                model.meshes[range.mesh].name.c_str(), range.primitive,
+                cacheStats[i].before.acmr, cacheStats[i].after.acmr, cacheStats[i].before.atvr, cacheStats[i].after.atvr, primitiveLods[i].count);
+        }
+
+        // external images are referenced by path, anything embedded is copied into the cache still encoded.
+        // the streamer reads them the same way, it keeps its own copy of embedded bytes since the model is freed on return
+        std::vector<SceneCacheImage> cacheImages(model.images.size());
+        for(u64 i = 0; i < model.images.size(); i++)
+        {
+            const Image& image = model.images[i];
+            cacheImages[i].name = imageNames[i];
+            if(!image.uri.empty() && image.uri.rfind("data:", 0) != 0)
+            {
+                cacheImages[i].path = baseDir.empty() ? image.uri : baseDir + "/" + image.uri;
+            }
+            else
+            {
+                cacheImages[i].encoded = image.image.data();
+                cacheImages[i].encodedSize = image.image.size();
+            }
+        }
+
+        if(streamer)
+        {
+            std::vector<StreamedImageSource> sources(cacheImages.size());
+            for(u64 i = 0; i < cacheImages.size(); i++)
+            {
+                sources[i].name = cacheImages[i].name;
+                sources[i].path = cacheImages[i].path;
+                if(cacheImages[i].encoded) sources[i].encoded.assign(cacheImages[i].encoded, cacheImages[i].encoded + cacheImages[i].encodedSize);
+            }
+            streamer->Begin(std::move(sources), outScene.images);
+        }
+        else
+        {
+            UploadImages(imageNames, decodedImages, outScene.images, outScene.imageIds);
+        }
+
+        SceneGeometry geometry;
+        geometry.vertices = vertices.data();
+        geometry.vertexCount = vertices.size();
+        geometry.indices = indices.data();
+        geometry.indexSize = indices.size();
+        geometry.wideIndexOffset = outScene.wideIndexOffset;
+        geometry.indirectDraws = indirectDraws.data();
+        geometry.indirectDrawCount = indirectDraws.size();
+        geometry.meshlets = meshlets.data();
+        geometry.meshletCount = meshlets.size();
+        geometry.meshletVertices = meshletVertices.data();
+        geometry.meshletVertexCount = meshletVertices.size();
+        geometry.meshletTriangles = meshletTriangles.data();
+        geometry.meshletTriangleCount = meshletTriangles.size();
+
+        // written before the geometry is uploaded, which moves the draws and bounds onto the asset's geometry heap ranges
+        std::vector<std::string> dependencies;
+        for(const Buffer& buffer : model.buffers)
+        {
+            if(buffer.uri.empty() || buffer.uri.rfind("data:", 0) == 0) continue;
+            dependencies.push_back(baseDir.empty() ? buffer.uri : baseDir + "/" + buffer.uri);
+        }
+
+        WriteSceneCache(filepath, dependencies, outScene, geometry, cacheImages);
+
+        if(!UploadSceneGeometry(filepath, geometry, outScene)) return false;
+
         u64 endTime = Timer::Get()->Now();
         f64 deltaTime = Timer::Get()->DeltaSeconds(startTime, endTime);
 
         RAW_TRACE("GLTF file '%s' loaded.", filepath.c_str());
         RAW_TRACE("Load Time: %0.2llf s", deltaTime);
+        return true;
     }
 }
\ No newline at end of file
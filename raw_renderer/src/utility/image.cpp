@@ -0,0 +1,179 @@
+#include "utility/image.hpp"
+#include "core/simd.hpp"
+#include "core/logger.hpp"
+#include "core/asserts.hpp"
+#include "resources/texture_loader.hpp"
+#include <stb_image.h>
+#include <cstdlib>
+
+namespace Raw::Utils
+{
+    namespace
+    {
+        // textures are uploaded in batches of at most this many bytes of rgba8 texels
+        constexpr u64 IMAGE_BATCH_SIZE = 256 * 1024 * 1024;
+
+        void ExpandRGBToRGBAScalar(const u8* rgb, u8* rgba, u64 first, u64 pixelCount)
+        {
+            for(u64 i = first; i < pixelCount; i++)
+            {
+                rgba[i * 4 + 0] = rgb[i * 3 + 0];
+                rgba[i * 4 + 1] = rgb[i * 3 + 1];
+                rgba[i * 4 + 2] = rgb[i * 3 + 2];
+                rgba[i * 4 + 3] = 255;
+            }
+        }
+
+#if defined(RAW_ARCH_X86)
+        // 8 pixels per iteration, each 128 bit lane expands 4 pixels from a 12 byte window
+        RAW_TARGET_AVX2 void ExpandRGBToRGBAAVX2(const u8* rgb, u8* rgba, u64 pixelCount)
+        {
+            const __m256i shuffle = _mm256_setr_epi8(
+                0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m256i alpha = _mm256_set1_epi32((i32)0xFF000000);
+
+            // every lane loads 16 bytes but only uses 12, stop early enough to never read past the source
+            u64 i = 0;
+            for(; i + 10 <= pixelCount; i += 8)
+            {
+                const __m128i lo = _mm_loadu_si128((const __m128i*)(rgb + i * 3));
+                const __m128i hi = _mm_loadu_si128((const __m128i*)(rgb + i * 3 + 12));
+                __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+                pixels = _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha);
+                _mm256_storeu_si256((__m256i*)(rgba + i * 4), pixels);
+            }
+
+            ExpandRGBToRGBAScalar(rgb, rgba, i, pixelCount);
+        }
+#endif
+    }
+
+    void ExpandRGBToRGBA(const u8* rgb, u8* rgba, u64 pixelCount)
+    {
+#if defined(RAW_ARCH_X86)
+        if(SIMD::SupportsAVX2())
+        {
+            ExpandRGBToRGBAAVX2(rgb, rgba, pixelCount);
+            return;
+        }
+#endif
+        ExpandRGBToRGBAScalar(rgb, rgba, 0, pixelCount);
+    }
+
+    bool DecodeImage(const u8* encoded, u64 size, cstring name, DecodedImage& outImage)
+    {
+        if(!encoded || size == 0) return false;
+
+        i32 width = 0;
+        i32 height = 0;
+        i32 components = 0;
+        u8* decoded = stbi_load_from_memory(encoded, (i32)size, &width, &height, &components, 0);
+        if(!decoded)
+        {
+            RAW_ERROR("Failed to decode image '%s': %s", name, stbi_failure_reason());
+            return false;
+        }
+
+        if(components == 4)
+        {
+            outImage.pixels = decoded;
+            outImage.fromStb = true;
+        }
+        else if(components == 3)
+        {
+            const u64 pixelCount = (u64)width * height;
+            outImage.pixels = (u8*)malloc(pixelCount * 4);
+            ExpandRGBToRGBA(decoded, outImage.pixels, pixelCount);
+            outImage.fromStb = false;
+            stbi_image_free(decoded);
+        }
+        else
+        {
+            // grey and grey alpha are rare enough to let stb expand them
+            stbi_image_free(decoded);
+            outImage.pixels = stbi_load_from_memory(encoded, (i32)size, &width, &height, &components, 4);
+            outImage.fromStb = true;
+        }
+
+        outImage.width = (u32)width;
+        outImage.height = (u32)height;
+        return outImage.pixels != nullptr;
+    }
+
+    void FreeDecodedImage(DecodedImage& image)
+    {
+        if(!image.pixels) return;
+
+        if(image.fromStb)   stbi_image_free(image.pixels);
+        else                free(image.pixels);
+        image.pixels = nullptr;
+    }
+
+    void UploadImages(const std::vector<std::string>& names, std::vector<DecodedImage>& decodedImages, std::vector<u32>& images, std::vector<u64>& imageIds)
+    {
+        RAW_ASSERT(names.size() == decodedImages.size());
+        TextureResource* errorTex = (TextureResource*)TextureLoader::Instance()->Get(ERROR_TEXTURE);
+
+        std::vector<cstring> batchNames;
+        std::vector<GFX::TextureDesc> batchDescs;
+        std::vector<void*> batchData;
+        std::vector<u32> batchImages;
+        std::vector<Resource*> batchResources;
+        u64 batchSize = 0;
+
+        images.resize(decodedImages.size(), errorTex->handle.id);
+
+        auto flushBatch = [&]()
+        {
+            if(batchNames.empty()) return;
+
+            batchResources.resize(batchNames.size());
+            TextureLoader::Instance()->CreateFromDataBatch(batchNames.data(), batchDescs.data(), batchData.data(), (u32)batchNames.size(), batchResources.data());
+
+            for(u64 i = 0; i < batchResources.size(); i++)
+            {
+                TextureResource* tex = (TextureResource*)batchResources[i];
+                if(!tex) continue;
+
+                images[batchImages[i]] = tex->handle.id;
+                imageIds.push_back(tex->textureId);
+                tex->AddRef();
+            }
+
+            batchNames.clear();
+            batchDescs.clear();
+            batchData.clear();
+            batchImages.clear();
+            batchSize = 0;
+        };
+
+        for(u32 i = 0; i < (u32)decodedImages.size(); i++)
+        {
+            const DecodedImage& image = decodedImages[i];
+            if(!image.pixels) continue;
+
+            const u64 imageSize = (u64)image.width * image.height * 4;
+            if(batchSize > 0 && batchSize + imageSize > IMAGE_BATCH_SIZE) flushBatch();
+
+            GFX::TextureDesc desc;
+            desc.depth = 1;
+            desc.width = image.width;
+            desc.height = image.height;
+            desc.isMipmapped = true;
+            desc.isRenderTarget = false;
+            desc.isStorageImage = false;
+            desc.type = GFX::ETextureType::TEXTURE2D;
+            desc.format = GFX::ETextureFormat::R8G8B8A8_UNORM;
+
+            batchNames.push_back(names[i].c_str());
+            batchDescs.push_back(desc);
+            batchData.push_back(image.pixels);
+            batchImages.push_back(i);
+            batchSize += imageSize;
+        }
+        flushBatch();
+
+        for(DecodedImage& image : decodedImages) FreeDecodedImage(image);
+    }
+}
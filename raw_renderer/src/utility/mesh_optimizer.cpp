@@ -0,0 +1,671 @@
+#include "utility/mesh_optimizer.hpp"
+#include "core/asserts.hpp"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace Raw::Utils
+{
+    namespace
+    {
+        // vertex to triangle adjacency in CSR form, triangles of vertex v are triangles[offsets[v], offsets[v + 1])
+        struct TriangleAdjacency
+        {
+            std::vector<u32> offsets;
+            std::vector<u32> triangles;
+        };
+
+        void BuildAdjacency(const u32* indices, u64 indexCount, u32 vertexCount, TriangleAdjacency& outAdjacency)
+        {
+            outAdjacency.offsets.assign(vertexCount + 1, 0);
+            outAdjacency.triangles.resize(indexCount);
+
+            for(u64 i = 0; i < indexCount; i++)
+            {
+                outAdjacency.offsets[indices[i] + 1]++;
+            }
+
+            for(u32 v = 0; v < vertexCount; v++)
+            {
+                outAdjacency.offsets[v + 1] += outAdjacency.offsets[v];
+            }
+
+            std::vector<u32> cursor(outAdjacency.offsets.begin(), outAdjacency.offsets.end() - 1);
+            for(u64 i = 0; i < indexCount; i++)
+            {
+                outAdjacency.triangles[cursor[indices[i]]++] = (u32)(i / 3);
+            }
+        }
+
+        // sum of squared distances to a set of planes, weighted by triangle area (Garland and Heckbert 1997),
+        // stored as the upper triangle of the symmetric 4x4 matrix
+        struct Quadric
+        {
+            f32 a00{ 0.0f }, a11{ 0.0f }, a22{ 0.0f };
+            f32 a01{ 0.0f }, a02{ 0.0f }, a12{ 0.0f };
+            f32 b0{ 0.0f }, b1{ 0.0f }, b2{ 0.0f };
+            f32 c{ 0.0f };
+            f32 weight{ 0.0f };
+        };
+
+        void AddPlane(Quadric& q, const glm::vec3& n, f32 d, f32 weight)
+        {
+            q.a00 += weight * n.x * n.x;
+            q.a11 += weight * n.y * n.y;
+            q.a22 += weight * n.z * n.z;
+            q.a01 += weight * n.x * n.y;
+            q.a02 += weight * n.x * n.z;
+            q.a12 += weight * n.y * n.z;
+            q.b0 += weight * n.x * d;
+            q.b1 += weight * n.y * d;
+            q.b2 += weight * n.z * d;
+            q.c += weight * d * d;
+            q.weight += weight;
+        }
+
+        void AddQuadric(Quadric& q, const Quadric& other)
+        {
+            q.a00 += other.a00; q.a11 += other.a11; q.a22 += other.a22;
+            q.a01 += other.a01; q.a02 += other.a02; q.a12 += other.a12;
+            q.b0 += other.b0; q.b1 += other.b1; q.b2 += other.b2;
+            q.c += other.c;
+            q.weight += other.weight;
+        }
+
+        // mean squared distance of p to the quadric's planes
+        f32 EvaluateQuadric(const Quadric& q, const glm::vec3& p)
+        {
+            const f32 r = 
+                q.a00 * p.x * p.x + q.a11 * p.y * p.y + q.a22 * p.z * p.z +
+                2.0f * (q.a01 * p.x * p.y + q.a02 * p.x * p.z + q.a12 * p.y * p.z) +
+                2.0f * (q.b0 * p.x + q.b1 * p.y + q.b2 * p.z) + q.c;
+            return q.weight > 0.0f ? fabsf(r) / q.weight : 0.0f;
+        }
+
+        struct EdgeCollapse
+        {
+            f32 error{ 0.0f };
+            u32 from{ 0 };
+            u32 to{ 0 };
+        };
+
+        // vertices that must not move, open edges and vertices sharing a position with another vertex (uv or normal seams),
+        // collapsing them would tear the surface open
+        void FindLockedVertices(const u32* indices, u64 indexCount, const glm::vec3* positions, u32 vertexCount, std::vector<u8>& outLocked)
+        {
+            struct PositionHash
+            {
+                u64 operator()(const glm::vec3& p) const
+                {
+                    // adding zero folds -0 into 0 so equal positions hash equally
+                    const glm::vec3 key = p + glm::vec3(0.0f);
+                    u32 bits[3];
+                    memcpy(bits, &key, sizeof(bits));
+                    return ((u64)bits[0] * 73856093u) ^ ((u64)bits[1] * 19349663u) ^ ((u64)bits[2] * 83492791u);
+                }
+            };
+
+            std::unordered_map<glm::vec3, u32, PositionHash> positionIds;
+            std::vector<u32> positionId(vertexCount);
+            std::vector<u32> positionUses;
+            for(u32 v = 0; v < vertexCount; v++)
+            {
+                auto it = positionIds.emplace(positions[v], (u32)positionUses.size());
+                if(it.second) positionUses.push_back(0);
+                positionId[v] = it.first->second;
+                positionUses[positionId[v]]++;
+            }
+
+            // undirected edges between positions, an edge used by anything but two triangles is a border or non manifold
+            std::unordered_map<u64, u32> edgeUses;
+            edgeUses.reserve(indexCount);
+            for(u64 i = 0; i < indexCount; i += 3)
+            {
+                for(u32 e = 0; e < 3; e++)
+                {
+                    u32 a = positionId[indices[i + e]];
+                    u32 b = positionId[indices[i + (e + 1) % 3]];
+                    if(a > b) std::swap(a, b);
+                    edgeUses[((u64)a << 32) | b]++;
+                }
+            }
+
+            std::vector<u8> lockedPosition(positionUses.size(), 0);
+            for(const auto& edge : edgeUses)
+            {
+                if(edge.second == 2) continue;
+                lockedPosition[(u32)(edge.first >> 32)] = 1;
+                lockedPosition[(u32)edge.first] = 1;
+            }
+
+            outLocked.resize(vertexCount);
+            for(u32 v = 0; v < vertexCount; v++)
+            {
+                outLocked[v] = positionUses[positionId[v]] > 1 || lockedPosition[positionId[v]];
+            }
+        }
+
+        // run of triangles Tipsify emitted between two dead ends, the cache is cold at its start
+        // so clusters can be drawn in any order without losing hits
+        struct TriangleCluster
+        {
+            u32 firstTriangle{ 0 };
+            u32 triangleCount{ 0 };
+            glm::vec3 centroid{ 0.0f };
+            glm::vec3 normal{ 0.0f };
+            f32 sortKey{ 0.0f };
+        };
+
+        // Tipsify's overdraw pass, clusters facing away from the mesh centre are drawn first since they tend to occlude the rest
+        void SortClustersForOverdraw(u32* indices, u64 indexCount, const glm::vec3* positions, std::vector<TriangleCluster>& clusters)
+        {
+            if(clusters.size() < 2) return;
+
+            glm::vec3 meshCentroid(0.0f);
+            f32 meshArea = 0.0f;
+            for(TriangleCluster& cluster : clusters)
+            {
+                f32 area = 0.0f;
+                for(u32 t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; t++)
+                {
+                    const glm::vec3& p0 = positions[indices[(u64)t * 3 + 0]];
+                    const glm::vec3& p1 = positions[indices[(u64)t * 3 + 1]];
+                    const glm::vec3& p2 = positions[indices[(u64)t * 3 + 2]];
+
+                    // cross product length is twice the area, the factor cancels out in the weighted averages
+                    const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+                    const f32 triangleArea = glm::length(n);
+                    cluster.centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+                    cluster.normal += n;
+                    area += triangleArea;
+                }
+
+                meshCentroid += cluster.centroid;
+                meshArea += area;
+
+                cluster.centroid = area > 0.0f ? cluster.centroid / area : positions[indices[cluster.firstTriangle * 3]];
+                const f32 normalLength = glm::length(cluster.normal);
+                cluster.normal = normalLength > 0.0f ? cluster.normal / normalLength : glm::vec3(0.0f);
+            }
+
+            if(meshArea <= 0.0f) return;
+            meshCentroid /= meshArea;
+
+            for(TriangleCluster& cluster : clusters)
+            {
+                cluster.sortKey = glm::dot(cluster.centroid - meshCentroid, cluster.normal);
+            }
+
+            std::stable_sort(clusters.begin(), clusters.end(),
+                [](const TriangleCluster& a, const TriangleCluster& b){ return a.sortKey > b.sortKey; });
+
+            std::vector<u32> sorted;
+            sorted.reserve(indexCount);
+            for(const TriangleCluster& cluster : clusters)
+            {
+                sorted.insert(sorted.end(), indices + (u64)cluster.firstTriangle * 3, indices + (u64)(cluster.firstTriangle + cluster.triangleCount) * 3);
+            }
+            RAW_ASSERT(sorted.size() == indexCount);
+            std::copy(sorted.begin(), sorted.end(), indices);
+        }
+    }
+
+    VertexCacheStats AnalyzeVertexCache(const u32* indices, u64 indexCount, u32 vertexCount, u32 cacheSize)
+    {
+        VertexCacheStats stats;
+        if(indexCount < 3 || vertexCount == 0) return stats;
+
+        // FIFO emulated with timestamps, a vertex is resident while fewer than cacheSize misses happened since it was loaded
+        std::vector<u32> cacheTime(vertexCount, 0);
+        std::vector<u8> referenced(vertexCount, 0);
+        u32 time = cacheSize + 1;
+        u32 misses = 0;
+        u32 uniqueVertices = 0;
+
+        for(u64 i = 0; i < indexCount; i++)
+        {
+            const u32 v = indices[i];
+            RAW_ASSERT(v < vertexCount);
+
+            if(time - cacheTime[v] > cacheSize)
+            {
+                cacheTime[v] = time++;
+                misses++;
+            }
+
+            if(!referenced[v])
+            {
+                referenced[v] = 1;
+                uniqueVertices++;
+            }
+        }
+
+        stats.acmr = (f32)misses / (f32)(indexCount / 3);
+        stats.atvr = (f32)misses / (f32)uniqueVertices;
+        return stats;
+    }
+
+    void OptimizeVertexCache(u32* indices, u64 indexCount, u32 vertexCount, const glm::vec3* positions, u32 cacheSize)
+    {
+        const u32 triangleCount = (u32)(indexCount / 3);
+        if(triangleCount < 2 || vertexCount == 0) return;
+
+        TriangleAdjacency adjacency;
+        BuildAdjacency(indices, (u64)triangleCount * 3, vertexCount, adjacency);
+
+        std::vector<u32> liveTriangles(vertexCount);
+        for(u32 v = 0; v < vertexCount; v++)
+        {
+            liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+        }
+
+        std::vector<u32> cacheTime(vertexCount, 0);
+        std::vector<u8> emitted(triangleCount, 0);
+        std::vector<u32> deadEnd;
+        std::vector<u32> candidates;
+        std::vector<u32> output;
+        std::vector<TriangleCluster> clusters;
+        deadEnd.reserve(indexCount);
+        candidates.reserve(64);
+        output.reserve((u64)triangleCount * 3);
+
+        u32 time = cacheSize + 1;
+        u32 cursor = 1;
+        i64 fanning = 0;
+        bool newCluster = true;
+
+        while(fanning >= 0)
+        {
+            if(newCluster)
+            {
+                TriangleCluster cluster;
+                cluster.firstTriangle = (u32)(output.size() / 3);
+                clusters.push_back(cluster);
+                newCluster = false;
+            }
+
+            // emit every remaining triangle around the fanning vertex
+            candidates.clear();
+            for(u32 a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; a++)
+            {
+                const u32 t = adjacency.triangles[a];
+                if(emitted[t]) continue;
+                emitted[t] = 1;
+
+                for(u32 c = 0; c < 3; c++)
+                {
+                    const u32 v = indices[(u64)t * 3 + c];
+                    output.push_back(v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    liveTriangles[v]--;
+
+                    if(time - cacheTime[v] > cacheSize)
+                    {
+                        cacheTime[v] = time++;
+                    }
+                }
+                clusters.back().triangleCount++;
+            }
+
+            // prefer the candidate that stays in the cache the longest while its fan is emitted
+            i64 next = -1;
+            i64 bestPriority = -1;
+            for(u32 v : candidates)
+            {
+                if(liveTriangles[v] == 0) continue;
+
+                i64 priority = 0;
+                if((i64)(time - cacheTime[v]) + 2 * (i64)liveTriangles[v] <= (i64)cacheSize)
+                {
+                    priority = time - cacheTime[v];
+                }
+
+                if(priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+
+            if(next == -1)
+            {
+                // dead end, recently used vertices first, then the first vertex that still has triangles
+                while(!deadEnd.empty())
+                {
+                    const u32 v = deadEnd.back();
+                    deadEnd.pop_back();
+                    if(liveTriangles[v] > 0)
+                    {
+                        next = v;
+                        break;
+                    }
+                }
+
+                while(next == -1 && cursor < vertexCount)
+                {
+                    if(liveTriangles[cursor] > 0) next = cursor;
+                    cursor++;
+                }
+
+                newCluster = true;
+            }
+
+            fanning = next;
+        }
+
+        RAW_ASSERT(output.size() == (u64)triangleCount * 3);
+
+        if(positions != nullptr)
+        {
+            clusters.erase(std::remove_if(clusters.begin(), clusters.end(),
+                [](const TriangleCluster& cluster){ return cluster.triangleCount == 0; }), clusters.end());
+            SortClustersForOverdraw(output.data(), output.size(), positions, clusters);
+        }
+
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    void OptimizeVertexFetch(u32* indices, u64 indexCount, u32 vertexCount, u32* outRemap)
+    {
+        std::fill(outRemap, outRemap + vertexCount, U32_MAX);
+
+        u32 next = 0;
+        for(u64 i = 0; i < indexCount; i++)
+        {
+            u32& remapped = outRemap[indices[i]];
+            if(remapped == U32_MAX)
+            {
+                remapped = next++;
+            }
+            indices[i] = remapped;
+        }
+
+        for(u32 v = 0; v < vertexCount; v++)
+        {
+            if(outRemap[v] == U32_MAX) outRemap[v] = next++;
+        }
+    }
+
+    void BuildMeshlets(const u32* indices, u64 indexCount, u32 vertexCount, u32 maxVertices, u32 maxTriangles, 
+        std::vector<Meshlet>& outMeshlets, std::vector<u32>& outVertices, std::vector<u32>& outTriangles)
+    {
+        RAW_ASSERT(maxVertices >= 3 && maxVertices <= 256 && maxTriangles > 0);
+
+        // meshlet local index of every vertex in the open meshlet, 0xFF when it isn't part of it
+        std::vector<u8> localIndex(vertexCount, 0xFF);
+        Meshlet meshlet;
+        meshlet.vertexOffset = (u32)outVertices.size();
+        meshlet.triangleOffset = (u32)outTriangles.size();
+
+        auto flush = [&]()
+        {
+            if(meshlet.triangleCount == 0) return;
+
+            for(u32 v = 0; v < meshlet.vertexCount; v++)
+            {
+                localIndex[outVertices[meshlet.vertexOffset + v]] = 0xFF;
+            }
+            outMeshlets.push_back(meshlet);
+
+            meshlet = {};
+            meshlet.vertexOffset = (u32)outVertices.size();
+            meshlet.triangleOffset = (u32)outTriangles.size();
+        };
+
+        for(u64 i = 0; i + 2 < indexCount; i += 3)
+        {
+            const u32 a = indices[i + 0];
+            const u32 b = indices[i + 1];
+            const u32 c = indices[i + 2];
+            RAW_ASSERT(a < vertexCount && b < vertexCount && c < vertexCount);
+
+            const u32 newVertices = (localIndex[a] == 0xFF) + (localIndex[b] == 0xFF) + (localIndex[c] == 0xFF);
+            if(meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles)
+            {
+                flush();
+            }
+
+            u32 packed = 0;
+            const u32 corners[3] = { a, b, c };
+            for(u32 corner = 0; corner < 3; corner++)
+            {
+                const u32 v = corners[corner];
+                if(localIndex[v] == 0xFF)
+                {
+                    localIndex[v] = (u8)meshlet.vertexCount++;
+                    outVertices.push_back(v);
+                }
+                packed |= (u32)localIndex[v] << (corner * 8);
+            }
+
+            outTriangles.push_back(packed);
+            meshlet.triangleCount++;
+        }
+
+        flush();
+    }
+
+    MeshletBounds ComputeMeshletBounds(const Meshlet& meshlet, const u32* meshletVertices, const u32* meshletTriangles, const glm::vec3* positions)
+    {
+        MeshletBounds bounds;
+        if(meshlet.vertexCount == 0) return bounds;
+
+        const u32* vertices = meshletVertices + meshlet.vertexOffset;
+        glm::vec3 boundsMin = positions[vertices[0]];
+        glm::vec3 boundsMax = positions[vertices[0]];
+        for(u32 v = 1; v < meshlet.vertexCount; v++)
+        {
+            boundsMin = glm::min(boundsMin, positions[vertices[v]]);
+            boundsMax = glm::max(boundsMax, positions[vertices[v]]);
+        }
+
+        bounds.center = (boundsMin + boundsMax) * 0.5f;
+        for(u32 v = 0; v < meshlet.vertexCount; v++)
+        {
+            bounds.radius = std::max(bounds.radius, glm::length(positions[vertices[v]] - bounds.center));
+        }
+
+        // normal cone, the axis is the average triangle normal and the cone widens by 90 degrees so
+        // any viewpoint inside it is behind every triangle's plane
+        auto triangleNormal = [&](u32 t, glm::vec3& outCorner) -> glm::vec3
+        {
+            const u32 packed = meshletTriangles[meshlet.triangleOffset + t];
+            const glm::vec3& p0 = positions[vertices[packed & 0xFF]];
+            const glm::vec3& p1 = positions[vertices[(packed >> 8) & 0xFF]];
+            const glm::vec3& p2 = positions[vertices[(packed >> 16) & 0xFF]];
+            outCorner = p0;
+
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            const f32 length = glm::length(n);
+            return length > 0.0f ? n / length : glm::vec3(0.0f);
+        };
+
+        glm::vec3 corner;
+        glm::vec3 axis(0.0f);
+        for(u32 t = 0; t < meshlet.triangleCount; t++)
+        {
+            axis += triangleNormal(t, corner);
+        }
+
+        const f32 axisLength = glm::length(axis);
+        if(axisLength <= 0.0f) return bounds;
+        axis /= axisLength;
+
+        f32 minDot = 1.0f;
+        for(u32 t = 0; t < meshlet.triangleCount; t++)
+        {
+            const glm::vec3 n = triangleNormal(t, corner);
+            if(n != glm::vec3(0.0f)) minDot = std::min(minDot, glm::dot(axis, n));
+        }
+
+        // normals spread over about a hemisphere or more, some triangle always faces the viewer
+        if(minDot <= 0.1f) return bounds;
+
+        // slide the apex back along the axis until it's behind every triangle's plane
+        f32 maxT = 0.0f;
+        for(u32 t = 0; t < meshlet.triangleCount; t++)
+        {
+            const glm::vec3 n = triangleNormal(t, corner);
+            if(n == glm::vec3(0.0f)) continue;
+            maxT = std::max(maxT, glm::dot(bounds.center - corner, n) / glm::dot(axis, n));
+        }
+
+        bounds.coneApex = bounds.center - axis * maxT;
+        bounds.coneAxis = axis;
+        bounds.coneCutoff = sqrtf(1.0f - minDot * minDot);
+        return bounds;
+    }
+
+    u64 SimplifyMesh(const u32* indices, u64 indexCount, u32 vertexCount, const glm::vec3* positions, u64 targetIndexCount, f32 maxError, 
+        u32* outIndices, f32& outError)
+    {
+        std::vector<u32> result(indices, indices + indexCount);
+        outError = 0.0f;
+
+        std::vector<u8> locked;
+        FindLockedVertices(indices, indexCount, positions, vertexCount, locked);
+
+        std::vector<Quadric> quadrics(vertexCount);
+        for(u64 i = 0; i < indexCount; i += 3)
+        {
+            const glm::vec3& p0 = positions[indices[i + 0]];
+            const glm::vec3 n = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+            const f32 length = glm::length(n);
+            if(length <= 0.0f) continue;
+
+            const glm::vec3 normal = n / length;
+            const f32 d = -glm::dot(normal, p0);
+            for(u32 corner = 0; corner < 3; corner++)
+            {
+                AddPlane(quadrics[indices[i + corner]], normal, d, length * 0.5f);
+            }
+        }
+
+        const f32 maxErrorSq = maxError * maxError;
+        f32 resultErrorSq = 0.0f;
+        TriangleAdjacency adjacency;
+        std::vector<EdgeCollapse> collapses;
+        std::vector<u32> remap(vertexCount);
+        std::vector<u8> touched(vertexCount);
+
+        // every pass collapses a set of edges whose neighbourhoods don't overlap, cheapest first, then rebuilds the index list
+        while(result.size() > targetIndexCount)
+        {
+            const u64 count = result.size();
+            BuildAdjacency(result.data(), count, vertexCount, adjacency);
+
+            collapses.clear();
+            for(u64 i = 0; i < count; i += 3)
+            {
+                for(u32 e = 0; e < 3; e++)
+                {
+                    const u32 a = result[i + e];
+                    const u32 b = result[i + (e + 1) % 3];
+                    const EdgeCollapse candidates[2] = {
+                        { EvaluateQuadric(quadrics[a], positions[b]), a, b },
+                        { EvaluateQuadric(quadrics[b], positions[a]), b, a } };
+                    for(const EdgeCollapse& candidate : candidates)
+                    {
+                        if(!locked[candidate.from] && candidate.error <= maxErrorSq) collapses.push_back(candidate);
+                    }
+                }
+            }
+            if(collapses.empty()) break;
+
+            std::sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& a, const EdgeCollapse& b){ return a.error < b.error; });
+
+            // a collapse removes about two triangles, only the cheapest part of the list is used so a blocked cheap collapse
+            // waits for the next pass instead of being replaced by an expensive one
+            const u64 triangleGoal = (count - targetIndexCount) / 3 + 1;
+            const f32 errorLimit = collapses[std::min<u64>(collapses.size() - 1, triangleGoal)].error;
+
+            for(u32 v = 0; v < vertexCount; v++) remap[v] = v;
+            std::fill(touched.begin(), touched.end(), 0);
+
+            u64 removed = 0;
+            for(const EdgeCollapse& collapse : collapses)
+            {
+                if(removed >= triangleGoal || collapse.error > errorLimit) break;
+                if(touched[collapse.from] || touched[collapse.to]) continue;
+
+                // the only neighbours from and to may share are the third corners of the triangles being removed,
+                // anything else would fold the surface onto itself (the link condition)
+                u32 collapsedTriangles = 0;
+                u32 opposite[2] = { U32_MAX, U32_MAX };
+                for(u32 t = adjacency.offsets[collapse.from]; t < adjacency.offsets[collapse.from + 1]; t++)
+                {
+                    const u32* triangle = &result[adjacency.triangles[t] * 3];
+                    if(triangle[0] != collapse.to && triangle[1] != collapse.to && triangle[2] != collapse.to) continue;
+
+                    if(collapsedTriangles < 2) opposite[collapsedTriangles] = triangle[0] ^ triangle[1] ^ triangle[2] ^ collapse.from ^ collapse.to;
+                    collapsedTriangles++;
+                }
+
+                // moving from onto to must not flip any triangle that survives the collapse either
+                bool flips = collapsedTriangles > 2;
+                for(u32 t = adjacency.offsets[collapse.from]; t < adjacency.offsets[collapse.from + 1] && !flips; t++)
+                {
+                    const u32* triangle = &result[adjacency.triangles[t] * 3];
+                    if(triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) continue;
+
+                    for(u32 corner = 0; corner < 3 && !flips; corner++)
+                    {
+                        const u32 v = triangle[corner];
+                        if(v == collapse.from || v == opposite[0] || v == opposite[1]) continue;
+                        for(u32 u = adjacency.offsets[collapse.to]; u < adjacency.offsets[collapse.to + 1] && !flips; u++)
+                        {
+                            const u32* shared = &result[adjacency.triangles[u] * 3];
+                            flips = shared[0] == v || shared[1] == v || shared[2] == v;
+                        }
+                    }
+
+                    glm::vec3 before[3];
+                    glm::vec3 after[3];
+                    for(u32 corner = 0; corner < 3; corner++)
+                    {
+                        before[corner] = positions[triangle[corner]];
+                        after[corner] = triangle[corner] == collapse.from ? positions[collapse.to] : before[corner];
+                    }
+                    const glm::vec3 nBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    const glm::vec3 nAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                    // turning a triangle edge on is as bad as flipping it, it shades as a crease
+                    flips = flips || glm::dot(nBefore, nAfter) <= 0.5f * glm::length(nBefore) * glm::length(nAfter);
+                }
+                if(flips) continue;
+
+                remap[collapse.from] = collapse.to;
+                AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+                resultErrorSq = std::max(resultErrorSq, collapse.error);
+                removed += collapsedTriangles;
+
+                for(u32 t = adjacency.offsets[collapse.from]; t < adjacency.offsets[collapse.from + 1]; t++)
+                {
+                    const u32* triangle = &result[adjacency.triangles[t] * 3];
+                    touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+                }
+            }
+            if(removed == 0) break;
+
+            u64 write = 0;
+            for(u64 i = 0; i < count; i += 3)
+            {
+                const u32 a = remap[result[i + 0]];
+                const u32 b = remap[result[i + 1]];
+                const u32 c = remap[result[i + 2]];
+                if(a == b || b == c || a == c) continue;
+
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        memcpy(outIndices, result.data(), result.size() * sizeof(u32));
+        outError = sqrtf(resultErrorSq);
+        return result.size();
+    }
+}
@@ -0,0 +1,475 @@
+#include "utility/scene_cache.hpp"
+#include "utility/hash.hpp"
+#include "utility/image.hpp"
+#include "resources/texture_streamer.hpp"
+#include "platform/mapped_file.hpp"
+#include "core/logger.hpp"
+#include "core/timer.hpp"
+#include "core/job_system.hpp"
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+
+namespace Raw::Utils
+{
+    namespace
+    {
+        constexpr u32 SCENE_CACHE_MAGIC = 0x53574152; // "RAWS"
+        constexpr u32 SCENE_CACHE_VERSION = 7;
+        constexpr u64 SCENE_CACHE_ALIGNMENT = 64;
+
+        enum ESceneCacheSection : u32
+        {
+            VERTICES,
+            INDICES,
+            INDIRECT_DRAWS,
+            MESHLETS,
+            MESHLET_VERTICES,
+            MESHLET_TRIANGLES,
+            MESH_DRAWS,
+            MESHES,
+            MESH_BOUNDS,
+            MATERIALS,
+            TEXTURES,
+            TRANSFORMS,
+            LOCAL_TRANSFORMS,
+            TRANSFORM_PARENTS,
+            IMAGES,
+            DEPENDENCIES,
+            STRINGS,
+            BLOBS,
+            SECTION_COUNT
+        };
+
+        // stride is stored so a change to any of the gpu structs invalidates old caches
+        struct SceneCacheSection
+        {
+            u64 offset{ 0 };
+            u64 size{ 0 };
+            u64 count{ 0 };
+            u64 stride{ 0 };
+        };
+
+        struct FileStamp
+        {
+            u64 size{ 0 };
+            u64 time{ 0 };
+            u64 hash{ 0 };
+        };
+
+        struct alignas(SCENE_CACHE_ALIGNMENT) SceneCacheHeader
+        {
+            u32 magic{ SCENE_CACHE_MAGIC };
+            u32 version{ SCENE_CACHE_VERSION };
+            FileStamp source;
+            u64 wideIndexOffset{ 0 };
+            u32 shortIndexDrawCount{ 0 };
+            u32 padding{ 0 };
+            GFX::DrawStream streams[GFX::DRAW_STREAM_COUNT];
+            SceneCacheSection sections[SECTION_COUNT];
+        };
+
+        // offsets are relative to the STRINGS and BLOBS sections
+        struct SceneCacheImageEntry
+        {
+            u64 nameOffset{ 0 };
+            u64 nameLength{ 0 };
+            u64 pathOffset{ 0 };
+            u64 pathLength{ 0 };
+            u64 dataOffset{ 0 };
+            u64 dataSize{ 0 };
+        };
+
+        struct SceneCacheDependency
+        {
+            u64 pathOffset{ 0 };
+            u64 pathLength{ 0 };
+            FileStamp stamp;
+        };
+
+        RAW_INLINE u64 AlignCacheOffset(u64 offset)
+        {
+            return (offset + SCENE_CACHE_ALIGNMENT - 1) & ~(SCENE_CACHE_ALIGNMENT - 1);
+        }
+
+        bool GetFileStamp(const std::string& path, FileStamp& outStamp, bool hashContents)
+        {
+            std::error_code ec;
+            outStamp.size = (u64)std::filesystem::file_size(path, ec);
+            if(ec) return false;
+            outStamp.time = (u64)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+            if(ec) return false;
+
+            outStamp.hash = 0;
+            if(hashContents)
+            {
+                MappedFile file;
+                if(!file.Open(path.c_str())) return false;
+                outStamp.hash = HashBytes(file.GetData(), file.GetSize());
+            }
+            return true;
+        }
+
+        // size and write time match is trusted, otherwise the contents decide
+        bool IsFileUnchanged(const std::string& path, const FileStamp& baked)
+        {
+            FileStamp current;
+            if(!GetFileStamp(path, current, false)) return false;
+            if(current.size != baked.size) return false;
+            if(current.time == baked.time) return true;
+
+            return GetFileStamp(path, current, true) && current.hash == baked.hash;
+        }
+
+        class SceneCacheWriter
+        {
+        public:
+            template<typename T>
+            void Add(ESceneCacheSection section, const T* data, u64 count)
+            {
+                Add(section, data, count * sizeof(T), count, sizeof(T));
+            }
+
+            void Add(ESceneCacheSection section, const void* data, u64 size, u64 count, u64 stride)
+            {
+                m_Data[section] = data;
+                m_Header.sections[section].size = size;
+                m_Header.sections[section].count = count;
+                m_Header.sections[section].stride = stride;
+            }
+
+            void SetIndexLayout(u32 shortIndexDrawCount, u64 wideIndexOffset)
+            {
+                m_Header.shortIndexDrawCount = shortIndexDrawCount;
+                m_Header.wideIndexOffset = wideIndexOffset;
+            }
+
+            void SetDrawStreams(const GFX::DrawStream* streams)
+            {
+                for(u32 i = 0; i < GFX::DRAW_STREAM_COUNT; i++) m_Header.streams[i] = streams[i];
+            }
+
+            bool Write(const std::string& path, const FileStamp& source)
+            {
+                m_Header.source = source;
+
+                u64 offset = AlignCacheOffset(sizeof(SceneCacheHeader));
+                for(u32 i = 0; i < SECTION_COUNT; i++)
+                {
+                    m_Header.sections[i].offset = offset;
+                    offset = AlignCacheOffset(offset + m_Header.sections[i].size);
+                }
+
+                // written to a temporary first so a crash never leaves a truncated cache behind
+                std::string tempPath = path + ".tmp";
+                {
+                    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                    if(!file.is_open()) return false;
+
+                    static const u8 padding[SCENE_CACHE_ALIGNMENT] = {};
+                    file.write((const char*)&m_Header, sizeof(SceneCacheHeader));
+                    u64 written = sizeof(SceneCacheHeader);
+                    for(u32 i = 0; i < SECTION_COUNT; i++)
+                    {
+                        const SceneCacheSection& section = m_Header.sections[i];
+                        file.write((const char*)padding, section.offset - written);
+                        if(section.size > 0) file.write((const char*)m_Data[i], section.size);
+                        written = section.offset + section.size;
+                    }
+                    if(!file.good()) return false;
+                }
+
+                std::error_code ec;
+                std::filesystem::rename(tempPath, path, ec);
+                if(ec)
+                {
+                    std::filesystem::remove(tempPath, ec);
+                    return false;
+                }
+                return true;
+            }
+
+        private:
+            SceneCacheHeader m_Header;
+            const void* m_Data[SECTION_COUNT]{};
+
+        };
+
+        class SceneCacheReader
+        {
+        public:
+            SceneCacheReader(const MappedFile& file) : m_File(file)
+            {
+                m_Header = (const SceneCacheHeader*)file.GetData();
+            }
+
+            bool Validate() const
+            {
+                if(m_File.GetSize() < sizeof(SceneCacheHeader)) return false;
+                if(m_Header->magic != SCENE_CACHE_MAGIC || m_Header->version != SCENE_CACHE_VERSION) return false;
+
+                for(u32 i = 0; i < SECTION_COUNT; i++)
+                {
+                    const SceneCacheSection& section = m_Header->sections[i];
+                    if(section.offset + section.size > m_File.GetSize()) return false;
+                    if(section.count * section.stride != section.size) return false;
+                }
+
+                if(m_Header->wideIndexOffset > m_Header->sections[INDICES].size) return false;
+                for(const GFX::DrawStream& stream : m_Header->streams)
+                {
+                    const u64 drawCount = m_Header->sections[INDIRECT_DRAWS].count;
+                    if((u64)stream.shortRange.first + stream.shortRange.count > drawCount) return false;
+                    if((u64)stream.wideRange.first + stream.wideRange.count > drawCount) return false;
+                }
+
+                return Stride(VERTICES) == sizeof(GFX::SceneVertex) &&
+                    Stride(INDICES) == 1 &&
+                    Stride(INDIRECT_DRAWS) == sizeof(GFX::IndirectDraw) &&
+                    Stride(MESHLETS) == sizeof(GFX::MeshletData) &&
+                    Stride(MESHLET_VERTICES) == sizeof(u32) &&
+                    Stride(MESHLET_TRIANGLES) == sizeof(u32) &&
+                    Stride(MESH_DRAWS) == sizeof(GFX::MeshDrawData) &&
+                    Stride(MESHES) == sizeof(GFX::MeshData) &&
+                    Stride(MESH_BOUNDS) == sizeof(GFX::MeshBoundsData) &&
+                    Stride(MATERIALS) == sizeof(GFX::PBRMaterialData) &&
+                    Stride(TEXTURES) == sizeof(u32) &&
+                    Stride(TRANSFORMS) == sizeof(glm::mat4) &&
+                    Stride(LOCAL_TRANSFORMS) == sizeof(glm::mat4) &&
+                    Stride(TRANSFORM_PARENTS) == sizeof(u32) &&
+                    Stride(IMAGES) == sizeof(SceneCacheImageEntry) &&
+                    Stride(DEPENDENCIES) == sizeof(SceneCacheDependency) &&
+                    Stride(STRINGS) == 1 &&
+                    Stride(BLOBS) == 1;
+            }
+
+            template<typename T>
+            RAW_INLINE const T* Get(ESceneCacheSection section) const { return (const T*)(m_File.GetData() + m_Header->sections[section].offset); }
+            RAW_INLINE u64 Count(ESceneCacheSection section) const { return m_Header->sections[section].count; }
+            RAW_INLINE u64 Stride(ESceneCacheSection section) const { return m_Header->sections[section].stride; }
+            RAW_INLINE const FileStamp& Source() const { return m_Header->source; }
+            RAW_INLINE u32 ShortIndexDrawCount() const { return m_Header->shortIndexDrawCount; }
+            RAW_INLINE u64 WideIndexOffset() const { return m_Header->wideIndexOffset; }
+            RAW_INLINE const GFX::DrawStream* DrawStreams() const { return m_Header->streams; }
+
+            template<typename T>
+            void Read(ESceneCacheSection section, std::vector<T>& out) const
+            {
+                out.resize(Count(section));
+                if(!out.empty()) memcpy(out.data(), Get<T>(section), out.size() * sizeof(T));
+            }
+
+            std::string ReadString(u64 offset, u64 length) const
+            {
+                return std::string(Get<char>(STRINGS) + offset, length);
+            }
+
+        private:
+            const MappedFile& m_File;
+            const SceneCacheHeader* m_Header{ nullptr };
+
+        };
+    }
+
+    std::string GetSceneCachePath(const std::string& sourcePath)
+    {
+        return sourcePath + ".rawscene";
+    }
+
+    ESceneCacheResult LoadSceneCache(const std::string& sourcePath, GFX::SceneData& outScene, TextureStreamer* streamer)
+    {
+        const std::string cachePath = GetSceneCachePath(sourcePath);
+        std::error_code ec;
+        if(!std::filesystem::exists(cachePath, ec)) return ESceneCacheResult::MISS;
+
+        u64 startTime = Timer::Get()->Now();
+
+        MappedFile cacheFile;
+        if(!cacheFile.Open(cachePath.c_str())) return ESceneCacheResult::MISS;
+
+        SceneCacheReader reader(cacheFile);
+        if(!reader.Validate())
+        {
+            RAW_WARN("Scene cache '%s' is invalid or from an older version, rebuilding.", cachePath.c_str());
+            return ESceneCacheResult::MISS;
+        }
+
+        if(!IsFileUnchanged(sourcePath, reader.Source()))
+        {
+            RAW_INFO("Scene cache '%s' is out of date, rebuilding.", cachePath.c_str());
+            return ESceneCacheResult::MISS;
+        }
+
+        const SceneCacheDependency* dependencies = reader.Get<SceneCacheDependency>(DEPENDENCIES);
+        for(u64 i = 0; i < reader.Count(DEPENDENCIES); i++)
+        {
+            std::string path = reader.ReadString(dependencies[i].pathOffset, dependencies[i].pathLength);
+            if(!IsFileUnchanged(path, dependencies[i].stamp))
+            {
+                RAW_INFO("Scene cache dependency '%s' changed, rebuilding.", path.c_str());
+                return ESceneCacheResult::MISS;
+            }
+        }
+
+        reader.Read(MESHES, outScene.meshes);
+        reader.Read(MESH_BOUNDS, outScene.meshBoundsData);
+        reader.Read(MESH_DRAWS, outScene.draws);
+        reader.Read(MATERIALS, outScene.materials);
+        reader.Read(TEXTURES, outScene.textures);
+        reader.Read(TRANSFORMS, outScene.transforms);
+        reader.Read(LOCAL_TRANSFORMS, outScene.localTransforms);
+        reader.Read(TRANSFORM_PARENTS, outScene.transformParents);
+
+        // images are decoded in parallel, referenced files are mapped by the job decoding them
+        const SceneCacheImageEntry* imageEntries = reader.Get<SceneCacheImageEntry>(IMAGES);
+        const u32 imageCount = (u32)reader.Count(IMAGES);
+        std::vector<std::string> imageNames(imageCount);
+        std::vector<std::string> imagePaths(imageCount);
+        for(u32 i = 0; i < imageCount; i++)
+        {
+            imageNames[i] = reader.ReadString(imageEntries[i].nameOffset, imageEntries[i].nameLength);
+            imagePaths[i] = reader.ReadString(imageEntries[i].pathOffset, imageEntries[i].pathLength);
+        }
+
+        const u8* blobs = reader.Get<u8>(BLOBS);
+        if(streamer)
+        {
+            // the mapping is closed on return, so embedded images are copied out for the streamer
+            std::vector<StreamedImageSource> sources(imageCount);
+            for(u32 i = 0; i < imageCount; i++)
+            {
+                const SceneCacheImageEntry& entry = imageEntries[i];
+                sources[i].name = imageNames[i];
+                sources[i].path = imagePaths[i];
+                if(entry.dataSize > 0) sources[i].encoded.assign(blobs + entry.dataOffset, blobs + entry.dataOffset + entry.dataSize);
+            }
+            streamer->Begin(std::move(sources), outScene.images);
+        }
+        else
+        {
+            std::vector<DecodedImage> decodedImages(imageCount);
+            JobSystem::Dispatch(imageCount, 1, [&](JobSystem::JobDispatchArgs args)
+                {
+                    const SceneCacheImageEntry& entry = imageEntries[args.jobIndex];
+                    if(entry.dataSize > 0)
+                    {
+                        DecodeImage(blobs + entry.dataOffset, entry.dataSize, imageNames[args.jobIndex].c_str(), decodedImages[args.jobIndex]);
+                        return;
+                    }
+
+                    MappedFile imageFile;
+                    if(imageFile.Open(imagePaths[args.jobIndex].c_str()))
+                    {
+                        DecodeImage(imageFile.GetData(), imageFile.GetSize(), imageNames[args.jobIndex].c_str(), decodedImages[args.jobIndex]);
+                    }
+                }
+            );
+            JobSystem::Wait();
+
+            UploadImages(imageNames, decodedImages, outScene.images, outScene.imageIds);
+        }
+
+        SceneGeometry geometry;
+        geometry.vertices = reader.Get<GFX::SceneVertex>(VERTICES);
+        geometry.vertexCount = reader.Count(VERTICES);
+        geometry.indices = reader.Get<u8>(INDICES);
+        geometry.indexSize = reader.Count(INDICES);
+
+        outScene.shortIndexDrawCount = reader.ShortIndexDrawCount();
+        geometry.wideIndexOffset = reader.WideIndexOffset();
+        for(u32 i = 0; i < GFX::DRAW_STREAM_COUNT; i++) outScene.streams[i] = reader.DrawStreams()[i];
+        geometry.indirectDraws = reader.Get<GFX::IndirectDraw>(INDIRECT_DRAWS);
+        geometry.indirectDrawCount = reader.Count(INDIRECT_DRAWS);
+        geometry.meshlets = reader.Get<GFX::MeshletData>(MESHLETS);
+        geometry.meshletCount = reader.Count(MESHLETS);
+        geometry.meshletVertices = reader.Get<u32>(MESHLET_VERTICES);
+        geometry.meshletVertexCount = reader.Count(MESHLET_VERTICES);
+        geometry.meshletTriangles = reader.Get<u32>(MESHLET_TRIANGLES);
+        geometry.meshletTriangleCount = reader.Count(MESHLET_TRIANGLES);
+
+        if(!UploadSceneGeometry(sourcePath, geometry, outScene)) return ESceneCacheResult::FAILED;
+
+        u64 endTime = Timer::Get()->Now();
+        f64 deltaTime = Timer::Get()->DeltaSeconds(startTime, endTime);
+
+        RAW_TRACE("Scene cache '%s' loaded.", cachePath.c_str());
+        RAW_TRACE("Load Time: %0.2llf s", deltaTime);
+        return ESceneCacheResult::LOADED;
+    }
+
+    bool WriteSceneCache(
+        const std::string& sourcePath,
+        const std::vector<std::string>& dependencies,
+        const GFX::SceneData& scene,
+        const SceneGeometry& geometry,
+        const std::vector<SceneCacheImage>& images)
+    {
+        FileStamp sourceStamp;
+        if(!GetFileStamp(sourcePath, sourceStamp, true)) return false;
+
+        std::string strings;
+        std::vector<u8> blobs;
+
+        std::vector<SceneCacheDependency> dependencyEntries(dependencies.size());
+        for(u64 i = 0; i < dependencies.size(); i++)
+        {
+            if(!GetFileStamp(dependencies[i], dependencyEntries[i].stamp, true)) return false;
+
+            dependencyEntries[i].pathOffset = strings.size();
+            dependencyEntries[i].pathLength = dependencies[i].size();
+            strings += dependencies[i];
+        }
+
+        std::vector<SceneCacheImageEntry> imageEntries(images.size());
+        for(u64 i = 0; i < images.size(); i++)
+        {
+            SceneCacheImageEntry& entry = imageEntries[i];
+            entry.nameOffset = strings.size();
+            entry.nameLength = images[i].name.size();
+            strings += images[i].name;
+
+            entry.pathOffset = strings.size();
+            entry.pathLength = images[i].path.size();
+            strings += images[i].path;
+
+            if(images[i].encoded && images[i].encodedSize > 0)
+            {
+                entry.dataOffset = blobs.size();
+                entry.dataSize = images[i].encodedSize;
+                blobs.insert(blobs.end(), images[i].encoded, images[i].encoded + images[i].encodedSize);
+            }
+        }
+
+        SceneCacheWriter writer;
+        writer.Add(VERTICES, geometry.vertices, geometry.vertexCount);
+        writer.Add(INDICES, geometry.indices, geometry.indexSize);
+        writer.SetIndexLayout(scene.shortIndexDrawCount, geometry.wideIndexOffset);
+        writer.SetDrawStreams(scene.streams);
+        writer.Add(INDIRECT_DRAWS, geometry.indirectDraws, geometry.indirectDrawCount);
+        writer.Add(MESHLETS, geometry.meshlets, geometry.meshletCount);
+        writer.Add(MESHLET_VERTICES, geometry.meshletVertices, geometry.meshletVertexCount);
+        writer.Add(MESHLET_TRIANGLES, geometry.meshletTriangles, geometry.meshletTriangleCount);
+        writer.Add(MESH_DRAWS, scene.draws.data(), scene.draws.size());
+        writer.Add(MESHES, scene.meshes.data(), scene.meshes.size());
+        writer.Add(MESH_BOUNDS, scene.meshBoundsData.data(), scene.meshBoundsData.size());
+        writer.Add(MATERIALS, scene.materials.data(), scene.materials.size());
+        writer.Add(TEXTURES, scene.textures.data(), scene.textures.size());
+        writer.Add(TRANSFORMS, scene.transforms.data(), scene.transforms.size());
+        writer.Add(LOCAL_TRANSFORMS, scene.localTransforms.data(), scene.localTransforms.size());
+        writer.Add(TRANSFORM_PARENTS, scene.transformParents.data(), scene.transformParents.size());
+        writer.Add(IMAGES, imageEntries.data(), imageEntries.size());
+        writer.Add(DEPENDENCIES, dependencyEntries.data(), dependencyEntries.size());
+        writer.Add(STRINGS, strings.data(), strings.size());
+        writer.Add(BLOBS, blobs.data(), blobs.size());
+
+        const std::string cachePath = GetSceneCachePath(sourcePath);
+        if(!writer.Write(cachePath, sourceStamp))
+        {
+            RAW_WARN("Failed to write scene cache '%s'.", cachePath.c_str());
+            return false;
+        }
+
+        RAW_TRACE("Scene cache '%s' written.", cachePath.c_str());
+        return true;
+    }
+}
@@ -1,9 +1,33 @@
 #define MAX_MATERIALS 512
-#define MAX_LIGHT_COUNT 64
+#define MAX_LIGHT_COUNT 4096
+// view space grid point lights are binned into, screen tiles split into exponential depth slices
+#define LIGHT_CLUSTER_X 16
+#define LIGHT_CLUSTER_Y 9
+#define LIGHT_CLUSTER_Z 24
+#define MAX_LIGHTS_PER_CLUSTER 128
 #define INVALID_MATERIAL_INDEX 4294967295
 #define PI 3.1415926538
 #define AMBIENT 0.5
 #define BIAS 0.0005
+#define MAX_LOD_COUNT 4
+// simplification error allowed on screen, as a fraction of the screen height
+#define LOD_ERROR_THRESHOLD 0.001
+#define MAX_MESHLET_VERTICES 64
+#define MAX_MESHLET_TRIANGLES 124
+#define MESHLET_TASK_SIZE 32
+// the compute culled meshlet index buffer stores a meshlet's slot above its local vertex index
+#define MESHLET_VERTEX_BITS 6
+// ECullPhase, passes of the early and late phase draw the instances whose visibility flags have that bit set
+#define CULL_PHASE_ALL 0
+#define CULL_PHASE_EARLY 1
+#define CULL_PHASE_LATE 2
+#define MAX_DEPTH_PYRAMID_MIPS 13
+#define SHADOW_CASCADE_COUNT 4
+// frustum culling views, the camera first and then one per shadow cascade
+#define CAMERA_CULL_VIEW 0
+#define CULL_ALL_INSTANCES 0
+#define CULL_STATIC_INSTANCES 1
+#define CULL_DYNAMIC_INSTANCES 2
 
 struct PointLight
 {
@@ -41,10 +65,58 @@ struct IndirectDrawData
     uint firstInstance;
 };
 
+struct MeshLod
+{
+    uint firstIndex;
+    uint indexCount;
+    uint firstMeshlet;
+    uint meshletCount;
+};
+
 struct MeshBoundsData
 {
     vec3 min;
+    uint lodCount;
+    vec3 max;
+    uint padding;
+    float lodErrors[MAX_LOD_COUNT];
+    MeshLod lods[MAX_LOD_COUNT];
+};
+
+// world space bounds of one instance, updated on the cpu whenever its transform changes
+struct InstanceBoundsData
+{
+    vec3 min;
+    float padding0;
     vec3 max;
+    float padding1;
+};
+
+struct MeshletData
+{
+    vec3 center;
+    float radius;
+    vec3 coneApex;
+    float coneCutoff;
+    vec3 coneAxis;
+    uint vertexOffset;
+    uint triangleOffset;
+    uint vertexCount;
+    uint triangleCount;
+    uint padding;
+};
+
+struct MeshletTask
+{
+    uint instanceIndex;
+    uint meshletOffset;
+};
+
+// meshlets of one task that survived culling, each gets its own mesh shader workgroup
+struct MeshletPayload
+{
+    uint instanceIndex;
+    uint meshlets[MESHLET_TASK_SIZE];
 };
 
 layout (set = 0, binding = 0) uniform sceneData{
@@ -58,7 +130,14 @@ layout (set = 0, binding = 0) uniform sceneData{
 	vec4 lightDir;
 	float lightIntensity;
 	uint shadowMapIndex;
+	float zNear;
+	float zFar;
     Frustum cameraFrustum;
+    mat4 cascadeViewProj[SHADOW_CASCADE_COUNT];
+    // view space distance each cascade ends at
+    vec4 cascadeSplits;
+    uvec4 cascadeShadowMaps;
+    Frustum cascadeFrustums[SHADOW_CASCADE_COUNT];
 } GlobalSceneData;
 
 struct PBRMaterial
@@ -74,6 +153,16 @@ struct PBRMaterial
     uint isTransparent;
 };
 
+#ifdef RAW_COMPACT_VERTICES
+// see CompactVertexData, position is quantised to the mesh bounds
+struct Vertex{
+	uint positionXY;
+	uint positionZW;
+	uint normal;
+	uint tangent;
+	uint texCoord;
+};
+#else
 struct Vertex{
 	vec3 position;
 	float u;
@@ -81,14 +170,133 @@ struct Vertex{
 	float v;
 	vec4 tangent;
 };
+#endif
+
+struct VertexAttributes
+{
+    vec3 position;
+    vec3 normal;
+    vec4 tangent;
+    vec2 uv;
+};
+
+vec3 DecodeOctahedral(uint packed)
+{
+    vec2 e = unpackSnorm2x16(packed);
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec3 DecodePosition(Vertex v, MeshBoundsData bounds)
+{
+#ifdef RAW_COMPACT_VERTICES
+    vec3 q = vec3(unpackUnorm2x16(v.positionXY), unpackUnorm2x16(v.positionZW).x);
+    return bounds.min + q * (bounds.max - bounds.min);
+#else
+    return v.position;
+#endif
+}
+
+VertexAttributes DecodeVertex(Vertex v, MeshBoundsData bounds)
+{
+    VertexAttributes attributes;
+    attributes.position = DecodePosition(v, bounds);
+#ifdef RAW_COMPACT_VERTICES
+    attributes.normal = DecodeOctahedral(v.normal);
+    attributes.tangent = vec4(DecodeOctahedral(v.tangent), (v.positionZW >> 16) != 0 ? 1.0 : -1.0);
+    attributes.uv = unpackHalf2x16(v.texCoord);
+#else
+    attributes.normal = v.normal;
+    attributes.tangent = v.tangent;
+    attributes.uv = vec2(v.u, v.v);
+#endif
+    return attributes;
+}
 
 struct MeshDrawData
 {
     mat4 transform;
     uint materialIndex;
     uint isTransparent;
+    uint drawIndex;
+    uint isDynamic;
 };
 
+// bounding sphere against the camera frustum, then the normal cone against the camera position
+bool IsMeshletVisible(MeshletData meshlet, mat4 transform)
+{
+    vec3 axisScale = vec3(length(transform[0].xyz), length(transform[1].xyz), length(transform[2].xyz));
+    float maxScale = max(axisScale.x, max(axisScale.y, axisScale.z));
+    vec3 center = (transform * vec4(meshlet.center, 1.0)).xyz;
+    float radius = meshlet.radius * maxScale;
+
+    Frustum cameraFrustum = GlobalSceneData.cameraFrustum;
+    Plane planes[6] = Plane[6](cameraFrustum.topFace, cameraFrustum.bottomFace, cameraFrustum.leftFace, 
+        cameraFrustum.rightFace, cameraFrustum.nearFace, cameraFrustum.farFace);
+    for(int i = 0; i < 6; i++)
+    {
+        if(dot(center, planes[i].normal) + planes[i].distance + radius < 0.0) return false;
+    }
+
+    // the cone doesn't survive non uniform scale, a mirrored transform flips which side is front
+    float minScale = min(axisScale.x, min(axisScale.y, axisScale.z));
+    if(meshlet.coneCutoff >= 1.0 || maxScale > minScale * 1.01) return true;
+
+    mat3 linear = mat3(transform);
+    vec3 apex = (transform * vec4(meshlet.coneApex, 1.0)).xyz;
+    vec3 axis = normalize(linear * meshlet.coneAxis) * sign(determinant(linear));
+    vec3 cameraPosition = GlobalSceneData.viewInv[3].xyz;
+    return dot(normalize(apex - cameraPosition), axis) < meshlet.coneCutoff;
+}
+
+// world space box against a frustum, the extents are projected onto each plane's normal
+bool IsBoxInFrustum(vec3 boxMin, vec3 boxMax, Frustum frustum)
+{
+    vec3 center = (boxMin + boxMax) * 0.5;
+    vec3 extents = (boxMax - boxMin) * 0.5;
+
+    Plane planes[6] = Plane[6](frustum.topFace, frustum.bottomFace, frustum.leftFace, 
+        frustum.rightFace, frustum.nearFace, frustum.farFace);
+    for(int i = 0; i < 6; i++)
+    {
+        if(dot(center, planes[i].normal) + dot(abs(planes[i].normal), extents) + planes[i].distance < 0.0) return false;
+    }
+    return true;
+}
+
+bool IsInCullPhase(uint visibilityFlags, uint cullPhase)
+{
+    return cullPhase == CULL_PHASE_ALL || (visibilityFlags & cullPhase) != 0;
+}
+
+// coarsest level whose simplification error projects to less than LOD_ERROR_THRESHOLD of the screen height
+uint SelectLod(MeshBoundsData bounds, mat4 transform)
+{
+    if(bounds.lodCount <= 1) return 0;
+
+    float maxScale = max(length(transform[0].xyz), max(length(transform[1].xyz), length(transform[2].xyz)));
+    vec3 center = (transform * vec4((bounds.min + bounds.max) * 0.5, 1.0)).xyz;
+    float radius = length(bounds.max - bounds.min) * 0.5 * maxScale;
+
+    // the error can sit anywhere on the mesh, so it is measured at the nearest point of the bounding sphere
+    vec3 cameraPosition = GlobalSceneData.viewInv[3].xyz;
+    float distance = max(length(center - cameraPosition) - radius, 0.0);
+
+    // proj[1][1] is cot(fov / 2), one world unit at this distance covers this fraction of the screen height
+    float screenScale = abs(GlobalSceneData.proj[1][1]) * 0.5 / max(distance, 0.0001);
+
+    uint lod = 0;
+    for(uint i = 1; i < bounds.lodCount; i++)
+    {
+        if(bounds.lodErrors[i] * maxScale * screenScale > LOD_ERROR_THRESHOLD) break;
+        lod = i;
+    }
+    return lod;
+}
+
 float heaviside( float v ) {
     if ( v > 0.0 ) return 1.0;
     else return 0.0;
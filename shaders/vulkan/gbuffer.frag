@@ -41,6 +41,11 @@ void main()
 
 		vec4 baseColor = texture(globalTextures[nonuniformEXT(material.diffuse)], inUV);
 		baseColor.rgba *= material.baseColorFactor.rgba;
+		// masked materials, everything else has a cutoff of 0
+		if(baseColor.a < material.alphaCutoff)
+		{
+			discard;
+		}
 		
 		vec3 vNorm = normalize(inNormal);
 		vec3 vTan = normalize(inTangent.xyz);
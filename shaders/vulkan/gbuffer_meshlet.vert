@@ -0,0 +1,69 @@
+#version 460
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_buffer_reference2 : require
+#extension GL_GOOGLE_include_directive : require
+
+#include "common.glsl"
+
+layout (location = 0) out vec2 outUV;
+layout (location = 1) out vec3 outNormal;
+layout (location = 2) out vec4 outTangent;
+layout (location = 3) out vec4 outViewSpacePos;
+layout (location = 4) out vec4 outLightClipSpacePos;
+layout (location = 5) out uint outMaterialIndex;
+
+layout(buffer_reference, std430) readonly buffer VertexBuffer{
+	Vertex vertices[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshDrawDataBuffer{
+	MeshDrawData meshData[];
+};
+
+// instance and meshlet of every meshlet that survived meshlet_culling
+layout(buffer_reference, std430) readonly buffer VisibleMeshletBuffer{
+	uvec2 meshlets[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshBoundsDataBuffer{
+	MeshBoundsData meshBounds[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshletBuffer{
+	MeshletData meshlets[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshletVertexBuffer{
+	uint vertices[];
+};
+
+layout(push_constant) uniform constants{
+	VertexBuffer vertexBuffer;
+	MeshDrawDataBuffer meshBuffer;
+	VisibleMeshletBuffer visibleMeshlets;
+	MeshBoundsDataBuffer meshBounds;
+	MeshletBuffer meshlets;
+	MeshletVertexBuffer meshletVertices;
+} PushConstants;
+
+void main()
+{
+	// the index holds the visible meshlet's slot and the vertex within the meshlet
+	uint index = uint(gl_VertexIndex);
+	uvec2 visible = PushConstants.visibleMeshlets.meshlets[index >> MESHLET_VERTEX_BITS];
+	MeshletData meshlet = PushConstants.meshlets.meshlets[visible.y];
+	uint vertexIndex = PushConstants.meshletVertices.vertices[meshlet.vertexOffset + (index & ((1u << MESHLET_VERTEX_BITS) - 1u))];
+
+	Vertex v = PushConstants.vertexBuffer.vertices[vertexIndex];
+	MeshDrawData drawData = PushConstants.meshBuffer.meshData[visible.x];
+	VertexAttributes attributes = DecodeVertex(v, PushConstants.meshBounds.meshBounds[drawData.drawIndex]);
+
+	//output the position of each vertex
+	gl_Position = GlobalSceneData.viewProj * drawData.transform * vec4(attributes.position, 1.0f);
+	outUV = attributes.uv;
+	outNormal = mat3(drawData.transform) * attributes.normal;
+	outMaterialIndex = drawData.materialIndex;
+	outTangent = attributes.tangent;
+	outViewSpacePos = GlobalSceneData.view * drawData.transform * vec4(attributes.position, 1.0f);
+	outLightClipSpacePos = GlobalSceneData.lightProj * GlobalSceneData.lightView * drawData.transform * vec4(attributes.position, 1.0f);
+}
@@ -0,0 +1,21 @@
+// view space cluster grid point lights are binned into, included after common.glsl
+
+// view space depth a slice starts at, slices grow exponentially from the near plane to the far plane
+float ClusterSliceDepth(uint slice)
+{
+	return GlobalSceneData.zNear * pow(GlobalSceneData.zFar / GlobalSceneData.zNear, float(slice) / float(LIGHT_CLUSTER_Z));
+}
+
+uint ClusterIndex(uvec3 cluster)
+{
+	return (cluster.z * LIGHT_CLUSTER_Y + cluster.y) * LIGHT_CLUSTER_X + cluster.x;
+}
+
+// cluster of a screen uv at a view space depth, depth is positive in front of the camera
+uint ClusterIndex(vec2 uv, float depth)
+{
+	uvec2 tile = min(uvec2(clamp(uv, 0.0, 1.0) * vec2(LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y)), uvec2(LIGHT_CLUSTER_X - 1, LIGHT_CLUSTER_Y - 1));
+	float slice = log(max(depth, GlobalSceneData.zNear) / GlobalSceneData.zNear) / log(GlobalSceneData.zFar / GlobalSceneData.zNear);
+	uint z = min(uint(slice * float(LIGHT_CLUSTER_Z)), LIGHT_CLUSTER_Z - 1);
+	return ClusterIndex(uvec3(tile, z));
+}
@@ -1,8 +1,11 @@
 #version 460
 #extension GL_EXT_nonuniform_qualifier : enable
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_buffer_reference2 : require
 #extension GL_GOOGLE_include_directive : require
 
 #include "common.glsl"
+#include "light_clusters.glsl"
 
 layout(set = 1, binding = 0) uniform sampler2D globalTextures[];
 layout(set = 1, binding = 0) uniform sampler3D globalTextures3D[];
@@ -10,10 +13,17 @@ layout(set = 1, binding = 0) uniform sampler3D globalTextures3D[];
 layout(set = 1, binding = 1) uniform texture2D globalImages[];
 layout(set = 1, binding = 2) uniform sampler shadowSampler;
 
-layout(set = 3, binding = 0) uniform lightData
-{
-    PointLight data[MAX_LIGHT_COUNT];
-} GlobalPointLightData;
+layout(buffer_reference, std430) readonly buffer PointLightBuffer{
+	PointLight lights[];
+};
+
+layout(buffer_reference, std430) readonly buffer ClusterLightCountBuffer{
+	uint counts[];
+};
+
+layout(buffer_reference, std430) readonly buffer ClusterLightIndexBuffer{
+	uint indices[];
+};
 
 layout (location = 0) in vec2 inUV;
 
@@ -29,81 +39,38 @@ layout(push_constant) uniform constants{
     uint occlusion;
     uint transparent;
     uint reflection;
+    // binned by the light culling pass, each cluster has MAX_LIGHTS_PER_CLUSTER index slots
+    PointLightBuffer pointLights;
+    ClusterLightCountBuffer clusterLightCounts;
+    ClusterLightIndexBuffer clusterLightIndices;
+    uint pointLightCount;
 } PushConstants;
 
-float textureProj(vec3 projCoords, vec2 off)
-{
-	float closestDepth = texture(sampler2D(globalImages[GlobalSceneData.shadowMapIndex], shadowSampler), projCoords.xy + off).r;
-	float curDepth = projCoords.z;
-
-	float shadow = curDepth - BIAS > closestDepth ? 1.0 : 0.0;
-	return shadow;
-}
-
-float filterPCF(vec4 shadowPos)
-{
-	ivec2 texDim = textureSize(sampler2D(globalImages[GlobalSceneData.shadowMapIndex], shadowSampler), 0);
-	float scale = 1.5;
-	float dx = scale * 1.0 / float(texDim.x);
-	float dy = scale * 1.0 / float(texDim.y);
-
-	vec3 projCoords = shadowPos.xyz / shadowPos.w;
-	projCoords.xy = projCoords.xy * 0.5 + 0.5;
-
-	if(projCoords.x < 0.0 || projCoords.x > 1.0 || projCoords.y < 0.0 || projCoords.y > 1.0)
-	{
-		return 0.0;
-	}
-
-	float shadowFactor = 0.0;
-	int count = 0;
-	int range = 1;
-
-	for(int x = -range; x <= range; x++)
-	{
-		for(int y = -range; y <= range; y++)
-		{
-			shadowFactor += textureProj(projCoords, vec2(dx * x, dy * y));
-			count++;
-		}
-	}
-	return shadowFactor / count;
-}
+#include "shadow.glsl"
 
 
-vec3 calcPointLight(uint index, vec4 baseColor, vec3 normal, vec4 rmOcc, vec3 eyePos, vec3 vPos)
+// world space, inverse square falloff windowed down to zero at the light's radius
+vec3 calcPointLight(PointLight light, vec3 albedo, vec3 N, vec3 V, vec3 worldPos, float roughness, float metalness)
 {
-    vec3 finalColor = vec3(0.0f);
-    PointLight light = GlobalPointLightData.data[index];
-    vec3 localLightPos = mat3(GlobalSceneData.view) * light.position;
+    vec3 toLight = light.position - worldPos;
+    float dist2 = max(dot(toLight, toLight), 0.0001);
+    float window = clamp(1.0 - pow(dist2 / (light.radius * light.radius), 2.0), 0.0, 1.0);
+    float attenuation = window * window / dist2;
 
-    float A = light.radius / dot(localLightPos - vPos, localLightPos - vPos);
-
-    vec3 V = normalize(eyePos - vPos);
-    vec3 L = normalize(light.position - vPos);
-    vec3 N = normal;
+    vec3 L = toLight * inversesqrt(dist2);
     vec3 H = normalize(L + V);
+    float NdotL = max(dot(N, L), 0.0);
 
-    float roughness = rmOcc.r;
-    float metalness = rmOcc.g;
-	float alpha = pow(roughness, 2.0);
-
-    vec3 F0 = mix(vec3(0.04), baseColor.rgb, metalness);
+    vec3 F0 = mix(vec3(0.04), albedo, metalness);
     vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
 
     float NDF = distGGX(N, H, roughness);
     float G = geomSmith(N, V, L, roughness);
-    
-    vec3 numerator = NDF * G * F;
-    float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
-    vec3 specular = numerator / denominator;
-
-    vec3 diffuse = baseColor.rgb / PI;
+    vec3 specular = NDF * G * F / (4.0 * max(dot(N, V), 0.0) * NdotL + 0.0001);
+    vec3 kD = (vec3(1.0) - F) * (1.0 - metalness);
 
-    float NdotL = clamp(max(dot(N, L), 0.0), 0, 1);
-    vec3 radiance = light.color.xyz * light.intensity * A * 0.000001;
-
-    return radiance;
+    vec3 radiance = light.color.rgb * light.intensity * attenuation;
+    return (kD * albedo / PI + specular) * radiance * NdotL;
 }
 
 void main() 
@@ -119,10 +86,6 @@ void main()
 
     if(reflectColor.a > 0.0f) baseColor = reflectColor;
 
-    mat3 rot = mat3(GlobalSceneData.view);
-    vec3 translation = vec3(GlobalSceneData.view[3]);
-    vec3 eyePos = -translation * rot;
-
     vec3 V = normalize(vec3(1.0));//normalize(-eyePos.xyz);
     vec3 L = normalize(-GlobalSceneData.lightDir.xyz);
     vec3 N = normal;
@@ -148,28 +111,27 @@ void main()
     float NdotL = clamp(max(dot(N, L), 0.0), 0, 1);
     vec3 radiance = vec3(1.0) * GlobalSceneData.lightIntensity;
 
-    vec4 lightClipSpacePos = texture(globalTextures[nonuniformEXT(PushConstants.lightClipSpacePos)], inUV);
-//    ivec2 shadowDim = textureSize(sampler2D(globalImages[GlobalSceneData.shadowMapIndex], shadowSampler), 0);
-//    ivec2 backBufferDim = textureSize(globalTextures[nonuniformEXT(PushConstants.diffuse)], 0);
-
-    //vec4 shadowUV;
-    // shadowUV.xy = lightClipSpacePos.xy * (shadowDim / backBufferDim);
-    // shadowUV.z = lightClipSpacePos.z;
-    // shadowUV.w = lightClipSpacePos.w;
-
-    float shadow = filterPCF(lightClipSpacePos);
+    // the g-buffer keeps view space positions, cascades are picked by their depth and sampled in world space
+    vec3 worldPos = (GlobalSceneData.viewInv * vec4(viewPos.xyz, 1.0)).xyz;
+    float shadow = CascadedShadow(worldPos);
     
     vec3 specRef = cooktorranceSpec(N, L, V, H, specular, roughness);
     specRef *= vec3(NdotL);
     vec3 relfectedLight = specRef;
 
-    /*vec3 pointLightColor = vec3(0.0f);
-    for(uint i = 0; i < MAX_LIGHT_COUNT; i++)
+    // only the lights the culling pass binned into this pixel's cluster
+    vec3 eyePos = GlobalSceneData.viewInv[3].xyz;
+    vec3 pointV = normalize(eyePos - worldPos);
+    uint cluster = ClusterIndex(inUV, -viewPos.z);
+    uint clusterLightCount = PushConstants.clusterLightCounts.counts[cluster];
+    vec3 pointLightColor = vec3(0.0f);
+    for(uint i = 0; i < clusterLightCount; i++)
     {
-        pointLightColor += calcPointLight(i, baseColor, normal, rmOcc, eyePos, viewPos.xyz);
-    }*/
+        uint lightId = PushConstants.clusterLightIndices.indices[cluster * MAX_LIGHTS_PER_CLUSTER + i];
+        pointLightColor += calcPointLight(PushConstants.pointLights.lights[lightId], baseColor.rgb, N, pointV, worldPos, roughness, metalness);
+    }
 
-    vec3 Lo = (diffuse + relfectedLight) * radiance * NdotL;
+    vec3 Lo = (diffuse + relfectedLight) * radiance * NdotL * (1.0 - shadow) + pointLightColor;
     vec3 ambient = baseColor.rgb * AMBIENT;
     vec3 color = emissive.rgb + ambient + Lo;
 
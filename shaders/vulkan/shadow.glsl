@@ -0,0 +1,53 @@
+// directional light shadows, included after globalImages and shadowSampler are declared
+
+float textureProj(uint shadowMap, vec3 projCoords, vec2 off)
+{
+	float closestDepth = texture(sampler2D(globalImages[nonuniformEXT(shadowMap)], shadowSampler), projCoords.xy + off).r;
+	float curDepth = projCoords.z;
+
+	float shadow = curDepth - BIAS > closestDepth ? 1.0 : 0.0;
+	return shadow;
+}
+
+float filterPCF(uint shadowMap, vec4 shadowPos)
+{
+	ivec2 texDim = textureSize(sampler2D(globalImages[nonuniformEXT(shadowMap)], shadowSampler), 0);
+	float scale = 1.5;
+	float dx = scale * 1.0 / float(texDim.x);
+	float dy = scale * 1.0 / float(texDim.y);
+
+	vec3 projCoords = shadowPos.xyz / shadowPos.w;
+	projCoords.xy = projCoords.xy * 0.5 + 0.5;
+
+	if(projCoords.x < 0.0 || projCoords.x > 1.0 || projCoords.y < 0.0 || projCoords.y > 1.0)
+	{
+		return 0.0;
+	}
+
+	float shadowFactor = 0.0;
+	int count = 0;
+	int range = 1;
+
+	for(int x = -range; x <= range; x++)
+	{
+		for(int y = -range; y <= range; y++)
+		{
+			shadowFactor += textureProj(shadowMap, projCoords, vec2(dx * x, dy * y));
+			count++;
+		}
+	}
+	return shadowFactor / count;
+}
+
+// the nearest cascade whose slice of the camera frustum holds the point, past the last one nothing is shadowed
+float CascadedShadow(vec3 worldPos)
+{
+	float viewDepth = -(GlobalSceneData.view * vec4(worldPos, 1.0)).z;
+
+	uint cascade = 0;
+	while(cascade < SHADOW_CASCADE_COUNT && viewDepth > GlobalSceneData.cascadeSplits[cascade]) cascade++;
+	if(cascade == SHADOW_CASCADE_COUNT) return 0.0;
+
+	vec4 shadowPos = GlobalSceneData.cascadeViewProj[cascade] * vec4(worldPos, 1.0);
+	return filterPCF(GlobalSceneData.cascadeShadowMaps[cascade], shadowPos);
+}
@@ -13,19 +13,29 @@ layout(buffer_reference, std430) readonly buffer MeshDrawDataBuffer{
 	MeshDrawData meshData[];
 };
 
+layout(buffer_reference, std430) readonly buffer VisibleInstanceBuffer{
+	uint instances[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshBoundsDataBuffer{
+	MeshBoundsData meshBounds[];
+};
+
 layout(push_constant) uniform constants{
 	VertexBuffer vertexBuffer;
 	MeshDrawDataBuffer meshBuffer;
+	VisibleInstanceBuffer visibleInstances;
+	MeshBoundsDataBuffer meshBounds;
+	uint cascadeIndex;
 } PushConstants;
 
 void main() 
 {	
 	Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
-	MeshDrawData drawData = PushConstants.meshBuffer.meshData[gl_DrawID];
-	if(drawData.isTransparent == 1)
-	{
-		return;
-	}
+	// culling packs each draw's surviving instances from its firstInstance onwards
+	uint instanceId = PushConstants.visibleInstances.instances[gl_InstanceIndex];
+	MeshDrawData drawData = PushConstants.meshBuffer.meshData[instanceId];
+	vec3 position = DecodePosition(v, PushConstants.meshBounds.meshBounds[drawData.drawIndex]);
 
-	gl_Position = GlobalSceneData.lightProj * GlobalSceneData.lightView * drawData.transform * vec4(v.position, 1.0f);
+	gl_Position = GlobalSceneData.cascadeViewProj[PushConstants.cascadeIndex] * drawData.transform * vec4(position, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : enable
+#extension GL_GOOGLE_include_directive : require
+
+#include "common.glsl"
+
+layout(set = 1, binding = 0) uniform sampler2D globalTextures[];
+
+layout(set = 2, binding = 0) uniform materialData
+{
+    PBRMaterial materials[MAX_MATERIALS];
+} GlobalMaterialData;
+
+//shader input
+layout (location = 0) in vec2 inUV;
+layout (location = 1) in flat uint inMaterialIndex;
+
+// depth only, alpha tested casters leave holes where the geometry pass discards
+void main() 
+{
+	if(inMaterialIndex < MAX_MATERIALS)
+	{
+		PBRMaterial material = GlobalMaterialData.materials[inMaterialIndex];
+
+		float alpha = texture(globalTextures[nonuniformEXT(material.diffuse)], inUV).a * material.baseColorFactor.a;
+		if(alpha < material.alphaCutoff)
+		{
+			discard;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#version 460
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_buffer_reference2 : require
+#extension GL_GOOGLE_include_directive : require
+
+#include "common.glsl"
+
+layout (location = 0) out vec2 outUV;
+layout (location = 1) out uint outMaterialIndex;
+
+layout(buffer_reference, std430) readonly buffer VertexBuffer{
+	Vertex vertices[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshDrawDataBuffer{
+	MeshDrawData meshData[];
+};
+
+layout(buffer_reference, std430) readonly buffer VisibleInstanceBuffer{
+	uint instances[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshBoundsDataBuffer{
+	MeshBoundsData meshBounds[];
+};
+
+layout(push_constant) uniform constants{
+	VertexBuffer vertexBuffer;
+	MeshDrawDataBuffer meshBuffer;
+	VisibleInstanceBuffer visibleInstances;
+	MeshBoundsDataBuffer meshBounds;
+	uint cascadeIndex;
+} PushConstants;
+
+void main() 
+{	
+	Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
+	// culling packs each draw's surviving instances from its firstInstance onwards
+	uint instanceId = PushConstants.visibleInstances.instances[gl_InstanceIndex];
+	MeshDrawData drawData = PushConstants.meshBuffer.meshData[instanceId];
+	VertexAttributes attributes = DecodeVertex(v, PushConstants.meshBounds.meshBounds[drawData.drawIndex]);
+
+	gl_Position = GlobalSceneData.cascadeViewProj[PushConstants.cascadeIndex] * drawData.transform * vec4(attributes.position, 1.0f);
+	outUV = attributes.uv;
+	outMaterialIndex = drawData.materialIndex;
+}
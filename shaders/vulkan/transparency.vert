@@ -21,27 +21,36 @@ layout(buffer_reference, std430) readonly buffer MeshDrawDataBuffer{
 	MeshDrawData meshData[];
 };
 
+layout(buffer_reference, std430) readonly buffer VisibleInstanceBuffer{
+	uint instances[];
+};
+
+layout(buffer_reference, std430) readonly buffer MeshBoundsDataBuffer{
+	MeshBoundsData meshBounds[];
+};
+
 layout(push_constant) uniform constants{
 	VertexBuffer vertexBuffer;
 	MeshDrawDataBuffer meshBuffer;
+	VisibleInstanceBuffer visibleInstances;
+	MeshBoundsDataBuffer meshBounds;
 } PushConstants;
 
 void main() 
 {	
 	Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
-	MeshDrawData drawData = PushConstants.meshBuffer.meshData[gl_DrawID];
-	if(drawData.isTransparent == 0)
-	{
-		return;
-	}
+	// culling packs each draw's surviving instances from its firstInstance onwards
+	uint instanceId = PushConstants.visibleInstances.instances[gl_InstanceIndex];
+	MeshDrawData drawData = PushConstants.meshBuffer.meshData[instanceId];
+	VertexAttributes attributes = DecodeVertex(v, PushConstants.meshBounds.meshBounds[drawData.drawIndex]);
 
 	//output the position of each vertex
-	gl_Position = GlobalSceneData.viewProj * drawData.transform * vec4(v.position, 1.0f);
-	outUV = vec2(v.u, v.v);
-	outWorldPos = drawData.transform * vec4(v.position, 1.0f);
+	gl_Position = GlobalSceneData.viewProj * drawData.transform * vec4(attributes.position, 1.0f);
+	outUV = attributes.uv;
+	outWorldPos = drawData.transform * vec4(attributes.position, 1.0f);
 	outViewPos = outWorldPos.xyz / outWorldPos.w;
-	outNormal = v.normal;
-	outLightPos = GlobalSceneData.lightProj * GlobalSceneData.lightView * drawData.transform * vec4(v.position, 1.0f);
+	outNormal = attributes.normal;
+	outLightPos = GlobalSceneData.lightProj * GlobalSceneData.lightView * drawData.transform * vec4(attributes.position, 1.0f);
 	outMaterialIndex = drawData.materialIndex;
-	outTangent = v.tangent;
+	outTangent = attributes.tangent;
 }
\ No newline at end of file
@@ -13,19 +13,21 @@ layout(buffer_reference, std430) readonly buffer MeshDrawDataBuffer{
 	MeshDrawData meshData[];
 };
 
+layout(buffer_reference, std430) readonly buffer MeshBoundsDataBuffer{
+	MeshBoundsData meshBounds[];
+};
+
 layout(push_constant) uniform constants{
 	VertexBuffer vertexBuffer;
 	MeshDrawDataBuffer meshBuffer;
+	layout(offset = 24) MeshBoundsDataBuffer meshBounds;
 } PushConstants;
 
 void main() 
 {	
 	Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
-	MeshDrawData drawData = PushConstants.meshBuffer.meshData[gl_DrawID];
-	if(drawData.isTransparent == 1)
-	{
-		return;
-	}
+	MeshDrawData drawData = PushConstants.meshBuffer.meshData[gl_InstanceIndex];
+	vec3 position = DecodePosition(v, PushConstants.meshBounds.meshBounds[drawData.drawIndex]);
 
-	gl_Position = GlobalSceneData.viewProj * drawData.transform * vec4(v.position, 1.0f);
+	gl_Position = GlobalSceneData.viewProj * drawData.transform * vec4(position, 1.0f);
 }
\ No newline at end of file